@@ -0,0 +1,56 @@
+#include "common/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "drake/common/drake_assert.h"
+
+namespace dairlib {
+
+LatencyHistogram::LatencyHistogram(double min_value, double max_value,
+                                   int bins_per_decade)
+    : min_value_(min_value), bins_per_decade_(bins_per_decade) {
+  DRAKE_DEMAND(min_value > 0);
+  DRAKE_DEMAND(max_value > min_value);
+  DRAKE_DEMAND(bins_per_decade > 0);
+  int n_bins = std::ceil(bins_per_decade * std::log10(max_value / min_value));
+  counts_.assign(n_bins, 0);
+}
+
+void LatencyHistogram::Add(double value) {
+  int bin = 0;
+  if (value > min_value_) {
+    bin = std::floor(bins_per_decade_ * std::log10(value / min_value_));
+    bin = std::min(bin, static_cast<int>(counts_.size()) - 1);
+  }
+  counts_[bin]++;
+  count_++;
+  max_ = std::max(max_, value);
+}
+
+double LatencyHistogram::Percentile(double p) const {
+  DRAKE_DEMAND(p >= 0 && p <= 100);
+  if (count_ == 0) return 0;
+  // Smallest bin which contains at least p percent of the samples
+  double target = p / 100 * count_;
+  int cumulative_count = 0;
+  for (unsigned int bin = 0; bin < counts_.size(); bin++) {
+    cumulative_count += counts_[bin];
+    if (cumulative_count >= target && cumulative_count > 0) {
+      // (The last bin also contains the values above max_value)
+      if (bin + 1 == counts_.size()) return max_;
+      double upper_edge =
+          min_value_ * std::pow(10.0, (bin + 1.0) / bins_per_decade_);
+      return std::min(upper_edge, max_);
+    }
+  }
+  return max_;
+}
+
+void LatencyHistogram::Reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  count_ = 0;
+  max_ = 0;
+}
+
+}  // namespace dairlib
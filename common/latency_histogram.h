@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+namespace dairlib {
+
+/// LatencyHistogram keeps a running histogram of durations (in seconds) with
+/// logarithmically spaced bins, so that percentiles of a long-running loop can
+/// be queried without storing the samples. Add() doesn't allocate memory.
+///
+/// Percentile() returns the upper edge of the bin which contains the
+/// percentile, so its relative error is bounded by the bin width
+/// (10^(1/bins_per_decade) - 1, i.e. 12% with the default 20 bins per decade).
+/// The maximum is exact. Values below `min_value` (above `max_value`) are
+/// counted in the first (last) bin.
+class LatencyHistogram {
+ public:
+  explicit LatencyHistogram(double min_value = 1e-7, double max_value = 1,
+                            int bins_per_decade = 20);
+
+  void Add(double value);
+
+  /// `p` in [0, 100]. Returns 0 if there is no sample.
+  double Percentile(double p) const;
+
+  double max() const { return max_; }
+  int count() const { return count_; }
+
+  void Reset();
+
+ private:
+  double min_value_;
+  int bins_per_decade_;
+  std::vector<int> counts_;
+  int count_ = 0;
+  double max_ = 0;
+};
+
+}  // namespace dairlib
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/latency_histogram.h"
+
+namespace dairlib {
+namespace {
+
+TEST(LatencyHistogramTest, Empty) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+  EXPECT_EQ(histogram.Percentile(0), 0);
+  EXPECT_EQ(histogram.Percentile(50), 0);
+  EXPECT_EQ(histogram.Percentile(100), 0);
+}
+
+// One bin per decade between 1ms and 1s, i.e. the bins [1ms, 10ms),
+// [10ms, 100ms) and [100ms, 1s]
+TEST(LatencyHistogramTest, Bins) {
+  LatencyHistogram histogram(1e-3, 1, 1);
+  histogram.Add(0.005);
+  histogram.Add(0.05);
+  histogram.Add(0.5);
+  EXPECT_EQ(histogram.count(), 3);
+  EXPECT_EQ(histogram.max(), 0.5);
+  // The upper edge of the bin of the percentile
+  EXPECT_DOUBLE_EQ(histogram.Percentile(0), 0.01);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(33), 0.01);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(34), 0.1);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(66), 0.1);
+  // ... except for the last bin, which returns the maximum
+  EXPECT_EQ(histogram.Percentile(67), 0.5);
+  EXPECT_EQ(histogram.Percentile(100), 0.5);
+
+  // The values below the range go to the first bin and the ones above it to
+  // the last bin
+  histogram.Add(1e-5);
+  histogram.Add(0);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(40), 0.01);
+  histogram.Add(5);
+  EXPECT_EQ(histogram.max(), 5);
+  EXPECT_EQ(histogram.Percentile(100), 5);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(50), 0.01);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(60), 0.1);
+}
+
+// The percentiles are within a bin width above the exact ones, and never
+// above the maximum
+TEST(LatencyHistogramTest, PercentileError) {
+  LatencyHistogram histogram;
+  const double bin_ratio = std::pow(10.0, 1.0 / 20);
+  std::vector<double> samples;
+  for (int i = 0; i < 1000; i++) {
+    samples.push_back(1e-5 * std::pow(10.0, std::fmod(0.37 * i, 3.0)));
+    histogram.Add(samples.back());
+  }
+  std::sort(samples.begin(), samples.end());
+  EXPECT_EQ(histogram.max(), samples.back());
+  for (double p : {0.1, 1.0, 10.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+    const double exact =
+        samples[static_cast<int>(std::ceil(p / 100 * samples.size())) - 1];
+    EXPECT_GE(histogram.Percentile(p), exact) << p;
+    EXPECT_LE(histogram.Percentile(p), exact * bin_ratio) << p;
+    EXPECT_LE(histogram.Percentile(p), histogram.max()) << p;
+  }
+}
+
+TEST(LatencyHistogramTest, Reset) {
+  LatencyHistogram histogram(1e-3, 1, 1);
+  histogram.Add(0.5);
+  histogram.Add(0.5);
+  histogram.Reset();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.max(), 0);
+  EXPECT_EQ(histogram.Percentile(50), 0);
+
+  // The previous samples are gone from the bins as well
+  histogram.Add(0.005);
+  EXPECT_EQ(histogram.count(), 1);
+  EXPECT_EQ(histogram.max(), 0.005);
+  EXPECT_EQ(histogram.Percentile(100), 0.005);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
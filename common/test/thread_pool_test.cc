@@ -0,0 +1,61 @@
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/thread_pool.h"
+
+namespace dairlib {
+namespace {
+
+TEST(ThreadPoolTest, RunsEveryTaskOnce) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  // Several batches reuse the same workers
+  for (int num_tasks : {0, 1, 3, 100}) {
+    std::vector<int> count(num_tasks, 0);
+    pool.ParallelFor(num_tasks, [&](int i) { count[i]++; });
+    for (int i = 0; i < num_tasks; i++) {
+      EXPECT_EQ(count[i], 1);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, StaticAssignment) {
+  ThreadPool pool(3);
+  std::vector<std::thread::id> thread_ids(9);
+  pool.ParallelFor(9,
+                   [&](int i) { thread_ids[i] = std::this_thread::get_id(); });
+  for (int i = 0; i < 9; i++) {
+    EXPECT_EQ(thread_ids[i], thread_ids[i % 3]);
+  }
+  // Task 0 runs on the calling thread
+  EXPECT_EQ(thread_ids[0], std::this_thread::get_id());
+}
+
+TEST(ThreadPoolTest, SingleThread) {
+  ThreadPool pool(1);
+  int sum = 0;
+  pool.ParallelFor(10, [&](int i) { sum += i; });
+  EXPECT_EQ(sum, 45);
+}
+
+TEST(ThreadPoolTest, RethrowsException) {
+  ThreadPool pool(2);
+  EXPECT_THROW(pool.ParallelFor(4,
+                                [](int i) {
+                                  if (i == 3) throw std::runtime_error("");
+                                }),
+               std::runtime_error);
+  // The pool is still usable
+  std::vector<int> count(4, 0);
+  pool.ParallelFor(4, [&](int i) { count[i]++; });
+  EXPECT_EQ(count, std::vector<int>(4, 1));
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "common/throttled_worker.h"
+
+namespace dairlib {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+TEST(ThrottledWorkerTest, ConsumesLatestValuesInOrder) {
+  std::vector<int> consumed;
+  {
+    ThrottledWorker<int> worker(
+        [&](const int& value) { consumed.push_back(value); }, 1000);
+    for (int i = 1; i <= 1000; i++) {
+      worker.Push(i);
+    }
+    EXPECT_EQ(worker.num_pushed(), 1000);
+  }
+  // The last value is consumed on destruction, and no value is consumed twice
+  ASSERT_FALSE(consumed.empty());
+  EXPECT_EQ(consumed.back(), 1000);
+  for (int i = 1; i < static_cast<int>(consumed.size()); i++) {
+    EXPECT_LT(consumed[i - 1], consumed[i]);
+  }
+}
+
+TEST(ThrottledWorkerTest, LimitsRate) {
+  int num_consumed = 0;
+  const auto start = Clock::now();
+  {
+    ThrottledWorker<int> worker([&](const int&) { num_consumed++; }, 20);
+    int i = 0;
+    while (Clock::now() - start < std::chrono::milliseconds(250)) {
+      worker.Push(i++);
+    }
+  }
+  // At most one value per 50 ms over the lifetime of the worker (which may
+  // be longer than 250 ms on a loaded machine), plus the last one
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  EXPECT_GE(num_consumed, 1);
+  EXPECT_LE(num_consumed, std::floor(elapsed * 20) + 2);
+}
+
+// The consumer is held in its first call while the producer pushes, so the
+// pushes can only complete if they don't wait for it
+TEST(ThrottledWorkerTest, PushDoesNotWaitForConsumer) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool consuming = false;
+  bool released = false;
+  std::vector<double> consumed;
+  {
+    ThrottledWorker<std::vector<double>> worker(
+        [&](const std::vector<double>& value) {
+          std::unique_lock<std::mutex> lock(mutex);
+          consuming = true;
+          cv.notify_all();
+          cv.wait(lock, [&] { return released; });
+          consumed.push_back(value[0]);
+        },
+        100);
+    worker.Push(std::vector<double>(1000, 0));
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return consuming; });
+    }
+
+    for (int i = 1; i <= 100; i++) {
+      worker.Push(std::vector<double>(1000, i));
+    }
+    EXPECT_EQ(worker.num_pushed(), 101);
+    EXPECT_EQ(worker.num_consumed(), 0);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      released = true;
+    }
+    cv.notify_all();
+  }
+  // The blocked value, and the latest one (at the latest on destruction)
+  ASSERT_GE(consumed.size(), 2u);
+  EXPECT_EQ(consumed.front(), 0);
+  EXPECT_EQ(consumed.back(), 100);
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,85 @@
+#include "common/thread_pool.h"
+
+#include "drake/common/drake_assert.h"
+
+namespace dairlib {
+
+ThreadPool::ThreadPool(int num_threads) {
+  DRAKE_DEMAND(num_threads >= 1);
+  exceptions_.resize(num_threads);
+  for (int i = 1; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  batch_started_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::RunTasks(int thread_index) {
+  try {
+    for (int i = thread_index; i < num_tasks_; i += num_threads()) {
+      (*task_)(i);
+    }
+  } catch (...) {
+    exceptions_[thread_index] = std::current_exception();
+  }
+}
+
+void ThreadPool::WorkerLoop(int thread_index) {
+  int last_batch = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      batch_started_.wait(lock,
+                          [&] { return stop_ || batch_ != last_batch; });
+      if (stop_) return;
+      last_batch = batch_;
+    }
+    RunTasks(thread_index);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      num_running_workers_--;
+    }
+    batch_finished_.notify_one();
+  }
+}
+
+void ThreadPool::ParallelFor(int num_tasks,
+                             const std::function<void(int)>& task) {
+  if (workers_.empty() || num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_tasks_ = num_tasks;
+    task_ = &task;
+    num_running_workers_ = workers_.size();
+    std::fill(exceptions_.begin(), exceptions_.end(), nullptr);
+    batch_++;
+  }
+  batch_started_.notify_all();
+  RunTasks(0);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    batch_finished_.wait(lock, [&] { return num_running_workers_ == 0; });
+    task_ = nullptr;
+  }
+
+  for (const auto& exception : exceptions_) {
+    if (exception) std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace dairlib
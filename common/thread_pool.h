@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dairlib {
+
+/// ThreadPool keeps a fixed set of worker threads alive for running batches of
+/// independent tasks (e.g. the constraint evaluations of a trajectory
+/// optimization), so that the threads are not created for every batch.
+///
+/// ParallelFor() assigns the tasks statically: task i runs on thread
+/// i % num_threads(), where thread 0 is the calling thread. The assignment
+/// doesn't depend on the timing of the threads, so a task which only writes
+/// its own outputs gives the same result as a serial loop.
+class ThreadPool {
+ public:
+  /// `num_threads` includes the calling thread (num_threads - 1 workers are
+  /// created)
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  /// Runs task(i) for i in [0, num_tasks) and returns once all of them are
+  /// done. If tasks throw, the first exception (in task order of the
+  /// threads) is rethrown. Not reentrant.
+  void ParallelFor(int num_tasks, const std::function<void(int)>& task);
+
+ private:
+  void WorkerLoop(int thread_index);
+  // Runs the tasks of `thread_index` in the current batch
+  void RunTasks(int thread_index);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable batch_started_;
+  std::condition_variable batch_finished_;
+  // Current batch (guarded by mutex_)
+  int batch_ = 0;
+  int num_tasks_ = 0;
+  const std::function<void(int)>* task_ = nullptr;
+  int num_running_workers_ = 0;
+  bool stop_ = false;
+  // Exception of each thread in the current batch
+  std::vector<std::exception_ptr> exceptions_;
+};
+
+}  // namespace dairlib
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "drake/common/drake_assert.h"
+
+namespace dairlib {
+
+/// ThrottledWorker moves the handling of a stream of values (e.g. drawing the
+/// iterates of a solver) off the thread producing them. Push() hands a value
+/// to a background thread which calls `consumer` on it, at most `max_rate`
+/// times per second. Values pushed in between are skipped: only the latest
+/// one is kept.
+///
+/// Push() never blocks. The values go through a triple buffer: the producer
+/// writes to its own slot and atomically swaps it with the shared middle
+/// slot, from which the consumer takes the latest value the same way. So the
+/// producer only pays for a copy (without allocations once T has reached its
+/// size, e.g. for a fixed-size Eigen::VectorXd).
+///
+/// Push() must only be called from one thread at a time. The destructor
+/// consumes the last value if it is pending, so the final value is never
+/// skipped.
+template <typename T>
+class ThrottledWorker {
+ public:
+  ThrottledWorker(std::function<void(const T&)> consumer, double max_rate)
+      : consumer_(consumer),
+        period_(std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / max_rate))) {
+    DRAKE_DEMAND(max_rate > 0);
+    thread_ = std::thread(&ThrottledWorker::Loop, this);
+  }
+
+  ~ThrottledWorker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    stop_requested_.notify_one();
+    thread_.join();
+  }
+
+  ThrottledWorker(const ThrottledWorker&) = delete;
+  ThrottledWorker& operator=(const ThrottledWorker&) = delete;
+
+  /// `value` is assigned to a T (e.g. an Eigen::Ref to an Eigen::VectorXd)
+  template <typename U>
+  void Push(const U& value) {
+    slots_[back_] = value;
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            ~kFresh;
+    num_pushed_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  int num_pushed() const { return num_pushed_.load(); }
+
+  /// Number of values passed to the consumer (so far)
+  int num_consumed() const { return num_consumed_.load(); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  // Set in middle_ when the middle slot holds a value not consumed yet
+  static constexpr int kFresh = 4;
+
+  // Consumes the latest value, if there is a new one
+  void ConsumeLatest() {
+    if (!(middle_.load(std::memory_order_acquire) & kFresh)) return;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~kFresh;
+    consumer_(slots_[front_]);
+    num_consumed_.fetch_add(1);
+  }
+
+  void Loop() {
+    auto next = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+      lock.unlock();
+      ConsumeLatest();
+      lock.lock();
+      next = std::max(next + period_, Clock::now());
+      stop_requested_.wait_until(lock, next, [this] { return stop_; });
+    }
+    lock.unlock();
+    ConsumeLatest();
+  }
+
+  const std::function<void(const T&)> consumer_;
+  const Clock::duration period_;
+
+  std::array<T, 3> slots_;
+  // Slot written by the producer
+  int back_ = 0;
+  // Slot read by the consumer
+  int front_ = 1;
+  // Shared slot (and kFresh)
+  std::atomic<int> middle_{2};
+  std::atomic<int> num_pushed_{0};
+  std::atomic<int> num_consumed_{0};
+
+  // Only to wake up the consumer thread when stopping
+  std::mutex mutex_;
+  std::condition_variable stop_requested_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace dairlib
@@ -89,10 +89,31 @@ CassieStateEstimator::CassieStateEstimator(
               &CassieStateEstimator::CopyEstimatedContactForces)
           .get_index();
 
-  // Initialize index maps
-  actuator_idx_map_ = multibody::makeNameToActuatorsMap(plant);
-  position_idx_map_ = multibody::makeNameToPositionsMap(plant);
-  velocity_idx_map_ = multibody::makeNameToVelocitiesMap(plant);
+  // Initialize the indices of the joints
+  const multibody::StateIndexLayout layout(plant);
+  for (const std::string side : {"left", "right"}) {
+    auto position = [&](const std::string& joint) {
+      return layout.position_index(joint + "_" + side);
+    };
+    auto velocity = [&](const std::string& joint) {
+      return layout.velocity_index(joint + "_" + side + "dot");
+    };
+    auto motor = [&](const std::string& joint) {
+      return layout.actuator_index(joint + "_" + side + "_motor");
+    };
+    const bool left = (side == "left");
+    (left ? left_position_idx_ : right_position_idx_) = {
+        position("hip_roll"), position("hip_yaw"), position("hip_pitch"),
+        position("knee"), position("toe"), position("knee_joint"),
+        position("ankle_joint"), position("ankle_spring_joint")};
+    (left ? left_velocity_idx_ : right_velocity_idx_) = {
+        velocity("hip_roll"), velocity("hip_yaw"), velocity("hip_pitch"),
+        velocity("knee"), velocity("toe"), velocity("knee_joint"),
+        velocity("ankle_joint"), velocity("ankle_spring_joint")};
+    (left ? left_motor_idx_ : right_motor_idx_) = {
+        motor("hip_roll"), motor("hip_yaw"), motor("hip_pitch"),
+        motor("knee"), motor("toe")};
+  }
 
   if (is_floating_base_) {
     // Middle point between the front and the rear contact points
@@ -108,6 +129,18 @@ CassieStateEstimator::CassieStateEstimator(
               .get_index();
     }
 
+    const std::vector<std::string> base_positions = {
+        "base_qw", "base_qx", "base_qy", "base_qz", "base_x", "base_y",
+        "base_z"};
+    for (int i = 0; i < 7; i++) {
+      base_position_idx_[i] = layout.position_index(base_positions[i]);
+    }
+    const std::vector<std::string> base_velocities = {
+        "base_wx", "base_wy", "base_wz", "base_vx", "base_vy", "base_vz"};
+    for (int i = 0; i < 6; i++) {
+      base_velocity_idx_[i] = layout.velocity_index(base_velocities[i]);
+    }
+
     // a state which stores previous timestamp
     time_idx_ = DeclareDiscreteState(VectorXd::Zero(1));
 
@@ -115,12 +148,13 @@ CassieStateEstimator::CassieStateEstimator(
     joint_selection_matrices.emplace_back(MatrixXd::Zero(n_v_, n_v_));
     joint_selection_matrices.emplace_back(MatrixXd::Zero(n_v_, n_v_));
     vector<string> leg_names = {"left, right"};
-    for (const auto& joint_name : velocity_idx_map_) {
-      if (joint_name.first.find("left") != std::string::npos) {
-        joint_selection_matrices[0](joint_name.second, joint_name.second) = 1;
+    for (int i = 0; i < n_v_; i++) {
+      const string& joint_name = layout.velocity_names()[i];
+      if (joint_name.find("left") != std::string::npos) {
+        joint_selection_matrices[0](i, i) = 1;
       }
-      if (joint_name.first.find("right") != std::string::npos) {
-        joint_selection_matrices[1](joint_name.second, joint_name.second) = 1;
+      if (joint_name.find("right") != std::string::npos) {
+        joint_selection_matrices[1](i, i) = 1;
       }
     }
 
@@ -305,26 +339,26 @@ void CassieStateEstimator::AssignImuValueToOutputVector(
 void CassieStateEstimator::AssignActuationFeedbackToOutputVector(
     const cassie_out_t& cassie_out, OutputVector<double>* output) const {
   // Copy actuators
-  output->SetEffortAtIndex(actuator_idx_map_.at("hip_roll_left_motor"),
+  output->SetEffortAtIndex(left_motor_idx_.hip_roll,
                            cassie_out.leftLeg.hipRollDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("hip_yaw_left_motor"),
+  output->SetEffortAtIndex(left_motor_idx_.hip_yaw,
                            cassie_out.leftLeg.hipYawDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("hip_pitch_left_motor"),
+  output->SetEffortAtIndex(left_motor_idx_.hip_pitch,
                            cassie_out.leftLeg.hipPitchDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("knee_left_motor"),
+  output->SetEffortAtIndex(left_motor_idx_.knee,
                            cassie_out.leftLeg.kneeDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("toe_left_motor"),
+  output->SetEffortAtIndex(left_motor_idx_.toe,
                            cassie_out.leftLeg.footDrive.torque);
 
-  output->SetEffortAtIndex(actuator_idx_map_.at("hip_roll_right_motor"),
+  output->SetEffortAtIndex(right_motor_idx_.hip_roll,
                            cassie_out.rightLeg.hipRollDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("hip_yaw_right_motor"),
+  output->SetEffortAtIndex(right_motor_idx_.hip_yaw,
                            cassie_out.rightLeg.hipYawDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("hip_pitch_right_motor"),
+  output->SetEffortAtIndex(right_motor_idx_.hip_pitch,
                            cassie_out.rightLeg.hipPitchDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("knee_right_motor"),
+  output->SetEffortAtIndex(right_motor_idx_.knee,
                            cassie_out.rightLeg.kneeDrive.torque);
-  output->SetEffortAtIndex(actuator_idx_map_.at("toe_right_motor"),
+  output->SetEffortAtIndex(right_motor_idx_.toe,
                            cassie_out.rightLeg.footDrive.torque);
 }
 
@@ -333,73 +367,69 @@ void CassieStateEstimator::AssignNonFloatingBaseStateToOutputVector(
   // Copy the robot state excluding floating base
   // TODO(yuming): check what cassie_out.leftLeg.footJoint.position is.
   // Similarly, the other leg and the velocity of these joints.
-  output->SetPositionAtIndex(position_idx_map_.at("hip_roll_left"),
+  output->SetPositionAtIndex(left_position_idx_.hip_roll,
                              cassie_out.leftLeg.hipRollDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("hip_yaw_left"),
+  output->SetPositionAtIndex(left_position_idx_.hip_yaw,
                              cassie_out.leftLeg.hipYawDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("hip_pitch_left"),
+  output->SetPositionAtIndex(left_position_idx_.hip_pitch,
                              cassie_out.leftLeg.hipPitchDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("knee_left"),
+  output->SetPositionAtIndex(left_position_idx_.knee,
                              cassie_out.leftLeg.kneeDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("toe_left"),
+  output->SetPositionAtIndex(left_position_idx_.toe,
                              cassie_out.leftLeg.footDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("knee_joint_left"),
+  output->SetPositionAtIndex(left_position_idx_.knee_joint,
                              cassie_out.leftLeg.shinJoint.position);
-  output->SetPositionAtIndex(position_idx_map_.at("ankle_joint_left"),
+  output->SetPositionAtIndex(left_position_idx_.ankle_joint,
                              cassie_out.leftLeg.tarsusJoint.position);
-  output->SetPositionAtIndex(position_idx_map_.at("ankle_spring_joint_left"),
-                             0.0);
+  output->SetPositionAtIndex(left_position_idx_.ankle_spring_joint, 0.0);
 
-  output->SetPositionAtIndex(position_idx_map_.at("hip_roll_right"),
+  output->SetPositionAtIndex(right_position_idx_.hip_roll,
                              cassie_out.rightLeg.hipRollDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("hip_yaw_right"),
+  output->SetPositionAtIndex(right_position_idx_.hip_yaw,
                              cassie_out.rightLeg.hipYawDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("hip_pitch_right"),
+  output->SetPositionAtIndex(right_position_idx_.hip_pitch,
                              cassie_out.rightLeg.hipPitchDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("knee_right"),
+  output->SetPositionAtIndex(right_position_idx_.knee,
                              cassie_out.rightLeg.kneeDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("toe_right"),
+  output->SetPositionAtIndex(right_position_idx_.toe,
                              cassie_out.rightLeg.footDrive.position);
-  output->SetPositionAtIndex(position_idx_map_.at("knee_joint_right"),
+  output->SetPositionAtIndex(right_position_idx_.knee_joint,
                              cassie_out.rightLeg.shinJoint.position);
-  output->SetPositionAtIndex(position_idx_map_.at("ankle_joint_right"),
+  output->SetPositionAtIndex(right_position_idx_.ankle_joint,
                              cassie_out.rightLeg.tarsusJoint.position);
-  output->SetPositionAtIndex(position_idx_map_.at("ankle_spring_joint_right"),
-                             0.0);
+  output->SetPositionAtIndex(right_position_idx_.ankle_spring_joint, 0.0);
 
-  output->SetVelocityAtIndex(velocity_idx_map_.at("hip_roll_leftdot"),
+  output->SetVelocityAtIndex(left_velocity_idx_.hip_roll,
                              cassie_out.leftLeg.hipRollDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("hip_yaw_leftdot"),
+  output->SetVelocityAtIndex(left_velocity_idx_.hip_yaw,
                              cassie_out.leftLeg.hipYawDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("hip_pitch_leftdot"),
+  output->SetVelocityAtIndex(left_velocity_idx_.hip_pitch,
                              cassie_out.leftLeg.hipPitchDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("knee_leftdot"),
+  output->SetVelocityAtIndex(left_velocity_idx_.knee,
                              cassie_out.leftLeg.kneeDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("toe_leftdot"),
+  output->SetVelocityAtIndex(left_velocity_idx_.toe,
                              cassie_out.leftLeg.footDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("knee_joint_leftdot"),
+  output->SetVelocityAtIndex(left_velocity_idx_.knee_joint,
                              cassie_out.leftLeg.shinJoint.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("ankle_joint_leftdot"),
+  output->SetVelocityAtIndex(left_velocity_idx_.ankle_joint,
                              cassie_out.leftLeg.tarsusJoint.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("ankle_spring_joint_leftdot"),
-                             0.0);
+  output->SetVelocityAtIndex(left_velocity_idx_.ankle_spring_joint, 0.0);
 
-  output->SetVelocityAtIndex(velocity_idx_map_.at("hip_roll_rightdot"),
+  output->SetVelocityAtIndex(right_velocity_idx_.hip_roll,
                              cassie_out.rightLeg.hipRollDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("hip_yaw_rightdot"),
+  output->SetVelocityAtIndex(right_velocity_idx_.hip_yaw,
                              cassie_out.rightLeg.hipYawDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("hip_pitch_rightdot"),
+  output->SetVelocityAtIndex(right_velocity_idx_.hip_pitch,
                              cassie_out.rightLeg.hipPitchDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("knee_rightdot"),
+  output->SetVelocityAtIndex(right_velocity_idx_.knee,
                              cassie_out.rightLeg.kneeDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("toe_rightdot"),
+  output->SetVelocityAtIndex(right_velocity_idx_.toe,
                              cassie_out.rightLeg.footDrive.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("knee_joint_rightdot"),
+  output->SetVelocityAtIndex(right_velocity_idx_.knee_joint,
                              cassie_out.rightLeg.shinJoint.velocity);
-  output->SetVelocityAtIndex(velocity_idx_map_.at("ankle_joint_rightdot"),
+  output->SetVelocityAtIndex(right_velocity_idx_.ankle_joint,
                              cassie_out.rightLeg.tarsusJoint.velocity);
-  output->SetVelocityAtIndex(
-      velocity_idx_map_.at("ankle_spring_joint_rightdot"), 0.0);
+  output->SetVelocityAtIndex(right_velocity_idx_.ankle_spring_joint, 0.0);
 
   // Solve fourbar linkage for heel spring positions
   double left_heel_spring = 0;
@@ -415,28 +445,28 @@ void CassieStateEstimator::AssignNonFloatingBaseStateToOutputVector(
     q[0] = 1;
   }
   solveFourbarLinkage(q, &left_heel_spring, &right_heel_spring);
-  output->SetPositionAtIndex(position_idx_map_.at("ankle_spring_joint_left"),
+  output->SetPositionAtIndex(left_position_idx_.ankle_spring_joint,
                              left_heel_spring);
-  output->SetPositionAtIndex(position_idx_map_.at("ankle_spring_joint_right"),
+  output->SetPositionAtIndex(right_position_idx_.ankle_spring_joint,
                              right_heel_spring);
 }
 
 void CassieStateEstimator::AssignFloatingBaseStateToOutputVector(
     const VectorXd& est_fb_state, OutputVector<double>* output) const {
-  output->SetPositionAtIndex(position_idx_map_.at("base_qw"), est_fb_state(0));
-  output->SetPositionAtIndex(position_idx_map_.at("base_qx"), est_fb_state(1));
-  output->SetPositionAtIndex(position_idx_map_.at("base_qy"), est_fb_state(2));
-  output->SetPositionAtIndex(position_idx_map_.at("base_qz"), est_fb_state(3));
-  output->SetPositionAtIndex(position_idx_map_.at("base_x"), est_fb_state(4));
-  output->SetPositionAtIndex(position_idx_map_.at("base_y"), est_fb_state(5));
-  output->SetPositionAtIndex(position_idx_map_.at("base_z"), est_fb_state(6));
-
-  output->SetVelocityAtIndex(velocity_idx_map_.at("base_wx"), est_fb_state(7));
-  output->SetVelocityAtIndex(velocity_idx_map_.at("base_wy"), est_fb_state(8));
-  output->SetVelocityAtIndex(velocity_idx_map_.at("base_wz"), est_fb_state(9));
-  output->SetVelocityAtIndex(velocity_idx_map_.at("base_vx"), est_fb_state(10));
-  output->SetVelocityAtIndex(velocity_idx_map_.at("base_vy"), est_fb_state(11));
-  output->SetVelocityAtIndex(velocity_idx_map_.at("base_vz"), est_fb_state(12));
+  output->SetPositionAtIndex(base_position_idx_[0], est_fb_state(0));
+  output->SetPositionAtIndex(base_position_idx_[1], est_fb_state(1));
+  output->SetPositionAtIndex(base_position_idx_[2], est_fb_state(2));
+  output->SetPositionAtIndex(base_position_idx_[3], est_fb_state(3));
+  output->SetPositionAtIndex(base_position_idx_[4], est_fb_state(4));
+  output->SetPositionAtIndex(base_position_idx_[5], est_fb_state(5));
+  output->SetPositionAtIndex(base_position_idx_[6], est_fb_state(6));
+
+  output->SetVelocityAtIndex(base_velocity_idx_[0], est_fb_state(7));
+  output->SetVelocityAtIndex(base_velocity_idx_[1], est_fb_state(8));
+  output->SetVelocityAtIndex(base_velocity_idx_[2], est_fb_state(9));
+  output->SetVelocityAtIndex(base_velocity_idx_[3], est_fb_state(10));
+  output->SetVelocityAtIndex(base_velocity_idx_[4], est_fb_state(11));
+  output->SetVelocityAtIndex(base_velocity_idx_[5], est_fb_state(12));
 }
 
 /// EstimateContactForEkf(). Conservative estimation.
@@ -491,13 +521,13 @@ void CassieStateEstimator::EstimateContactForEkf(
   // deflections are *both* over some thresholds. We don't update anything
   // if it's under the threshold.
   const double& left_knee_spring =
-      output.GetPositionAtIndex(position_idx_map_.at("knee_joint_left"));
+      output.GetPositionAtIndex(left_position_idx_.knee_joint);
   const double& right_knee_spring =
-      output.GetPositionAtIndex(position_idx_map_.at("knee_joint_right"));
+      output.GetPositionAtIndex(right_position_idx_.knee_joint);
   const double& left_heel_spring = output.GetPositionAtIndex(
-      position_idx_map_.at("ankle_spring_joint_left"));
+      left_position_idx_.ankle_spring_joint);
   const double& right_heel_spring = output.GetPositionAtIndex(
-      position_idx_map_.at("ankle_spring_joint_right"));
+      right_position_idx_.ankle_spring_joint);
   bool left_contact_spring = (left_knee_spring < knee_spring_threshold_ekf_ &&
                               left_heel_spring < heel_spring_threshold_ekf_);
   bool right_contact_spring = (right_knee_spring < knee_spring_threshold_ekf_ &&
@@ -554,13 +584,13 @@ void CassieStateEstimator::EstimateContactForController(
   // deflection is over a threshold. We don't update anything if it's under
   // the threshold.
   const double& left_knee_spring =
-      output.GetPositionAtIndex(position_idx_map_.at("knee_joint_left"));
+      output.GetPositionAtIndex(left_position_idx_.knee_joint);
   const double& right_knee_spring =
-      output.GetPositionAtIndex(position_idx_map_.at("knee_joint_right"));
+      output.GetPositionAtIndex(right_position_idx_.knee_joint);
   const double& left_heel_spring = output.GetPositionAtIndex(
-      position_idx_map_.at("ankle_spring_joint_left"));
+      left_position_idx_.ankle_spring_joint);
   const double& right_heel_spring = output.GetPositionAtIndex(
-      position_idx_map_.at("ankle_spring_joint_right"));
+      right_position_idx_.ankle_spring_joint);
   bool left_contact_spring = (left_knee_spring < knee_spring_threshold_ctrl_ ||
                               left_heel_spring < heel_spring_threshold_ctrl_);
   bool right_contact_spring =
@@ -616,7 +646,7 @@ EventStatus CassieStateEstimator::Update(
     // is not triggered by CASSIE_STATE_SIMULATION message.
     // This wouldn't be an issue when you don't use ground truth state.
     if (output_gt.GetPositions().head(7).norm() == 0) {
-      output_gt.SetPositionAtIndex(position_idx_map_.at("base_qw"), 1);
+      output_gt.SetPositionAtIndex(base_position_idx_[0], 1);
     }
 
     // Get kinematics cache for ground truth
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <fstream>
 #include <map>
 #include <memory>
@@ -154,9 +155,36 @@ class CassieStateEstimator : public drake::systems::LeafSystem<double> {
   const bool is_floating_base_;
   std::unique_ptr<drake::systems::Context<double>> context_;
 
-  std::map<std::string, int> position_idx_map_;
-  std::map<std::string, int> velocity_idx_map_;
-  std::map<std::string, int> actuator_idx_map_;
+  // Indices of the joints of a leg in the positions (or velocities)
+  struct LegIndices {
+    int hip_roll;
+    int hip_yaw;
+    int hip_pitch;
+    int knee;
+    int toe;
+    int knee_joint;
+    int ankle_joint;
+    int ankle_spring_joint;
+  };
+  // Indices of the motors of a leg in the efforts
+  struct MotorIndices {
+    int hip_roll;
+    int hip_yaw;
+    int hip_pitch;
+    int knee;
+    int toe;
+  };
+  // Looked up by name once, in the constructor
+  LegIndices left_position_idx_;
+  LegIndices right_position_idx_;
+  LegIndices left_velocity_idx_;
+  LegIndices right_velocity_idx_;
+  MotorIndices left_motor_idx_;
+  MotorIndices right_motor_idx_;
+  // base_qw, base_qx, base_qy, base_qz, base_x, base_y, base_z and base_wx,
+  // base_wy, base_wz, base_vx, base_vy, base_vz (with a floating base only)
+  std::array<int, 7> base_position_idx_;
+  std::array<int, 6> base_velocity_idx_;
 
   // Body frames
   std::vector<const drake::multibody::Frame<double>*> toe_frames_;
@@ -5,6 +5,7 @@
 #include <drake/multibody/inverse_kinematics/inverse_kinematics.h>
 #include <drake/multibody/plant/multibody_plant.h>
 #include <drake/solvers/choose_best_solver.h>
+#include <drake/solvers/ipopt_solver.h>
 #include <drake/solvers/snopt_solver.h>
 #include <drake/systems/analysis/simulator.h>
 #include <gflags/gflags.h>
@@ -14,6 +15,7 @@
 #include "lcm/lcm_trajectory.h"
 #include "multibody/multibody_utils.h"
 #include "multibody/visualization_utils.h"
+#include "solvers/solver_options.h"
 #include "systems/trajectory_optimization/dircon_distance_data.h"
 #include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
 #include "systems/trajectory_optimization/dircon_opt_constraints.h"
@@ -73,6 +75,8 @@ DEFINE_string(save_filename, "default_filename",
               "Filename to save decision "
               "vars to.");
 DEFINE_string(traj_name, "", "File to load saved LCM trajs from.");
+DEFINE_bool(ipopt, false, "Use IPOPT as solver instead of SNOPT");
+DEFINE_bool(playback, true, "Playback the solution");
 
 namespace dairlib {
 
@@ -229,23 +233,21 @@ void DoMain() {
   auto trajopt = std::make_shared<HybridDircon<double>>(
       plant, timesteps, min_dt, max_dt, contact_mode_list, options_list);
 
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(), "Print file",
-                           "../jumping_snopt.out");
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Major iterations limit", 50000);
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Iterations limit", 50000);  // QP subproblems
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(), "Verify level",
-                           0);  // 0
-  trajopt->SetSolverOption(
-      drake::solvers::SnoptSolver::id(), "Scale option",
-      FLAGS_scale_option);  // snopt doc said try 2 if seeing snopta exit 40
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Major optimality tolerance",
-                           FLAGS_tol);  // target nonlinear constraint violation
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Major feasibility tolerance",
-                           FLAGS_tol);  // target complementarity gap
+  if (FLAGS_ipopt) {
+    solvers::IpoptOptions ipopt_options;
+    ipopt_options.max_iter = 50000;
+    ipopt_options.tol = FLAGS_tol;
+    solvers::SetIpoptOptions(ipopt_options, trajopt.get());
+  } else {
+    solvers::SnoptOptions snopt_options;
+    snopt_options.print_file = "../jumping_snopt.out";
+    snopt_options.major_iterations_limit = 50000;
+    snopt_options.iterations_limit = 50000;
+    snopt_options.scale_option = FLAGS_scale_option;
+    snopt_options.major_optimality_tolerance = FLAGS_tol;
+    snopt_options.major_feasibility_tolerance = FLAGS_tol;
+    solvers::SetSnoptOptions(snopt_options, trajopt.get());
+  }
 
   std::cout << "Adding kinematic constraints: " << std::endl;
   setKinematicConstraints(trajopt.get(), plant);
@@ -332,12 +334,17 @@ void DoMain() {
   //    cout << endl;
   //  }
 
-  cout << "\nChoose the best solver: "
-       << drake::solvers::ChooseBestSolver(*trajopt).name() << endl;
+  const auto solver_id = FLAGS_ipopt
+                             ? drake::solvers::IpoptSolver::id()
+                             : drake::solvers::ChooseBestSolver(*trajopt);
+  cout << "\nChose the solver: " << solver_id.name() << endl;
 
   cout << "Solving DIRCON\n\n";
   auto start = std::chrono::high_resolution_clock::now();
-  const auto result = Solve(*trajopt, trajopt->initial_guess());
+  auto solver = drake::solvers::MakeSolver(solver_id);
+  MathematicalProgramResult result;
+  solver->Solve(*trajopt, trajopt->initial_guess(), trajopt->solver_options(),
+                &result);
   //  SolutionResult solution_result = result.get_solution_result();
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
@@ -359,7 +366,7 @@ void DoMain() {
 
   auto diagram = builder.Build();
 
-  while (true) {
+  while (FLAGS_playback) {
     drake::systems::Simulator<double> simulator(*diagram);
     simulator.set_target_realtime_rate(0.5);
     simulator.Initialize();
@@ -17,6 +17,7 @@
 #include "multibody/multibody_utils.h"
 #include "solvers/nonlinear_constraint.h"
 #include "solvers/optimization_utils.h"
+#include "solvers/solver_options.h"
 #include "systems/primitives/subvector_pass_through.h"
 #include "systems/trajectory_optimization/dircon/dircon.h"
 
@@ -80,6 +81,14 @@ DEFINE_bool(playback, true, "Playback the solution");
 // Parameters which enable dircon-improving features
 DEFINE_bool(scale_constraint, true, "Scale the nonlinear constraint values");
 DEFINE_bool(scale_variable, false, "Scale the decision variable");
+DEFINE_bool(auto_scale, false,
+            "Equilibrate the constraint Jacobians at the initial guess (on "
+            "top of scale_constraint and scale_variable)");
+DEFINE_double(visualization_rate, 10,
+              "Maximum rate (Hz) of the solver visualization, drawn on a "
+              "background thread (0 draws every iterate on the solver thread)");
+DEFINE_int32(num_threads, 1,
+             "Number of threads of Dircon's batched constraint evaluation");
 
 namespace dairlib {
 using systems::trajectory_optimization::Dircon;
@@ -223,44 +232,19 @@ void DoMain(double duration, int max_iter, string data_directory,
   // double_support.set_constraint_type(num_knotpoints - 1,
   //                                   KinematicConstraintType::kAccelOnly);
 
-  auto trajopt = Dircon<double>(&double_support);
+  auto trajopt = Dircon<double>(&double_support, FLAGS_num_threads);
 
   if (FLAGS_ipopt) {
-    // Ipopt settings adapted from CaSaDi and FROST
-    auto id = drake::solvers::IpoptSolver::id();
-    trajopt.SetSolverOption(id, "tol", tol);
-    trajopt.SetSolverOption(id, "dual_inf_tol", tol);
-    trajopt.SetSolverOption(id, "constr_viol_tol", tol);
-    trajopt.SetSolverOption(id, "compl_inf_tol", tol);
-    trajopt.SetSolverOption(id, "max_iter", max_iter);
-    trajopt.SetSolverOption(id, "nlp_lower_bound_inf", -1e6);
-    trajopt.SetSolverOption(id, "nlp_upper_bound_inf", 1e6);
-    trajopt.SetSolverOption(id, "print_timing_statistics", "yes");
-    trajopt.SetSolverOption(id, "print_level", 5);
-
-    // Set to ignore overall tolerance/dual infeasibility, but terminate when
-    // primal feasible and objective fails to increase over 5 iterations.
-    trajopt.SetSolverOption(id, "acceptable_compl_inf_tol", tol);
-    trajopt.SetSolverOption(id, "acceptable_constr_viol_tol", tol);
-    trajopt.SetSolverOption(id, "acceptable_obj_change_tol", 1e-3);
-    trajopt.SetSolverOption(id, "acceptable_tol", 1e2);
-    trajopt.SetSolverOption(id, "acceptable_iter", 5);
+    solvers::IpoptOptions ipopt_options;
+    ipopt_options.max_iter = max_iter;
+    ipopt_options.tol = tol;
+    solvers::SetIpoptOptions(ipopt_options, &trajopt);
   } else {
-    // Snopt settings
-    auto id = drake::solvers::SnoptSolver::id();
-    // trajopt.SetSolverOption(id, "Print file", "../snopt.out");
-    trajopt.SetSolverOption(id, "Major iterations limit", max_iter);
-    trajopt.SetSolverOption(id, "Iterations limit", 100000);
-    trajopt.SetSolverOption(id, "Verify level", 0);
-
-    // snopt doc said try 2 if seeing snopta exit 40
-    trajopt.SetSolverOption(id, "Scale option", 0);
-
-    // target nonlinear constraint violation
-    trajopt.SetSolverOption(id, "Major optimality tolerance", tol);
-
-    // target complementarity gap
-    trajopt.SetSolverOption(id, "Major feasibility tolerance", tol);
+    solvers::SnoptOptions snopt_options;
+    snopt_options.major_iterations_limit = max_iter;
+    snopt_options.major_optimality_tolerance = tol;
+    snopt_options.major_feasibility_tolerance = tol;
+    solvers::SetSnoptOptions(snopt_options, &trajopt);
   }
 
   // Get the decision variables that will be used
@@ -479,10 +463,15 @@ void DoMain(double duration, int max_iter, string data_directory,
     }
   }
 
+  if (FLAGS_auto_scale) {
+    trajopt.AutoScale();
+  }
+
   double alpha = .2;
   int num_poses = std::min(num_knotpoints, 5);
   trajopt.CreateVisualizationCallback(
       "examples/Cassie/urdf/cassie_fixed_springs.urdf", num_poses, alpha);
+  trajopt.SetAsyncVisualization(FLAGS_visualization_rate);
 
   drake::solvers::SolverId solver_id("");
 
@@ -494,6 +483,22 @@ void DoMain(double duration, int max_iter, string data_directory,
     cout << "\nChose the best solver: " << solver_id.name() << endl;
   }
 
+  if (FLAGS_num_threads > 1) {
+    // Time the batched evaluation of the nonlinear constraints (and their
+    // gradients) at the initial guess
+    VectorXd z0 = trajopt.initial_guess().unaryExpr(
+        [](double z) { return std::isnan(z) ? 0 : z; });
+    std::vector<VectorXd> values;
+    std::vector<MatrixXd> gradients;
+    auto eval_start = std::chrono::high_resolution_clock::now();
+    trajopt.EvalGenericConstraints(z0, &values, &gradients);
+    auto eval_finish = std::chrono::high_resolution_clock::now();
+    cout << "Constraint evaluation with " << FLAGS_num_threads
+         << " threads: "
+         << std::chrono::duration<double>(eval_finish - eval_start).count()
+         << " seconds\n";
+  }
+
   cout << "Solving DIRCON\n\n";
   auto start = std::chrono::high_resolution_clock::now();
   auto solver = drake::solvers::MakeSolver(solver_id);
@@ -510,6 +515,11 @@ void DoMain(double duration, int max_iter, string data_directory,
   cout << "\n" << to_string(solution_result) << endl;
   cout << "Solve time:" << elapsed.count() << std::endl;
   cout << "Cost:" << result.get_optimal_cost() << std::endl;
+  const auto cache_stats = trajopt.GetDynamicsCacheStats();
+  cout << "Dynamics cache: " << cache_stats.hits << " hits, "
+       << cache_stats.misses << " misses, " << cache_stats.evictions
+       << " evictions (hit rate " << cache_stats.hit_rate() << ", "
+       << cache_stats.bytes / 1024 << " kB)" << std::endl;
 
   // Save trajectory to file
   if (!FLAGS_save_filename.empty()) {
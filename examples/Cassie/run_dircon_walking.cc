@@ -13,6 +13,7 @@
 #include "multibody/com_pose_system.h"
 #include "multibody/multibody_utils.h"
 #include "multibody/visualization_utils.h"
+#include "solvers/solver_options.h"
 #include "systems/primitives/subvector_pass_through.h"
 #include "systems/trajectory_optimization/dircon_distance_data.h"
 #include "systems/trajectory_optimization/dircon_kinematic_data_set.h"
@@ -26,6 +27,7 @@
 #include "drake/multibody/parsing/parser.h"
 #include "drake/solvers/choose_best_solver.h"
 #include "drake/solvers/constraint.h"
+#include "drake/solvers/ipopt_solver.h"
 #include "drake/solvers/snopt_solver.h"
 #include "drake/solvers/solve.h"
 #include "drake/systems/analysis/simulator.h"
@@ -96,6 +98,8 @@ DEFINE_bool(is_scale_variable, true, "Scale the decision variable");
 // Others
 DEFINE_bool(visualize_init_guess, false,
             "to visualize the poses of the initial guess");
+DEFINE_bool(ipopt, false, "Use IPOPT as solver instead of SNOPT");
+DEFINE_bool(playback, true, "Playback the solution");
 
 namespace dairlib {
 
@@ -438,24 +442,19 @@ void DoMain(double duration, double stride_length, double ground_incline,
   auto trajopt = std::make_shared<HybridDircon<double>>(
       plant, num_time_samples, min_dt, max_dt, dataset_list, options_list);
 
-  // Snopt settings
-  //  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(), "Print file",
-  //                           "../snopt.out");
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Major iterations limit", max_iter);
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Iterations limit", 100000);  // QP subproblems
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(), "Verify level",
-                           0);  // 0
-  trajopt->SetSolverOption(
-      drake::solvers::SnoptSolver::id(), "Scale option",
-      scale_option);  // snopt doc said try 2 if seeing snopta exit 40
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Major optimality tolerance",
-                           tol);  // target nonlinear constraint violation
-  trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Major feasibility tolerance",
-                           tol);  // target complementarity gap
+  if (FLAGS_ipopt) {
+    solvers::IpoptOptions ipopt_options;
+    ipopt_options.max_iter = max_iter;
+    ipopt_options.tol = tol;
+    solvers::SetIpoptOptions(ipopt_options, trajopt.get());
+  } else {
+    solvers::SnoptOptions snopt_options;
+    snopt_options.major_iterations_limit = max_iter;
+    snopt_options.scale_option = scale_option;
+    snopt_options.major_optimality_tolerance = tol;
+    snopt_options.major_feasibility_tolerance = tol;
+    solvers::SetSnoptOptions(snopt_options, trajopt.get());
+  }
 
   int N = 0;
   for (uint i = 0; i < num_time_samples.size(); i++) N += num_time_samples[i];
@@ -910,12 +909,17 @@ void DoMain(double duration, double stride_length, double ground_incline,
   trajopt->CreateVisualizationCallback(
       "examples/Cassie/urdf/cassie_fixed_springs.urdf", num_poses, alpha);
 
-  cout << "\nChoose the best solver: "
-       << drake::solvers::ChooseBestSolver(*trajopt).name() << endl;
+  const auto solver_id = FLAGS_ipopt
+                             ? drake::solvers::IpoptSolver::id()
+                             : drake::solvers::ChooseBestSolver(*trajopt);
+  cout << "\nChose the solver: " << solver_id.name() << endl;
 
   cout << "Solving DIRCON\n\n";
   auto start = std::chrono::high_resolution_clock::now();
-  const auto result = Solve(*trajopt, trajopt->initial_guess());
+  auto solver = drake::solvers::MakeSolver(solver_id);
+  drake::solvers::MathematicalProgramResult result;
+  solver->Solve(*trajopt, trajopt->initial_guess(), trajopt->solver_options(),
+                &result);
   SolutionResult solution_result = result.get_solution_result();
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
@@ -1156,7 +1160,7 @@ void DoMain(double duration, double stride_length, double ground_incline,
   drake::geometry::ConnectDrakeVisualizer(&builder, scene_graph);
   auto diagram = builder.Build();
 
-  while (true) {
+  while (FLAGS_playback) {
     drake::systems::Simulator<double> simulator(*diagram);
     simulator.set_target_realtime_rate(.1);
     simulator.Initialize();
@@ -72,6 +72,9 @@ DEFINE_bool(print_osc, false, "whether to print the osc debug message or not");
 DEFINE_bool(is_two_phase, false,
             "true: only right/left single support"
             "false: both double and single support");
+DEFINE_double(osc_deadline, 0,
+              "Time budget (in seconds) of each OSC tick. When the QP misses "
+              "it, the previous input is extrapolated. 0 disables it.");
 
 int DoMain(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -463,6 +466,9 @@ int DoMain(int argc, char* argv[]) {
                                              "hip_yaw_leftdot");
   osc->AddConstTrackingData(&swing_hip_yaw_traj, VectorXd::Zero(1));
   // Build OSC problem
+  if (FLAGS_osc_deadline > 0) {
+    osc->SetSolveDeadline(FLAGS_osc_deadline);
+  }
   osc->Build();
   // Connect ports
   builder.Connect(simulator_drift->get_output_port(0),
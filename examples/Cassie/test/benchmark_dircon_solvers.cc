@@ -0,0 +1,119 @@
+#include <array>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+/// Benchmark of the time-to-solution of SNOPT and IPOPT on the Cassie
+/// trajectory optimization examples (run_dircon_walking, run_dircon_jumping
+/// and run_dircon_squatting). Each example is run once per solver, without
+/// playback, and the solve time it reports is collected:
+///
+///   bazel build //examples/Cassie:benchmark_dircon_solvers
+///   bazel-bin/examples/Cassie/benchmark_dircon_solvers --knot_points=40
+///
+/// --knot_points sets the number of knot points (per mode) of every example,
+/// or keeps their defaults if 0. The options of each solver are the
+/// SnoptOptions and IpoptOptions set by the examples.
+
+DEFINE_string(problems, "walking,jumping,squatting",
+              "Comma-separated subset of walking, jumping and squatting");
+DEFINE_string(solvers, "snopt,ipopt",
+              "Comma-separated subset of snopt and ipopt");
+DEFINE_int32(knot_points, 0, "Number of knot points (0 keeps the defaults)");
+DEFINE_string(bin_directory, "bazel-bin/examples/Cassie/",
+              "Directory of the example binaries");
+DEFINE_string(data_directory, "/tmp/",
+              "Directory to which the examples write their solutions");
+
+namespace dairlib {
+namespace {
+
+struct Problem {
+  std::string name;
+  // Flag setting the number of knot points of the example
+  std::string knot_flag;
+  std::string extra_flags;
+};
+
+std::vector<std::string> Split(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+// Runs `command` (hiding its output) and returns the "Solve time:" that it
+// printed, or -1 if it failed
+double RunAndGetSolveTime(const std::string& command) {
+  FILE* pipe = popen((command + " 2>&1").c_str(), "r");
+  if (!pipe) return -1;
+  const std::string key = "Solve time:";
+  double solve_time = -1;
+  std::array<char, 4096> buffer;
+  while (fgets(buffer.data(), buffer.size(), pipe)) {
+    const std::string line(buffer.data());
+    const auto pos = line.find(key);
+    if (pos != std::string::npos) {
+      solve_time = std::stod(line.substr(pos + key.size()));
+    }
+  }
+  return (pclose(pipe) == 0) ? solve_time : -1;
+}
+
+int do_main() {
+  const std::vector<Problem> all_problems = {
+      {"walking", "n_node", "--playback=false --store_data=false"},
+      {"jumping", "knot_points", "--playback=false"},
+      {"squatting", "N", "--playback=false --store_data=false"}};
+
+  std::cout << "problem\tsolver\tsolve time (s)\n";
+  for (const auto& name : Split(FLAGS_problems)) {
+    const Problem* problem = nullptr;
+    for (const auto& p : all_problems) {
+      if (p.name == name) problem = &p;
+    }
+    if (!problem) {
+      std::cerr << "Unknown problem " << name << std::endl;
+      return 1;
+    }
+    for (const auto& solver : Split(FLAGS_solvers)) {
+      if (solver != "snopt" && solver != "ipopt") {
+        std::cerr << "Unknown solver " << solver << std::endl;
+        return 1;
+      }
+      std::string command =
+          FLAGS_bin_directory + "run_dircon_" + name + " " +
+          problem->extra_flags +
+          " --ipopt=" + (solver == "ipopt" ? "true" : "false") +
+          " --data_directory=" + FLAGS_data_directory +
+          " --save_filename=benchmark_" + name + "_" + solver;
+      if (FLAGS_knot_points > 0) {
+        command += " --" + problem->knot_flag + "=" +
+                   std::to_string(FLAGS_knot_points);
+      }
+      const double solve_time = RunAndGetSolveTime(command);
+      std::cout << name << "\t" << solver << "\t";
+      if (solve_time >= 0) {
+        std::cout << solve_time << std::endl;
+      } else {
+        std::cout << "failed (" << command << ")" << std::endl;
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  return dairlib::do_main();
+}
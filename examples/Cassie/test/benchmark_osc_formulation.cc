@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/find_resource.h"
+#include "dairlib/lcmt_osc_output.hpp"
+#include "examples/Cassie/cassie_fixed_point_solver.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "examples/Cassie/osc/osc_walking_gains.h"
+#include "multibody/kinematic/fixed_joint_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/multibody_utils.h"
+#include "solvers/dense_active_set_solver.h"
+#include "systems/controllers/osc/operational_space_control.h"
+#include "systems/framework/output_vector.h"
+
+#include "drake/common/yaml/yaml_read_archive.h"
+
+/// Benchmark of the two formulations of OperationalSpaceControl
+/// (OscFormulation::kFull and OscFormulation::kReduced) with the Cassie
+/// walking gains. The controller is set up as in run_osc_walking_controller
+/// (but with constant desired trajectories), and is evaluated around a fixed
+/// point with a time-varying velocity while cycling through the left stance,
+/// double support and right stance states.
+///
+/// --qp_solver selects the QP backend of OSC ("osqp" or "active_set").
+
+DEFINE_int32(num_reps, 3000, "Number of OSC evaluations per formulation");
+DEFINE_string(gains_filename, "examples/Cassie/osc/osc_walking_gains.yaml",
+              "Filepath containing gains");
+DEFINE_double(height, 0.9, "Pelvis height of the fixed point");
+DEFINE_string(qp_solver, "osqp", "QP solver of OSC (osqp or active_set)");
+
+namespace dairlib {
+namespace {
+
+using Eigen::Matrix3d;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using systems::OutputVector;
+using systems::controllers::JointSpaceTrackingData;
+using systems::controllers::OperationalSpaceControl;
+using systems::controllers::OscFormulation;
+using systems::controllers::RotTaskSpaceTrackingData;
+using systems::controllers::TransTaskSpaceTrackingData;
+
+typedef std::chrono::steady_clock my_clock;
+
+const int left_stance_state = 0;
+const int right_stance_state = 1;
+const int double_support_state = 2;
+
+// Runs the walking OSC with `formulation` and stores the inputs in `u_sols`
+void RunBenchmark(const drake::multibody::MultibodyPlant<double>& plant,
+                  const OSCWalkingGains& gains, const VectorXd& q,
+                  OscFormulation formulation, const std::string& name,
+                  std::vector<VectorXd>* u_sols) {
+  auto context = plant.CreateDefaultContext();
+  int n_v = plant.num_velocities();
+
+  OperationalSpaceControl osc(plant, plant, context.get(), context.get(), true,
+                              false, formulation);
+  if (FLAGS_qp_solver == "active_set") {
+    osc.SetQpSolver([]() {
+      return std::make_unique<solvers::DenseActiveSetSolver>();
+    });
+  } else {
+    DRAKE_DEMAND(FLAGS_qp_solver == "osqp");
+  }
+
+  // Cost
+  osc.SetAccelerationCostForAllJoints(gains.w_accel *
+                                      MatrixXd::Identity(n_v, n_v));
+
+  // Constraints (same as run_osc_walking_controller)
+  multibody::KinematicEvaluatorSet<double> evaluators(plant);
+  auto left_loop = LeftLoopClosureEvaluator(plant);
+  auto right_loop = RightLoopClosureEvaluator(plant);
+  evaluators.add_evaluator(&left_loop);
+  evaluators.add_evaluator(&right_loop);
+  auto pos_idx_map = multibody::makeNameToPositionsMap(plant);
+  auto vel_idx_map = multibody::makeNameToVelocitiesMap(plant);
+  auto left_fixed_knee_spring = multibody::FixedJointEvaluator(
+      plant, pos_idx_map.at("knee_joint_left"),
+      vel_idx_map.at("knee_joint_leftdot"), 0);
+  auto right_fixed_knee_spring = multibody::FixedJointEvaluator(
+      plant, pos_idx_map.at("knee_joint_right"),
+      vel_idx_map.at("knee_joint_rightdot"), 0);
+  auto left_fixed_ankle_spring = multibody::FixedJointEvaluator(
+      plant, pos_idx_map.at("ankle_spring_joint_left"),
+      vel_idx_map.at("ankle_spring_joint_leftdot"), 0);
+  auto right_fixed_ankle_spring = multibody::FixedJointEvaluator(
+      plant, pos_idx_map.at("ankle_spring_joint_right"),
+      vel_idx_map.at("ankle_spring_joint_rightdot"), 0);
+  evaluators.add_evaluator(&left_fixed_knee_spring);
+  evaluators.add_evaluator(&right_fixed_knee_spring);
+  evaluators.add_evaluator(&left_fixed_ankle_spring);
+  evaluators.add_evaluator(&right_fixed_ankle_spring);
+  osc.AddKinematicConstraint(&evaluators);
+
+  osc.SetWeightOfSoftContactConstraint(gains.w_soft_constraint);
+  osc.SetContactFriction(gains.mu);
+  auto left_toe = LeftToeFront(plant);
+  auto left_heel = LeftToeRear(plant);
+  auto right_toe = RightToeFront(plant);
+  auto right_heel = RightToeRear(plant);
+  auto left_toe_evaluator = multibody::WorldPointEvaluator(
+      plant, left_toe.first, left_toe.second, Matrix3d::Identity(),
+      Vector3d::Zero(), {1, 2});
+  auto left_heel_evaluator = multibody::WorldPointEvaluator(
+      plant, left_heel.first, left_heel.second, Matrix3d::Identity(),
+      Vector3d::Zero(), {0, 1, 2});
+  auto right_toe_evaluator = multibody::WorldPointEvaluator(
+      plant, right_toe.first, right_toe.second, Matrix3d::Identity(),
+      Vector3d::Zero(), {1, 2});
+  auto right_heel_evaluator = multibody::WorldPointEvaluator(
+      plant, right_heel.first, right_heel.second, Matrix3d::Identity(),
+      Vector3d::Zero(), {0, 1, 2});
+  osc.AddStateAndContactPoint(left_stance_state, &left_toe_evaluator);
+  osc.AddStateAndContactPoint(left_stance_state, &left_heel_evaluator);
+  osc.AddStateAndContactPoint(right_stance_state, &right_toe_evaluator);
+  osc.AddStateAndContactPoint(right_stance_state, &right_heel_evaluator);
+  osc.AddStateAndContactPoint(double_support_state, &left_toe_evaluator);
+  osc.AddStateAndContactPoint(double_support_state, &left_heel_evaluator);
+  osc.AddStateAndContactPoint(double_support_state, &right_toe_evaluator);
+  osc.AddStateAndContactPoint(double_support_state, &right_heel_evaluator);
+
+  // Tracking data (with constant desired trajectories)
+  TransTaskSpaceTrackingData swing_foot_traj(
+      "swing_ft_traj", gains.K_p_swing_foot, gains.K_d_swing_foot,
+      gains.W_swing_foot, plant, plant);
+  swing_foot_traj.AddStateAndPointToTrack(left_stance_state, "toe_right");
+  swing_foot_traj.AddStateAndPointToTrack(right_stance_state, "toe_left");
+  osc.AddConstTrackingData(&swing_foot_traj, Vector3d(0, 0, 0.1));
+  TransTaskSpaceTrackingData pelvis_traj("lipm_traj", gains.K_p_com,
+                                         gains.K_d_com, gains.W_com, plant,
+                                         plant);
+  pelvis_traj.AddPointToTrack("pelvis");
+  osc.AddConstTrackingData(&pelvis_traj, Vector3d(0, 0, FLAGS_height));
+  VectorXd pelvis_desired_quat(4);
+  pelvis_desired_quat << 1, 0, 0, 0;
+  RotTaskSpaceTrackingData pelvis_balance_traj(
+      "pelvis_balance_traj", gains.K_p_pelvis_balance, gains.K_d_pelvis_balance,
+      gains.W_pelvis_balance, plant, plant);
+  pelvis_balance_traj.AddFrameToTrack("pelvis");
+  osc.AddConstTrackingData(&pelvis_balance_traj, pelvis_desired_quat);
+  RotTaskSpaceTrackingData pelvis_heading_traj(
+      "pelvis_heading_traj", gains.K_p_pelvis_heading, gains.K_d_pelvis_heading,
+      gains.W_pelvis_heading, plant, plant);
+  pelvis_heading_traj.AddFrameToTrack("pelvis");
+  osc.AddConstTrackingData(&pelvis_heading_traj, pelvis_desired_quat);
+  JointSpaceTrackingData swing_toe_traj_left(
+      "left_toe_angle_traj", gains.K_p_swing_toe, gains.K_d_swing_toe,
+      gains.W_swing_toe, plant, plant);
+  JointSpaceTrackingData swing_toe_traj_right(
+      "right_toe_angle_traj", gains.K_p_swing_toe, gains.K_d_swing_toe,
+      gains.W_swing_toe, plant, plant);
+  swing_toe_traj_right.AddStateAndJointToTrack(left_stance_state, "toe_right",
+                                               "toe_rightdot");
+  swing_toe_traj_left.AddStateAndJointToTrack(right_stance_state, "toe_left",
+                                              "toe_leftdot");
+  osc.AddConstTrackingData(&swing_toe_traj_left,
+                           q.segment(pos_idx_map.at("toe_left"), 1));
+  osc.AddConstTrackingData(&swing_toe_traj_right,
+                           q.segment(pos_idx_map.at("toe_right"), 1));
+  JointSpaceTrackingData swing_hip_yaw_traj(
+      "swing_hip_yaw_traj", gains.K_p_hip_yaw, gains.K_d_hip_yaw,
+      gains.W_hip_yaw, plant, plant);
+  swing_hip_yaw_traj.AddStateAndJointToTrack(left_stance_state, "hip_yaw_right",
+                                             "hip_yaw_rightdot");
+  swing_hip_yaw_traj.AddStateAndJointToTrack(right_stance_state, "hip_yaw_left",
+                                             "hip_yaw_leftdot");
+  osc.AddConstTrackingData(&swing_hip_yaw_traj, VectorXd::Zero(1));
+  osc.EnableStageTiming();
+  osc.Build();
+
+  // Inputs and outputs of OSC
+  auto osc_context = osc.CreateDefaultContext();
+  auto u_output = osc.get_osc_output_port().Allocate();
+  auto debug_output = osc.get_osc_debug_port().Allocate();
+  OutputVector<double> robot_output(plant.num_positions(), n_v,
+                                    plant.num_actuators());
+  robot_output.SetPositions(q);
+  robot_output.SetEfforts(VectorXd::Zero(plant.num_actuators()));
+  std::vector<int> fsm_states = {left_stance_state, double_support_state,
+                                 right_stance_state};
+
+  double total_time = 0;
+  double total_solve_time = 0;
+  double total_setup_time = 0;
+  int total_iterations = 0;
+  int max_iterations = 0;
+  u_sols->clear();
+  for (int i = 0; i < FLAGS_num_reps; i++) {
+    double t = 0.001 * i;
+    VectorXd v = 0.1 * (VectorXd::LinSpaced(n_v, 1, 2) * (10 * t))
+                           .array()
+                           .sin()
+                           .matrix();
+    robot_output.SetVelocities(v);
+    robot_output.set_timestamp(t);
+    osc.get_robot_output_input_port().FixValue(osc_context.get(),
+                                               robot_output);
+    osc.get_fsm_input_port().FixValue(
+        osc_context.get(),
+        drake::systems::BasicVector<double>(
+            VectorXd::Constant(1, fsm_states[(i / 100) % 3])));
+
+    auto start = my_clock::now();
+    osc.get_osc_output_port().Calc(*osc_context, u_output.get());
+    auto stop = my_clock::now();
+    total_time += std::chrono::duration<double>(stop - start).count();
+
+    osc.get_osc_debug_port().Calc(*osc_context, debug_output.get());
+    const auto& qp_output =
+        debug_output->get_value<dairlib::lcmt_osc_output>().qp_output;
+    total_solve_time += qp_output.solve_time;
+    total_setup_time += qp_output.setup_time;
+    total_iterations += qp_output.iterations;
+    max_iterations = std::max(max_iterations, qp_output.iterations);
+    // (The last element of the TimestampedVector is the timestamp)
+    u_sols->push_back(u_output->get_value<drake::systems::BasicVector<double>>()
+                          .get_value()
+                          .head(plant.num_actuators()));
+  }
+
+  std::cout << "(" << name << ") " << FLAGS_num_reps
+            << "x OSC evaluations: " << 1e6 * total_time / FLAGS_num_reps
+            << " microseconds per evaluation, of which QP solve "
+            << 1e6 * total_solve_time / FLAGS_num_reps
+            << " microseconds and QP setup "
+            << 1e6 * total_setup_time / FLAGS_num_reps << " microseconds."
+            << std::endl;
+  std::cout << "(" << name << ") QP iterations: "
+            << static_cast<double>(total_iterations) / FLAGS_num_reps
+            << " on average, " << max_iterations << " at most." << std::endl;
+  const auto& qp_output =
+      debug_output->get_value<dairlib::lcmt_osc_output>().qp_output;
+  for (int stage = 0; stage < qp_output.num_stages; stage++) {
+    std::cout << "(" << name << ")   " << qp_output.stage_names[stage]
+              << ": p50 " << 1e6 * qp_output.stage_time_p50[stage]
+              << ", p99 " << 1e6 * qp_output.stage_time_p99[stage] << ", max "
+              << 1e6 * qp_output.stage_time_max[stage] << " microseconds"
+              << std::endl;
+  }
+}
+
+int do_main() {
+  OSCWalkingGains gains;
+  const YAML::Node& root =
+      YAML::LoadFile(FindResourceOrThrow(FLAGS_gains_filename));
+  drake::yaml::YamlReadArchive(root).Accept(&gains);
+
+  // Plant of the controller (same as run_osc_walking_controller)
+  drake::multibody::MultibodyPlant<double> plant(0.0);
+  addCassieMultibody(&plant, nullptr, true /*floating base*/,
+                     "examples/Cassie/urdf/cassie_v2.urdf",
+                     true /*spring model*/, false /*loop closure*/);
+  plant.Finalize();
+
+  // Fixed point
+  drake::multibody::MultibodyPlant<double> plant_for_solver(0.0);
+  addCassieMultibody(&plant_for_solver, nullptr, true /*floating base*/,
+                     "examples/Cassie/urdf/cassie_v2.urdf",
+                     true /*spring model*/, true /*loop closure*/);
+  plant_for_solver.Finalize();
+  VectorXd q, u, lambda;
+  CassieFixedPointSolver(plant_for_solver, FLAGS_height, gains.mu, 70, true,
+                         0.2, &q, &u, &lambda);
+
+  std::vector<VectorXd> u_full;
+  std::vector<VectorXd> u_reduced;
+  RunBenchmark(plant, gains, q, OscFormulation::kFull, "full", &u_full);
+  RunBenchmark(plant, gains, q, OscFormulation::kReduced, "reduced",
+               &u_reduced);
+
+  double max_u_diff = 0;
+  for (int i = 0; i < FLAGS_num_reps; i++) {
+    max_u_diff = std::max(
+        max_u_diff, (u_full[i] - u_reduced[i]).lpNorm<Eigen::Infinity>());
+  }
+  std::cout << "Max difference between the inputs of the two formulations: "
+            << max_u_diff << std::endl;
+
+  return 0;
+}
+
+}  // namespace
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  return dairlib::do_main();
+}
@@ -0,0 +1,78 @@
+#include "multibody/kinematic/body_kinematics.h"
+
+#include "drake/math/cross_product.h"
+
+using drake::MatrixX;
+using drake::Vector3;
+using drake::multibody::Frame;
+using drake::multibody::JacobianWrtVariable;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+
+namespace dairlib {
+namespace multibody {
+
+template <typename T>
+void BodyKinematics<T>::Reset(const MultibodyPlant<T>& plant,
+                              const Context<T>& context) {
+  plant_ = &plant;
+  context_ = &context;
+  num_bodies_ = 0;
+}
+
+template <typename T>
+const typename BodyKinematics<T>::Entry& BodyKinematics<T>::GetBody(
+    const drake::multibody::Body<T>& body) {
+  DRAKE_DEMAND(plant_ != nullptr);
+  for (int i = 0; i < num_bodies_; i++) {
+    if (bodies_[i].index == body.index()) {
+      return bodies_[i];
+    }
+  }
+
+  if (num_bodies_ == static_cast<int>(bodies_.size())) {
+    bodies_.emplace_back();
+  }
+  Entry& entry = bodies_[num_bodies_++];
+  const auto& world = plant_->world_frame();
+  entry.index = body.index();
+  entry.X_WB = plant_->EvalBodyPoseInWorld(*context_, body);
+  entry.w_WB =
+      plant_->EvalBodySpatialVelocityInWorld(*context_, body).rotational();
+  entry.J_Bo.resize(6, plant_->num_velocities());
+  plant_->CalcJacobianSpatialVelocity(
+      *context_, JacobianWrtVariable::kV, body.body_frame(),
+      Vector3<T>::Zero(), world, world, &entry.J_Bo);
+  entry.A_bias_Bo = plant_->CalcBiasSpatialAcceleration(
+      *context_, JacobianWrtVariable::kV, body.body_frame(),
+      Vector3<T>::Zero(), world, world);
+  return entry;
+}
+
+template <typename T>
+void BodyKinematics<T>::CalcPoint(const Frame<T>& frame,
+                                  const Eigen::Vector3d& pt_F,
+                                  Vector3<T>* position,
+                                  drake::EigenPtr<MatrixX<T>> J,
+                                  Vector3<T>* Jdotv) {
+  const Entry& body = GetBody(frame.body());
+  const Vector3<T> p_BoP_B =
+      frame.CalcPoseInBodyFrame(*context_) * pt_F.template cast<T>();
+  const Vector3<T> p_BoP_W = body.X_WB.rotation() * p_BoP_B;
+  *position = body.X_WB.translation() + p_BoP_W;
+
+  // v_P = v_Bo + w_WB x p_BoP = v_Bo - [p_BoP]x w_WB
+  *J = body.J_Bo.bottomRows(3);
+  J->noalias() -=
+      drake::math::VectorToSkewSymmetric(p_BoP_W) * body.J_Bo.topRows(3);
+
+  const auto& A = body.A_bias_Bo;
+  *Jdotv = A.translational() + A.rotational().cross(p_BoP_W) +
+           body.w_WB.cross(body.w_WB.cross(p_BoP_W));
+}
+
+DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
+    class ::dairlib::multibody::BodyKinematics)
+
+}  // namespace multibody
+}  // namespace dairlib
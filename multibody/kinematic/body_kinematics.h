@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include "drake/math/rigid_transform.h"
+#include "drake/multibody/math/spatial_acceleration.h"
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/context.h"
+
+namespace dairlib {
+namespace multibody {
+
+/// Kinematics of bodies shared by the points on them, for the fused
+/// Jacobian and Jdot * v evaluations of KinematicEvaluator and
+/// KinematicEvaluatorSet. For each body B, the pose X_WB, the angular
+/// velocity w_WB, the spatial velocity Jacobian of Bo (w.r.t. v) and the bias
+/// spatial acceleration of Bo are computed once, on the first point of B.
+/// The Jacobian and Jdot * v of any point P of B then follow from
+///   J_P = J_v_Bo - [p_BoP]x J_w_B,
+///   Jdot_P * v = a_bias_Bo + alpha_bias_B x p_BoP + w_WB x (w_WB x p_BoP),
+/// all expressed in world. So, e.g., the two contact points of a foot share
+/// a single Jacobian computation.
+///
+/// The computed bodies are valid for a single state: Reset() must be called
+/// whenever the context changes. Reset() keeps the storage of the bodies, so
+/// a reused object doesn't allocate (for T = double).
+template <typename T>
+class BodyKinematics {
+ public:
+  BodyKinematics() = default;
+
+  /// Starts the evaluations at `context` of `plant`, forgetting the bodies
+  /// computed so far. Both must outlive the following evaluations.
+  void Reset(const drake::multibody::MultibodyPlant<T>& plant,
+             const drake::systems::Context<T>& context);
+
+  /// Computes the position of the point `pt_F` of `frame` (expressed in
+  /// `frame`), its translational velocity Jacobian w.r.t. v (3 x nv) and its
+  /// bias acceleration Jdot * v, all in world.
+  void CalcPoint(const drake::multibody::Frame<T>& frame,
+                 const Eigen::Vector3d& pt_F, drake::Vector3<T>* position,
+                 drake::EigenPtr<drake::MatrixX<T>> J,
+                 drake::Vector3<T>* Jdotv);
+
+  /// Number of bodies computed since the last Reset()
+  int num_bodies() const { return num_bodies_; }
+
+ private:
+  struct Entry {
+    drake::multibody::BodyIndex index;
+    drake::math::RigidTransform<T> X_WB;
+    drake::Vector3<T> w_WB;
+    // Spatial velocity Jacobian of Bo, rotational rows first
+    drake::MatrixX<T> J_Bo;
+    drake::multibody::SpatialAcceleration<T> A_bias_Bo;
+  };
+
+  // Finds the body in bodies_, computing it first if needed
+  const Entry& GetBody(const drake::multibody::Body<T>& body);
+
+  const drake::multibody::MultibodyPlant<T>* plant_ = nullptr;
+  const drake::systems::Context<T>* context_ = nullptr;
+  // The first num_bodies_ entries are valid, the others are kept for reuse
+  std::vector<Entry> bodies_;
+  int num_bodies_ = 0;
+};
+
+}  // namespace multibody
+}  // namespace dairlib
@@ -3,7 +3,6 @@
 #include "drake/math/orthonormal_basis.h"
 
 using drake::MatrixX;
-using drake::Matrix3X;
 using drake::VectorX;
 using drake::Vector3;
 using drake::multibody::Frame;
@@ -29,34 +28,36 @@ DistanceEvaluator<T>::DistanceEvaluator(const MultibodyPlant<T>& plant,
       distance_(distance) {}
 
 template <typename T>
-VectorX<T> DistanceEvaluator<T>::EvalFull(const Context<T>& context) const {
+void DistanceEvaluator<T>::EvalFull(const Context<T>& context,
+                                    drake::EigenPtr<VectorX<T>> phi) const {
   // Transform points A and B to world frame
   const drake::multibody::Frame<T>& world = plant().world_frame();
-  static Vector3<T> pt_A_W;
-  static Vector3<T> pt_B_W;
+  Vector3<T> pt_A_W;
+  Vector3<T> pt_B_W;
 
   plant().CalcPointsPositions(context, frame_A_, pt_A_.template cast<T>(),
                               world, &pt_A_W);
   plant().CalcPointsPositions(context, frame_B_, pt_B_.template cast<T>(),
                               world, &pt_B_W);
   auto rel_pos = pt_A_W - pt_B_W;
-  VectorX<T> difference(1);
-  difference << rel_pos.norm() - distance_;
-  return difference;
+  (*phi)(0) = rel_pos.norm() - distance_;
 }
 
 template <typename T>
 void DistanceEvaluator<T>::EvalFullJacobian(
-    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J) const {
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    KinematicWorkspace<T>* workspace) const {
   /// Jacobian of ||pt_A - pt_B||, evaluated all in world frame, is
   ///   (pt_A - pt_B)^T * (J_A - J_B) / ||pt_A - pt_B||
 
-  // Create static Jacobians and point positions for re-use. Warning: not thread
-  // safe
-  static Matrix3X<T> J_A(3, plant().num_velocities());
-  static Matrix3X<T> J_B(3, plant().num_velocities());
-  static Vector3<T> pt_A_W;;
-  static Vector3<T> pt_B_W;
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  auto J_A = workspace->matrix(KinematicWorkspace<T>::kPointA, 3,
+                               plant().num_velocities());
+  auto J_B = workspace->matrix(KinematicWorkspace<T>::kPointB, 3,
+                               plant().num_velocities());
+  Vector3<T> pt_A_W;
+  Vector3<T> pt_B_W;
 
   const drake::multibody::Frame<T>& world = plant().world_frame();
 
@@ -77,8 +78,9 @@ void DistanceEvaluator<T>::EvalFullJacobian(
 }
 
 template <typename T>
-VectorX<T> DistanceEvaluator<T>::EvalFullJacobianDotTimesV(
-    const Context<T>& context) const {
+void DistanceEvaluator<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
   // From applying the chain rule to Jacobian, Jdot * v is
   //
   // ||(J_A - J_B) * v||^2/phi ...
@@ -86,10 +88,14 @@ VectorX<T> DistanceEvaluator<T>::EvalFullJacobianDotTimesV(
   //   - phidot * (pt_A - pt_B)^T (J_A - J_B) *v / phi^2
   const drake::multibody::Frame<T>& world = plant().world_frame();
 
-  static MatrixX<T> J_A(3, plant().num_velocities());
-  static MatrixX<T> J_B(3, plant().num_velocities());
-  static VectorX<T> pt_A_world(3);
-  static VectorX<T> pt_B_world(3);
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  auto J_A = workspace->matrix(KinematicWorkspace<T>::kPointA, 3,
+                               plant().num_velocities());
+  auto J_B = workspace->matrix(KinematicWorkspace<T>::kPointB, 3,
+                               plant().num_velocities());
+  Vector3<T> pt_A_world;
+  Vector3<T> pt_B_world;
 
   auto pt_A_cast = pt_A_.template cast<T>();
   auto pt_B_cast = pt_B_.template cast<T>();
@@ -127,11 +133,43 @@ VectorX<T> DistanceEvaluator<T>::EvalFullJacobianDotTimesV(
   J_rel_v << J_rel * plant().GetVelocities(context);
 
   // Compute all terms as scalars using dot products
-  VectorX<T> J_dot_times_v(1);
-  J_dot_times_v << (J_rel_v).squaredNorm() / phi +
-                       rel_pos.dot(J_rel_dot_times_v) / phi -
-                       phidot * rel_pos.dot(J_rel_v) / (phi * phi);
-  return J_dot_times_v;
+  (*Jdotv)(0) = (J_rel_v).squaredNorm() / phi +
+                rel_pos.dot(J_rel_dot_times_v) / phi -
+                phidot * rel_pos.dot(J_rel_v) / (phi * phi);
+}
+
+template <typename T>
+void DistanceEvaluator<T>::EvalFullJacobianAndJdotV(
+    const Context<T>& context, BodyKinematics<T>* bodies,
+    drake::EigenPtr<MatrixX<T>> J, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  // Same as EvalFullJacobian and EvalFullJacobianDotTimesV, with the points'
+  // positions, Jacobians and Jdotv computed once (and shared through `bodies`)
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  auto J_A = workspace->matrix(KinematicWorkspace<T>::kPointA, 3,
+                               plant().num_velocities());
+  auto J_B = workspace->matrix(KinematicWorkspace<T>::kPointB, 3,
+                               plant().num_velocities());
+  Vector3<T> pt_A_W;
+  Vector3<T> pt_B_W;
+  Vector3<T> J_A_dot_times_v;
+  Vector3<T> J_B_dot_times_v;
+  bodies->CalcPoint(frame_A_, pt_A_, &pt_A_W, &J_A, &J_A_dot_times_v);
+  bodies->CalcPoint(frame_B_, pt_B_, &pt_B_W, &J_B, &J_B_dot_times_v);
+
+  const Vector3<T> rel_pos = pt_A_W - pt_B_W;
+  const T phi = rel_pos.norm();
+  // J_A becomes J_A - J_B
+  J_A -= J_B;
+  J->noalias() = (rel_pos / phi).transpose() * J_A;
+
+  const auto& v = plant().GetVelocities(context);
+  const T phidot = J->row(0).dot(v);
+  const Vector3<T> J_rel_v = J_A * v;
+  (*Jdotv)(0) = J_rel_v.squaredNorm() / phi +
+                rel_pos.dot(J_A_dot_times_v - J_B_dot_times_v) / phi -
+                phidot * rel_pos.dot(J_rel_v) / (phi * phi);
 }
 
 DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
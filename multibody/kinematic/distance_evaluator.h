@@ -29,16 +29,28 @@ class DistanceEvaluator : public KinematicEvaluator<T> {
                     const Eigen::Vector3d pt_B,
                     const drake::multibody::Frame<T>& frame_B, double distance);
 
-  drake::VectorX<T> EvalFull(
-      const drake::systems::Context<T>& context) const override;
+  void EvalFull(const drake::systems::Context<T>& context,
+                drake::EigenPtr<drake::VectorX<T>> phi) const override;
 
   void EvalFullJacobian(const drake::systems::Context<T>& context,
-                        drake::EigenPtr<drake::MatrixX<T>> J) const override;
+                        drake::EigenPtr<drake::MatrixX<T>> J,
+                        KinematicWorkspace<T>* workspace) const override;
 
-  drake::VectorX<T> EvalFullJacobianDotTimesV(
-      const drake::systems::Context<T>& context) const override;
+  void EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace) const override;
 
+  void EvalFullJacobianAndJdotV(
+      const drake::systems::Context<T>& context, BodyKinematics<T>* bodies,
+      drake::EigenPtr<drake::MatrixX<T>> J,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace) const override;
+
+  using KinematicEvaluator<T>::EvalFull;
   using KinematicEvaluator<T>::EvalFullJacobian;
+  using KinematicEvaluator<T>::EvalFullJacobianDotTimesV;
+  using KinematicEvaluator<T>::EvalFullJacobianAndJdotV;
   using KinematicEvaluator<T>::plant;
 
  private:
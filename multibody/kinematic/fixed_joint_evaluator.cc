@@ -20,22 +20,23 @@ FixedJointEvaluator<T>::FixedJointEvaluator(const MultibodyPlant<T>& plant,
 }
 
 template <typename T>
-VectorX<T> FixedJointEvaluator<T>::EvalFull(const Context<T>& context) const {
-  VectorX<T> difference(1);
-  difference << plant().GetPositions(context)(pos_idx_) - pos_value_;
-  return difference;
+void FixedJointEvaluator<T>::EvalFull(const Context<T>& context,
+                                      drake::EigenPtr<VectorX<T>> phi) const {
+  (*phi)(0) = plant().GetPositions(context)(pos_idx_) - pos_value_;
 }
 
 template <typename T>
 void FixedJointEvaluator<T>::EvalFullJacobian(
-    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J) const {
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    KinematicWorkspace<T>* workspace) const {
   *J = J_;
 }
 
 template <typename T>
-VectorX<T> FixedJointEvaluator<T>::EvalFullJacobianDotTimesV(
-    const Context<T>& context) const {
-  return VectorX<T>::Zero(1);
+void FixedJointEvaluator<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  Jdotv->setZero();
 }
 
 DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
@@ -19,16 +19,21 @@ class FixedJointEvaluator : public KinematicEvaluator<T> {
   FixedJointEvaluator(const drake::multibody::MultibodyPlant<T>& plant,
                       int pos_idx, int vel_idx, double pos_value);
 
-  drake::VectorX<T> EvalFull(
-      const drake::systems::Context<T>& context) const override;
+  void EvalFull(const drake::systems::Context<T>& context,
+                drake::EigenPtr<drake::VectorX<T>> phi) const override;
 
   void EvalFullJacobian(const drake::systems::Context<T>& context,
-                        drake::EigenPtr<drake::MatrixX<T>> J) const override;
+                        drake::EigenPtr<drake::MatrixX<T>> J,
+                        KinematicWorkspace<T>* workspace) const override;
 
-  drake::VectorX<T> EvalFullJacobianDotTimesV(
-      const drake::systems::Context<T>& context) const override;
+  void EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace) const override;
 
+  using KinematicEvaluator<T>::EvalFull;
   using KinematicEvaluator<T>::EvalFullJacobian;
+  using KinematicEvaluator<T>::EvalFullJacobianDotTimesV;
   using KinematicEvaluator<T>::plant;
 
  private:
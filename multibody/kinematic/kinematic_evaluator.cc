@@ -28,76 +28,190 @@ MatrixX<T> KinematicEvaluator<T>::EvalFullJacobian(
   return J;
 }
 
+template <typename T>
+VectorX<T> KinematicEvaluator<T>::EvalFull(const Context<T>& context) const {
+  VectorX<T> phi(length_);
+  EvalFull(context, &phi);
+  return phi;
+}
+
+template <typename T>
+VectorX<T> KinematicEvaluator<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context) const {
+  VectorX<T> Jdotv(length_);
+  EvalFullJacobianDotTimesV(context, &Jdotv);
+  return Jdotv;
+}
+
 template <typename T>
 VectorX<T> KinematicEvaluator<T>::EvalActive(const Context<T>& context) const {
-  // TODO: With Eigen 3.4, can slice by (active_inds_);
+  VectorX<T> phi(num_active_);
+  EvalActive(context, &phi);
+  return phi;
+}
 
-  auto phi_full = EvalFull(context);
+template <typename T>
+void KinematicEvaluator<T>::EvalActive(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> phi,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(phi->size() == num_active_);
   if (all_active_default_order_) {
-    return phi_full;
+    EvalFull(context, phi);
+    return;
   }
 
-  VectorX<T> phi(num_active_);
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  // TODO: With Eigen 3.4, can slice by (active_inds_);
+  auto phi_full = workspace->vector(KinematicWorkspace<T>::kFullRows, length_);
+  EvalFull(context, &phi_full);
   for (int i = 0; i < num_active_; i++) {
-    phi(i) = phi_full(active_inds_.at(i));
+    (*phi)(i) = phi_full(active_inds_[i]);
   }
-  return phi;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluator<T>::EvalActiveTimeDerivative(
     const Context<T>& context) const {
-  // TODO: With Eigen 3.4, can slice by (active_inds_);
-  auto phidot_full = EvalFullTimeDerivative(context);
+  VectorX<T> phidot(num_active_);
+  EvalActiveTimeDerivative(context, &phidot);
+  return phidot;
+}
+
+template <typename T>
+void KinematicEvaluator<T>::EvalActiveTimeDerivative(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> phidot,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(phidot->size() == num_active_);
   if (all_active_default_order_) {
-    return phidot_full;
+    EvalFullTimeDerivative(context, phidot, workspace);
+    return;
   }
 
-  VectorX<T> phidot(num_active_);
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  // TODO: With Eigen 3.4, can slice by (active_inds_);
+  auto phidot_full =
+      workspace->vector(KinematicWorkspace<T>::kFullRows, length_);
+  EvalFullTimeDerivative(context, &phidot_full, workspace);
   for (int i = 0; i < num_active_; i++) {
-    phidot(i) = phidot_full(active_inds_.at(i));
+    (*phidot)(i) = phidot_full(active_inds_[i]);
   }
-  return phidot;
 }
 
 template <typename T>
 MatrixX<T> KinematicEvaluator<T>::EvalActiveJacobian(
     const Context<T>& context) const {
-  // TODO: With Eigen 3.4, can slice by (active_inds_, all);
-  auto J_full = EvalFullJacobian(context);
+  MatrixX<T> J(num_active_, plant_.num_velocities());
+  EvalActiveJacobian(context, &J);
+  return J;
+}
+
+template <typename T>
+void KinematicEvaluator<T>::EvalActiveJacobian(
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(J->rows() == num_active_);
+  DRAKE_THROW_UNLESS(J->cols() == plant_.num_velocities());
   if (all_active_default_order_) {
-    return J_full;
+    EvalFullJacobian(context, J, workspace);
+    return;
   }
 
-  MatrixX<T> J_active(num_active_, J_full.cols());
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  // TODO: With Eigen 3.4, can slice by (active_inds_, all);
+  auto J_full = workspace->matrix(KinematicWorkspace<T>::kFullRows, length_,
+                                  plant_.num_velocities());
+  EvalFullJacobian(context, &J_full, workspace);
   for (int i = 0; i < num_active_; i++) {
-    J_active.row(i) = J_full.row(active_inds_.at(i));
+    J->row(i) = J_full.row(active_inds_[i]);
   }
-
-  // Extract active rows only
-  return J_active;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluator<T>::EvalActiveJacobianDotTimesV(
     const Context<T>& context) const {
-  // TODO: With Eigen 3.4, can slice by (active_inds_);
-  auto Jdot_v_full = EvalFullJacobianDotTimesV(context);
+  VectorX<T> Jdotv(num_active_);
+  EvalActiveJacobianDotTimesV(context, &Jdotv);
+  return Jdotv;
+}
+
+template <typename T>
+void KinematicEvaluator<T>::EvalActiveJacobianDotTimesV(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(Jdotv->size() == num_active_);
   if (all_active_default_order_) {
-    return Jdot_v_full;
+    EvalFullJacobianDotTimesV(context, Jdotv, workspace);
+    return;
   }
 
-  VectorX<T> Jdot_v(num_active_);
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  // TODO: With Eigen 3.4, can slice by (active_inds_);
+  auto Jdotv_full =
+      workspace->vector(KinematicWorkspace<T>::kFullRows, length_);
+  EvalFullJacobianDotTimesV(context, &Jdotv_full, workspace);
   for (int i = 0; i < num_active_; i++) {
-    Jdot_v(i) = Jdot_v_full(active_inds_.at(i));
+    (*Jdotv)(i) = Jdotv_full(active_inds_[i]);
   }
-  return Jdot_v;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluator<T>::EvalFullTimeDerivative(
     const Context<T>& context) const {
-  return EvalFullJacobian(context) * plant_.GetVelocities(context);
+  VectorX<T> phidot(length_);
+  EvalFullTimeDerivative(context, &phidot);
+  return phidot;
+}
+
+template <typename T>
+void KinematicEvaluator<T>::EvalFullTimeDerivative(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> phidot,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(phidot->size() == length_);
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  auto J = workspace->matrix(KinematicWorkspace<T>::kFullRows, length_,
+                             plant_.num_velocities());
+  EvalFullJacobian(context, &J, workspace);
+  phidot->noalias() = J * plant_.GetVelocities(context);
+}
+
+template <typename T>
+void KinematicEvaluator<T>::EvalFullJacobianAndJdotV(
+    const Context<T>& context, BodyKinematics<T>* bodies,
+    drake::EigenPtr<MatrixX<T>> J, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  EvalFullJacobian(context, J, workspace);
+  EvalFullJacobianDotTimesV(context, Jdotv, workspace);
+}
+
+template <typename T>
+void KinematicEvaluator<T>::EvalActiveJacobianAndJdotV(
+    const Context<T>& context, BodyKinematics<T>* bodies,
+    drake::EigenPtr<MatrixX<T>> J, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(J->rows() == num_active_);
+  DRAKE_THROW_UNLESS(J->cols() == plant_.num_velocities());
+  DRAKE_THROW_UNLESS(Jdotv->size() == num_active_);
+  if (all_active_default_order_) {
+    EvalFullJacobianAndJdotV(context, bodies, J, Jdotv, workspace);
+    return;
+  }
+
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  auto J_full = workspace->matrix(KinematicWorkspace<T>::kFullRows, length_,
+                                  plant_.num_velocities());
+  auto Jdotv_full =
+      workspace->vector(KinematicWorkspace<T>::kFullRows, length_);
+  EvalFullJacobianAndJdotV(context, bodies, &J_full, &Jdotv_full, workspace);
+  for (int i = 0; i < num_active_; i++) {
+    J->row(i) = J_full.row(active_inds_[i]);
+    (*Jdotv)(i) = Jdotv_full(active_inds_[i]);
+  }
 }
 
 template <typename T>
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "multibody/kinematic/body_kinematics.h"
+#include "multibody/kinematic/kinematic_workspace.h"
+
 #include "drake/multibody/plant/multibody_plant.h"
 #include "drake/solvers/constraint.h"
 #include "drake/systems/framework/context.h"
@@ -25,6 +28,14 @@ namespace multibody {
 /// For efficiency, maintains a boolean all_active_default_order_ to
 /// determine whether all constraints are active in the original order {0,1,...}
 /// If true, can skip the slicing stage.
+///
+/// Every evaluation can either be returned as a new vector/matrix, or be
+/// written into an output of the right size (e.g. a block of a larger
+/// matrix) passed as an EigenPtr. Implementations only provide the EigenPtr
+/// versions of the full evaluations. The active rows (and some of the full
+/// evaluations) need intermediate terms, which are stored in the given
+/// KinematicWorkspace: with a reused workspace, the EigenPtr versions do not
+/// allocate, apart from what the plant does.
 template <typename T>
 class KinematicEvaluator {
  public:
@@ -36,34 +47,77 @@ class KinematicEvaluator {
   /// Evaluates phi(q), limited only to active rows
   drake::VectorX<T> EvalActive(const drake::systems::Context<T>& context) const;
 
+  /// Evaluates phi(q), limited only to active rows, into phi (num_active())
+  void EvalActive(const drake::systems::Context<T>& context,
+                  drake::EigenPtr<drake::VectorX<T>> phi,
+                  KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the time-derivative, d/dt phi(q), limited only to active rows
   drake::VectorX<T> EvalActiveTimeDerivative(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates the time-derivative, d/dt phi(q), limited only to active rows,
+  /// into phidot (num_active())
+  void EvalActiveTimeDerivative(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> phidot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the constraint Jacobian w.r.t. velocity v (not qdot)
   ///  limited only to active rows
   /// TODO (posa): could add an option to compute w.r.t. q
   drake::MatrixX<T> EvalActiveJacobian(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates the constraint Jacobian w.r.t. velocity v (not qdot)
+  ///  limited only to active rows, into J (num_active() x num_velocities)
+  void EvalActiveJacobian(const drake::systems::Context<T>& context,
+                          drake::EigenPtr<drake::MatrixX<T>> J,
+                          KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates Jdot * v, useful for computing second derivative,
   ///  which would be d^2 phi/dt^2 = J * vdot + Jdot * v
   ///  limited only to active rows
   drake::VectorX<T> EvalActiveJacobianDotTimesV(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates Jdot * v, limited only to active rows, into Jdotv
+  /// (num_active())
+  void EvalActiveJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the time-derivative, d/dt phi(q)
   drake::VectorX<T> EvalFullTimeDerivative(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates the time-derivative, d/dt phi(q), into phidot (num_full())
+  void EvalFullTimeDerivative(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> phidot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates, phi(q), including inactive rows
-  virtual drake::VectorX<T> EvalFull(
-      const drake::systems::Context<T>& context) const = 0;
+  drake::VectorX<T> EvalFull(const drake::systems::Context<T>& context) const;
+
+  /// Evaluates, phi(q), including inactive rows, into phi (num_full())
+  virtual void EvalFull(const drake::systems::Context<T>& context,
+                        drake::EigenPtr<drake::VectorX<T>> phi) const = 0;
 
-  /// Evaluates the Jacobian w.r.t. velocity v (not qdot)
+  /// Evaluates the Jacobian w.r.t. velocity v (not qdot), into J
+  /// (num_full() x num_velocities)
   /// TODO (posa): could add an option to compute w.r.t. q
+  void EvalFullJacobian(const drake::systems::Context<T>& context,
+                        drake::EigenPtr<drake::MatrixX<T>> J) const {
+    EvalFullJacobian(context, J, nullptr);
+  }
+
+  /// Same as EvalFullJacobian(context, J), with the intermediate terms in
+  /// `workspace` (a temporary one if nullptr)
   virtual void EvalFullJacobian(const drake::systems::Context<T>& context,
-                                drake::EigenPtr<drake::MatrixX<T>> J) const = 0;
+                                drake::EigenPtr<drake::MatrixX<T>> J,
+                                KinematicWorkspace<T>* workspace) const = 0;
 
   /// Evaluates the Jacobian w.r.t. velocity v
   drake::MatrixX<T> EvalFullJacobian(
@@ -71,8 +125,50 @@ class KinematicEvaluator {
 
   /// Evaluates Jdot * v, useful for computing constraint second derivative,
   ///  which would be d^2 phi/dt^2 = J * vdot + Jdot * v
-  virtual drake::VectorX<T> EvalFullJacobianDotTimesV(
-      const drake::systems::Context<T>& context) const = 0;
+  drake::VectorX<T> EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context) const;
+
+  /// Evaluates Jdot * v into Jdotv (num_full())
+  void EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv) const {
+    EvalFullJacobianDotTimesV(context, Jdotv, nullptr);
+  }
+
+  /// Same as EvalFullJacobianDotTimesV(context, Jdotv), with the intermediate
+  /// terms in `workspace` (a temporary one if nullptr)
+  virtual void EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace) const = 0;
+
+  /// Evaluates the Jacobian (num_full() x num_velocities) and Jdot * v
+  /// (num_full()) together, so that the kinematics they share are computed
+  /// once. Implementations for points on bodies take these from `bodies`,
+  /// which must have been reset to `context` and may be shared with other
+  /// evaluators (see BodyKinematics). The default evaluates both separately.
+  void EvalFullJacobianAndJdotV(
+      const drake::systems::Context<T>& context, BodyKinematics<T>* bodies,
+      drake::EigenPtr<drake::MatrixX<T>> J,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv) const {
+    EvalFullJacobianAndJdotV(context, bodies, J, Jdotv, nullptr);
+  }
+
+  /// Same as EvalFullJacobianAndJdotV(context, bodies, J, Jdotv), with the
+  /// intermediate terms in `workspace` (a temporary one if nullptr)
+  virtual void EvalFullJacobianAndJdotV(
+      const drake::systems::Context<T>& context, BodyKinematics<T>* bodies,
+      drake::EigenPtr<drake::MatrixX<T>> J,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace) const;
+
+  /// Evaluates the Jacobian and Jdot * v together, limited only to active rows
+  /// (see EvalFullJacobianAndJdotV)
+  void EvalActiveJacobianAndJdotV(
+      const drake::systems::Context<T>& context, BodyKinematics<T>* bodies,
+      drake::EigenPtr<drake::MatrixX<T>> J,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace = nullptr) const;
 
   void set_active_inds(std::vector<int> active_inds);
 
@@ -1,5 +1,8 @@
 #include "multibody/kinematic/kinematic_evaluator_set.h"
 
+#include <algorithm>
+#include <type_traits>
+
 #include "drake/math/autodiff_gradient.h"
 
 namespace dairlib {
@@ -12,7 +15,7 @@ using drake::systems::Context;
 template <typename T>
 KinematicEvaluatorSet<T>::KinematicEvaluatorSet(
     const drake::multibody::MultibodyPlant<T>& plant)
-    : plant_(plant) {
+    : plant_(plant), B_(plant.MakeActuationMatrix()) {
   if (plant.geometry_source_is_registered()) {
     drake::log()->warn(
         "Plant in KinematicEvaluatorSet has an associated SceneGraph. This may "
@@ -22,108 +25,213 @@ KinematicEvaluatorSet<T>::KinematicEvaluatorSet(
   }
 }
 
+namespace {
+
+// The value of the applied generalized force input port of `context`, which is
+// only fixed on the first call (FixValue() allocates a new value every time)
+template <typename T>
+Eigen::VectorBlock<VectorX<T>> MutableAppliedGeneralizedForce(
+    const drake::multibody::MultibodyPlant<T>& plant, Context<T>* context) {
+  const auto& port = plant.get_applied_generalized_force_input_port();
+  drake::systems::FixedInputPortValue* value =
+      context->MaybeGetMutableFixedInputPortValue(port.get_index());
+  if (value == nullptr) {
+    value = &port.FixValue(context, VectorX<T>::Zero(plant.num_velocities()));
+  }
+  return value->GetMutableVectorData<T>()->get_mutable_value();
+}
+
+}  // namespace
+
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalActive(
     const Context<T>& context) const {
   VectorX<T> phi(count_active());
+  EvalActive(context, &phi);
+  return phi;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalActive(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> phi,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(phi->size() == count_active());
   int ind = 0;
   for (const auto& e : evaluators_) {
-    phi.segment(ind, e->num_active()) = e->EvalActive(context);
+    auto phi_i = phi->segment(ind, e->num_active());
+    e->EvalActive(context, &phi_i, workspace);
     ind += e->num_active();
   }
-  return phi;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalActiveTimeDerivative(
     const Context<T>& context) const {
   VectorX<T> phidot(count_active());
+  EvalActiveTimeDerivative(context, &phidot);
+  return phidot;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalActiveTimeDerivative(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> phidot,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(phidot->size() == count_active());
   int ind = 0;
   for (const auto& e : evaluators_) {
-    phidot.segment(ind, e->num_active()) = e->EvalActiveTimeDerivative(context);
+    auto phidot_i = phidot->segment(ind, e->num_active());
+    e->EvalActiveTimeDerivative(context, &phidot_i, workspace);
     ind += e->num_active();
   }
-  return phidot;
 }
 
 template <typename T>
 MatrixX<T> KinematicEvaluatorSet<T>::EvalActiveJacobian(
     const Context<T>& context) const {
+  MatrixX<T> J(count_active(), plant_.num_velocities());
+  EvalActiveJacobian(context, &J);
+  return J;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalActiveJacobian(
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    KinematicWorkspace<T>* workspace) const {
   const int num_velocities = plant_.num_velocities();
-  MatrixX<T> J(count_active(), num_velocities);
+  DRAKE_THROW_UNLESS(J->rows() == count_active());
+  DRAKE_THROW_UNLESS(J->cols() == num_velocities);
   int ind = 0;
   for (const auto& e : evaluators_) {
-    J.block(ind, 0, e->num_active(), num_velocities) =
-        e->EvalActiveJacobian(context);
+    auto J_i = J->block(ind, 0, e->num_active(), num_velocities);
+    e->EvalActiveJacobian(context, &J_i, workspace);
     ind += e->num_active();
   }
-  return J;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalActiveJacobianDotTimesV(
     const Context<T>& context) const {
   VectorX<T> Jdotv(count_active());
+  EvalActiveJacobianDotTimesV(context, &Jdotv);
+  return Jdotv;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalActiveJacobianDotTimesV(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(Jdotv->size() == count_active());
   int ind = 0;
   for (const auto& e : evaluators_) {
-    Jdotv.segment(ind, e->num_active()) =
-        e->EvalActiveJacobianDotTimesV(context);
+    auto Jdotv_i = Jdotv->segment(ind, e->num_active());
+    e->EvalActiveJacobianDotTimesV(context, &Jdotv_i, workspace);
     ind += e->num_active();
   }
-  return Jdotv;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalFull(const Context<T>& context) const {
   VectorX<T> phi(count_full());
+  EvalFull(context, &phi);
+  return phi;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalFull(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> phi) const {
+  DRAKE_THROW_UNLESS(phi->size() == count_full());
   int ind = 0;
   for (const auto& e : evaluators_) {
-    phi.segment(ind, e->num_full()) = e->EvalFull(context);
+    auto phi_i = phi->segment(ind, e->num_full());
+    e->EvalFull(context, &phi_i);
     ind += e->num_full();
   }
-  return phi;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalFullTimeDerivative(
     const Context<T>& context) const {
   VectorX<T> phidot(count_full());
+  EvalFullTimeDerivative(context, &phidot);
+  return phidot;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalFullTimeDerivative(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> phidot,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(phidot->size() == count_full());
   int ind = 0;
   for (const auto& e : evaluators_) {
-    phidot.segment(ind, e->num_full()) = e->EvalFullTimeDerivative(context);
+    auto phidot_i = phidot->segment(ind, e->num_full());
+    e->EvalFullTimeDerivative(context, &phidot_i, workspace);
     ind += e->num_full();
   }
-  return phidot;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalFullSecondTimeDerivative(
     Context<T>* context, const VectorX<T>& lambda) const {
-  const auto& xdot = CalcTimeDerivativesWithForce(context, lambda);
-  const auto& J = EvalFullJacobian(*context);
-  const auto& Jdotv = EvalFullJacobianDotTimesV(*context);
-  return J * xdot.tail(plant_.num_velocities()) + Jdotv;
+  VectorX<T> phiddot(count_full());
+  EvalFullSecondTimeDerivative(context, lambda, &phiddot);
+  return phiddot;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalFullSecondTimeDerivative(
+    Context<T>* context, const VectorX<T>& lambda,
+    drake::EigenPtr<VectorX<T>> phiddot,
+    KinematicWorkspace<T>* workspace) const {
+  const int num_velocities = plant_.num_velocities();
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  auto xdot = workspace->vector(KinematicWorkspace<T>::kSetState,
+                                plant_.num_positions() + num_velocities);
+  CalcTimeDerivativesWithForce(context, lambda, &xdot, workspace);
+  auto J = workspace->matrix(KinematicWorkspace<T>::kSetJacobian,
+                             count_full(), num_velocities);
+  EvalFullJacobian(*context, &J, workspace);
+  EvalFullJacobianDotTimesV(*context, phiddot, workspace);
+  phiddot->noalias() += J * xdot.tail(num_velocities);
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalActiveSecondTimeDerivative(
     Context<T>* context, const VectorX<T>& lambda) const {
-  const auto& xdot = CalcTimeDerivativesWithForce(context, lambda);
-  const auto& J = EvalActiveJacobian(*context);
-  const auto& Jdotv = EvalActiveJacobianDotTimesV(*context);
-  return J * xdot.tail(plant_.num_velocities()) + Jdotv;
+  VectorX<T> phiddot(count_active());
+  EvalActiveSecondTimeDerivative(context, lambda, &phiddot);
+  return phiddot;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalActiveSecondTimeDerivative(
+    Context<T>* context, const VectorX<T>& lambda,
+    drake::EigenPtr<VectorX<T>> phiddot,
+    KinematicWorkspace<T>* workspace) const {
+  const int num_velocities = plant_.num_velocities();
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  auto xdot = workspace->vector(KinematicWorkspace<T>::kSetState,
+                                plant_.num_positions() + num_velocities);
+  CalcTimeDerivativesWithForce(context, lambda, &xdot, workspace);
+  auto J = workspace->matrix(KinematicWorkspace<T>::kSetJacobian,
+                             count_active(), num_velocities);
+  EvalActiveJacobian(*context, &J, workspace);
+  EvalActiveJacobianDotTimesV(*context, phiddot, workspace);
+  phiddot->noalias() += J * xdot.tail(num_velocities);
 }
 
 template <typename T>
 void KinematicEvaluatorSet<T>::EvalFullJacobian(
-    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J) const {
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    KinematicWorkspace<T>* workspace) const {
   const int num_velocities = plant_.num_velocities();
   DRAKE_THROW_UNLESS(J->rows() == count_full());
   DRAKE_THROW_UNLESS(J->cols() == num_velocities);
   int ind = 0;
   for (const auto& e : evaluators_) {
     auto J_i = J->block(ind, 0, e->num_full(), num_velocities);
-    e->EvalFullJacobian(context, &J_i);
+    e->EvalFullJacobian(context, &J_i, workspace);
     ind += e->num_full();
   }
 }
@@ -140,12 +248,70 @@ template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::EvalFullJacobianDotTimesV(
     const Context<T>& context) const {
   VectorX<T> Jdotv(count_full());
+  EvalFullJacobianDotTimesV(context, &Jdotv);
+  return Jdotv;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  DRAKE_THROW_UNLESS(Jdotv->size() == count_full());
   int ind = 0;
   for (const auto& e : evaluators_) {
-    Jdotv.segment(ind, e->num_full()) = e->EvalFullJacobianDotTimesV(context);
+    auto Jdotv_i = Jdotv->segment(ind, e->num_full());
+    e->EvalFullJacobianDotTimesV(context, &Jdotv_i, workspace);
+    ind += e->num_full();
+  }
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalFullJacobianAndJdotV(
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    drake::EigenPtr<VectorX<T>> Jdotv, BodyKinematics<T>* bodies,
+    KinematicWorkspace<T>* workspace) const {
+  const int num_velocities = plant_.num_velocities();
+  DRAKE_THROW_UNLESS(J->rows() == count_full());
+  DRAKE_THROW_UNLESS(J->cols() == num_velocities);
+  DRAKE_THROW_UNLESS(Jdotv->size() == count_full());
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  if (bodies == nullptr) {
+    bodies = &workspace->bodies();
+    bodies->Reset(plant_, context);
+  }
+  int ind = 0;
+  for (const auto& e : evaluators_) {
+    auto J_i = J->block(ind, 0, e->num_full(), num_velocities);
+    auto Jdotv_i = Jdotv->segment(ind, e->num_full());
+    e->EvalFullJacobianAndJdotV(context, bodies, &J_i, &Jdotv_i, workspace);
     ind += e->num_full();
   }
-  return Jdotv;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::EvalActiveJacobianAndJdotV(
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    drake::EigenPtr<VectorX<T>> Jdotv, BodyKinematics<T>* bodies,
+    KinematicWorkspace<T>* workspace) const {
+  const int num_velocities = plant_.num_velocities();
+  DRAKE_THROW_UNLESS(J->rows() == count_active());
+  DRAKE_THROW_UNLESS(J->cols() == num_velocities);
+  DRAKE_THROW_UNLESS(Jdotv->size() == count_active());
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+  if (bodies == nullptr) {
+    bodies = &workspace->bodies();
+    bodies->Reset(plant_, context);
+  }
+  int ind = 0;
+  for (const auto& e : evaluators_) {
+    auto J_i = J->block(ind, 0, e->num_active(), num_velocities);
+    auto Jdotv_i = Jdotv->segment(ind, e->num_active());
+    e->EvalActiveJacobianAndJdotV(context, bodies, &J_i, &Jdotv_i,
+                                  workspace);
+    ind += e->num_active();
+  }
 }
 
 template <typename T>
@@ -205,46 +371,108 @@ std::vector<int> KinematicEvaluatorSet<T>::FindActiveIndicesUnion(
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::CalcMassMatrixTimesVDot(
     const Context<T>& context, const VectorX<T>& lambda) const {
-  // M(q)vdot + C(q,v) = tau_g(q) + F_app + Bu + J(q)^T lambda
-  VectorX<T> C(plant_.num_velocities());
-  plant_.CalcBiasTerm(context, &C);
-
-  VectorX<T> Bu = plant_.MakeActuationMatrix() *
-                  plant_.get_actuation_input_port().Eval(context);
-
-  VectorX<T> tau_g = plant_.CalcGravityGeneralizedForces(context);
+  VectorX<T> Mvdot(plant_.num_velocities());
+  CalcMassMatrixTimesVDot(context, lambda, &Mvdot);
+  return Mvdot;
+}
 
-  drake::multibody::MultibodyForces<T> f_app(plant_);
-  plant_.CalcForceElementsContribution(context, &f_app);
+template <typename T>
+void KinematicEvaluatorSet<T>::CalcMassMatrixTimesVDot(
+    const Context<T>& context, const VectorX<T>& lambda,
+    drake::EigenPtr<VectorX<T>> Mvdot,
+    KinematicWorkspace<T>* workspace) const {
+  const int num_velocities = plant_.num_velocities();
+  DRAKE_THROW_UNLESS(Mvdot->size() == num_velocities);
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
 
-  VectorX<T> J_transpose_lambda =
-      EvalFullJacobian(context).transpose() * lambda;
+  // M(q)vdot + C(q,v) = tau_g(q) + F_app + Bu + J(q)^T lambda
+  CalcNonConstraintForces(context, Mvdot, workspace);
 
-  return tau_g + f_app.generalized_forces() + Bu + J_transpose_lambda - C;
+  auto J = workspace->matrix(KinematicWorkspace<T>::kSetJacobian,
+                             count_full(), num_velocities);
+  EvalFullJacobian(context, &J, workspace);
+  Mvdot->noalias() += J.transpose() * lambda;
 }
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivativesWithForce(
     Context<T>* context, const VectorX<T>& lambda) const {
-  MatrixX<T> J(count_full(), plant_.num_velocities());
-  EvalFullJacobian(*context, &J);
-  VectorX<T> J_transpose_lambda = J.transpose() * lambda;
+  VectorX<T> x_dot(plant_.num_positions() + plant_.num_velocities());
+  CalcTimeDerivativesWithForce(context, lambda, &x_dot);
+  return x_dot;
+}
 
-  plant_.get_applied_generalized_force_input_port().FixValue(
-      context, J_transpose_lambda);
+template <typename T>
+void KinematicEvaluatorSet<T>::CalcTimeDerivativesWithForce(
+    Context<T>* context, const VectorX<T>& lambda,
+    drake::EigenPtr<VectorX<T>> x_dot,
+    KinematicWorkspace<T>* workspace) const {
+  const int num_positions = plant_.num_positions();
+  const int num_velocities = plant_.num_velocities();
+  DRAKE_THROW_UNLESS(x_dot->size() == num_positions + num_velocities);
+  KinematicWorkspace<T> own_workspace;
+  if (workspace == nullptr) workspace = &own_workspace;
+
+  auto J = workspace->matrix(KinematicWorkspace<T>::kSetJacobian,
+                             count_full(), num_velocities);
+  EvalFullJacobian(*context, &J, workspace);
+  MutableAppliedGeneralizedForce(plant_, context).noalias() =
+      J.transpose() * lambda;
 
   // N.B. Evaluating the generalized acceleration port rather than the time
   // derivatives to ensure that this supports continuous and discrete plants
   // (discrete plants would not compute time derivatives)
-  const VectorX<T>& v_dot =
+  x_dot->tail(num_velocities) =
       plant_.get_generalized_acceleration_output_port()
-          .template Eval<drake::systems::BasicVector<double>>(*context)
-          .CopyToVector();
-  VectorX<T> x_dot(plant_.num_positions() + plant_.num_velocities());
-  VectorX<T> q_dot(plant_.num_positions());
+          .template Eval<drake::systems::BasicVector<T>>(*context)
+          .get_value();
+  auto q_dot = x_dot->head(num_positions);
   plant_.MapVelocityToQDot(*context, plant_.GetVelocities(*context), &q_dot);
-  x_dot << q_dot, v_dot;
-  return x_dot;
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::CalcNonConstraintForces(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> f,
+    KinematicWorkspace<T>* workspace) const {
+  // C is computed in place, and the other terms added to -C
+  plant_.CalcBiasTerm(context, f);
+  *f = workspace->EvalGravityGeneralizedForces(plant_, context) - *f;
+
+  auto& f_app = workspace->forces(plant_);
+  plant_.CalcForceElementsContribution(context, &f_app);
+  *f += f_app.generalized_forces();
+
+  f->noalias() += B_ * plant_.get_actuation_input_port().Eval(context);
+}
+
+template <typename T>
+void KinematicEvaluatorSet<T>::CalcConstraintAcceleration(
+    const Context<T>& context, double alpha, drake::EigenPtr<VectorX<T>> c,
+    KinematicWorkspace<T>* workspace) const {
+  EvalActiveJacobianDotTimesV(context, c, workspace);
+  // phi and phidot are only needed for stabilization
+  if (alpha != 0) {
+    auto phi = workspace->vector(KinematicWorkspace<T>::kSetConstraint,
+                                 count_active());
+    EvalActive(context, &phi, workspace);
+    *c += alpha * alpha * phi;
+    EvalActiveTimeDerivative(context, &phi, workspace);
+    *c += 2 * alpha * phi;
+  }
+  *c = -*c;
+}
+
+template <typename T>
+bool ConstrainedDynamicsFactors<T>::IsValidFor(
+    const KinematicEvaluatorSet<T>& evaluators,
+    const Eigen::Ref<const VectorX<T>>& q) const {
+  if constexpr (std::is_same<T, double>::value) {
+    return evaluators_ == &evaluators && q_.size() == q.size() && q_ == q;
+  } else {
+    // The factors would also depend on the derivatives of q
+    return false;
+  }
 }
 
 template <typename T>
@@ -256,50 +484,126 @@ VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivatives(
 
 template <typename T>
 VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivatives(
-    const Context<T>& context, VectorX<T>* lambda, double alpha) const {
+    const Context<T>& context, VectorX<T>* lambda, double alpha,
+    ConstrainedDynamicsFactors<T>* factors) const {
   // M(q) vdot + C(q,v) = tau_g(q) + f_app + Bu + J(q)^T lambda
   // J vdot + Jdotv  + kp phi + kd phidot = 0
   // Produces linear system of equations
   // [[M -J^T]  [[vdot  ]  =  [[tau_g + f_app + Bu - C     ]
   //  [J  0 ]]  [lambda]]     [ -Jdotv - kp phi - kd phidot]]
+  // or [[M -J^T]; [J 0]] [vdot; lambda] = [f; c]
+  const int num_velocities = plant_.num_velocities();
+  const int num_active = count_active();
+  KinematicWorkspace<T> workspace;
+
+  VectorX<T> f(num_velocities);
+  CalcNonConstraintForces(context, &f, &workspace);
+  VectorX<T> c(num_active);
+  CalcConstraintAcceleration(context, alpha, &c, &workspace);
+
+  VectorX<T> x_dot(plant_.num_positions() + num_velocities);
+  auto v_dot = x_dot.tail(num_velocities);
+
+  if (dynamics_solver_ == ConstrainedDynamicsSolver::kKktLdlt) {
+    MatrixX<T> M(num_velocities, num_velocities);
+    plant_.CalcMassMatrix(context, &M);
+    MatrixX<T> J = EvalActiveJacobian(context);
+
+    MatrixX<T> A(num_velocities + num_active, num_velocities + num_active);
+    VectorX<T> b(num_velocities + num_active);
+    A << M, -J.transpose(), J, MatrixX<T>::Zero(num_active, num_active);
+    b << f, c;
+    const VectorX<T> vdot_lambda = A.ldlt().solve(b);
+
+    *lambda = vdot_lambda.tail(num_active);
+    v_dot = vdot_lambda.head(num_velocities);
+  } else {
+    ConstrainedDynamicsFactors<T> own_factors;
+    if (factors == nullptr) {
+      factors = &own_factors;
+    }
+    const auto& q = plant_.GetPositions(context);
+    if (!factors->IsValidFor(*this, q)) {
+      // M = L L^T, Y = L^-1 J^T and J M^-1 J^T = Y^T Y
+      factors->M_.resize(num_velocities, num_velocities);
+      plant_.CalcMassMatrix(context, &factors->M_);
+      factors->M_llt_.compute(factors->M_);
+      factors->J_.resize(num_active, num_velocities);
+      EvalActiveJacobian(context, &factors->J_);
+      factors->Y_ = factors->J_.transpose();
+      factors->M_llt_.matrixL().solveInPlace(factors->Y_);
+      factors->Lambda_inv_.noalias() =
+          factors->Y_.transpose() * factors->Y_;
+      if (num_active > 0) {
+        factors->Lambda_inv_ldlt_.compute(factors->Lambda_inv_);
+      }
+      factors->evaluators_ = this;
+      factors->q_ = q;
+      factors->num_factorizations_++;
+    }
 
-  // Evaluate manipulator equation terms
-  MatrixX<T> M(plant_.num_velocities(), plant_.num_velocities());
-  plant_.CalcMassMatrix(context, &M);
-
-  VectorX<T> C(plant_.num_velocities());
-  plant_.CalcBiasTerm(context, &C);
-
-  VectorX<T> Bu = plant_.MakeActuationMatrix() *
-                  plant_.get_actuation_input_port().Eval(context);
-
-  VectorX<T> tau_g = plant_.CalcGravityGeneralizedForces(context);
-
-  drake::multibody::MultibodyForces<T> f_app(plant_);
-  plant_.CalcForceElementsContribution(context, &f_app);
-
-  // Evaluate active constraint terms.
-  VectorX<T> phi = EvalActive(context);
-  VectorX<T> phidot = EvalActiveTimeDerivative(context);
-  MatrixX<T> J = EvalActiveJacobian(context);
-  VectorX<T> Jdotv = EvalActiveJacobianDotTimesV(context);
-
-  MatrixX<T> A(M.rows() + J.rows(), M.cols() + J.rows());
-  VectorX<T> b(M.rows() + J.rows());
-  A << M, -J.transpose(), J, MatrixX<T>::Zero(J.rows(), J.rows());
-  b << tau_g + f_app.generalized_forces() + Bu - C,
-      -(Jdotv + alpha * alpha * phi + 2 * alpha * phidot);
-  const VectorX<T> vdot_lambda = A.ldlt().solve(b);
-
-  *lambda = vdot_lambda.tail(J.rows());
-
-  VectorX<T> x_dot(plant_.num_positions() + plant_.num_velocities());
-  VectorX<T> q_dot(plant_.num_positions());
+    // g = L^-1 f, then (Y^T Y) lambda = c - Y^T g, and
+    // vdot = L^-T (g + Y lambda)
+    v_dot = f;
+    factors->M_llt_.matrixL().solveInPlace(v_dot);
+    if (num_active > 0) {
+      c.noalias() -= factors->Y_.transpose() * v_dot;
+      *lambda = factors->Lambda_inv_ldlt_.solve(c);
+      v_dot.noalias() += factors->Y_ * *lambda;
+    } else {
+      lambda->resize(0);
+    }
+    factors->M_llt_.matrixU().solveInPlace(v_dot);
+  }
 
+  auto q_dot = x_dot.head(plant_.num_positions());
   plant_.MapVelocityToQDot(context, plant_.GetVelocities(context), &q_dot);
+  return x_dot;
+}
+
+template <typename T>
+VectorX<T> KinematicEvaluatorSet<T>::CalcTimeDerivativesByForwardDynamics(
+    Context<T>* context, VectorX<T>* lambda, double alpha) const {
+  const int num_velocities = plant_.num_velocities();
+  const int num_active = count_active();
+  const auto& acceleration_port =
+      plant_.get_generalized_acceleration_output_port();
+
+  // Free acceleration M^-1 f, without constraint forces
+  MutableAppliedGeneralizedForce(plant_, context).setZero();
+  const VectorX<T> vdot_free =
+      acceleration_port
+          .template Eval<drake::systems::BasicVector<T>>(*context)
+          .get_value();
+
+  // Columns of M^-1 J^T, as the change of the acceleration due to J^T e_i
+  MatrixX<T> J = EvalActiveJacobian(*context);
+  MatrixX<T> Minv_JT(num_velocities, num_active);
+  for (int i = 0; i < num_active; i++) {
+    MutableAppliedGeneralizedForce(plant_, context) = J.row(i).transpose();
+    Minv_JT.col(i) =
+        acceleration_port
+            .template Eval<drake::systems::BasicVector<T>>(*context)
+            .get_value() -
+        vdot_free;
+  }
 
-  x_dot << q_dot, vdot_lambda.head(plant_.num_velocities());
+  // (J M^-1 J^T) lambda = c - J M^-1 f
+  VectorX<T> c(num_active);
+  KinematicWorkspace<T> workspace;
+  CalcConstraintAcceleration(*context, alpha, &c, &workspace);
+  c.noalias() -= J * vdot_free;
+  const MatrixX<T> Lambda_inv = J * Minv_JT;
+  *lambda = Lambda_inv.ldlt().solve(c);
+
+  VectorX<T> x_dot(plant_.num_positions() + num_velocities);
+  x_dot.tail(num_velocities) = vdot_free + Minv_JT * *lambda;
+  auto q_dot = x_dot.head(plant_.num_positions());
+  plant_.MapVelocityToQDot(*context, plant_.GetVelocities(*context), &q_dot);
 
+  // Leave the constraint forces applied, as CalcTimeDerivativesWithForce does
+  MutableAppliedGeneralizedForce(plant_, context).noalias() =
+      J.transpose() * *lambda;
   return x_dot;
 }
 
@@ -360,6 +664,8 @@ bool KinematicEvaluatorSet<T>::is_active(int index) const {
   DRAKE_UNREACHABLE();
 }
 
+DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
+    class ::dairlib::multibody::ConstrainedDynamicsFactors)
 DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
     class ::dairlib::multibody::KinematicEvaluatorSet)
 
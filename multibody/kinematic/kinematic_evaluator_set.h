@@ -5,6 +5,61 @@
 namespace dairlib {
 namespace multibody {
 
+/// Linear solver of KinematicEvaluatorSet::CalcTimeDerivatives, for the
+/// constrained dynamics
+///   [[M -J^T]  [[vdot  ]  =  [[f]
+///    [J  0 ]]  [lambda]]     [ c]]
+enum class ConstrainedDynamicsSolver {
+  /// Cholesky factorization M = L L^T and the Schur complement: with
+  /// Y = L^-1 J^T, solves (J M^-1 J^T) lambda = (Y^T Y) lambda = c - Y^T L^-1 f
+  /// and vdot = L^-T (L^-1 f + Y lambda). M and J M^-1 J^T are positive
+  /// (semi)definite, and their factors can be reused at the same q (see
+  /// ConstrainedDynamicsFactors).
+  kSchurComplement,
+  /// LDLT factorization of the whole (indefinite) matrix
+  kKktLdlt,
+};
+
+template <typename T>
+class KinematicEvaluatorSet;
+
+/// Factors of the constrained dynamics at a configuration q, computed by
+/// KinematicEvaluatorSet::CalcTimeDerivatives with
+/// ConstrainedDynamicsSolver::kSchurComplement. They only depend on q (through
+/// M(q) and the active J(q)), so passing the same object to calls at the same
+/// q (e.g. with other velocities or inputs) skips the factorization.
+/// Invalidate() must be called if anything else they depend on changes (e.g.
+/// the plant parameters or the active rows). Only reused for T = double.
+template <typename T>
+class ConstrainedDynamicsFactors {
+ public:
+  ConstrainedDynamicsFactors() = default;
+
+  void Invalidate() { evaluators_ = nullptr; }
+
+  /// Number of factorizations computed so far
+  int num_factorizations() const { return num_factorizations_; }
+
+ private:
+  friend class KinematicEvaluatorSet<T>;
+
+  bool IsValidFor(const KinematicEvaluatorSet<T>& evaluators,
+                  const Eigen::Ref<const drake::VectorX<T>>& q) const;
+
+  // Set and configuration of the factors (nullptr if invalid)
+  const KinematicEvaluatorSet<T>* evaluators_ = nullptr;
+  drake::VectorX<T> q_;
+  drake::MatrixX<T> M_;
+  Eigen::LLT<drake::MatrixX<T>> M_llt_;
+  drake::MatrixX<T> J_;
+  // L^-1 J^T
+  drake::MatrixX<T> Y_;
+  // J M^-1 J^T
+  drake::MatrixX<T> Lambda_inv_;
+  Eigen::LDLT<drake::MatrixX<T>> Lambda_inv_ldlt_;
+  int num_factorizations_ = 0;
+};
+
 /// Simple class that maintains a vector pointers to KinematicEvaluator
 /// objects. Provides a basic API for counting and accumulating evaluations
 /// and their Jacobians.
@@ -14,6 +69,12 @@ namespace multibody {
 /// CalcTimeDerivativesWithForWithForce), the plant should *NOT* be declared
 /// with an associated SceneGraph (which would introduce contact dynamics via
 /// the Drake simulation)
+///
+/// As for KinematicEvaluator, every evaluation can also be written into an
+/// output of the right size, passed as an EigenPtr. Each evaluator then
+/// writes directly into its rows of the output, and the intermediate terms
+/// are stored in the given KinematicWorkspace: with a reused workspace, these
+/// versions do not allocate beyond what the plant does.
 template <typename T>
 class KinematicEvaluatorSet {
  public:
@@ -23,10 +84,22 @@ class KinematicEvaluatorSet {
   /// Evaluates phi(q), limited only to active rows
   drake::VectorX<T> EvalActive(const drake::systems::Context<T>& context) const;
 
+  /// Evaluates phi(q), limited only to active rows, into phi (count_active())
+  void EvalActive(const drake::systems::Context<T>& context,
+                  drake::EigenPtr<drake::VectorX<T>> phi,
+                  KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the time-derivative, d/dt phi(q), limited only to active rows
   drake::VectorX<T> EvalActiveTimeDerivative(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates d/dt phi(q), limited only to active rows, into phidot
+  /// (count_active())
+  void EvalActiveTimeDerivative(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> phidot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the second time-derivative, d^2/dt^2 phi(q), given force
   /// lambda (lambda for full constraints)
   /// Note that calculations of acceleration require changing the context
@@ -34,21 +107,47 @@ class KinematicEvaluatorSet {
       drake::systems::Context<T>* context,
       const drake::VectorX<T>& lambda) const;
 
+  /// Evaluates d^2/dt^2 phi(q), limited only to active rows, into phiddot
+  /// (count_active())
+  void EvalActiveSecondTimeDerivative(
+      drake::systems::Context<T>* context, const drake::VectorX<T>& lambda,
+      drake::EigenPtr<drake::VectorX<T>> phiddot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the constraint Jacobian w.r.t. velocity v (not qdot)
   ///  limited only to active rows
   drake::MatrixX<T> EvalActiveJacobian(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates the constraint Jacobian w.r.t. velocity v (not qdot)
+  ///  limited only to active rows, into J (count_active() x num_velocities)
+  void EvalActiveJacobian(const drake::systems::Context<T>& context,
+                          drake::EigenPtr<drake::MatrixX<T>> J,
+                          KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates Jdot * v, useful for computing second derivative,
   ///  which would be d^2 phi/dt^2 = J * vdot + Jdot * v
   ///  limited only to active rows
   drake::VectorX<T> EvalActiveJacobianDotTimesV(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates Jdot * v, limited only to active rows, into Jdotv
+  /// (count_active())
+  void EvalActiveJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the time-derivative, d/dt phi(q)
   drake::VectorX<T> EvalFullTimeDerivative(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates d/dt phi(q) into phidot (count_full())
+  void EvalFullTimeDerivative(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> phidot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates the second time-derivative, d^2/dt^2 phi(q), given force
   /// lambda (lambda for full constraints)
   /// Note that calculations of acceleration require changing the context
@@ -56,21 +155,63 @@ class KinematicEvaluatorSet {
       drake::systems::Context<T>* context,
       const drake::VectorX<T>& lambda) const;
 
+  /// Evaluates d^2/dt^2 phi(q) into phiddot (count_full())
+  void EvalFullSecondTimeDerivative(
+      drake::systems::Context<T>* context, const drake::VectorX<T>& lambda,
+      drake::EigenPtr<drake::VectorX<T>> phiddot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Evaluates, phi(q), including inactive rows
   drake::VectorX<T> EvalFull(const drake::systems::Context<T>& context) const;
 
+  /// Evaluates, phi(q), including inactive rows, into phi (count_full())
+  void EvalFull(const drake::systems::Context<T>& context,
+                drake::EigenPtr<drake::VectorX<T>> phi) const;
+
   /// Evaluates the Jacobian w.r.t. velocity v (not qdot)
   drake::MatrixX<T> EvalFullJacobian(
       const drake::systems::Context<T>& context) const;
 
   /// Evaluates the Jacobian w.r.t. velocity v (not qdot)
   void EvalFullJacobian(const drake::systems::Context<T>& context,
-                        drake::EigenPtr<drake::MatrixX<T>> J) const;
+                        drake::EigenPtr<drake::MatrixX<T>> J,
+                        KinematicWorkspace<T>* workspace = nullptr) const;
 
   /// Evaluates Jdot * v, useful for computing constraint second derivative,
   drake::VectorX<T> EvalFullJacobianDotTimesV(
       const drake::systems::Context<T>& context) const;
 
+  /// Evaluates Jdot * v into Jdotv (count_full())
+  void EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
+  /// Evaluates the Jacobian (count_full() x num_velocities) and Jdot * v
+  /// (count_full()) together. The body kinematics are computed once for all
+  /// the points of the evaluators on the same body (see BodyKinematics).
+  /// @param bodies If given, the body kinematics are taken from (and stored
+  ///   in) `bodies`, which must have been reset to `context`, so that they
+  ///   can be shared beyond this set. By default, they are only shared
+  ///   within the call.
+  /// @param workspace Storage of the intermediate terms (and of the body
+  ///   kinematics without `bodies`), a temporary one if nullptr.
+  void EvalFullJacobianAndJdotV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::MatrixX<T>> J,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      BodyKinematics<T>* bodies = nullptr,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
+  /// Evaluates the Jacobian and Jdot * v together, limited only to active
+  /// rows (see EvalFullJacobianAndJdotV)
+  void EvalActiveJacobianAndJdotV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::MatrixX<T>> J,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      BodyKinematics<T>* bodies = nullptr,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Determines the list of evaluators objects contained in the union with
   /// another set Specifically, `index` is in the returned vector if
   /// other.evaluators_.at(index) is an element of other.evaluators, as judged
@@ -104,6 +245,13 @@ class KinematicEvaluatorSet {
       const drake::systems::Context<T>& context,
       const drake::VectorX<T>& lambda) const;
 
+  /// Computes M(q) * d/dt v into Mvdot (num_velocities)
+  void CalcMassMatrixTimesVDot(
+      const drake::systems::Context<T>& context,
+      const drake::VectorX<T>& lambda,
+      drake::EigenPtr<drake::VectorX<T>> Mvdot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Computes vdot given the state, control inputs and constraint
   /// forces. Similar to CalcMassMatrixTimesVDot, but uses inv(M)
   /// and includes qdot. Forces are associated with the full kinematic
@@ -116,6 +264,15 @@ class KinematicEvaluatorSet {
       drake::systems::Context<T>* context,
       const drake::VectorX<T>& lambda) const;
 
+  /// Computes xdot = [qdot; vdot] given the constraint forces into x_dot
+  /// (num_positions + num_velocities). The applied generalized force input
+  /// port is only fixed on the first call with `context`, and then updated in
+  /// place.
+  void CalcTimeDerivativesWithForce(
+      drake::systems::Context<T>* context, const drake::VectorX<T>& lambda,
+      drake::EigenPtr<drake::VectorX<T>> x_dot,
+      KinematicWorkspace<T>* workspace = nullptr) const;
+
   /// Computes vdot given the state and control inputs, satisfying kinematic
   /// constraints.
   /// Solves for the constraint forces using the ACTIVE kinematic elements.
@@ -136,10 +293,35 @@ class KinematicEvaluatorSet {
   /// inputs. Solution is calculated to satisfy all kinematic constraints. See
   /// CalcTimeDerivatives(context, kp, kd) for full details. This version also
   /// returns the constraint force lambda via an input pointer.
+  /// @param factors If given (with the kSchurComplement solver), the
+  ///   factorization is taken from `factors` if they are for the same set
+  ///   and q, and stored there otherwise.
   drake::VectorX<T> CalcTimeDerivatives(
       const drake::systems::Context<T>& context, drake::VectorX<T>* lambda,
+      double alpha = 0,
+      ConstrainedDynamicsFactors<T>* factors = nullptr) const;
+
+  /// Same as CalcTimeDerivatives(context, lambda, alpha), but without the
+  /// mass matrix: the free acceleration M^-1 f and the columns of M^-1 J^T
+  /// are computed by evaluating the forward dynamics of the plant (with
+  /// J^T e_i as the applied generalized force), which are O(n) per evaluation
+  /// for a tree-structured plant using the articulated body algorithm. This
+  /// then scales as O(n m) for m active constraints, instead of O(n^3).
+  /// As for CalcTimeDerivativesWithForce, this changes the applied
+  /// generalized force input port of the context (which is left at
+  /// J^T lambda), and the plant should not have an associated SceneGraph.
+  drake::VectorX<T> CalcTimeDerivativesByForwardDynamics(
+      drake::systems::Context<T>* context, drake::VectorX<T>* lambda,
       double alpha = 0) const;
 
+  /// Sets the linear solver of CalcTimeDerivatives (default
+  /// kSchurComplement)
+  void set_dynamics_solver(ConstrainedDynamicsSolver solver) {
+    dynamics_solver_ = solver;
+  }
+
+  ConstrainedDynamicsSolver dynamics_solver() const { return dynamics_solver_; }
+
   /// Gets the starting index into phi_full of the specified evaluator
   int evaluator_full_start(int index) const;
 
@@ -173,8 +355,24 @@ class KinematicEvaluatorSet {
   const drake::multibody::MultibodyPlant<T>& plant() const { return plant_; };
 
  private:
+  // f = tau_g + f_app + Bu - C, the generalized forces other than J^T lambda
+  void CalcNonConstraintForces(const drake::systems::Context<T>& context,
+                               drake::EigenPtr<drake::VectorX<T>> f,
+                               KinematicWorkspace<T>* workspace) const;
+
+  // c = -(Jdotv + kp phi + kd phidot), the constrained (active) acceleration
+  // J vdot
+  void CalcConstraintAcceleration(const drake::systems::Context<T>& context,
+                                  double alpha,
+                                  drake::EigenPtr<drake::VectorX<T>> c,
+                                  KinematicWorkspace<T>* workspace) const;
+
   const drake::multibody::MultibodyPlant<T>& plant_;
+  // Actuation matrix of the plant
+  const drake::MatrixX<T> B_;
   std::vector<KinematicEvaluator<T>*> evaluators_;
+  ConstrainedDynamicsSolver dynamics_solver_ =
+      ConstrainedDynamicsSolver::kSchurComplement;
 };
 
 }  // namespace multibody
@@ -0,0 +1,66 @@
+#include "multibody/kinematic/kinematic_workspace.h"
+
+#include <algorithm>
+#include <type_traits>
+
+using drake::MatrixX;
+using drake::VectorX;
+using drake::multibody::MultibodyForces;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+
+namespace dairlib {
+namespace multibody {
+
+template <typename T>
+Eigen::Block<MatrixX<T>> KinematicWorkspace<T>::matrix(Slot slot, int rows,
+                                                       int cols) {
+  MatrixX<T>& buffer = matrices_.at(slot);
+  if (buffer.rows() < rows || buffer.cols() < cols) {
+    buffer.resize(std::max<int>(rows, buffer.rows()),
+                  std::max<int>(cols, buffer.cols()));
+  }
+  return buffer.topLeftCorner(rows, cols);
+}
+
+template <typename T>
+Eigen::VectorBlock<VectorX<T>> KinematicWorkspace<T>::vector(Slot slot,
+                                                             int size) {
+  VectorX<T>& buffer = vectors_.at(slot);
+  if (buffer.size() < size) {
+    buffer.resize(size);
+  }
+  return buffer.head(size);
+}
+
+template <typename T>
+MultibodyForces<T>& KinematicWorkspace<T>::forces(
+    const MultibodyPlant<T>& plant) {
+  if (forces_ == nullptr || !forces_->CheckHasRightSizeForModel(plant)) {
+    forces_ = std::make_unique<MultibodyForces<T>>(plant);
+  }
+  return *forces_;
+}
+
+template <typename T>
+const VectorX<T>& KinematicWorkspace<T>::EvalGravityGeneralizedForces(
+    const MultibodyPlant<T>& plant, const Context<T>& context) {
+  if constexpr (std::is_same<T, double>::value) {
+    const auto& q = plant.GetPositions(context);
+    if (gravity_plant_ == &plant && gravity_q_.size() == q.size() &&
+        gravity_q_ == q) {
+      return gravity_;
+    }
+    gravity_plant_ = &plant;
+    gravity_q_ = q;
+  }
+  // With T = AutoDiffXd, they would also depend on the derivatives of q
+  gravity_ = plant.CalcGravityGeneralizedForces(context);
+  return gravity_;
+}
+
+DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
+    class ::dairlib::multibody::KinematicWorkspace)
+
+}  // namespace multibody
+}  // namespace dairlib
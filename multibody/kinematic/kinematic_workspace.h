@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include "multibody/kinematic/body_kinematics.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/systems/framework/context.h"
+
+namespace dairlib {
+namespace multibody {
+
+/// Scratch storage of the kinematic evaluations which need intermediate
+/// terms, e.g. the full rows from which KinematicEvaluator selects the active
+/// ones. Evaluators (and their sets) are shared between threads, e.g. by a
+/// parallel Dircon solve, so they don't keep any scratch themselves: a caller
+/// which must not allocate keeps a workspace (one per thread) and passes it to
+/// every evaluation. The storage only grows, so a reused workspace doesn't
+/// allocate (for T = double). Evaluations without a workspace use a temporary
+/// one.
+template <typename T>
+class KinematicWorkspace {
+ public:
+  /// Uses of the scratch matrices and vectors. Each one has its own, so that
+  /// nested evaluations don't overwrite each other.
+  enum Slot {
+    /// Full rows of a KinematicEvaluator, before selecting the active ones
+    kFullRows,
+    /// Translational Jacobians of two points (3 x nv), e.g. for
+    /// DistanceEvaluator
+    kPointA,
+    kPointB,
+    /// Jacobian of a KinematicEvaluatorSet
+    kSetJacobian,
+    /// Intermediate vectors of KinematicEvaluatorSet (x_dot, phi)
+    kSetState,
+    kSetConstraint,
+    kNumSlots,
+  };
+
+  KinematicWorkspace() = default;
+
+  /// The rows x cols block of the scratch matrix of `slot`
+  Eigen::Block<drake::MatrixX<T>> matrix(Slot slot, int rows, int cols);
+
+  /// The first `size` entries of the scratch vector of `slot`
+  Eigen::VectorBlock<drake::VectorX<T>> vector(Slot slot, int size);
+
+  /// Body kinematics for the fused Jacobian and Jdot * v evaluations which
+  /// aren't given any
+  BodyKinematics<T>& bodies() { return bodies_; }
+
+  /// Forces of the force elements of `plant`
+  drake::multibody::MultibodyForces<T>& forces(
+      const drake::multibody::MultibodyPlant<T>& plant);
+
+  /// Generalized gravity forces of `plant` at `context`. For T = double, they
+  /// are only recomputed when the plant or the positions change (so the
+  /// workspace must not be shared between contexts with other parameters).
+  const drake::VectorX<T>& EvalGravityGeneralizedForces(
+      const drake::multibody::MultibodyPlant<T>& plant,
+      const drake::systems::Context<T>& context);
+
+ private:
+  std::array<drake::MatrixX<T>, kNumSlots> matrices_;
+  std::array<drake::VectorX<T>, kNumSlots> vectors_;
+  BodyKinematics<T> bodies_;
+  std::unique_ptr<drake::multibody::MultibodyForces<T>> forces_;
+  // Plant and positions of gravity_ (nullptr if not computed)
+  const drake::multibody::MultibodyPlant<T>* gravity_plant_ = nullptr;
+  drake::VectorX<T> gravity_q_;
+  drake::VectorX<T> gravity_;
+};
+
+}  // namespace multibody
+}  // namespace dairlib
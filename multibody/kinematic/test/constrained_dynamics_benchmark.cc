@@ -0,0 +1,172 @@
+#include <chrono>
+
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+
+#include "drake/common/text_logging.h"
+#include "drake/multibody/parsing/parser.h"
+
+/// Timing comparison of the solvers of the constrained dynamics,
+/// KinematicEvaluatorSet::CalcTimeDerivatives, on Cassie with the four-bar
+/// loop closures, and then with the toe contacts as well:
+///  - KKT: the LDLT of the full [[M, -J^T]; [J, 0]] system
+///  - Schur: the Cholesky of M and the Schur complement J M^-1 J^T
+///  - Schur, reused: as above, at a fixed q, reusing the factors
+///  - forward dynamics: M^-1 J^T by the plant's forward dynamics
+/// The largest difference of xdot from the KKT solution is also reported.
+///
+///   bazel-bin/multibody/kinematic/constrained_dynamics_benchmark
+
+namespace dairlib {
+namespace multibody {
+
+using Eigen::VectorXd;
+using std::cout;
+using std::endl;
+typedef std::chrono::steady_clock my_clock;
+
+void TestEvaluatorSet(KinematicEvaluatorSet<double>* evaluators) {
+  int N = 10000;
+  const auto& plant = evaluators->plant();
+  auto context = plant.CreateDefaultContext();
+  plant.get_actuation_input_port().FixValue(
+      context.get(), VectorXd::Zero(plant.num_actuators()));
+
+  VectorXd q, v, lambda;
+  ConstrainedDynamicsFactors<double> factors;
+
+  cout << "***** constrained dynamics (" << std::to_string(N) << ") *****"
+       << endl;
+  evaluators->set_dynamics_solver(ConstrainedDynamicsSolver::kKktLdlt);
+  auto start = my_clock::now();
+  for (int i = 0; i < N; i++) {
+    q = VectorXd::Random(plant.num_positions());
+    v = VectorXd::Random(plant.num_velocities());
+    plant.SetPositions(context.get(), q);
+    plant.SetVelocities(context.get(), v);
+    auto tmp = evaluators->CalcTimeDerivatives(*context, &lambda);
+  }
+  auto stop = my_clock::now();
+  auto duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+  cout << "KKT:\t" << (1.0 * duration.count()) / N << endl;
+
+  evaluators->set_dynamics_solver(ConstrainedDynamicsSolver::kSchurComplement);
+  start = my_clock::now();
+  for (int i = 0; i < N; i++) {
+    q = VectorXd::Random(plant.num_positions());
+    v = VectorXd::Random(plant.num_velocities());
+    plant.SetPositions(context.get(), q);
+    plant.SetVelocities(context.get(), v);
+    auto tmp = evaluators->CalcTimeDerivatives(*context, &lambda);
+  }
+  stop = my_clock::now();
+  duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+  cout << "Schur:\t" << (1.0 * duration.count()) / N << endl;
+
+  q = VectorXd::Random(plant.num_positions());
+  plant.SetPositions(context.get(), q);
+  start = my_clock::now();
+  for (int i = 0; i < N; i++) {
+    v = VectorXd::Random(plant.num_velocities());
+    plant.SetVelocities(context.get(), v);
+    auto tmp = evaluators->CalcTimeDerivatives(*context, &lambda, 0, &factors);
+  }
+  stop = my_clock::now();
+  duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+  cout << "Schur, reused (" << factors.num_factorizations()
+       << " factorization):\t" << (1.0 * duration.count()) / N << endl;
+
+  start = my_clock::now();
+  for (int i = 0; i < N; i++) {
+    q = VectorXd::Random(plant.num_positions());
+    v = VectorXd::Random(plant.num_velocities());
+    plant.SetPositions(context.get(), q);
+    plant.SetVelocities(context.get(), v);
+    auto tmp = evaluators->CalcTimeDerivativesByForwardDynamics(
+        context.get(), &lambda);
+  }
+  stop = my_clock::now();
+  duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+  cout << "forward dynamics:\t" << (1.0 * duration.count()) / N << endl;
+
+  cout << "***** difference from KKT *****" << endl;
+  q = VectorXd::Random(plant.num_positions());
+  v = VectorXd::Random(plant.num_velocities());
+  plant.SetPositions(context.get(), q);
+  plant.SetVelocities(context.get(), v);
+  evaluators->set_dynamics_solver(ConstrainedDynamicsSolver::kKktLdlt);
+  const VectorXd xdot_kkt = evaluators->CalcTimeDerivatives(*context, &lambda);
+  evaluators->set_dynamics_solver(ConstrainedDynamicsSolver::kSchurComplement);
+  const VectorXd xdot_schur =
+      evaluators->CalcTimeDerivatives(*context, &lambda);
+  const VectorXd xdot_forward =
+      evaluators->CalcTimeDerivativesByForwardDynamics(context.get(), &lambda);
+  cout << "Schur:\t" << (xdot_schur - xdot_kkt).lpNorm<Eigen::Infinity>()
+       << endl;
+  cout << "forward dynamics:\t"
+       << (xdot_forward - xdot_kkt).lpNorm<Eigen::Infinity>() << endl;
+}
+
+int DoMain(int argc, char* argv[]) {
+  srand((unsigned int) time(0));
+  drake::logging::set_log_level("err");  // ignore warnings about joint limit
+
+  std::string filename = "examples/Cassie/urdf/cassie_fixed_springs.urdf";
+  // Build plant
+  drake::multibody::MultibodyPlant<double> plant(0);
+  drake::multibody::Parser parser(&plant);
+  std::string full_name = FindResourceOrThrow(filename);
+  parser.AddModelFromFile(full_name);
+  plant.Finalize();
+
+  multibody::KinematicEvaluatorSet<double> evaluators(plant);
+
+  // Add loop closures
+  auto left_loop = LeftLoopClosureEvaluator(plant);
+  auto right_loop = RightLoopClosureEvaluator(plant);
+  evaluators.add_evaluator(&left_loop);
+  evaluators.add_evaluator(&right_loop);
+
+  cout << "ALL TIMES AVG TIME IN MICROSECONDS." << endl;
+  cout << endl << "LOOP CLOSURES." << endl;
+  TestEvaluatorSet(&evaluators);
+
+  // Add the toe contacts. Only y and z of the rear contacts, so that J has
+  // full row rank.
+  auto left_toe = LeftToeFront(plant);
+  auto left_heel = LeftToeRear(plant);
+  auto right_toe = RightToeFront(plant);
+  auto right_heel = RightToeRear(plant);
+  auto left_toe_eval = WorldPointEvaluator<double>(
+      plant, left_toe.first, left_toe.second, Eigen::Matrix3d::Identity(),
+      Eigen::Vector3d::Zero(), {0, 1, 2});
+  auto left_heel_eval = WorldPointEvaluator<double>(
+      plant, left_heel.first, left_heel.second, Eigen::Matrix3d::Identity(),
+      Eigen::Vector3d::Zero(), {1, 2});
+  auto right_toe_eval = WorldPointEvaluator<double>(
+      plant, right_toe.first, right_toe.second, Eigen::Matrix3d::Identity(),
+      Eigen::Vector3d::Zero(), {0, 1, 2});
+  auto right_heel_eval = WorldPointEvaluator<double>(
+      plant, right_heel.first, right_heel.second, Eigen::Matrix3d::Identity(),
+      Eigen::Vector3d::Zero(), {1, 2});
+  evaluators.add_evaluator(&left_toe_eval);
+  evaluators.add_evaluator(&left_heel_eval);
+  evaluators.add_evaluator(&right_toe_eval);
+  evaluators.add_evaluator(&right_heel_eval);
+
+  cout << endl << "LOOP CLOSURES AND TOE CONTACTS." << endl;
+  TestEvaluatorSet(&evaluators);
+  return 0;
+}
+
+}  // namespace multibody
+}  // namespace dairlib
+
+int main(int argc, char* argv[]) {
+  return dairlib::multibody::DoMain(argc, argv);
+}
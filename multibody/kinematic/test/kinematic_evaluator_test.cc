@@ -9,6 +9,7 @@
 #include "common/find_resource.h"
 #include "multibody/kinematic/distance_evaluator.h"
 #include "multibody/kinematic/kinematic_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
 #include "multibody/kinematic/world_point_evaluator.h"
 
 namespace dairlib {
@@ -160,6 +161,232 @@ TEST_F(KinematicEvaluatorTest, DistanceEvaluatorTest) {
   EXPECT_TRUE(CompareMatrices(Jdotv, Jdot_approx * v, dt * 100));
 }
 
+TEST_F(KinematicEvaluatorTest, OutputArgumentTest) {
+  const double tolerance = 1e-12;
+  const int nv = plant_->num_velocities();
+
+  Vector3d pt_A({0, 0, -.5});
+  const auto& frame_A = plant_->GetFrameByName("right_lower_leg");
+  const auto& frame_B = plant_->GetFrameByName("left_lower_leg");
+
+  // Active rows out of order, so that they are selected
+  auto point = WorldPointEvaluator<double>(*plant_, pt_A, frame_A,
+      Eigen::Matrix3d::Identity(), Vector3d({1, 2, 3}), {2, 0});
+  auto distance = DistanceEvaluator<double>(*plant_, pt_A, frame_A, pt_A,
+      frame_B, .5);
+  KinematicEvaluatorSet<double> evaluators(*plant_);
+  evaluators.add_evaluator(&point);
+  evaluators.add_evaluator(&distance);
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+  plant_->SetVelocities(context.get(), VectorXd::Random(nv));
+
+  // Outputs are written into blocks of larger matrices, which must keep
+  // their other entries
+  const int n_active = evaluators.count_active();
+  const int n_full = evaluators.count_full();
+  MatrixXd J = MatrixXd::Zero(n_active + 2, nv);
+  auto J_active = J.middleRows(1, n_active);
+  evaluators.EvalActiveJacobian(*context, &J_active);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalActiveJacobian(*context),
+                              J.middleRows(1, n_active), tolerance));
+  EXPECT_EQ(J.row(0).norm() + J.row(n_active + 1).norm(), 0);
+
+  VectorXd y = VectorXd::Zero(n_full + 2);
+  auto phi = y.segment(1, n_active);
+  evaluators.EvalActive(*context, &phi);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalActive(*context),
+                              y.segment(1, n_active), tolerance));
+  evaluators.EvalActiveTimeDerivative(*context, &phi);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalActiveTimeDerivative(*context),
+                              y.segment(1, n_active), tolerance));
+  evaluators.EvalActiveJacobianDotTimesV(*context, &phi);
+  EXPECT_TRUE(CompareMatrices(
+      evaluators.EvalActiveJacobianDotTimesV(*context),
+      y.segment(1, n_active), tolerance));
+  EXPECT_EQ(y(0), 0);
+
+  auto phi_full = y.segment(1, n_full);
+  evaluators.EvalFull(*context, &phi_full);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalFull(*context),
+                              y.segment(1, n_full), tolerance));
+  evaluators.EvalFullTimeDerivative(*context, &phi_full);
+  EXPECT_TRUE(CompareMatrices(
+      evaluators.EvalFullJacobian(*context) * plant_->GetVelocities(*context),
+      y.segment(1, n_full), tolerance));
+  evaluators.EvalFullJacobianDotTimesV(*context, &phi_full);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalFullJacobianDotTimesV(*context),
+                              y.segment(1, n_full), tolerance));
+  EXPECT_EQ(y(0) + y(n_full + 1), 0);
+
+  // Active rows of a single evaluator
+  VectorXd phi_point(2);
+  point.EvalActive(*context, &phi_point);
+  const VectorXd phi_point_full = point.EvalFull(*context);
+  EXPECT_NEAR(phi_point(0), phi_point_full(2), tolerance);
+  EXPECT_NEAR(phi_point(1), phi_point_full(0), tolerance);
+}
+
+TEST_F(KinematicEvaluatorTest, FusedJacobianAndJdotVTest) {
+  const double tolerance = 1e-10;
+  const int nv = plant_->num_velocities();
+
+  const auto& frame_A = plant_->GetFrameByName("right_lower_leg");
+  const auto& frame_B = plant_->GetFrameByName("left_lower_leg");
+
+  // Two points on the same body, one of them rotated with selected rows, and
+  // a distance between bodies
+  auto point = WorldPointEvaluator<double>(*plant_, Vector3d({0, 0, -.5}),
+      frame_A, Vector3d({1, 0, 0}), Vector3d({1, 2, 3}), false);
+  auto other_point = WorldPointEvaluator<double>(*plant_,
+      Vector3d({.1, 0, -.2}), frame_A);
+  auto distance = DistanceEvaluator<double>(*plant_, Vector3d({0, 0, -.5}),
+      frame_A, Vector3d({0, 0, -.3}), frame_B, .5);
+  KinematicEvaluatorSet<double> evaluators(*plant_);
+  evaluators.add_evaluator(&point);
+  evaluators.add_evaluator(&other_point);
+  evaluators.add_evaluator(&distance);
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+  plant_->SetVelocities(context.get(), VectorXd::Random(nv));
+
+  MatrixXd J(evaluators.count_full(), nv);
+  VectorXd Jdotv(evaluators.count_full());
+  evaluators.EvalFullJacobianAndJdotV(*context, &J, &Jdotv);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalFullJacobian(*context), J,
+                              tolerance));
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalFullJacobianDotTimesV(*context),
+                              Jdotv, tolerance));
+
+  MatrixXd J_active(evaluators.count_active(), nv);
+  VectorXd Jdotv_active(evaluators.count_active());
+  evaluators.EvalActiveJacobianAndJdotV(*context, &J_active, &Jdotv_active);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalActiveJacobian(*context),
+                              J_active, tolerance));
+  EXPECT_TRUE(CompareMatrices(
+      evaluators.EvalActiveJacobianDotTimesV(*context), Jdotv_active,
+      tolerance));
+
+  // The body kinematics are shared between the evaluators
+  BodyKinematics<double> bodies;
+  bodies.Reset(*plant_, *context);
+  evaluators.EvalFullJacobianAndJdotV(*context, &J, &Jdotv, &bodies);
+  EXPECT_EQ(bodies.num_bodies(), 2);
+}
+
+// A workspace reused across (nested) evaluations gives the same results as
+// the temporary ones
+TEST_F(KinematicEvaluatorTest, WorkspaceTest) {
+  const double tolerance = 1e-10;
+  const int nq = plant_->num_positions();
+  const int nv = plant_->num_velocities();
+
+  const auto& frame_A = plant_->GetFrameByName("right_lower_leg");
+  const auto& frame_B = plant_->GetFrameByName("left_lower_leg");
+  auto point = WorldPointEvaluator<double>(*plant_, Vector3d({0, 0, -.5}),
+      frame_A, Eigen::Matrix3d::Identity(), Vector3d::Zero(), {2, 0});
+  auto distance = DistanceEvaluator<double>(*plant_, Vector3d({0, 0, -.5}),
+      frame_A, Vector3d({0, 0, -.3}), frame_B, .5);
+  KinematicEvaluatorSet<double> evaluators(*plant_);
+  evaluators.add_evaluator(&point);
+  evaluators.add_evaluator(&distance);
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->get_actuation_input_port().FixValue(
+      context.get(), VectorXd::Random(plant_->num_actuators()));
+  plant_->SetPositions(context.get(), VectorXd::Random(nq));
+  plant_->SetVelocities(context.get(), VectorXd::Random(nv));
+  const VectorXd lambda = VectorXd::Random(evaluators.count_full());
+
+  KinematicWorkspace<double> workspace;
+  VectorXd phiddot(evaluators.count_active());
+  evaluators.EvalActiveSecondTimeDerivative(context.get(), lambda, &phiddot,
+                                            &workspace);
+  EXPECT_TRUE(CompareMatrices(
+      evaluators.EvalActiveSecondTimeDerivative(context.get(), lambda),
+      phiddot, tolerance));
+
+  MatrixXd J(evaluators.count_active(), nv);
+  VectorXd Jdotv(evaluators.count_active());
+  evaluators.EvalActiveJacobianAndJdotV(*context, &J, &Jdotv, nullptr,
+                                        &workspace);
+  EXPECT_TRUE(CompareMatrices(evaluators.EvalActiveJacobian(*context), J,
+                              tolerance));
+  EXPECT_TRUE(CompareMatrices(
+      evaluators.EvalActiveJacobianDotTimesV(*context), Jdotv, tolerance));
+
+  // The applied force port, fixed by the first call, is updated in place
+  VectorXd Mvdot(nv);
+  evaluators.CalcMassMatrixTimesVDot(*context, lambda, &Mvdot, &workspace);
+  VectorXd xdot(nq + nv);
+  evaluators.CalcTimeDerivativesWithForce(context.get(), 2 * lambda, &xdot,
+                                          &workspace);
+  evaluators.CalcTimeDerivativesWithForce(context.get(), lambda, &xdot,
+                                          &workspace);
+  MatrixXd M(nv, nv);
+  plant_->CalcMassMatrix(*context, &M);
+  EXPECT_TRUE(CompareMatrices(M * xdot.tail(nv), Mvdot, 1e-8));
+}
+
+TEST_F(KinematicEvaluatorTest, ConstrainedDynamicsSolverTest) {
+  const double tolerance = 1e-8;
+
+  // A foot point (in the plane of the walker) and a distance between the legs
+  auto point = WorldPointEvaluator<double>(*plant_, Vector3d({0, 0, -.5}),
+      plant_->GetFrameByName("right_lower_leg"), Eigen::Matrix3d::Identity(),
+      Vector3d::Zero(), {0, 2});
+  auto distance = DistanceEvaluator<double>(*plant_, Vector3d({0, 0, -.5}),
+      plant_->GetFrameByName("right_lower_leg"), Vector3d({0, 0, -.3}),
+      plant_->GetFrameByName("left_lower_leg"), .5);
+  KinematicEvaluatorSet<double> evaluators(*plant_);
+  evaluators.add_evaluator(&point);
+  evaluators.add_evaluator(&distance);
+
+  auto context = plant_->CreateDefaultContext();
+  plant_->get_actuation_input_port().FixValue(
+      context.get(), VectorXd::Random(plant_->num_actuators()));
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+  plant_->SetVelocities(context.get(),
+                        VectorXd::Random(plant_->num_velocities()));
+
+  VectorXd lambda_kkt, lambda_schur, lambda_forward;
+  evaluators.set_dynamics_solver(ConstrainedDynamicsSolver::kKktLdlt);
+  const VectorXd xdot_kkt =
+      evaluators.CalcTimeDerivatives(*context, &lambda_kkt, 1.0);
+  evaluators.set_dynamics_solver(ConstrainedDynamicsSolver::kSchurComplement);
+  const VectorXd xdot_schur =
+      evaluators.CalcTimeDerivatives(*context, &lambda_schur, 1.0);
+  EXPECT_TRUE(CompareMatrices(xdot_kkt, xdot_schur, tolerance));
+  EXPECT_TRUE(CompareMatrices(lambda_kkt, lambda_schur, tolerance));
+
+  // The factors are only recomputed when q changes
+  ConstrainedDynamicsFactors<double> factors;
+  evaluators.CalcTimeDerivatives(*context, &lambda_schur, 1.0, &factors);
+  plant_->SetVelocities(context.get(),
+                        VectorXd::Random(plant_->num_velocities()));
+  const VectorXd xdot_reused =
+      evaluators.CalcTimeDerivatives(*context, &lambda_schur, 1.0, &factors);
+  EXPECT_EQ(factors.num_factorizations(), 1);
+  EXPECT_TRUE(CompareMatrices(
+      evaluators.CalcTimeDerivatives(*context, &lambda_forward, 1.0),
+      xdot_reused, tolerance));
+
+  const VectorXd xdot_forward = evaluators.CalcTimeDerivativesByForwardDynamics(
+      context.get(), &lambda_forward, 1.0);
+  EXPECT_TRUE(CompareMatrices(xdot_reused, xdot_forward, tolerance));
+  EXPECT_TRUE(CompareMatrices(lambda_schur, lambda_forward, tolerance));
+
+  plant_->SetPositions(context.get(),
+                       VectorXd::Random(plant_->num_positions()));
+  evaluators.CalcTimeDerivatives(*context, &lambda_schur, 1.0, &factors);
+  EXPECT_EQ(factors.num_factorizations(), 2);
+}
+
 }  // namespace
 }  // namespace multibody
 }  // namespace dairlib
@@ -5,6 +5,7 @@
 #include "drake/math/orthonormal_basis.h"
 
 using drake::MatrixX;
+using drake::Vector3;
 using drake::VectorX;
 using drake::multibody::Frame;
 using drake::multibody::MultibodyPlant;
@@ -19,6 +20,20 @@ using std::vector;
 namespace dairlib {
 namespace multibody {
 
+namespace {
+
+// J = rotation * J, column by column rather than through a temporary 3 x nv
+// matrix
+template <typename T>
+void RotateColumns(const Matrix3d& rotation, drake::EigenPtr<MatrixX<T>> J) {
+  for (int i = 0; i < J->cols(); i++) {
+    const Vector3<T> column = rotation * J->col(i);
+    J->col(i) = column;
+  }
+}
+
+}  // namespace
+
 template <typename T>
 WorldPointEvaluator<T>::WorldPointEvaluator(const MultibodyPlant<T>& plant,
                                             Vector3d pt_A,
@@ -52,38 +67,53 @@ WorldPointEvaluator<T>::WorldPointEvaluator(const MultibodyPlant<T>& plant,
 }
 
 template <typename T>
-VectorX<T> WorldPointEvaluator<T>::EvalFull(const Context<T>& context) const {
-  VectorX<T> pt_world(3);
+void WorldPointEvaluator<T>::EvalFull(const Context<T>& context,
+                                      drake::EigenPtr<VectorX<T>> phi) const {
+  Vector3<T> pt_world;
   const drake::multibody::Frame<T>& world = plant().world_frame();
 
   plant().CalcPointsPositions(context, frame_A_, pt_A_.template cast<T>(),
                               world, &pt_world);
 
-  return rotation_ * (pt_world - offset_);
+  *phi = rotation_ * (pt_world - offset_);
 }
 
 template <typename T>
 void WorldPointEvaluator<T>::EvalFullJacobian(
-    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J) const {
+    const Context<T>& context, drake::EigenPtr<MatrixX<T>> J,
+    KinematicWorkspace<T>* workspace) const {
   const drake::multibody::Frame<T>& world = plant().world_frame();
 
   // .template cast<T> converts pt_A_, as a double, into type T
   plant().CalcJacobianTranslationalVelocity(
       context, drake::multibody::JacobianWrtVariable::kV, frame_A_,
       pt_A_.template cast<T>(), world, world, J);
-  *J = rotation_ * (*J);
+  RotateColumns(rotation_, J);
 }
 
 template <typename T>
-VectorX<T> WorldPointEvaluator<T>::EvalFullJacobianDotTimesV(
-    const Context<T>& context) const {
+void WorldPointEvaluator<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
   const drake::multibody::Frame<T>& world = plant().world_frame();
 
-  MatrixX<T> Jdot_times_V = plant().CalcBiasTranslationalAcceleration(
+  const Vector3<T> Jdot_times_V = plant().CalcBiasTranslationalAcceleration(
       context, drake::multibody::JacobianWrtVariable::kV, frame_A_,
       pt_A_.template cast<T>(), world, world);
 
-  return rotation_ * Jdot_times_V;
+  *Jdotv = rotation_ * Jdot_times_V;
+}
+
+template <typename T>
+void WorldPointEvaluator<T>::EvalFullJacobianAndJdotV(
+    const Context<T>& context, BodyKinematics<T>* bodies,
+    drake::EigenPtr<MatrixX<T>> J, drake::EigenPtr<VectorX<T>> Jdotv,
+    KinematicWorkspace<T>* workspace) const {
+  Vector3<T> pt_world;
+  Vector3<T> Jdot_times_V;
+  bodies->CalcPoint(frame_A_, pt_A_, &pt_world, J, &Jdot_times_V);
+  RotateColumns(rotation_, J);
+  *Jdotv = rotation_ * Jdot_times_V;
 }
 
 template <typename T>
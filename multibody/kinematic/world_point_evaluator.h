@@ -52,16 +52,28 @@ class WorldPointEvaluator : public KinematicEvaluator<T> {
                       const Eigen::Vector3d offset = Eigen::Vector3d::Zero(),
                       bool tangent_active = true);
 
-  drake::VectorX<T> EvalFull(
-      const drake::systems::Context<T>& context) const override;
+  void EvalFull(const drake::systems::Context<T>& context,
+                drake::EigenPtr<drake::VectorX<T>> phi) const override;
 
   void EvalFullJacobian(const drake::systems::Context<T>& context,
-                        drake::EigenPtr<drake::MatrixX<T>> J) const override;
+                        drake::EigenPtr<drake::MatrixX<T>> J,
+                        KinematicWorkspace<T>* workspace) const override;
 
-  drake::VectorX<T> EvalFullJacobianDotTimesV(
-      const drake::systems::Context<T>& context) const override;
+  void EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace) const override;
 
+  void EvalFullJacobianAndJdotV(
+      const drake::systems::Context<T>& context, BodyKinematics<T>* bodies,
+      drake::EigenPtr<drake::MatrixX<T>> J,
+      drake::EigenPtr<drake::VectorX<T>> Jdotv,
+      KinematicWorkspace<T>* workspace) const override;
+
+  using KinematicEvaluator<T>::EvalFull;
   using KinematicEvaluator<T>::EvalFullJacobian;
+  using KinematicEvaluator<T>::EvalFullJacobianDotTimesV;
+  using KinematicEvaluator<T>::EvalFullJacobianAndJdotV;
   using KinematicEvaluator<T>::plant;
 
   std::vector<std::shared_ptr<drake::solvers::Constraint>>
@@ -1,9 +1,11 @@
 #include "multibody/multibody_utils.h"
 
 #include <set>
+#include <stdexcept>
 #include <vector>
 
 #include "drake/common/drake_assert.h"
+#include "drake/common/drake_throw.h"
 #include "drake/math/autodiff_gradient.h"
 
 namespace dairlib {
@@ -337,6 +339,99 @@ vector<string> createActuatorNameVectorFromMap(
   return actuator_names;
 }
 
+uint64_t NameListHash(const vector<string>& names) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const auto& name : names) {
+    for (char c : name) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+namespace {
+
+// Names ordered by index, from a map built by the functions above
+vector<string> OrderedNames(const map<string, int>& name_to_index, int size) {
+  vector<string> names(size);
+  for (const auto& name_index_pair : name_to_index) {
+    names[name_index_pair.second] = name_index_pair.first;
+  }
+  return names;
+}
+
+int FindIndex(const map<string, int>& name_to_index, const string& name) {
+  const auto it = name_to_index.find(name);
+  if (it == name_to_index.end()) {
+    throw std::out_of_range("No coordinate named " + name);
+  }
+  return it->second;
+}
+
+}  // namespace
+
+template <typename T>
+StateIndexLayout::StateIndexLayout(const MultibodyPlant<T>& plant)
+    : position_map_(makeNameToPositionsMap(plant)),
+      velocity_map_(makeNameToVelocitiesMap(plant)),
+      actuator_map_(makeNameToActuatorsMap(plant)),
+      position_names_(OrderedNames(position_map_, plant.num_positions())),
+      velocity_names_(OrderedNames(velocity_map_, plant.num_velocities())),
+      actuator_names_(OrderedNames(actuator_map_, plant.num_actuators())),
+      position_names_hash_(NameListHash(position_names_)),
+      velocity_names_hash_(NameListHash(velocity_names_)),
+      actuator_names_hash_(NameListHash(actuator_names_)) {}
+
+int StateIndexLayout::position_index(const string& name) const {
+  return FindIndex(position_map_, name);
+}
+
+int StateIndexLayout::velocity_index(const string& name) const {
+  return FindIndex(velocity_map_, name);
+}
+
+int StateIndexLayout::actuator_index(const string& name) const {
+  return FindIndex(actuator_map_, name);
+}
+
+NameOrdering::NameOrdering(const vector<string>& layout_names)
+    : layout_names_(layout_names), layout_hash_(NameListHash(layout_names)) {
+  for (size_t i = 0; i < layout_names.size(); i++) {
+    layout_map_[layout_names[i]] = i;
+  }
+}
+
+const vector<int>& NameOrdering::Update(const vector<string>& names) {
+  const uint64_t hash = NameListHash(names);
+  if (has_indices_ && hash == hash_) {
+    return indices_;
+  }
+  has_indices_ = false;
+  indices_.resize(names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    indices_[i] = FindIndex(layout_map_, names[i]);
+  }
+  hash_ = hash;
+  has_indices_ = true;
+  is_identity_ = (hash == layout_hash_ && names == layout_names_);
+  return indices_;
+}
+
+void NameOrdering::Copy(const vector<string>& names,
+                        const vector<double>& values,
+                        Eigen::Ref<VectorXd> layout_values) {
+  DRAKE_THROW_UNLESS(names.size() == values.size());
+  const auto& indices = Update(names);
+  if (is_identity_) {
+    layout_values = Eigen::Map<const VectorXd>(values.data(), values.size());
+    return;
+  }
+  for (size_t i = 0; i < indices.size(); i++) {
+    layout_values(indices[i]) = values[i];
+  }
+}
+
 bool JointsWithinLimits(const MultibodyPlant<double>& plant, VectorXd positions,
                         double tolerance) {
   VectorXd joint_min = plant.GetPositionLowerLimits();
@@ -385,6 +480,8 @@ bool isQuaternion(const MultibodyPlant<T>& plant) {
   return QuaternionStartIndex(plant) != -1;
 }
 
+template StateIndexLayout::StateIndexLayout(const MultibodyPlant<double>& plant);  // NOLINT
+template StateIndexLayout::StateIndexLayout(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
 template int QuaternionStartIndex(const MultibodyPlant<double>& plant);  // NOLINT
 template int QuaternionStartIndex(const MultibodyPlant<AutoDiffXd>& plant);  // NOLINT
 template std::vector<int> QuaternionStartIndices(const MultibodyPlant<double>& plant);  // NOLINT
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "drake/multibody/plant/multibody_plant.h"
 
@@ -95,6 +97,94 @@ template <typename T>
 std::vector<std::string> createActuatorNameVectorFromMap(
     const drake::multibody::MultibodyPlant<T>& plant);
 
+/// Hash identifying an ordered list of names (e.g. the joint names of a
+/// message): the 64-bit FNV-1a hash of the names, each followed by a zero byte
+uint64_t NameListHash(const std::vector<std::string>& names);
+
+/// Index layout of the positions, velocities and actuators of a plant, with
+/// the names of the maps above. It is built once from the plant (e.g. in the
+/// constructor of a system), so that the code running on every message or
+/// tick uses integer indices instead of looking up names.
+class StateIndexLayout {
+ public:
+  template <typename T>
+  explicit StateIndexLayout(const drake::multibody::MultibodyPlant<T>& plant);
+
+  int num_positions() const { return position_names_.size(); }
+  int num_velocities() const { return velocity_names_.size(); }
+  int num_actuators() const { return actuator_names_.size(); }
+
+  /// Index of a position by name. Throws if the plant has no such position.
+  int position_index(const std::string& name) const;
+  /// Index of a velocity by name. Throws if the plant has no such velocity.
+  int velocity_index(const std::string& name) const;
+  /// Index of an actuator by name. Throws if the plant has no such actuator.
+  int actuator_index(const std::string& name) const;
+
+  /// The names, in the order of the plant's vectors
+  const std::vector<std::string>& position_names() const {
+    return position_names_;
+  }
+  const std::vector<std::string>& velocity_names() const {
+    return velocity_names_;
+  }
+  const std::vector<std::string>& actuator_names() const {
+    return actuator_names_;
+  }
+
+  /// NameListHash() of the names
+  uint64_t position_names_hash() const { return position_names_hash_; }
+  uint64_t velocity_names_hash() const { return velocity_names_hash_; }
+  uint64_t actuator_names_hash() const { return actuator_names_hash_; }
+
+ private:
+  std::map<std::string, int> position_map_;
+  std::map<std::string, int> velocity_map_;
+  std::map<std::string, int> actuator_map_;
+  std::vector<std::string> position_names_;
+  std::vector<std::string> velocity_names_;
+  std::vector<std::string> actuator_names_;
+  uint64_t position_names_hash_;
+  uint64_t velocity_names_hash_;
+  uint64_t actuator_names_hash_;
+};
+
+/// Copies values received in the order of a list of names (e.g. the
+/// positions of a message with their names) to a vector ordered as
+/// `layout_names` (e.g. StateIndexLayout::position_names()). The indices of
+/// the names are looked up for the first list, and then only again when the
+/// NameListHash() of the list changes: a stream of messages with the same
+/// names costs a hash per message, and a plain copy if they are in the
+/// layout's order.
+class NameOrdering {
+ public:
+  explicit NameOrdering(const std::vector<std::string>& layout_names);
+
+  /// Copies `values` (ordered as `names`) into the entries of
+  /// `layout_values` named by `names`. The others are left unchanged.
+  /// Throws if one of `names` isn't in the layout.
+  void Copy(const std::vector<std::string>& names,
+            const std::vector<double>& values,
+            Eigen::Ref<Eigen::VectorXd> layout_values);
+
+  /// Index in the layout of each of `names`, looked up again only if their
+  /// hash differs from the previous call
+  const std::vector<int>& Update(const std::vector<std::string>& names);
+
+  /// Whether the last names were those of the layout, in order
+  bool is_identity() const { return is_identity_; }
+
+ private:
+  const std::vector<std::string> layout_names_;
+  std::map<std::string, int> layout_map_;
+  uint64_t layout_hash_;
+  // The last ordering, and the hash of its names
+  std::vector<int> indices_;
+  uint64_t hash_ = 0;
+  bool has_indices_ = false;
+  bool is_identity_ = false;
+};
+
 // TODO: The following two functions need to be implemented as a part of
 // RBT/Multibody and not as separate functions that take in RBTs. Make the
 // change once the codebase shifts to using multibody.
@@ -58,6 +58,56 @@ TEST_F(MultibodyUtilsTest, ContextTest) {
   EXPECT_EQ(u, u_context);
 }
 
+TEST_F(MultibodyUtilsTest, StateIndexLayoutTest) {
+  const StateIndexLayout layout(plant_);
+  auto positions_map = makeNameToPositionsMap(plant_);
+  EXPECT_EQ(layout.num_positions(), plant_.num_positions());
+  for (const auto& name_index : positions_map) {
+    EXPECT_EQ(layout.position_index(name_index.first), name_index.second);
+    EXPECT_EQ(layout.position_names()[name_index.second], name_index.first);
+  }
+  EXPECT_EQ(layout.velocity_index("knee_leftdot"),
+            makeNameToVelocitiesMap(plant_).at("knee_leftdot"));
+  EXPECT_EQ(layout.actuator_index("knee_left_motor"),
+            makeNameToActuatorsMap(plant_).at("knee_left_motor"));
+  EXPECT_THROW(layout.position_index("not_a_joint"), std::out_of_range);
+  EXPECT_EQ(layout.position_names_hash(),
+            NameListHash(layout.position_names()));
+}
+
+TEST_F(MultibodyUtilsTest, NameOrderingTest) {
+  const StateIndexLayout layout(plant_);
+  NameOrdering ordering(layout.position_names());
+  const int n = layout.num_positions();
+
+  // In the order of the layout
+  std::vector<double> values(n);
+  for (int i = 0; i < n; i++) {
+    values[i] = i;
+  }
+  VectorXd q = VectorXd::Zero(n);
+  ordering.Copy(layout.position_names(), values, q);
+  EXPECT_TRUE(ordering.is_identity());
+  for (int i = 0; i < n; i++) {
+    EXPECT_EQ(q(i), i);
+  }
+
+  // Reversed, and missing the first name of the layout
+  std::vector<std::string> names(layout.position_names().rbegin(),
+                                 layout.position_names().rend() - 1);
+  values.resize(n - 1);
+  q = VectorXd::Constant(n, -1);
+  ordering.Copy(names, values, q);
+  EXPECT_FALSE(ordering.is_identity());
+  EXPECT_EQ(q(0), -1);
+  for (int i = 0; i < n - 1; i++) {
+    EXPECT_EQ(q(n - 1 - i), values[i]);
+  }
+
+  names.back() = "not_a_joint";
+  EXPECT_THROW(ordering.Copy(names, values, q), std::out_of_range);
+}
+
 }  // namespace
 }  // namespace multibody
 }  // namespace dairlib
@@ -0,0 +1,454 @@
+#include "solvers/dense_active_set_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "drake/common/drake_assert.h"
+
+using drake::solvers::Binding;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::SolutionResult;
+using drake::solvers::VectorXDecisionVariable;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace dairlib {
+namespace solvers {
+
+namespace {
+
+vector<int> GetVariableIndices(const MathematicalProgram& prog,
+                               const VectorXDecisionVariable& vars) {
+  vector<int> idx(vars.size());
+  for (int i = 0; i < vars.size(); i++) {
+    idx[i] = prog.FindDecisionVariableIndex(vars(i));
+  }
+  return idx;
+}
+
+template <typename C>
+void GetConstraintVariableIndices(const MathematicalProgram& prog,
+                                  const vector<Binding<C>>& bindings,
+                                  int* n_rows, vector<vector<int>>* var_idx) {
+  var_idx->clear();
+  for (const auto& binding : bindings) {
+    var_idx->push_back(GetVariableIndices(prog, binding.variables()));
+    *n_rows += binding.evaluator()->num_constraints();
+  }
+}
+
+// Multipliers and step ratios below this value are treated as zero
+constexpr double kZeroTol = 1e-12;
+
+}  // namespace
+
+DenseActiveSetSolver::DenseActiveSetSolver(DenseActiveSetSolverOptions options)
+    : options_(options) {
+  DRAKE_DEMAND(options_.max_iter >= 0);
+  DRAKE_DEMAND(options_.regularization >= 0);
+}
+
+void DenseActiveSetSolver::InitializeSolver(const MathematicalProgram& prog) {
+  DRAKE_DEMAND(prog.generic_costs().empty());
+  DRAKE_DEMAND(prog.generic_constraints().empty());
+  DRAKE_DEMAND(prog.linear_complementarity_constraints().empty());
+  DRAKE_DEMAND(prog.lorentz_cone_constraints().empty());
+  DRAKE_DEMAND(prog.rotated_lorentz_cone_constraints().empty());
+  DRAKE_DEMAND(prog.positive_semidefinite_constraints().empty());
+
+  n_ = prog.num_vars();
+
+  quadratic_cost_var_idx_.clear();
+  for (const auto& binding : prog.quadratic_costs()) {
+    quadratic_cost_var_idx_.push_back(
+        GetVariableIndices(prog, binding.variables()));
+  }
+  linear_cost_var_idx_.clear();
+  for (const auto& binding : prog.linear_costs()) {
+    linear_cost_var_idx_.push_back(
+        GetVariableIndices(prog, binding.variables()));
+  }
+  m_eq_ = 0;
+  GetConstraintVariableIndices(prog, prog.linear_equality_constraints(),
+                               &m_eq_, &linear_eq_var_idx_);
+  // The inequality rows are ordered as [linear constraints; bounding boxes]
+  m_in_ = 0;
+  GetConstraintVariableIndices(prog, prog.linear_constraints(), &m_in_,
+                               &linear_var_idx_);
+  GetConstraintVariableIndices(prog, prog.bounding_box_constraints(), &m_in_,
+                               &bbox_var_idx_);
+
+  P_ = MatrixXd::Zero(n_, n_);
+  q_ = VectorXd::Zero(n_);
+  A_eq_ = MatrixXd::Zero(m_eq_, n_);
+  b_eq_ = VectorXd::Zero(m_eq_);
+  A_in_ = MatrixXd::Zero(m_in_, n_);
+  lb_ = VectorXd::Zero(m_in_);
+  ub_ = VectorXd::Zero(m_in_);
+  P_llt_ = Eigen::LLT<MatrixXd>(n_);
+  x_unconstrained_ = VectorXd::Zero(n_);
+
+  // The working set contains at most n linearly independent constraints
+  // besides the equality constraints.
+  int capacity = m_eq_ + n_;
+  num_working_ = 0;
+  working_set_.assign(capacity, 0);
+  in_working_set_.assign(2 * m_in_, 0);
+  N_ = MatrixXd::Zero(capacity, n_);
+  b_ws_ = VectorXd::Zero(capacity);
+  PinvNT_ = MatrixXd::Zero(n_, capacity);
+  lambda_ = VectorXd::Zero(capacity);
+  R_ = MatrixXd::Zero(capacity, capacity);
+
+  x_ = VectorXd::Zero(n_);
+  n_p_ = VectorXd::Zero(n_);
+  Pinv_n_p_ = VectorXd::Zero(n_);
+  z_ = VectorXd::Zero(n_);
+  r_ = VectorXd::Zero(capacity);
+  N_Pinv_n_p_ = VectorXd::Zero(capacity);
+
+  active_inequalities_.clear();
+  active_inequalities_.reserve(capacity);
+
+  initialized_ = true;
+}
+
+void DenseActiveSetSolver::UpdateCoefficients(const MathematicalProgram& prog) {
+  P_.setZero();
+  q_.setZero();
+  A_eq_.setZero();
+  A_in_.setZero();
+
+  // Costs
+  const auto& quadratic_costs = prog.quadratic_costs();
+  for (unsigned int k = 0; k < quadratic_costs.size(); k++) {
+    const auto& Q = quadratic_costs[k].evaluator()->Q();
+    const auto& b = quadratic_costs[k].evaluator()->b();
+    const auto& var_idx = quadratic_cost_var_idx_[k];
+    for (int j = 0; j < Q.cols(); j++) {
+      for (int i = 0; i < Q.rows(); i++) {
+        P_(var_idx[i], var_idx[j]) += Q(i, j);
+      }
+      q_(var_idx[j]) += b(j);
+    }
+  }
+  const auto& linear_costs = prog.linear_costs();
+  for (unsigned int k = 0; k < linear_costs.size(); k++) {
+    const auto& a = linear_costs[k].evaluator()->a();
+    for (int i = 0; i < a.size(); i++) {
+      q_(linear_cost_var_idx_[k][i]) += a(i);
+    }
+  }
+
+  // Equality constraints
+  int row = 0;
+  const auto& linear_eq = prog.linear_equality_constraints();
+  for (unsigned int k = 0; k < linear_eq.size(); k++) {
+    const auto& A = linear_eq[k].evaluator()->A();
+    for (int j = 0; j < A.cols(); j++) {
+      for (int i = 0; i < A.rows(); i++) {
+        A_eq_(row + i, linear_eq_var_idx_[k][j]) += A(i, j);
+      }
+    }
+    b_eq_.segment(row, A.rows()) = linear_eq[k].evaluator()->lower_bound();
+    row += A.rows();
+  }
+
+  // Inequality constraints
+  row = 0;
+  const auto& linear = prog.linear_constraints();
+  for (unsigned int k = 0; k < linear.size(); k++) {
+    const auto& A = linear[k].evaluator()->A();
+    for (int j = 0; j < A.cols(); j++) {
+      for (int i = 0; i < A.rows(); i++) {
+        A_in_(row + i, linear_var_idx_[k][j]) += A(i, j);
+      }
+    }
+    lb_.segment(row, A.rows()) = linear[k].evaluator()->lower_bound();
+    ub_.segment(row, A.rows()) = linear[k].evaluator()->upper_bound();
+    row += A.rows();
+  }
+  const auto& bbox = prog.bounding_box_constraints();
+  for (unsigned int k = 0; k < bbox.size(); k++) {
+    int n_rows = bbox[k].evaluator()->num_constraints();
+    for (int i = 0; i < n_rows; i++) {
+      A_in_(row + i, bbox_var_idx_[k][i]) = 1;
+    }
+    lb_.segment(row, n_rows) = bbox[k].evaluator()->lower_bound();
+    ub_.segment(row, n_rows) = bbox[k].evaluator()->upper_bound();
+    row += n_rows;
+  }
+}
+
+void DenseActiveSetSolver::GetConstraint(int constraint, VectorXd* normal,
+                                         double* b) const {
+  if (constraint < 0) {
+    int row = -constraint - 1;
+    *normal = A_eq_.row(row).transpose();
+    *b = b_eq_(row);
+  } else if (constraint % 2 == 0) {
+    // a^T x >= lb
+    int row = constraint / 2;
+    *normal = A_in_.row(row).transpose();
+    *b = lb_(row);
+  } else {
+    // -a^T x >= -ub
+    int row = constraint / 2;
+    *normal = -A_in_.row(row).transpose();
+    *b = -ub_(row);
+  }
+}
+
+bool DenseActiveSetSolver::AddToWorkingSet(int constraint, double lambda) {
+  DRAKE_DEMAND(num_working_ < static_cast<int>(working_set_.size()));
+  int k = num_working_;
+  double b;
+  GetConstraint(constraint, &n_p_, &b);
+  PinvNT_.col(k) = P_llt_.solve(n_p_);
+
+  // Append a column to the factor:
+  //   [S  s]   [R^T  0] [R  r]
+  //   [s^T c] = [r^T  d] [0  d]
+  // with s = N P^-1 n and c = n^T P^-1 n, i.e. R^T r = s and d^2 = c - r^T r
+  auto r = R_.col(k).head(k);
+  r.noalias() = N_.topRows(k) * PinvNT_.col(k);
+  R_.topLeftCorner(k, k).transpose().triangularView<Eigen::Lower>()
+      .solveInPlace(r);
+  double c = n_p_.dot(PinvNT_.col(k));
+  double d2 = c - r.squaredNorm();
+  factorization_cost_ += k * (k + 1) / 2 + k;
+  if (d2 <= kZeroTol * std::max(1.0, c)) {
+    return false;
+  }
+  R_(k, k) = std::sqrt(d2);
+
+  working_set_[k] = constraint;
+  N_.row(k) = n_p_.transpose();
+  b_ws_(k) = b;
+  lambda_(k) = lambda;
+  if (constraint >= 0) {
+    in_working_set_[constraint] = 1;
+  }
+  num_working_++;
+  return true;
+}
+
+void DenseActiveSetSolver::RemoveFromWorkingSet(int index) {
+  DRAKE_DEMAND(working_set_[index] >= 0);
+  in_working_set_[working_set_[index]] = 0;
+  int m = num_working_;
+  for (int j = index; j < m - 1; j++) {
+    working_set_[j] = working_set_[j + 1];
+    N_.row(j) = N_.row(j + 1);
+    b_ws_(j) = b_ws_(j + 1);
+    PinvNT_.col(j) = PinvNT_.col(j + 1);
+    lambda_(j) = lambda_(j + 1);
+    R_.col(j).head(j + 2) = R_.col(j + 1).head(j + 2);
+  }
+  // Without column `index`, the factor has a subdiagonal from that column on,
+  // which the Givens rotations of the rows (j, j + 1) remove. Since they are
+  // orthogonal, R^T R stays the Schur complement of the working set.
+  for (int j = index; j < m - 1; j++) {
+    Eigen::JacobiRotation<double> rotation;
+    rotation.makeGivens(R_(j, j), R_(j + 1, j), &R_(j, j));
+    R_(j + 1, j) = 0;
+    R_.middleCols(j + 1, m - 2 - j)
+        .applyOnTheLeft(j, j + 1, rotation.adjoint());
+    factorization_cost_ += 4 * (m - 2 - j);
+  }
+  num_working_--;
+}
+
+void DenseActiveSetSolver::SolveSchurComplement(const VectorXd& rhs,
+                                                VectorXd* sol) const {
+  int m = num_working_;
+  auto x = sol->head(m);
+  x = rhs.head(m);
+  R_.topLeftCorner(m, m).transpose().triangularView<Eigen::Lower>()
+      .solveInPlace(x);
+  R_.topLeftCorner(m, m).triangularView<Eigen::Upper>().solveInPlace(x);
+}
+
+void DenseActiveSetSolver::SolveWorkingSet() {
+  // x = x_unconstrained + P^-1 N^T lambda with N x = b
+  // -> (N P^-1 N^T) lambda = b - N x_unconstrained
+  int m = num_working_;
+  x_ = x_unconstrained_;
+  if (m > 0) {
+    r_.head(m) = b_ws_.head(m);
+    r_.head(m).noalias() -= N_.topRows(m) * x_unconstrained_;
+    SolveSchurComplement(r_, &lambda_);
+    x_.noalias() += PinvNT_.leftCols(m) * lambda_.head(m);
+  }
+}
+
+SolutionResult DenseActiveSetSolver::Solve(const MathematicalProgram& prog) {
+  DRAKE_DEMAND(IsInitialized());
+  DRAKE_DEMAND(prog.num_vars() == n_);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  UpdateCoefficients(prog);
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> setup_time = finish - start;
+  setup_time_ = setup_time.count();
+
+  start = std::chrono::high_resolution_clock::now();
+  iterations_ = 0;
+  factorization_cost_ = 0;
+  SolutionResult result = SolutionResult::kSolutionFound;
+
+  P_.diagonal().array() += options_.regularization;
+  P_llt_.compute(P_);
+  if (P_llt_.info() != Eigen::Success) {
+    x_.setZero();
+    active_inequalities_.clear();
+    finish = std::chrono::high_resolution_clock::now();
+    solve_time_ = std::chrono::duration<double>(finish - start).count();
+    return SolutionResult::kSolverSpecificError;
+  }
+  x_unconstrained_ = P_llt_.solve(q_);
+  x_unconstrained_ *= -1;
+
+  // Initial working set: the equality constraints and (with warm start) the
+  // active inequality constraints of the previous solve, without the ones
+  // which are (numerically) linearly dependent on the previous ones
+  num_working_ = 0;
+  std::fill(in_working_set_.begin(), in_working_set_.end(), 0);
+  for (int i = 0; i < m_eq_; i++) {
+    AddToWorkingSet(-(i + 1), 0);
+  }
+  num_working_eq_ = num_working_;
+  if (options_.warm_start) {
+    for (int constraint : active_inequalities_) {
+      // (Skip the bounds which became infinite)
+      int row = constraint / 2;
+      if (std::isfinite(constraint % 2 == 0 ? lb_(row) : ub_(row))) {
+        AddToWorkingSet(constraint, 0);
+      }
+    }
+  }
+  SolveWorkingSet();
+  // Remove the inequality constraints with negative multipliers, so that the
+  // iterate is the minimizer subject to the working set with nonnegative
+  // multipliers (required by the dual method)
+  while (num_working_ > num_working_eq_) {
+    int k = -1;
+    double min_lambda = -kZeroTol;
+    for (int j = num_working_eq_; j < num_working_; j++) {
+      if (lambda_(j) < min_lambda) {
+        min_lambda = lambda_(j);
+        k = j;
+      }
+    }
+    if (k < 0) break;
+    RemoveFromWorkingSet(k);
+    SolveWorkingSet();
+    iterations_++;
+  }
+
+  // Goldfarb-Idnani iterations
+  bool done = false;
+  while (!done) {
+    // Most violated inequality constraint
+    int p = -1;
+    double max_violation = options_.feasibility_tol;
+    for (int i = 0; i < m_in_; i++) {
+      double ax = A_in_.row(i).dot(x_);
+      if (lb_(i) - ax > max_violation && !in_working_set_[2 * i]) {
+        max_violation = lb_(i) - ax;
+        p = 2 * i;
+      }
+      if (ax - ub_(i) > max_violation && !in_working_set_[2 * i + 1]) {
+        max_violation = ax - ub_(i);
+        p = 2 * i + 1;
+      }
+    }
+    if (p < 0) break;
+
+    double b_p;
+    double lambda_p = 0;
+    while (true) {
+      if (iterations_ >= options_.max_iter ||
+          (options_.time_limit > 0 &&
+           std::chrono::duration<double>(
+               std::chrono::high_resolution_clock::now() - start)
+                   .count() > options_.time_limit)) {
+        result = SolutionResult::kIterationLimit;
+        done = true;
+        break;
+      }
+      iterations_++;
+
+      // Primal step direction z and the change of the multipliers r, i.e.
+      //   P z + N^T r = n_p and N z = 0
+      int m = num_working_;
+      GetConstraint(p, &n_p_, &b_p);
+      Pinv_n_p_ = P_llt_.solve(n_p_);
+      z_ = Pinv_n_p_;
+      if (m > 0) {
+        N_Pinv_n_p_.head(m).noalias() = N_.topRows(m) * Pinv_n_p_;
+        SolveSchurComplement(N_Pinv_n_p_, &r_);
+        z_.noalias() -= PinvNT_.leftCols(m) * r_.head(m);
+      }
+
+      // Dual step length (the largest step that keeps the multipliers of the
+      // inequality constraints nonnegative)
+      double t_dual = std::numeric_limits<double>::infinity();
+      int k = -1;
+      for (int j = num_working_eq_; j < m; j++) {
+        if (r_(j) > kZeroTol) {
+          double t = lambda_(j) / r_(j);
+          if (t < t_dual) {
+            t_dual = t;
+            k = j;
+          }
+        }
+      }
+
+      double zn = z_.dot(n_p_);
+      if (zn <= kZeroTol * Pinv_n_p_.dot(n_p_)) {
+        // n_p is linearly dependent on the working set
+        if (k < 0) {
+          result = SolutionResult::kInfeasibleConstraints;
+          done = true;
+          break;
+        }
+        // Dual step only
+        lambda_.head(m) -= t_dual * r_.head(m);
+        lambda_p += t_dual;
+        RemoveFromWorkingSet(k);
+        continue;
+      }
+
+      // Primal step length (the step that satisfies constraint p)
+      double t_primal = (b_p - n_p_.dot(x_)) / zn;
+      double t = std::min(t_dual, t_primal);
+      x_ += t * z_;
+      if (m > 0) {
+        lambda_.head(m) -= t * r_.head(m);
+      }
+      lambda_p += t;
+      if (t_primal <= t_dual) {
+        AddToWorkingSet(p, lambda_p);
+        break;
+      } else {
+        RemoveFromWorkingSet(k);
+      }
+    }
+  }
+
+  active_inequalities_.clear();
+  for (int j = num_working_eq_; j < num_working_; j++) {
+    active_inequalities_.push_back(working_set_[j]);
+  }
+
+  finish = std::chrono::high_resolution_clock::now();
+  solve_time_ = std::chrono::duration<double>(finish - start).count();
+  return result;
+}
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "drake/solvers/mathematical_program.h"
+#include "solvers/fixed_structure_qp_solver.h"
+
+namespace dairlib {
+namespace solvers {
+
+struct DenseActiveSetSolverOptions {
+  /// Maximum number of iterations. Every addition to and removal from the
+  /// working set counts as one iteration, so the iteration count (and the
+  /// solve time) of a QP has a fixed upper bound. Solve() returns
+  /// kIterationLimit with the current iterate once the limit is reached.
+  int max_iter = 100;
+  /// Added to the diagonal of the Hessian, which has to be positive definite
+  /// for the dual method (e.g. the contact forces of OSC have no cost).
+  double regularization = 1e-8;
+  /// Constraint violation that is considered feasible
+  double feasibility_tol = 1e-8;
+  /// Start from the working set of the previous solve
+  bool warm_start = true;
+  /// Time limit (in seconds) of the iterations. Solve() returns
+  /// kIterationLimit with the current iterate once the limit is reached.
+  /// Disabled when nonpositive.
+  double time_limit = 0;
+};
+
+/// DenseActiveSetSolver solves small convex QPs
+///   min 0.5 x^T P x + q^T x
+///   s.t. A_eq x = b_eq
+///        lb <= A x <= ub
+/// with the dual active-set method of Goldfarb and Idnani. The method starts
+/// from the minimum subject to the equality constraints and repeatedly adds
+/// the most violated inequality constraint to the working set (removing the
+/// constraints whose multipliers would become negative), so it doesn't need a
+/// feasible initial point and terminates in a finite number of iterations.
+///
+/// All the data is stored densely. In each Solve(), P is factorized once and
+/// the working set is handled through the Schur complement
+/// N P^-1 N^T, where the rows of N are the constraints in the working set.
+/// Its Cholesky factor is updated when a constraint enters the working set
+/// (by appending a column) or leaves it (by Givens rotations), so that each
+/// iteration costs O(n^2) instead of refactorizing the Schur complement.
+/// Equality rows which are (numerically) linearly dependent on the previous
+/// ones are left out of the working set.
+///
+/// With warm start, the initial working set is the active set of the previous
+/// solve (after removing the constraints with negative multipliers). Since the
+/// QPs of consecutive control ticks are nearly identical, the active set rarely
+/// changes, and the solve usually takes a few iterations.
+///
+/// The supported costs and constraints are the same as FastOsqpSolver.
+class DenseActiveSetSolver : public FixedStructureQpSolver {
+ public:
+  explicit DenseActiveSetSolver(
+      DenseActiveSetSolverOptions options = DenseActiveSetSolverOptions());
+
+  DenseActiveSetSolver(const DenseActiveSetSolver&) = delete;
+  DenseActiveSetSolver& operator=(const DenseActiveSetSolver&) = delete;
+
+  void InitializeSolver(
+      const drake::solvers::MathematicalProgram& prog) override;
+
+  bool IsInitialized() const override { return initialized_; }
+
+  void SetTimeLimit(double time_limit) override {
+    options_.time_limit = time_limit;
+  }
+
+  drake::solvers::SolutionResult Solve(
+      const drake::solvers::MathematicalProgram& prog) override;
+
+  Eigen::Map<const Eigen::VectorXd> primal_solution() const override {
+    return Eigen::Map<const Eigen::VectorXd>(x_.data(), n_);
+  }
+
+  int iterations() const override { return iterations_; }
+  double setup_time() const override { return setup_time_; }
+  double solve_time() const override { return solve_time_; }
+
+  /// Number of inequality constraints in the active set of the latest Solve()
+  int num_active_inequalities() const { return active_inequalities_.size(); }
+
+  /// Number of multiplications spent on updating the factorization of the
+  /// Schur complement in the latest Solve()
+  int64_t factorization_cost() const { return factorization_cost_; }
+
+  int num_vars() const { return n_; }
+  int num_equality_rows() const { return m_eq_; }
+  int num_inequality_rows() const { return m_in_; }
+
+ private:
+  // Copy the current coefficients of `prog` into the dense QP data
+  void UpdateCoefficients(const drake::solvers::MathematicalProgram& prog);
+
+  // The constraints are identified by an integer:
+  //   -(i + 1) for the i-th equality row,
+  //   2 * i for the lower bound of the i-th inequality row, and
+  //   2 * i + 1 for the upper bound of the i-th inequality row.
+  // In the working set, every constraint is written as n^T x >= b (or == b
+  // for the equalities).
+  void GetConstraint(int constraint, Eigen::VectorXd* normal, double* b) const;
+
+  // Working set operations. They keep N_, b_ws_, PinvNT_, lambda_ and the
+  // factor R_ consistent. AddToWorkingSet() returns false (and leaves the
+  // working set unchanged) if the constraint is (numerically) linearly
+  // dependent on the working set.
+  bool AddToWorkingSet(int constraint, double lambda);
+  void RemoveFromWorkingSet(int index);
+  // Minimizer and multipliers subject to the working set (as equalities)
+  void SolveWorkingSet();
+  // Solves S sol = rhs with the factorization of the Schur complement, where
+  // only the first num_working_ entries of rhs and sol are used
+  void SolveSchurComplement(const Eigen::VectorXd& rhs,
+                            Eigen::VectorXd* sol) const;
+
+  DenseActiveSetSolverOptions options_;
+  bool initialized_ = false;
+
+  // Number of decision variables, equality rows and inequality rows
+  int n_ = 0;
+  int m_eq_ = 0;
+  int m_in_ = 0;
+
+  // Dense QP data
+  Eigen::MatrixXd P_;
+  Eigen::VectorXd q_;
+  Eigen::MatrixXd A_eq_;
+  Eigen::VectorXd b_eq_;
+  Eigen::MatrixXd A_in_;
+  Eigen::VectorXd lb_;
+  Eigen::VectorXd ub_;
+
+  // Decision variable indices of each binding
+  std::vector<std::vector<int>> quadratic_cost_var_idx_;
+  std::vector<std::vector<int>> linear_cost_var_idx_;
+  std::vector<std::vector<int>> linear_eq_var_idx_;
+  std::vector<std::vector<int>> linear_var_idx_;
+  std::vector<std::vector<int>> bbox_var_idx_;
+
+  // Factorization of P and the unconstrained minimizer -P^-1 q
+  Eigen::LLT<Eigen::MatrixXd> P_llt_;
+  Eigen::VectorXd x_unconstrained_;
+
+  // Working set (the equality rows come first). Only the first
+  // num_working_ entries (rows or columns) are used, of which the first
+  // num_working_eq_ are equality rows.
+  int num_working_ = 0;
+  int num_working_eq_ = 0;
+  std::vector<int> working_set_;
+  std::vector<char> in_working_set_;  // indexed by the inequality constraints
+  Eigen::MatrixXd N_;
+  Eigen::VectorXd b_ws_;
+  Eigen::MatrixXd PinvNT_;
+  Eigen::VectorXd lambda_;
+  // Upper triangular Cholesky factor R of the Schur complement of the working
+  // set, i.e. N P^-1 N^T = R^T R (in the top left corner, with the capacity
+  // of the working set)
+  Eigen::MatrixXd R_;
+
+  // Buffers of the iterations
+  Eigen::VectorXd x_;
+  Eigen::VectorXd n_p_;
+  Eigen::VectorXd Pinv_n_p_;
+  Eigen::VectorXd z_;
+  Eigen::VectorXd r_;
+  Eigen::VectorXd N_Pinv_n_p_;
+
+  // Inequality constraints in the working set at the end of the latest solve
+  std::vector<int> active_inequalities_;
+
+  int iterations_ = 0;
+  int64_t factorization_cost_ = 0;
+  double setup_time_ = 0;
+  double solve_time_ = 0;
+};
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,417 @@
+#include "solvers/fast_osqp_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <utility>
+
+#include "drake/common/drake_assert.h"
+
+using drake::solvers::Binding;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::MathematicalProgramResult;
+using drake::solvers::OsqpSolver;
+using drake::solvers::OsqpSolverDetails;
+using drake::solvers::SolutionResult;
+using drake::solvers::VectorXDecisionVariable;
+using Eigen::VectorXd;
+using std::vector;
+
+namespace dairlib {
+namespace solvers {
+
+namespace {
+
+// (column, row) -> index into the nonzero array. std::map keeps the keys
+// ordered column-major, which is the CSC ordering.
+using SparsityPattern = std::map<std::pair<int, int>, int>;
+
+vector<int> GetVariableIndices(const MathematicalProgram& prog,
+                               const VectorXDecisionVariable& vars) {
+  vector<int> idx(vars.size());
+  for (int i = 0; i < vars.size(); i++) {
+    idx[i] = prog.FindDecisionVariableIndex(vars(i));
+  }
+  return idx;
+}
+
+// Convert the pattern into CSC column pointers and row indices, and
+// assign the nonzero index of each entry.
+void FinalizePattern(int n_cols, SparsityPattern* pattern, vector<c_int>* p,
+                     vector<c_int>* i) {
+  p->assign(n_cols + 1, 0);
+  i->clear();
+  i->reserve(pattern->size());
+  int nz = 0;
+  for (auto& entry : *pattern) {
+    (*p)[entry.first.first + 1]++;
+    i->push_back(entry.first.second);
+    entry.second = nz++;
+  }
+  for (int col = 0; col < n_cols; col++) {
+    (*p)[col + 1] += (*p)[col];
+  }
+}
+
+// Add the entries of a dense constraint block to the pattern
+template <typename C>
+void AddConstraintPattern(const MathematicalProgram& prog,
+                          const vector<Binding<C>>& bindings, int* row,
+                          vector<vector<int>>* var_idx,
+                          SparsityPattern* pattern) {
+  for (const auto& binding : bindings) {
+    var_idx->push_back(GetVariableIndices(prog, binding.variables()));
+    int n_rows = binding.evaluator()->num_constraints();
+    for (int col : var_idx->back()) {
+      for (int r = 0; r < n_rows; r++) {
+        (*pattern)[{col, *row + r}] = -1;
+      }
+    }
+    *row += n_rows;
+  }
+}
+
+// Look up the nonzero index of each entry (column-major) of the bindings
+vector<vector<int>> GetConstraintNonzeroIndices(
+    const vector<vector<int>>& var_idx, const vector<int>& n_rows,
+    const vector<int>& first_row, const SparsityPattern& pattern) {
+  vector<vector<int>> nz_idx(var_idx.size());
+  for (unsigned int k = 0; k < var_idx.size(); k++) {
+    for (int col : var_idx[k]) {
+      for (int r = 0; r < n_rows[k]; r++) {
+        nz_idx[k].push_back(pattern.at({col, first_row[k] + r}));
+      }
+    }
+  }
+  return nz_idx;
+}
+
+template <typename C>
+void AddConstraintRows(const vector<Binding<C>>& bindings, int* row,
+                       vector<int>* n_rows, vector<int>* first_row) {
+  for (const auto& binding : bindings) {
+    first_row->push_back(*row);
+    n_rows->push_back(binding.evaluator()->num_constraints());
+    *row += n_rows->back();
+  }
+}
+
+c_float ClampToOsqpInfinity(double value) {
+  return std::min(std::max(value, -OSQP_INFTY), OSQP_INFTY);
+}
+
+template <typename C>
+void CopyBounds(const vector<Binding<C>>& bindings, int* row,
+                vector<c_float>* l, vector<c_float>* u) {
+  for (const auto& binding : bindings) {
+    const auto& lb = binding.evaluator()->lower_bound();
+    const auto& ub = binding.evaluator()->upper_bound();
+    for (int r = 0; r < lb.size(); r++) {
+      (*l)[*row + r] = ClampToOsqpInfinity(lb(r));
+      (*u)[*row + r] = ClampToOsqpInfinity(ub(r));
+    }
+    *row += lb.size();
+  }
+}
+
+void SetOsqpSettings(const MathematicalProgram& prog, OSQPSettings* settings) {
+  osqp_set_default_settings(settings);
+  // Same defaults as drake::solvers::OsqpSolver
+  settings->eps_abs = 1e-5;
+  settings->eps_rel = 1e-5;
+  settings->eps_prim_inf = 1e-5;
+  settings->eps_dual_inf = 1e-5;
+  settings->polish = 1;
+  settings->verbose = 0;
+  // Warm start from the solution stored in the workspace
+  settings->warm_start = 1;
+
+  const std::map<std::string, c_float*> double_options = {
+      {"rho", &settings->rho},
+      {"sigma", &settings->sigma},
+      {"eps_abs", &settings->eps_abs},
+      {"eps_rel", &settings->eps_rel},
+      {"eps_prim_inf", &settings->eps_prim_inf},
+      {"eps_dual_inf", &settings->eps_dual_inf},
+      {"alpha", &settings->alpha},
+      {"delta", &settings->delta},
+      {"time_limit", &settings->time_limit}};
+  const std::map<std::string, c_int*> int_options = {
+      {"max_iter", &settings->max_iter},
+      {"polish", &settings->polish},
+      {"polish_refine_iter", &settings->polish_refine_iter},
+      {"verbose", &settings->verbose},
+      {"scaled_termination", &settings->scaled_termination},
+      {"check_termination", &settings->check_termination},
+      {"warm_start", &settings->warm_start},
+      {"scaling", &settings->scaling},
+      {"adaptive_rho", &settings->adaptive_rho}};
+  for (const auto& option : prog.GetSolverOptionsDouble(OsqpSolver::id())) {
+    auto it = double_options.find(option.first);
+    DRAKE_DEMAND(it != double_options.end());
+    *it->second = option.second;
+  }
+  for (const auto& option : prog.GetSolverOptionsInt(OsqpSolver::id())) {
+    auto it = int_options.find(option.first);
+    DRAKE_DEMAND(it != int_options.end());
+    *it->second = option.second;
+  }
+}
+
+SolutionResult ConvertOsqpStatus(c_int status_val) {
+  switch (status_val) {
+    case OSQP_SOLVED:
+    case OSQP_SOLVED_INACCURATE:
+      return SolutionResult::kSolutionFound;
+    case OSQP_PRIMAL_INFEASIBLE:
+    case OSQP_PRIMAL_INFEASIBLE_INACCURATE:
+      return SolutionResult::kInfeasibleConstraints;
+    case OSQP_DUAL_INFEASIBLE:
+    case OSQP_DUAL_INFEASIBLE_INACCURATE:
+      return SolutionResult::kDualInfeasible;
+    case OSQP_MAX_ITER_REACHED:
+    case OSQP_TIME_LIMIT_REACHED:
+      return SolutionResult::kIterationLimit;
+    default:
+      return SolutionResult::kSolverSpecificError;
+  }
+}
+
+}  // namespace
+
+FastOsqpSolver::~FastOsqpSolver() {
+  if (workspace_ != nullptr) {
+    osqp_cleanup(workspace_);
+  }
+}
+
+void FastOsqpSolver::InitializeSolver(const MathematicalProgram& prog) {
+  DRAKE_DEMAND(prog.generic_costs().empty());
+  DRAKE_DEMAND(prog.generic_constraints().empty());
+  DRAKE_DEMAND(prog.linear_complementarity_constraints().empty());
+  DRAKE_DEMAND(prog.lorentz_cone_constraints().empty());
+  DRAKE_DEMAND(prog.rotated_lorentz_cone_constraints().empty());
+  DRAKE_DEMAND(prog.positive_semidefinite_constraints().empty());
+  if (workspace_ != nullptr) {
+    osqp_cleanup(workspace_);
+    workspace_ = nullptr;
+  }
+
+  n_ = prog.num_vars();
+
+  // Sparsity pattern of P (upper triangular part of the dense blocks)
+  SparsityPattern P_pattern;
+  quadratic_cost_var_idx_.clear();
+  for (const auto& binding : prog.quadratic_costs()) {
+    quadratic_cost_var_idx_.push_back(
+        GetVariableIndices(prog, binding.variables()));
+    for (int v_i : quadratic_cost_var_idx_.back()) {
+      for (int v_j : quadratic_cost_var_idx_.back()) {
+        P_pattern[{std::max(v_i, v_j), std::min(v_i, v_j)}] = -1;
+      }
+    }
+  }
+  FinalizePattern(n_, &P_pattern, &P_p_, &P_i_);
+  quadratic_cost_P_idx_.clear();
+  for (const auto& var_idx : quadratic_cost_var_idx_) {
+    quadratic_cost_P_idx_.emplace_back();
+    for (int v_j : var_idx) {
+      for (int v_i : var_idx) {
+        quadratic_cost_P_idx_.back().push_back(
+            P_pattern.at({std::max(v_i, v_j), std::min(v_i, v_j)}));
+      }
+    }
+  }
+  linear_cost_var_idx_.clear();
+  for (const auto& binding : prog.linear_costs()) {
+    linear_cost_var_idx_.push_back(
+        GetVariableIndices(prog, binding.variables()));
+  }
+
+  // Sparsity pattern of A. The rows are ordered as
+  //   [linear equality constraints; linear constraints; bounding boxes]
+  SparsityPattern A_pattern;
+  vector<vector<int>> eq_var_idx;
+  vector<vector<int>> lin_var_idx;
+  vector<vector<int>> bbox_var_idx;
+  int row = 0;
+  AddConstraintPattern(prog, prog.linear_equality_constraints(), &row,
+                       &eq_var_idx, &A_pattern);
+  AddConstraintPattern(prog, prog.linear_constraints(), &row, &lin_var_idx,
+                       &A_pattern);
+  AddConstraintPattern(prog, prog.bounding_box_constraints(), &row,
+                       &bbox_var_idx, &A_pattern);
+  m_ = row;
+  FinalizePattern(n_, &A_pattern, &A_p_, &A_i_);
+
+  row = 0;
+  vector<int> eq_n_rows, lin_n_rows, bbox_n_rows;
+  vector<int> eq_first_row, lin_first_row, bbox_first_row;
+  AddConstraintRows(prog.linear_equality_constraints(), &row, &eq_n_rows,
+                    &eq_first_row);
+  AddConstraintRows(prog.linear_constraints(), &row, &lin_n_rows,
+                    &lin_first_row);
+  AddConstraintRows(prog.bounding_box_constraints(), &row, &bbox_n_rows,
+                    &bbox_first_row);
+  linear_eq_A_idx_ = GetConstraintNonzeroIndices(eq_var_idx, eq_n_rows,
+                                                 eq_first_row, A_pattern);
+  linear_A_idx_ = GetConstraintNonzeroIndices(lin_var_idx, lin_n_rows,
+                                              lin_first_row, A_pattern);
+  bbox_A_idx_ = GetConstraintNonzeroIndices(bbox_var_idx, bbox_n_rows,
+                                            bbox_first_row, A_pattern);
+
+  P_x_.assign(P_i_.size(), 0);
+  A_x_.assign(A_i_.size(), 0);
+  q_.assign(n_, 0);
+  l_.assign(m_, 0);
+  u_.assign(m_, 0);
+  UpdateCoefficients(prog);
+
+  // OSQP copies the data in the setup, so the csc structs can point to our
+  // buffers
+  csc P_csc = {static_cast<c_int>(P_x_.size()), n_, n_, P_p_.data(),
+               P_i_.data(), P_x_.data(), -1};
+  csc A_csc = {static_cast<c_int>(A_x_.size()), m_, n_, A_p_.data(),
+               A_i_.data(), A_x_.data(), -1};
+  OSQPData data;
+  data.n = n_;
+  data.m = m_;
+  data.P = &P_csc;
+  data.A = &A_csc;
+  data.q = q_.data();
+  data.l = l_.data();
+  data.u = u_.data();
+
+  SetOsqpSettings(prog, &settings_);
+  c_int exitflag = osqp_setup(&workspace_, &data, &settings_);
+  DRAKE_DEMAND(exitflag == 0);
+}
+
+void FastOsqpSolver::UpdateCoefficients(const MathematicalProgram& prog) {
+  std::fill(P_x_.begin(), P_x_.end(), 0);
+  std::fill(A_x_.begin(), A_x_.end(), 0);
+  std::fill(q_.begin(), q_.end(), 0);
+
+  // Costs
+  // OSQP's cost is 1/2 x^T P x + q^T x. Entries of Q that map to an
+  // off-diagonal entry of P are split between (i, j) and (j, i).
+  const auto& quadratic_costs = prog.quadratic_costs();
+  for (unsigned int k = 0; k < quadratic_costs.size(); k++) {
+    const auto& Q = quadratic_costs[k].evaluator()->Q();
+    const auto& b = quadratic_costs[k].evaluator()->b();
+    const auto& var_idx = quadratic_cost_var_idx_[k];
+    const auto& P_idx = quadratic_cost_P_idx_[k];
+    int nz = 0;
+    for (int j = 0; j < Q.cols(); j++) {
+      for (int i = 0; i < Q.rows(); i++) {
+        P_x_[P_idx[nz++]] +=
+            (var_idx[i] == var_idx[j]) ? Q(i, j) : 0.5 * Q(i, j);
+      }
+      q_[var_idx[j]] += b(j);
+    }
+  }
+  const auto& linear_costs = prog.linear_costs();
+  for (unsigned int k = 0; k < linear_costs.size(); k++) {
+    const auto& a = linear_costs[k].evaluator()->a();
+    for (int i = 0; i < a.size(); i++) {
+      q_[linear_cost_var_idx_[k][i]] += a(i);
+    }
+  }
+
+  // Constraints
+  const auto& linear_eq = prog.linear_equality_constraints();
+  for (unsigned int k = 0; k < linear_eq.size(); k++) {
+    const auto& A = linear_eq[k].evaluator()->A();
+    int nz = 0;
+    for (int j = 0; j < A.cols(); j++) {
+      for (int i = 0; i < A.rows(); i++) {
+        A_x_[linear_eq_A_idx_[k][nz++]] += A(i, j);
+      }
+    }
+  }
+  const auto& linear = prog.linear_constraints();
+  for (unsigned int k = 0; k < linear.size(); k++) {
+    const auto& A = linear[k].evaluator()->A();
+    int nz = 0;
+    for (int j = 0; j < A.cols(); j++) {
+      for (int i = 0; i < A.rows(); i++) {
+        A_x_[linear_A_idx_[k][nz++]] += A(i, j);
+      }
+    }
+  }
+  const auto& bbox = prog.bounding_box_constraints();
+  for (unsigned int k = 0; k < bbox.size(); k++) {
+    int n_rows = bbox[k].evaluator()->num_constraints();
+    for (int i = 0; i < n_rows; i++) {
+      A_x_[bbox_A_idx_[k][i * n_rows + i]] += 1;
+    }
+  }
+
+  // Bounds
+  int row = 0;
+  CopyBounds(linear_eq, &row, &l_, &u_);
+  CopyBounds(linear, &row, &l_, &u_);
+  CopyBounds(bbox, &row, &l_, &u_);
+}
+
+void FastOsqpSolver::SetTimeLimit(double time_limit) {
+  DRAKE_DEMAND(IsInitialized());
+  // (OSQP disables the time limit when it is 0)
+  osqp_update_time_limit(workspace_, std::max(time_limit, 0.0));
+}
+
+SolutionResult FastOsqpSolver::Solve(const MathematicalProgram& prog) {
+  DRAKE_DEMAND(IsInitialized());
+  DRAKE_DEMAND(prog.num_vars() == n_);
+
+  // Only the numeric values change. (The workspace keeps the solution of the
+  // previous solve, which is used as the warm start.)
+  auto start = std::chrono::high_resolution_clock::now();
+  UpdateCoefficients(prog);
+  osqp_update_P_A(workspace_, P_x_.data(), OSQP_NULL, P_x_.size(),
+                  A_x_.data(), OSQP_NULL, A_x_.size());
+  osqp_update_lin_cost(workspace_, q_.data());
+  osqp_update_bounds(workspace_, l_.data(), u_.data());
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> setup_time = finish - start;
+
+  osqp_solve(workspace_);
+
+  const OSQPInfo* info = workspace_->info;
+  details_.iter = info->iter;
+  details_.status_val = info->status_val;
+  details_.primal_res = info->pri_res;
+  details_.dual_res = info->dua_res;
+  details_.setup_time = setup_time.count();
+  details_.solve_time = info->solve_time;
+  details_.polish_time = info->polish_time;
+  details_.run_time =
+      setup_time.count() + info->solve_time + info->polish_time;
+  return ConvertOsqpStatus(info->status_val);
+}
+
+void FastOsqpSolver::Solve(const MathematicalProgram& prog,
+                           MathematicalProgramResult* result) {
+  SolutionResult solution_result = Solve(prog);
+
+  result->set_solver_id(OsqpSolver::id());
+  result->set_decision_variable_index(prog.decision_variable_index());
+  result->set_x_val(primal_solution());
+  result->set_solution_result(solution_result);
+  double constant_cost = 0;
+  for (const auto& binding : prog.quadratic_costs()) {
+    constant_cost += binding.evaluator()->c();
+  }
+  for (const auto& binding : prog.linear_costs()) {
+    constant_cost += binding.evaluator()->b();
+  }
+  result->set_optimal_cost(workspace_->info->obj_val + constant_cost);
+
+  OsqpSolverDetails& details =
+      result->SetSolverDetailsType<OsqpSolverDetails>();
+  details = details_;
+  details.y = dual_solution();
+}
+
+}  // namespace solvers
+}  // namespace dairlib
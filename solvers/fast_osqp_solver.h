@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+
+#include <osqp.h>
+
+#include "drake/solvers/mathematical_program.h"
+#include "drake/solvers/mathematical_program_result.h"
+#include "drake/solvers/osqp_solver.h"
+#include "solvers/fixed_structure_qp_solver.h"
+
+namespace dairlib {
+namespace solvers {
+
+/// FastOsqpSolver keeps a single OSQP workspace alive across repeated solves
+/// of a MathematicalProgram whose sparsity never changes (e.g. the QP of
+/// OperationalSpaceControl).
+///
+/// drake::solvers::Solve() re-runs solver selection, rebuilds the sparse
+/// matrices and performs a cold start on every call. Instead, InitializeSolver()
+/// fixes the sparsity pattern of P and A once, treating every entry of each
+/// cost/constraint binding as structurally nonzero. Solve() then only copies
+/// the current numeric values of P, q, A, l and u into the workspace and
+/// solves, warm-started from the previous primal/dual solution.
+///
+/// Supported costs: QuadraticCost, LinearCost.
+/// Supported constraints: LinearEqualityConstraint, LinearConstraint,
+/// BoundingBoxConstraint.
+/// Adding/removing bindings or variables after InitializeSolver() is not
+/// allowed.
+///
+/// The solver options of `prog` registered for OsqpSolver::id() are read once
+/// in InitializeSolver() (e.g. "time_limit", "max_iter", "eps_abs").
+class FastOsqpSolver : public FixedStructureQpSolver {
+ public:
+  FastOsqpSolver() = default;
+  ~FastOsqpSolver() override;
+
+  FastOsqpSolver(const FastOsqpSolver&) = delete;
+  FastOsqpSolver& operator=(const FastOsqpSolver&) = delete;
+
+  /// Builds the sparsity pattern of `prog` and runs the OSQP setup
+  /// (symbolic and numeric factorization) with the current coefficients.
+  void InitializeSolver(
+      const drake::solvers::MathematicalProgram& prog) override;
+
+  bool IsInitialized() const override { return workspace_ != nullptr; }
+
+  /// Overrides the "time_limit" option of the program
+  void SetTimeLimit(double time_limit) override;
+
+  /// Updates the numeric values of the QP data from `prog` and solves it.
+  /// The result is reported through `result`, with the solver details set to
+  /// drake::solvers::OsqpSolverDetails. `OsqpSolverDetails::setup_time` holds
+  /// the time spent on copying the new coefficients into the workspace (and
+  /// the numeric refactorization), and `solve_time` holds OSQP's solve time.
+  void Solve(const drake::solvers::MathematicalProgram& prog,
+             drake::solvers::MathematicalProgramResult* result);
+
+  /// Same as Solve(prog, result), but the solution is only stored in the
+  /// solver (see primal_solution(), dual_solution() and solver_details()).
+  /// Unlike filling a MathematicalProgramResult, this does not allocate any
+  /// heap memory once the solver is initialized, as long as OSQP's solution
+  /// polishing is disabled ("polish" = 0).
+  drake::solvers::SolutionResult Solve(
+      const drake::solvers::MathematicalProgram& prog) override;
+
+  /// Primal and dual solutions of the latest Solve()
+  Eigen::Map<const Eigen::VectorXd> primal_solution() const override {
+    return Eigen::Map<const Eigen::VectorXd>(workspace_->solution->x, n_);
+  }
+  Eigen::Map<const Eigen::VectorXd> dual_solution() const {
+    return Eigen::Map<const Eigen::VectorXd>(workspace_->solution->y, m_);
+  }
+  /// Solver details of the latest Solve(). (`y` is not filled in. Use
+  /// dual_solution() instead.)
+  const drake::solvers::OsqpSolverDetails& solver_details() const {
+    return details_;
+  }
+
+  int iterations() const override { return details_.iter; }
+  double setup_time() const override { return details_.setup_time; }
+  double solve_time() const override { return details_.solve_time; }
+
+  int num_vars() const { return n_; }
+  int num_constraint_rows() const { return m_; }
+  int P_nnz() const { return P_x_.size(); }
+  int A_nnz() const { return A_x_.size(); }
+
+ private:
+  // Copy the current coefficients of `prog` into P_x_, q_, A_x_, l_ and u_
+  void UpdateCoefficients(const drake::solvers::MathematicalProgram& prog);
+
+  // Number of decision variables and constraint rows
+  int n_ = 0;
+  int m_ = 0;
+
+  // CSC data of P (upper triangular) and A
+  std::vector<c_int> P_p_;
+  std::vector<c_int> P_i_;
+  std::vector<c_float> P_x_;
+  std::vector<c_int> A_p_;
+  std::vector<c_int> A_i_;
+  std::vector<c_float> A_x_;
+  std::vector<c_float> q_;
+  std::vector<c_float> l_;
+  std::vector<c_float> u_;
+
+  // For each binding, the index into P_x_ (or A_x_) of every entry of the
+  // binding's (dense) coefficient matrix, stored column-major.
+  std::vector<std::vector<int>> quadratic_cost_P_idx_;
+  std::vector<std::vector<int>> linear_eq_A_idx_;
+  std::vector<std::vector<int>> linear_A_idx_;
+  std::vector<std::vector<int>> bbox_A_idx_;
+
+  // Decision variable indices of each cost binding
+  std::vector<std::vector<int>> quadratic_cost_var_idx_;
+  std::vector<std::vector<int>> linear_cost_var_idx_;
+
+  OSQPSettings settings_;
+  OSQPWorkspace* workspace_ = nullptr;
+
+  drake::solvers::OsqpSolverDetails details_;
+};
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include "drake/solvers/mathematical_program.h"
+#include "drake/solvers/solution_result.h"
+
+namespace dairlib {
+namespace solvers {
+
+/// Interface of the QP solvers which repeatedly solve a MathematicalProgram
+/// whose structure (decision variables, costs and constraints) never changes,
+/// while the coefficients do (e.g. the QP of OperationalSpaceControl).
+///
+/// InitializeSolver() processes the structure of the program once. Each
+/// Solve() then reads the current coefficients of the program and solves the
+/// QP, warm-started from the previous solve in whatever way the solver
+/// supports.
+class FixedStructureQpSolver {
+ public:
+  virtual ~FixedStructureQpSolver() = default;
+
+  virtual void InitializeSolver(
+      const drake::solvers::MathematicalProgram& prog) = 0;
+
+  virtual bool IsInitialized() const = 0;
+
+  /// Sets the time limit (in seconds) of the following Solve()s. Once it is
+  /// reached, Solve() returns kIterationLimit with the current iterate. A
+  /// nonpositive value removes the limit. Must be called after
+  /// InitializeSolver().
+  virtual void SetTimeLimit(double time_limit) = 0;
+
+  virtual drake::solvers::SolutionResult Solve(
+      const drake::solvers::MathematicalProgram& prog) = 0;
+
+  /// Primal solution of the latest Solve()
+  virtual Eigen::Map<const Eigen::VectorXd> primal_solution() const = 0;
+
+  /// Number of iterations of the latest Solve()
+  virtual int iterations() const = 0;
+  /// Time (in seconds) spent on copying the coefficients into the solver in
+  /// the latest Solve()
+  virtual double setup_time() const = 0;
+  /// Time (in seconds) spent on solving in the latest Solve()
+  virtual double solve_time() const = 0;
+};
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -1,5 +1,11 @@
 #include "solvers/nonlinear_constraint.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "drake/common/drake_assert.h"
 #include "drake/common/default_scalars.h"
 #include "drake/math/autodiff.h"
 #include "drake/math/autodiff_gradient.h"
@@ -9,6 +15,7 @@ namespace solvers {
 
 using drake::AutoDiffVecXd;
 using drake::AutoDiffXd;
+using drake::MatrixX;
 using drake::VectorX;
 using Eigen::MatrixXd;
 using Eigen::VectorXd;
@@ -27,6 +34,170 @@ void NonlinearConstraint<T>::SetConstraintScaling(
   constraint_scaling_ = map;
 }
 
+template <typename T>
+void NonlinearConstraint<T>::SetJacobianSparsity(
+    const std::vector<std::pair<int, int>>& nonzeros, bool declare_to_solver) {
+  column_rows_.assign(num_vars(), std::vector<int>());
+  for (const auto& [row, col] : nonzeros) {
+    DRAKE_DEMAND(row >= 0 && row < num_outputs());
+    DRAKE_DEMAND(col >= 0 && col < num_vars());
+    column_rows_[col].push_back(row);
+  }
+  std::vector<std::pair<int, int>> gradient_sparsity_pattern;
+  for (int col = 0; col < num_vars(); col++) {
+    auto& rows = column_rows_[col];
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    for (int row : rows) {
+      gradient_sparsity_pattern.emplace_back(row, col);
+    }
+  }
+  if (declare_to_solver) {
+    this->SetGradientSparsityPattern(gradient_sparsity_pattern);
+  } else if (this->gradient_sparsity_pattern().has_value()) {
+    // Replaces a previously declared pattern
+    gradient_sparsity_pattern.clear();
+    for (int col = 0; col < num_vars(); col++) {
+      for (int row = 0; row < num_outputs(); row++) {
+        gradient_sparsity_pattern.emplace_back(row, col);
+      }
+    }
+    this->SetGradientSparsityPattern(gradient_sparsity_pattern);
+  }
+
+  // Greedy coloring of the column intersection graph, largest columns first.
+  // Two columns can be perturbed together if they have no common row.
+  std::vector<int> order(num_vars());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return column_rows_[a].size() > column_rows_[b].size();
+  });
+  column_groups_.clear();
+  std::vector<std::vector<bool>> group_rows;
+  for (int col : order) {
+    // Structurally zero columns don't need to be perturbed at all
+    if (column_rows_[col].empty()) continue;
+    size_t group = 0;
+    for (; group < column_groups_.size(); group++) {
+      if (std::none_of(column_rows_[col].begin(), column_rows_[col].end(),
+                       [&](int row) { return group_rows[group][row]; })) {
+        break;
+      }
+    }
+    if (group == column_groups_.size()) {
+      column_groups_.emplace_back();
+      group_rows.emplace_back(num_outputs(), false);
+    }
+    column_groups_[group].push_back(col);
+    for (int row : column_rows_[col]) {
+      group_rows[group][row] = true;
+    }
+  }
+}
+
+template <typename T>
+void NonlinearConstraint<T>::DetectJacobianSparsity(
+    const Eigen::Ref<const VectorXd>& x, int num_samples) {
+  column_rows_.clear();
+  column_groups_.clear();
+
+  // Fixed seed, so that the detected pattern is repeatable
+  std::mt19937 generator(0);
+  std::normal_distribution<double> distribution;
+  MatrixX<bool> nonzero = MatrixX<bool>::Constant(num_outputs(), num_vars(),
+                                                  false);
+  VectorXd x_sample = x;
+  VectorXd y;
+  MatrixXd dy;
+  for (int i = 0; i <= num_samples; i++) {
+    CalcFiniteDifferenceJacobian(x_sample, &y, &dy);
+    // Entries at the level of the round-off error of the finite differences
+    // are treated as zeros
+    const VectorXd tolerance =
+        100 * std::numeric_limits<double>::epsilon() *
+        (VectorXd::Ones(y.size()) + y.cwiseAbs()) / eps_;
+    for (int col = 0; col < dy.cols(); col++) {
+      nonzero.col(col) =
+          nonzero.col(col).array() ||
+          (dy.col(col).cwiseAbs().array() > tolerance.array());
+    }
+    for (int j = 0; j < x.size(); j++) {
+      x_sample(j) = x(j) + 1e-2 * (1 + std::abs(x(j))) *
+                                  distribution(generator);
+    }
+  }
+
+  std::vector<std::pair<int, int>> nonzeros;
+  for (int col = 0; col < nonzero.cols(); col++) {
+    for (int row = 0; row < nonzero.rows(); row++) {
+      if (nonzero(row, col)) nonzeros.emplace_back(row, col);
+    }
+  }
+  SetJacobianSparsity(nonzeros, /*declare_to_solver=*/false);
+}
+
+template <typename T>
+std::vector<std::pair<int, int>> NonlinearConstraint<T>::GetJacobianSparsity()
+    const {
+  std::vector<std::pair<int, int>> nonzeros;
+  for (int col = 0; col < static_cast<int>(column_rows_.size()); col++) {
+    for (int row : column_rows_[col]) {
+      nonzeros.emplace_back(row, col);
+    }
+  }
+  return nonzeros;
+}
+
+template <typename T>
+int NonlinearConstraint<T>::num_jacobian_evaluations() const {
+  const int num_perturbations =
+      column_rows_.empty() ? num_vars() : column_groups_.size();
+  // (y itself is always evaluated)
+  return (fd_method_ == FiniteDifference::kCentral) ? 1 + 2 * num_perturbations
+                                                    : 1 + num_perturbations;
+}
+
+template <typename T>
+void NonlinearConstraint<T>::CalcFiniteDifferenceJacobian(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  const bool central = (fd_method_ == FiniteDifference::kCentral);
+  VectorXd x_val = x;
+  VectorXd y_plus, y_minus;
+  EvaluateConstraintValue(x_val, y);
+  dy->setZero(y->size(), x_val.size());
+
+  // Every column is its own group if there is no sparsity pattern
+  const int num_groups =
+      column_rows_.empty() ? x_val.size() : column_groups_.size();
+  for (int group = 0; group < num_groups; group++) {
+    const std::vector<int> dense_group{group};
+    const auto& cols = column_rows_.empty() ? dense_group
+                                            : column_groups_[group];
+    for (int col : cols) x_val(col) += eps_;
+    EvaluateConstraintValue(x_val, &y_plus);
+    if (central) {
+      for (int col : cols) x_val(col) -= 2 * eps_;
+      EvaluateConstraintValue(x_val, &y_minus);
+      for (int col : cols) x_val(col) += eps_;
+    } else {
+      for (int col : cols) x_val(col) -= eps_;
+    }
+    const VectorXd diff =
+        central ? VectorXd((y_plus - y_minus) / (2 * eps_))
+                : VectorXd((y_plus - *y) / eps_);
+
+    if (column_rows_.empty()) {
+      dy->col(group) = diff;
+    } else {
+      for (int col : cols) {
+        for (int row : column_rows_[col]) {
+          (*dy)(row, col) = diff(row);
+        }
+      }
+    }
+  }
+}
+
 template <typename T>
 template <typename U>
 void NonlinearConstraint<T>::ScaleConstraint(VectorX<U>* y) const {
@@ -43,11 +214,23 @@ void NonlinearConstraint<double>::DoEval(
 }
 
 template <>
-void NonlinearConstraint<AutoDiffXd>::DoEval(
-    const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::VectorXd* y) const {
+void NonlinearConstraint<double>::EvaluateConstraintValue(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y) const {
+  EvaluateConstraint(x, y);
+}
+
+template <>
+void NonlinearConstraint<AutoDiffXd>::EvaluateConstraintValue(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y) const {
   AutoDiffVecXd y_t;
   EvaluateConstraint(drake::math::initializeAutoDiff(x), &y_t);
   *y = drake::math::autoDiffToValueMatrix(y_t);
+}
+
+template <>
+void NonlinearConstraint<AutoDiffXd>::DoEval(
+    const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::VectorXd* y) const {
+  EvaluateConstraintValue(x, y);
   this->ScaleConstraint<double>(y);
 }
 
@@ -66,23 +249,34 @@ void NonlinearConstraint<AutoDiffXd>::DoEval(
   this->ScaleConstraint<AutoDiffXd>(y);
 }
 
+template <>
+void NonlinearConstraint<double>::EvaluateConstraintWithJacobian(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  CalcFiniteDifferenceJacobian(x, y, dy);
+}
+
+template <>
+void NonlinearConstraint<AutoDiffXd>::EvaluateConstraintWithJacobian(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  AutoDiffVecXd y_t;
+  EvaluateConstraint(drake::math::initializeAutoDiff(x), &y_t);
+  *y = drake::math::autoDiffToValueMatrix(y_t);
+  *dy = drake::math::autoDiffToGradientMatrix(y_t);
+  // (The gradient is empty if y doesn't depend on x)
+  if (dy->cols() != x.size()) {
+    *dy = MatrixXd::Zero(y->size(), x.size());
+  }
+}
+
 template <>
 void NonlinearConstraint<double>::DoEval(
     const Eigen::Ref<const AutoDiffVecXd>& x, AutoDiffVecXd* y) const {
   MatrixXd original_grad = drake::math::autoDiffToGradientMatrix(x);
 
-  // forward differencing
   VectorXd x_val = drake::math::autoDiffToValueMatrix(x);
-  VectorXd y0, yi;
-  EvaluateConstraint(x_val, &y0);
-
-  MatrixXd dy = MatrixXd(y0.size(), x_val.size());
-  for (int i = 0; i < x_val.size(); i++) {
-    x_val(i) += eps_;
-    EvaluateConstraint(x_val, &yi);
-    x_val(i) -= eps_;
-    dy.col(i) = (yi - y0) / eps_;
-  }
+  VectorXd y0;
+  MatrixXd dy;
+  EvaluateConstraintWithJacobian(x_val, &y0, &dy);
 
   // Profiling identified dy * original_grad as a significant runtime event,
   // even though it is almost always the identity matrix.
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "drake/common/symbolic.h"
 #include "drake/solvers/constraint.h"
 
@@ -12,6 +14,18 @@ namespace solvers {
 /// manages evaluation of functions and numerical differentiation
 /// 
 /// Subclasses should implement the method EvaluateConstraint
+///
+/// For NonlinearConstraint<double>, the gradient is computed by
+/// EvaluateConstraintWithJacobian(), which uses forward differencing by
+/// default. Subclasses which know the derivative structure of the constraint
+/// can override it to supply an analytic (or semi-analytic) Jacobian.
+///
+/// If the structural sparsity of the Jacobian is known (declared with
+/// SetJacobianSparsity() or estimated with DetectJacobianSparsity()), the
+/// finite differencing perturbs groups of structurally independent columns
+/// together (Curtis-Powell-Reid), so that the number of constraint
+/// evaluations per Jacobian is the number of groups instead of the number of
+/// variables.
 template <typename T>
 class NonlinearConstraint : public drake::solvers::Constraint {
  public:
@@ -38,14 +52,70 @@ class NonlinearConstraint : public drake::solvers::Constraint {
 
   void SetConstraintScaling(const std::unordered_map<int, double>& map);
 
+  const std::unordered_map<int, double>& GetConstraintScaling() const {
+    return constraint_scaling_;
+  }
+
+  enum class FiniteDifference { kForward, kCentral };
+
+  /// Central differencing is second order accurate, at the cost of twice as
+  /// many constraint evaluations (default kForward)
+  void SetFiniteDifference(FiniteDifference method) { fd_method_ = method; }
+
+  /// Declares the structurally nonzero entries (row, column) of the
+  /// Jacobian. Entries which are not listed are assumed to be always zero.
+  /// If `declare_to_solver`, the pattern is also passed on as the gradient
+  /// sparsity pattern of the constraint, so that solvers only allocate the
+  /// nonzero entries. Otherwise it only groups the columns of the finite
+  /// differences, and solvers see a dense Jacobian.
+  void SetJacobianSparsity(const std::vector<std::pair<int, int>>& nonzeros,
+                           bool declare_to_solver = true);
+
+  /// Estimates the sparsity of the Jacobian from dense finite differences at
+  /// x and at `num_samples` random perturbations of x. Entries which are zero
+  /// (up to the round-off error of the differences) at all of the points are
+  /// assumed to be zero by the finite differences. Since they might only
+  /// vanish near x, the pattern isn't declared to the solver.
+  void DetectJacobianSparsity(const Eigen::Ref<const Eigen::VectorXd>& x,
+                              int num_samples = 2);
+
+  /// The nonzero entries (row, column) used by the finite differences, or
+  /// none if the Jacobian is dense
+  std::vector<std::pair<int, int>> GetJacobianSparsity() const;
+
+  /// Number of constraint evaluations per finite difference Jacobian
+  int num_jacobian_evaluations() const;
+
   virtual void EvaluateConstraint(const Eigen::Ref<const drake::VectorX<T>>& x,
                                   drake::VectorX<T>* y) const = 0;
 
+ protected:
+  /// Evaluates the (unscaled) constraint y and its Jacobian dy/dx
+  virtual void EvaluateConstraintWithJacobian(
+      const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::VectorXd* y,
+      Eigen::MatrixXd* dy) const;
+
+  double eps() const { return eps_; }
+
+  /// Finite difference Jacobian of EvaluateConstraint(), using the sparsity
+  /// pattern if there is one. y is also evaluated at x.
+  void CalcFiniteDifferenceJacobian(const Eigen::Ref<const Eigen::VectorXd>& x,
+                                    Eigen::VectorXd* y,
+                                    Eigen::MatrixXd* dy) const;
+
  private:
   template <typename U>
   void ScaleConstraint(drake::VectorX<U>* y) const;
+  // EvaluateConstraint() on double inputs
+  void EvaluateConstraintValue(const Eigen::Ref<const Eigen::VectorXd>& x,
+                               Eigen::VectorXd* y) const;
   std::unordered_map<int, double> constraint_scaling_;
   double eps_;
+  FiniteDifference fd_method_ = FiniteDifference::kForward;
+  // Structurally nonzero rows of each column (empty if dense)
+  std::vector<std::vector<int>> column_rows_;
+  // Columns which are perturbed together (empty if dense)
+  std::vector<std::vector<int>> column_groups_;
 };
 
 }  // namespace solvers
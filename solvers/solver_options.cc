@@ -0,0 +1,59 @@
+#include "solvers/solver_options.h"
+
+#include "drake/solvers/ipopt_solver.h"
+#include "drake/solvers/snopt_solver.h"
+
+namespace dairlib {
+namespace solvers {
+
+using drake::solvers::IpoptSolver;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::SnoptSolver;
+
+void SetSnoptOptions(const SnoptOptions& options, MathematicalProgram* prog) {
+  const auto id = SnoptSolver::id();
+  if (!options.print_file.empty()) {
+    prog->SetSolverOption(id, "Print file", options.print_file);
+  }
+  prog->SetSolverOption(id, "Major iterations limit",
+                        options.major_iterations_limit);
+  prog->SetSolverOption(id, "Iterations limit", options.iterations_limit);
+  prog->SetSolverOption(id, "Verify level", options.verify_level);
+  prog->SetSolverOption(id, "Scale option", options.scale_option);
+  prog->SetSolverOption(id, "Major optimality tolerance",
+                        options.major_optimality_tolerance);
+  prog->SetSolverOption(id, "Major feasibility tolerance",
+                        options.major_feasibility_tolerance);
+}
+
+void SetIpoptOptions(const IpoptOptions& options, MathematicalProgram* prog) {
+  const auto id = IpoptSolver::id();
+  prog->SetSolverOption(id, "max_iter", options.max_iter);
+  prog->SetSolverOption(id, "tol", options.tol);
+  prog->SetSolverOption(id, "dual_inf_tol", options.tol);
+  prog->SetSolverOption(id, "constr_viol_tol", options.tol);
+  prog->SetSolverOption(id, "compl_inf_tol", options.tol);
+
+  prog->SetSolverOption(id, "acceptable_compl_inf_tol", options.tol);
+  prog->SetSolverOption(id, "acceptable_constr_viol_tol", options.tol);
+  prog->SetSolverOption(id, "acceptable_obj_change_tol",
+                        options.acceptable_obj_change_tol);
+  prog->SetSolverOption(id, "acceptable_tol", options.acceptable_tol);
+  prog->SetSolverOption(id, "acceptable_iter", options.acceptable_iter);
+
+  prog->SetSolverOption(id, "jacobian_approximation", "exact");
+  prog->SetSolverOption(id, "hessian_approximation", "limited-memory");
+  prog->SetSolverOption(id, "limited_memory_max_history",
+                        options.limited_memory_max_history);
+  prog->SetSolverOption(id, "linear_solver", options.linear_solver);
+  prog->SetSolverOption(id, "mu_strategy", options.mu_strategy);
+
+  prog->SetSolverOption(id, "nlp_lower_bound_inf", -options.bound_inf);
+  prog->SetSolverOption(id, "nlp_upper_bound_inf", options.bound_inf);
+  prog->SetSolverOption(id, "print_level", options.print_level);
+  prog->SetSolverOption(id, "print_timing_statistics",
+                        options.print_timing_statistics ? "yes" : "no");
+}
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+
+#include "drake/solvers/mathematical_program.h"
+
+namespace dairlib {
+namespace solvers {
+
+/// Settings of SNOPT for trajectory optimization, see SetSnoptOptions()
+struct SnoptOptions {
+  int major_iterations_limit = 100000;
+  /// Total number of minor (QP subproblem) iterations
+  int iterations_limit = 100000;
+  int verify_level = 0;
+  /// Try 2 if seeing snopta exit 40
+  int scale_option = 0;
+  /// Target nonlinear constraint violation
+  double major_feasibility_tolerance = 1e-4;
+  /// Target complementarity gap
+  double major_optimality_tolerance = 1e-4;
+  /// Not written if empty
+  std::string print_file = "";
+};
+
+/// Settings of IPOPT for trajectory optimization, see SetIpoptOptions().
+/// The default termination criteria (adapted from CasADi and FROST) ignore
+/// the overall tolerance and dual infeasibility, and stop once the problem is
+/// primal feasible and the cost has stopped decreasing for acceptable_iter
+/// iterations.
+struct IpoptOptions {
+  int max_iter = 1000;
+  /// Tolerance for the constraint violation, dual infeasibility and
+  /// complementarity
+  double tol = 1e-4;
+  double acceptable_tol = 1e2;
+  double acceptable_obj_change_tol = 1e-3;
+  int acceptable_iter = 5;
+  /// Number of updates kept by the L-BFGS approximation of the Hessian of
+  /// the Lagrangian (MathematicalProgram only provides first derivatives)
+  int limited_memory_max_history = 6;
+  /// "mumps" ships with IPOPT, the HSL solvers (e.g. "ma57") are usually
+  /// faster but need a separate license
+  std::string linear_solver = "mumps";
+  /// "adaptive" is typically more robust than the default "monotone" on
+  /// badly scaled trajectory optimization problems
+  std::string mu_strategy = "adaptive";
+  /// Bounds beyond this magnitude are treated as infinite
+  double bound_inf = 1e6;
+  int print_level = 5;
+  bool print_timing_statistics = true;
+};
+
+/// Sets the options of the SnoptSolver for `prog`
+void SetSnoptOptions(const SnoptOptions& options,
+                     drake::solvers::MathematicalProgram* prog);
+
+/// Sets the options of the IpoptSolver for `prog`. The constraint Jacobians
+/// are always exact: IPOPT gets their structure from the gradient sparsity
+/// pattern of each constraint (e.g. see
+/// NonlinearConstraint::SetJacobianSparsity()), or assumes them dense.
+void SetIpoptOptions(const IpoptOptions& options,
+                     drake::solvers::MathematicalProgram* prog);
+
+}  // namespace solvers
+}  // namespace dairlib
@@ -0,0 +1,198 @@
+#include <memory>
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/common/test_utilities/limit_malloc.h"
+#include "drake/solvers/mathematical_program.h"
+#include "drake/solvers/osqp_solver.h"
+#include "solvers/dense_active_set_solver.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using drake::CompareMatrices;
+using drake::solvers::LinearConstraint;
+using drake::solvers::LinearEqualityConstraint;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::MathematicalProgramResult;
+using drake::solvers::OsqpSolver;
+using drake::solvers::QuadraticCost;
+using drake::solvers::SolutionResult;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+class DenseActiveSetSolverTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    x_ = prog_.NewContinuousVariables(3, "x");
+    y_ = prog_.NewContinuousVariables(2, "y");
+    cost_ = prog_.AddQuadraticCost(MatrixXd::Identity(3, 3),
+                                   VectorXd::Zero(3), x_)
+                .evaluator()
+                .get();
+    prog_.AddQuadraticCost(MatrixXd::Identity(2, 2), VectorXd::Zero(2), y_);
+    eq_ = prog_.AddLinearEqualityConstraint(MatrixXd::Zero(1, 5),
+                                            VectorXd::Zero(1), {x_, y_})
+              .evaluator()
+              .get();
+    MatrixXd A(2, 3);
+    A << 1, 1, 0,
+         0, 1, -1;
+    ineq_ = prog_.AddLinearConstraint(A, -VectorXd::Ones(2),
+                                      VectorXd::Ones(2), x_)
+                .evaluator()
+                .get();
+    prog_.AddBoundingBoxConstraint(-0.5, 0.5, y_);
+  }
+
+  // Update the coefficients to the i-th QP of a sequence
+  void UpdateQp(int i) {
+    MatrixXd Q = MatrixXd::Identity(3, 3) * (1 + 0.1 * i);
+    Q(0, 1) = Q(1, 0) = 0.2;
+    VectorXd b(3);
+    b << -3 + 0.1 * i, 2, 1 - 0.2 * i;
+    cost_->UpdateCoefficients(Q, b);
+    MatrixXd A(1, 5);
+    A << 1, 0, 1, -1, 0.5;
+    eq_->UpdateCoefficients(A, VectorXd::Constant(1, 0.1 * i));
+  }
+
+  MathematicalProgram prog_;
+  drake::solvers::VectorXDecisionVariable x_;
+  drake::solvers::VectorXDecisionVariable y_;
+  QuadraticCost* cost_;
+  LinearEqualityConstraint* eq_;
+  LinearConstraint* ineq_;
+};
+
+// Solve a sequence of QPs and compare against drake's OsqpSolver.
+TEST_F(DenseActiveSetSolverTest, MatchesOsqpSolver) {
+  DenseActiveSetSolver solver;
+  solver.InitializeSolver(prog_);
+  EXPECT_EQ(solver.num_vars(), 5);
+  EXPECT_EQ(solver.num_equality_rows(), 1);
+  EXPECT_EQ(solver.num_inequality_rows(), 4);
+
+  OsqpSolver osqp;
+  for (int i = 0; i < 5; i++) {
+    UpdateQp(i);
+    EXPECT_EQ(solver.Solve(prog_), SolutionResult::kSolutionFound);
+    MathematicalProgramResult result = osqp.Solve(prog_, {}, {});
+    EXPECT_TRUE(CompareMatrices(solver.primal_solution(),
+                                result.GetSolution(), 1e-4));
+    // Some of the inequality constraints are active
+    EXPECT_GT(solver.num_active_inequalities(), 0);
+  }
+}
+
+// With warm start, re-solving the same QP doesn't take any iteration, since
+// the initial working set is already the optimal active set.
+TEST_F(DenseActiveSetSolverTest, WarmStart) {
+  DenseActiveSetSolver solver;
+  solver.InitializeSolver(prog_);
+  UpdateQp(0);
+  solver.Solve(prog_);
+  EXPECT_GT(solver.iterations(), 0);
+  VectorXd x_sol = solver.primal_solution();
+
+  solver.Solve(prog_);
+  EXPECT_EQ(solver.iterations(), 0);
+  EXPECT_TRUE(CompareMatrices(solver.primal_solution(), x_sol, 1e-10));
+
+  DenseActiveSetSolverOptions options;
+  options.warm_start = false;
+  DenseActiveSetSolver cold_solver(options);
+  cold_solver.InitializeSolver(prog_);
+  cold_solver.Solve(prog_);
+  cold_solver.Solve(prog_);
+  EXPECT_GT(cold_solver.iterations(), 0);
+  EXPECT_TRUE(CompareMatrices(cold_solver.primal_solution(), x_sol, 1e-10));
+}
+
+// The working set changes size within and across the solves, without
+// touching the heap after initialization
+TEST_F(DenseActiveSetSolverTest, NoHeapAllocationAfterInitialization) {
+  DenseActiveSetSolverOptions options;
+  options.warm_start = false;
+  DenseActiveSetSolver solver(options);
+  solver.InitializeSolver(prog_);
+  for (int i = 0; i < 5; i++) {
+    UpdateQp(i);
+    {
+      drake::test::LimitMalloc guard;
+      EXPECT_EQ(solver.Solve(prog_), SolutionResult::kSolutionFound);
+    }
+    EXPECT_GT(solver.iterations(), 0);
+  }
+}
+
+// Each change of the working set updates the factorization of the Schur
+// complement in O(capacity^2), instead of refactorizing it in
+// O(capacity^3). Also, the redundant equality row is left out of the working
+// set.
+TEST_F(DenseActiveSetSolverTest, IterationCost) {
+  const int n = 40;
+  const int m_eq = 10;
+  MathematicalProgram prog;
+  auto x = prog.NewContinuousVariables(n, "x");
+  prog.AddQuadraticCost(MatrixXd::Identity(n, n),
+                        VectorXd::LinSpaced(n, -5, 5), x);
+  MatrixXd A = MatrixXd::Random(m_eq, n);
+  A.row(m_eq - 1) = A.row(0) + A.row(1);
+  VectorXd b = 0.1 * VectorXd::Random(m_eq);
+  b(m_eq - 1) = b(0) + b(1);
+  prog.AddLinearEqualityConstraint(A, b, x);
+  prog.AddBoundingBoxConstraint(-1, 1, x);
+
+  DenseActiveSetSolverOptions options;
+  options.warm_start = false;
+  DenseActiveSetSolver solver(options);
+  solver.InitializeSolver(prog);
+  EXPECT_EQ(solver.Solve(prog), SolutionResult::kSolutionFound);
+  MathematicalProgramResult result = OsqpSolver().Solve(prog, {}, {});
+  EXPECT_TRUE(CompareMatrices(solver.primal_solution(), result.GetSolution(),
+                              1e-4));
+  EXPECT_GT(solver.num_active_inequalities(), 0);
+
+  // Every iteration (and every equality row) changes the working set once.
+  // (Refactorizing would take about capacity^3 / 6 multiplications per
+  // change.)
+  const int64_t capacity = m_eq + n;
+  const int64_t num_changes = m_eq + solver.iterations();
+  EXPECT_LE(solver.factorization_cost(), 2 * capacity * capacity * num_changes);
+}
+
+TEST_F(DenseActiveSetSolverTest, IterationLimit) {
+  DenseActiveSetSolverOptions options;
+  options.max_iter = 1;
+  options.warm_start = false;
+  DenseActiveSetSolver solver(options);
+  solver.InitializeSolver(prog_);
+  UpdateQp(0);
+  EXPECT_EQ(solver.Solve(prog_), SolutionResult::kIterationLimit);
+  EXPECT_EQ(solver.iterations(), 1);
+}
+
+TEST_F(DenseActiveSetSolverTest, Infeasible) {
+  DenseActiveSetSolver solver;
+  solver.InitializeSolver(prog_);
+  UpdateQp(0);
+  // x0 + x1 >= 2 and x0 + x1 <= -2
+  MatrixXd A(2, 3);
+  A << 1, 1, 0,
+       -1, -1, 0;
+  ineq_->UpdateCoefficients(A, VectorXd::Constant(2, 2),
+                            VectorXd::Constant(2, 10));
+  EXPECT_EQ(solver.Solve(prog_), SolutionResult::kInfeasibleConstraints);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,121 @@
+#include <memory>
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/common/test_utilities/limit_malloc.h"
+#include "drake/solvers/mathematical_program.h"
+#include "drake/solvers/osqp_solver.h"
+#include "solvers/fast_osqp_solver.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using drake::CompareMatrices;
+using drake::solvers::LinearEqualityConstraint;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::MathematicalProgramResult;
+using drake::solvers::OsqpSolver;
+using drake::solvers::QuadraticCost;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+class FastOsqpSolverTest : public ::testing::Test {};
+
+// Solve a sequence of QPs with the same sparsity but different coefficients
+// and compare against drake's OsqpSolver.
+TEST_F(FastOsqpSolverTest, MatchesOsqpSolver) {
+  MathematicalProgram prog;
+  auto x = prog.NewContinuousVariables(3, "x");
+  auto y = prog.NewContinuousVariables(2, "y");
+  QuadraticCost* cost =
+      prog.AddQuadraticCost(MatrixXd::Zero(3, 3), VectorXd::Zero(3), x)
+          .evaluator()
+          .get();
+  prog.AddQuadraticCost(MatrixXd::Identity(2, 2), VectorXd::Zero(2), y);
+  LinearEqualityConstraint* eq =
+      prog.AddLinearEqualityConstraint(MatrixXd::Zero(2, 5),
+                                       VectorXd::Zero(2), {x, y})
+          .evaluator()
+          .get();
+  prog.AddLinearConstraint(MatrixXd::Identity(3, 3), -VectorXd::Ones(3),
+                           VectorXd::Ones(3), x);
+  prog.AddBoundingBoxConstraint(-2, 2, y);
+
+  FastOsqpSolver fast_solver;
+  fast_solver.InitializeSolver(prog);
+  EXPECT_EQ(fast_solver.num_vars(), 5);
+  EXPECT_EQ(fast_solver.num_constraint_rows(), 7);
+
+  OsqpSolver osqp;
+  for (int i = 0; i < 5; i++) {
+    MatrixXd Q = MatrixXd::Identity(3, 3) * (1 + 0.1 * i);
+    Q(0, 1) = Q(1, 0) = 0.2;
+    VectorXd b(3);
+    b << 1, -0.5 * i, 0.3;
+    cost->UpdateCoefficients(Q, b);
+    MatrixXd A(2, 5);
+    A << 1, 0, 0, -1, 0,
+         0, 1, 1, 0, -1;
+    VectorXd beq(2);
+    beq << 0.1 * i, -0.2;
+    eq->UpdateCoefficients(A, beq);
+
+    MathematicalProgramResult fast_result;
+    fast_solver.Solve(prog, &fast_result);
+    MathematicalProgramResult result = osqp.Solve(prog, {}, {});
+
+    EXPECT_TRUE(fast_result.is_success());
+    EXPECT_TRUE(CompareMatrices(fast_result.GetSolution(x),
+                                result.GetSolution(x), 1e-4));
+    EXPECT_TRUE(CompareMatrices(fast_result.GetSolution(y),
+                                result.GetSolution(y), 1e-4));
+    EXPECT_NEAR(fast_result.get_optimal_cost(), result.get_optimal_cost(),
+                1e-4);
+  }
+}
+
+// After the initialization, updating the coefficients and solving must not
+// touch the heap (used in real-time controllers).
+TEST_F(FastOsqpSolverTest, NoHeapAllocationAfterInitialization) {
+  MathematicalProgram prog;
+  auto x = prog.NewContinuousVariables(4, "x");
+  QuadraticCost* cost =
+      prog.AddQuadraticCost(MatrixXd::Identity(4, 4), VectorXd::Zero(4), x)
+          .evaluator()
+          .get();
+  LinearEqualityConstraint* eq =
+      prog.AddLinearEqualityConstraint(MatrixXd::Ones(1, 4),
+                                       VectorXd::Ones(1), x)
+          .evaluator()
+          .get();
+  prog.AddBoundingBoxConstraint(-1, 1, x);
+  prog.SetSolverOption(OsqpSolver::id(), "polish", 0);
+
+  FastOsqpSolver fast_solver;
+  fast_solver.InitializeSolver(prog);
+  // Warm up
+  fast_solver.Solve(prog);
+
+  const MatrixXd Q = 2 * MatrixXd::Identity(4, 4);
+  const VectorXd b = VectorXd::LinSpaced(4, -1, 1);
+  const MatrixXd A = MatrixXd::Constant(1, 4, 2);
+  const VectorXd beq = VectorXd::Constant(1, 0.5);
+  {
+    drake::test::LimitMalloc guard;
+    cost->UpdateCoefficients(Q, b);
+    eq->UpdateCoefficients(A, beq);
+    fast_solver.Solve(prog);
+  }
+  EXPECT_NEAR(2 * fast_solver.primal_solution().sum(), 0.5, 1e-4);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,145 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
+#include "solvers/nonlinear_constraint.h"
+
+namespace dairlib {
+namespace solvers {
+namespace {
+
+using drake::AutoDiffVecXd;
+using drake::CompareMatrices;
+using drake::VectorX;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+// y_i = sin(x_i) * x_{n+i}^2 for i < n, so that column i and n+i only touch
+// row i and every column of each half can be perturbed together
+class ProductConstraint : public NonlinearConstraint<double> {
+ public:
+  explicit ProductConstraint(int n)
+      : NonlinearConstraint<double>(n, 2 * n, VectorXd::Zero(n),
+                                    VectorXd::Zero(n), "", 1e-6),
+        n_(n) {}
+
+  void EvaluateConstraint(const Eigen::Ref<const VectorXd>& x,
+                          VectorXd* y) const override {
+    num_evaluations_++;
+    *y = x.head(n_).array().sin() * x.tail(n_).array().square();
+  }
+
+  MatrixXd Jacobian(const VectorXd& x) const {
+    MatrixXd dy = MatrixXd::Zero(n_, 2 * n_);
+    for (int i = 0; i < n_; i++) {
+      dy(i, i) = std::cos(x(i)) * x(n_ + i) * x(n_ + i);
+      dy(i, n_ + i) = 2 * std::sin(x(i)) * x(n_ + i);
+    }
+    return dy;
+  }
+
+  MatrixXd FiniteDifferenceJacobian(const VectorXd& x) const {
+    AutoDiffVecXd y;
+    Eval(drake::math::initializeAutoDiff(x), &y);
+    return drake::math::autoDiffToGradientMatrix(y);
+  }
+
+  mutable int num_evaluations_ = 0;
+
+ private:
+  const int n_;
+};
+
+class NonlinearConstraintTest : public ::testing::Test {
+ protected:
+  NonlinearConstraintTest() : constraint_(5), x_(10) {
+    x_ << 0.1, 0.2, 0.3, 0.4, 0.5, 1, 2, 3, 4, 5;
+  }
+
+  ProductConstraint constraint_;
+  VectorXd x_;
+};
+
+TEST_F(NonlinearConstraintTest, DenseForwardDifference) {
+  EXPECT_EQ(constraint_.num_jacobian_evaluations(), 11);
+  const MatrixXd dy = constraint_.FiniteDifferenceJacobian(x_);
+  EXPECT_EQ(constraint_.num_evaluations_, 11);
+  EXPECT_TRUE(CompareMatrices(dy, constraint_.Jacobian(x_), 1e-4));
+}
+
+TEST_F(NonlinearConstraintTest, DeclaredSparsity) {
+  std::vector<std::pair<int, int>> nonzeros;
+  for (int i = 0; i < 5; i++) {
+    nonzeros.emplace_back(i, i);
+    nonzeros.emplace_back(i, 5 + i);
+  }
+  constraint_.SetJacobianSparsity(nonzeros);
+  EXPECT_EQ(constraint_.num_jacobian_evaluations(), 3);
+  ASSERT_TRUE(constraint_.gradient_sparsity_pattern().has_value());
+  EXPECT_EQ(constraint_.gradient_sparsity_pattern()->size(), 10);
+
+  const MatrixXd dy = constraint_.FiniteDifferenceJacobian(x_);
+  EXPECT_EQ(constraint_.num_evaluations_, 3);
+  EXPECT_TRUE(CompareMatrices(dy, constraint_.Jacobian(x_), 1e-4));
+}
+
+TEST_F(NonlinearConstraintTest, DetectedSparsity) {
+  constraint_.DetectJacobianSparsity(x_);
+  EXPECT_EQ(constraint_.num_jacobian_evaluations(), 3);
+  EXPECT_EQ(constraint_.GetJacobianSparsity().size(), 10);
+  // The solver sees a dense Jacobian
+  EXPECT_FALSE(constraint_.gradient_sparsity_pattern().has_value());
+
+  // The pattern also holds away from the detection point
+  VectorXd x = 2 * x_;
+  constraint_.num_evaluations_ = 0;
+  const MatrixXd dy = constraint_.FiniteDifferenceJacobian(x);
+  EXPECT_EQ(constraint_.num_evaluations_, 3);
+  EXPECT_TRUE(CompareMatrices(dy, constraint_.Jacobian(x), 1e-4));
+}
+
+TEST_F(NonlinearConstraintTest, UndeclaredSparsity) {
+  std::vector<std::pair<int, int>> nonzeros;
+  for (int i = 0; i < 5; i++) {
+    nonzeros.emplace_back(i, i);
+    nonzeros.emplace_back(i, 5 + i);
+  }
+  constraint_.SetJacobianSparsity(nonzeros);
+  constraint_.SetJacobianSparsity(nonzeros, /*declare_to_solver=*/false);
+  EXPECT_EQ(constraint_.num_jacobian_evaluations(), 3);
+  EXPECT_EQ(constraint_.GetJacobianSparsity().size(), 10);
+  // The previously declared pattern is replaced by a dense one
+  ASSERT_TRUE(constraint_.gradient_sparsity_pattern().has_value());
+  EXPECT_EQ(constraint_.gradient_sparsity_pattern()->size(), 50);
+}
+
+TEST_F(NonlinearConstraintTest, CentralDifference) {
+  const double forward_error =
+      (constraint_.FiniteDifferenceJacobian(x_) - constraint_.Jacobian(x_))
+          .cwiseAbs()
+          .maxCoeff();
+
+  constraint_.DetectJacobianSparsity(x_);
+  constraint_.SetFiniteDifference(
+      NonlinearConstraint<double>::FiniteDifference::kCentral);
+  EXPECT_EQ(constraint_.num_jacobian_evaluations(), 5);
+  constraint_.num_evaluations_ = 0;
+  const double central_error =
+      (constraint_.FiniteDifferenceJacobian(x_) - constraint_.Jacobian(x_))
+          .cwiseAbs()
+          .maxCoeff();
+  EXPECT_EQ(constraint_.num_evaluations_, 5);
+  EXPECT_LT(central_error, 1e-2 * forward_error);
+}
+
+}  // namespace
+}  // namespace solvers
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -1,10 +1,15 @@
 #include "systems/controllers/osc/operational_space_control.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
 #include <drake/math/saturate.h>
 #include <drake/multibody/plant/multibody_plant.h>
 
 #include "common/eigen_utils.h"
 #include "multibody/multibody_utils.h"
+#include "solvers/fast_osqp_solver.h"
 
 #include "drake/common/text_logging.h"
 
@@ -34,7 +39,6 @@ using drake::trajectories::PiecewisePolynomial;
 
 using drake::solvers::OsqpSolver;
 using drake::solvers::OsqpSolverDetails;
-using drake::solvers::Solve;
 
 namespace dairlib::systems::controllers {
 
@@ -45,12 +49,19 @@ using multibody::WorldPointEvaluator;
 
 int kSpaceDim = OscTrackingData::kSpaceDim;
 
+// Names of OperationalSpaceControl::Stage in lcmt_osc_qp_output
+const char* const kStageNames[OperationalSpaceControl::kNumStages] = {
+    "context_update", "dynamics",     "contact_jacobians",
+    "constraints",    "tracking_data", "qp_update",
+    "solver_setup",   "solve",         "solution_extraction"};
+
 OperationalSpaceControl::OperationalSpaceControl(
     const MultibodyPlant<double>& plant_w_spr,
     const MultibodyPlant<double>& plant_wo_spr,
     drake::systems::Context<double>* context_w_spr,
     drake::systems::Context<double>* context_wo_spr,
-    bool used_with_finite_state_machine, bool print_tracking_info)
+    bool used_with_finite_state_machine, bool print_tracking_info,
+    OscFormulation formulation)
     : plant_w_spr_(plant_w_spr),
       plant_wo_spr_(plant_wo_spr),
       context_w_spr_(context_w_spr),
@@ -58,7 +69,8 @@ OperationalSpaceControl::OperationalSpaceControl(
       world_w_spr_(plant_w_spr_.world_frame()),
       world_wo_spr_(plant_wo_spr_.world_frame()),
       used_with_finite_state_machine_(used_with_finite_state_machine),
-      print_tracking_info_(print_tracking_info) {
+      print_tracking_info_(print_tracking_info),
+      formulation_(formulation) {
   this->set_name("OSC");
 
   n_q_ = plant_wo_spr.num_positions();
@@ -246,12 +258,18 @@ void OperationalSpaceControl::Build() {
   // Checker
   CheckCostSettings();
   CheckConstraintSettings();
+  // Collect the kinematics queries of all the tracking data, so that the
+  // shared ones are computed once per tick
+  kinematics_cache_ = std::make_unique<OscKinematicsCache>(
+      plant_w_spr_, *context_w_spr_, plant_wo_spr_, *context_wo_spr_);
   for (auto tracking_data : *tracking_data_vec_) {
     tracking_data->CheckOscTrackingData();
+    tracking_data->RegisterKinematicsRequests(kinematics_cache_.get());
   }
+  kinematics_cache_->Finalize();
 
-  // Construct QP
-  prog_ = std::make_unique<MathematicalProgram>();
+  // Timing
+  stage_histograms_.assign(kNumStages, LatencyHistogram());
 
   // Size of decision variable
   n_h_ = (kinematic_evaluators_ == nullptr)
@@ -259,7 +277,9 @@ void OperationalSpaceControl::Build() {
              : kinematic_evaluators_->count_full();
   n_c_ = kSpaceDim * all_contacts_.size();
   n_c_active_ = 0;
+  epsilon_start_of_contact_.clear();
   for (auto evaluator : all_contacts_) {
+    epsilon_start_of_contact_.push_back(n_c_active_);
     n_c_active_ += evaluator->num_active();
   }
 
@@ -275,131 +295,290 @@ void OperationalSpaceControl::Build() {
   lambda_h_sol_->setZero();
   epsilon_sol_->setZero();
 
+  // Allocate the buffers used in SolveQp
+  B_ = plant_wo_spr_.MakeActuationMatrix();
+  B_pinv_ = B_.completeOrthogonalDecomposition().pseudoInverse();
+  u_prev_ = VectorXd::Zero(n_u_);
+  u_prev2_ = VectorXd::Zero(n_u_);
+  f_app_ = std::make_unique<drake::multibody::MultibodyForces<double>>(
+      plant_wo_spr_);
+  x_w_spr_ = VectorXd::Zero(plant_w_spr_.num_positions() +
+                            plant_w_spr_.num_velocities());
+  x_wo_spr_ = VectorXd::Zero(n_q_ + n_v_);
+  M_ = MatrixXd::Zero(n_v_, n_v_);
+  bias_ = VectorXd::Zero(n_v_);
+  J_h_ = MatrixXd::Zero(n_h_, n_v_);
+  JdotV_h_ = VectorXd::Zero(n_h_);
+  b_dyn_ = VectorXd::Zero(n_v_);
+  b_h_ = VectorXd::Zero(n_h_);
+  int max_n_ydot = 0;
+  for (auto tracking_data : *tracking_data_vec_) {
+    max_n_ydot = std::max(max_n_ydot, tracking_data->GetYdotDim());
+  }
+  Q_tracking_ = MatrixXd::Zero(n_v_, n_v_);
+  b_tracking_ = VectorXd::Zero(n_v_);
+  tracking_cost_buffer_ = VectorXd::Zero(max_n_ydot * (n_v_ + 2));
+  kernels_ = OscFixedSizeKernelTable::ForNumVelocities(n_v_);
+  zero_Q_tracking_ = MatrixXd::Zero(n_v_, n_v_);
+  zero_b_tracking_ = VectorXd::Zero(n_v_);
+  M_llt_ = Eigen::LLT<MatrixXd>(n_v_);
+  Lambda_h_ldlt_ = Eigen::LDLT<MatrixXd>(n_h_);
+  Minv_J_hT_ = MatrixXd::Zero(n_v_, n_h_);
+  Lambda_h_ = MatrixXd::Zero(n_h_, n_h_);
+  g_ = VectorXd::Zero(n_v_);
+  h_ = VectorXd::Zero(n_h_);
+  J_h_g_ = VectorXd::Zero(n_h_);
+  Q_dv_ = MatrixXd::Zero(n_v_, n_v_);
+  b_dv_ = VectorXd::Zero(n_v_);
+  Q_dv_g_ = VectorXd::Zero(n_v_);
+
+  // Construct one QP per contact mode, so that switching between the finite
+  // state machine states doesn't change the sparsity of a QP
+  contact_mode_qps_.clear();
+  for (const auto& state_and_contacts : contact_indices_map_) {
+    contact_mode_qps_[state_and_contacts.first] =
+        BuildContactModeQp(state_and_contacts.second);
+  }
+  no_contact_qp_ = BuildContactModeQp({});
+
+  // Construct the constant trajectories
+  fixed_position_traj_vec_.clear();
+  for (const auto& fixed_position : fixed_position_vec_) {
+    if (fixed_position.size() != 0) {
+      fixed_position_traj_vec_.push_back(
+          PiecewisePolynomial<double>(fixed_position));
+    } else {
+      fixed_position_traj_vec_.push_back(PiecewisePolynomial<double>());
+    }
+  }
+}
+
+std::unique_ptr<OperationalSpaceControl::ContactModeQp>
+OperationalSpaceControl::BuildContactModeQp(
+    const std::set<int>& active_contact_set) const {
+  auto qp = std::make_unique<ContactModeQp>();
+  qp->contact_indices.assign(active_contact_set.begin(),
+                             active_contact_set.end());
+  qp->n_c = kSpaceDim * qp->contact_indices.size();
+  qp->n_c_active = 0;
+  for (int i : qp->contact_indices) {
+    qp->n_c_active += all_contacts_[i]->num_active();
+  }
+  int n_c = qp->n_c;
+  int n_c_active = qp->n_c_active;
+  bool is_full = (formulation_ == OscFormulation::kFull);
+  // Size of z = [u; lambda_c] in OscFormulation::kReduced
+  int n_z = n_u_ + n_c;
+
+  // Construct QP
+  qp->prog = std::make_unique<MathematicalProgram>();
+  auto& prog = *qp->prog;
+
   // Add decision variables
-  dv_ = prog_->NewContinuousVariables(n_v_, "dv");
-  u_ = prog_->NewContinuousVariables(n_u_, "u");
-  lambda_c_ = prog_->NewContinuousVariables(n_c_, "lambda_contact");
-  lambda_h_ = prog_->NewContinuousVariables(n_h_, "lambda_holonomic");
-  epsilon_ = prog_->NewContinuousVariables(n_c_active_, "epsilon");
+  // (dv and lambda_h are eliminated in OscFormulation::kReduced)
+  drake::solvers::VectorXDecisionVariable dv;
+  drake::solvers::VectorXDecisionVariable lambda_h;
+  if (is_full) {
+    dv = prog.NewContinuousVariables(n_v_, "dv");
+  }
+  auto u = prog.NewContinuousVariables(n_u_, "u");
+  auto lambda_c = prog.NewContinuousVariables(n_c, "lambda_contact");
+  if (is_full) {
+    lambda_h = prog.NewContinuousVariables(n_h_, "lambda_holonomic");
+  }
+  auto epsilon = prog.NewContinuousVariables(n_c_active, "epsilon");
 
   // Add constraints
-  // 1. Dynamics constraint
-  dynamics_constraint_ =
-      prog_
-          ->AddLinearEqualityConstraint(
-              MatrixXd::Zero(n_v_, n_v_ + n_c_ + n_h_ + n_u_),
-              VectorXd::Zero(n_v_), {dv_, lambda_c_, lambda_h_, u_})
-          .evaluator()
-          .get();
-  // 2. Holonomic constraint
-  holonomic_constraint_ =
-      prog_
-          ->AddLinearEqualityConstraint(MatrixXd::Zero(n_h_, n_v_),
-                                        VectorXd::Zero(n_h_), dv_)
-          .evaluator()
-          .get();
+  qp->dynamics_constraint = nullptr;
+  qp->holonomic_constraint = nullptr;
+  if (is_full) {
+    // 1. Dynamics constraint
+    qp->dynamics_constraint =
+        prog.AddLinearEqualityConstraint(
+                MatrixXd::Zero(n_v_, n_v_ + n_c + n_h_ + n_u_),
+                VectorXd::Zero(n_v_), {dv, lambda_c, lambda_h, u})
+            .evaluator()
+            .get();
+    // 2. Holonomic constraint
+    qp->holonomic_constraint =
+        prog.AddLinearEqualityConstraint(MatrixXd::Zero(n_h_, n_v_),
+                                         VectorXd::Zero(n_h_), dv)
+            .evaluator()
+            .get();
+  }
   // 3. Contact constraint
-  if (all_contacts_.size() > 0) {
+  qp->contact_constraints = nullptr;
+  if (n_c > 0 && !is_full) {
+    // The contact constraint is imposed on dv = G*[u; lambda_c] + g
+    if (w_soft_constraint_ <= 0) {
+      qp->contact_constraints =
+          prog.AddLinearEqualityConstraint(MatrixXd::Zero(n_c_active, n_z),
+                                           VectorXd::Zero(n_c_active),
+                                           {u, lambda_c})
+              .evaluator()
+              .get();
+    } else {
+      // Relaxed version:
+      qp->contact_constraints =
+          prog.AddLinearEqualityConstraint(
+                  MatrixXd::Zero(n_c_active, n_z + n_c_active),
+                  VectorXd::Zero(n_c_active), {u, lambda_c, epsilon})
+              .evaluator()
+              .get();
+    }
+  } else if (n_c > 0) {
     if (w_soft_constraint_ <= 0) {
-      contact_constraints_ =
-          prog_
-              ->AddLinearEqualityConstraint(MatrixXd::Zero(n_c_active_, n_v_),
-                                            VectorXd::Zero(n_c_active_), dv_)
+      qp->contact_constraints =
+          prog.AddLinearEqualityConstraint(MatrixXd::Zero(n_c_active, n_v_),
+                                           VectorXd::Zero(n_c_active), dv)
               .evaluator()
               .get();
     } else {
       // Relaxed version:
-      contact_constraints_ =
-          prog_
-              ->AddLinearEqualityConstraint(
-                  MatrixXd::Zero(n_c_active_, n_v_ + n_c_active_),
-                  VectorXd::Zero(n_c_active_), {dv_, epsilon_})
+      qp->contact_constraints =
+          prog.AddLinearEqualityConstraint(
+                  MatrixXd::Zero(n_c_active, n_v_ + n_c_active),
+                  VectorXd::Zero(n_c_active), {dv, epsilon})
               .evaluator()
               .get();
     }
   }
   // 4. Friction constraint (approximated friction cone)
-  if (!all_contacts_.empty()) {
+  /// For i = active contact indices
+  ///     mu_*lambda_c(3*i+2) >= lambda_c(3*i+0)
+  ///    -mu_*lambda_c(3*i+2) <= lambda_c(3*i+0)
+  ///     mu_*lambda_c(3*i+2) >= lambda_c(3*i+1)
+  ///    -mu_*lambda_c(3*i+2) <= lambda_c(3*i+1)
+  ///         lambda_c(3*i+2) >= 0
+  /// ->
+  ///     mu_*lambda_c(3*i+2) - lambda_c(3*i+0) >= 0
+  ///     mu_*lambda_c(3*i+2) + lambda_c(3*i+0) >= 0
+  ///     mu_*lambda_c(3*i+2) - lambda_c(3*i+1) >= 0
+  ///     mu_*lambda_c(3*i+2) + lambda_c(3*i+1) >= 0
+  ///                           lambda_c(3*i+2) >= 0
+  /// The constraints only contain the contacts of the mode, so their bounds
+  /// never change.
+  if (n_c > 0) {
     VectorXd mu_neg1(2);
     VectorXd mu_1(2);
     VectorXd one(1);
     mu_neg1 << mu_, -1;
     mu_1 << mu_, 1;
     one << 1;
-    for (unsigned int j = 0; j < all_contacts_.size(); j++) {
-      friction_constraints_.push_back(
-          prog_
-              ->AddLinearConstraint(mu_neg1.transpose(), 0,
-                                    numeric_limits<double>::infinity(),
-                                    {lambda_c_.segment(kSpaceDim * j + 2, 1),
-                                     lambda_c_.segment(kSpaceDim * j + 0, 1)})
-              .evaluator()
-              .get());
-      friction_constraints_.push_back(
-          prog_
-              ->AddLinearConstraint(mu_1.transpose(), 0,
-                                    numeric_limits<double>::infinity(),
-                                    {lambda_c_.segment(kSpaceDim * j + 2, 1),
-                                     lambda_c_.segment(kSpaceDim * j + 0, 1)})
-              .evaluator()
-              .get());
-      friction_constraints_.push_back(
-          prog_
-              ->AddLinearConstraint(mu_neg1.transpose(), 0,
-                                    numeric_limits<double>::infinity(),
-                                    {lambda_c_.segment(kSpaceDim * j + 2, 1),
-                                     lambda_c_.segment(kSpaceDim * j + 1, 1)})
-              .evaluator()
-              .get());
-      friction_constraints_.push_back(
-          prog_
-              ->AddLinearConstraint(mu_1.transpose(), 0,
-                                    numeric_limits<double>::infinity(),
-                                    {lambda_c_.segment(kSpaceDim * j + 2, 1),
-                                     lambda_c_.segment(kSpaceDim * j + 1, 1)})
-              .evaluator()
-              .get());
-      friction_constraints_.push_back(
-          prog_
-              ->AddLinearConstraint(one.transpose(), 0,
-                                    numeric_limits<double>::infinity(),
-                                    lambda_c_.segment(kSpaceDim * j + 2, 1))
-              .evaluator()
-              .get());
+    for (unsigned int j = 0; j < qp->contact_indices.size(); j++) {
+      prog.AddLinearConstraint(mu_neg1.transpose(), 0,
+                               numeric_limits<double>::infinity(),
+                               {lambda_c.segment(kSpaceDim * j + 2, 1),
+                                lambda_c.segment(kSpaceDim * j + 0, 1)});
+      prog.AddLinearConstraint(mu_1.transpose(), 0,
+                               numeric_limits<double>::infinity(),
+                               {lambda_c.segment(kSpaceDim * j + 2, 1),
+                                lambda_c.segment(kSpaceDim * j + 0, 1)});
+      prog.AddLinearConstraint(mu_neg1.transpose(), 0,
+                               numeric_limits<double>::infinity(),
+                               {lambda_c.segment(kSpaceDim * j + 2, 1),
+                                lambda_c.segment(kSpaceDim * j + 1, 1)});
+      prog.AddLinearConstraint(mu_1.transpose(), 0,
+                               numeric_limits<double>::infinity(),
+                               {lambda_c.segment(kSpaceDim * j + 2, 1),
+                                lambda_c.segment(kSpaceDim * j + 1, 1)});
+      prog.AddLinearConstraint(one.transpose(), 0,
+                               numeric_limits<double>::infinity(),
+                               lambda_c.segment(kSpaceDim * j + 2, 1));
     }
   }
   // 5. Input constraint
   if (with_input_constraints_) {
-    prog_->AddLinearConstraint(MatrixXd::Identity(n_u_, n_u_), u_min_, u_max_,
-                               u_);
+    prog.AddLinearConstraint(MatrixXd::Identity(n_u_, n_u_), u_min_, u_max_,
+                             u);
   }
   // No joint position constraint in this implementation
 
   // Add costs
   // 1. input cost
   if (W_input_.size() > 0) {
-    prog_->AddQuadraticCost(W_input_, VectorXd::Zero(n_u_), u_);
+    prog.AddQuadraticCost(W_input_, VectorXd::Zero(n_u_), u);
   }
   // 2. acceleration cost
-  if (W_joint_accel_.size() > 0) {
-    prog_->AddQuadraticCost(W_joint_accel_, VectorXd::Zero(n_v_), dv_);
+  // (In OscFormulation::kReduced, the acceleration cost and the tracking cost
+  // are added to reduced_dv_cost instead.)
+  if (W_joint_accel_.size() > 0 && is_full) {
+    prog.AddQuadraticCost(W_joint_accel_, VectorXd::Zero(n_v_), dv);
   }
   // 3. Soft constraint cost
-  if (w_soft_constraint_ > 0) {
-    prog_->AddQuadraticCost(
-        w_soft_constraint_ * MatrixXd::Identity(n_c_active_, n_c_active_),
-        VectorXd::Zero(n_c_active_), epsilon_);
+  if (w_soft_constraint_ > 0 && n_c_active > 0) {
+    prog.AddQuadraticCost(
+        w_soft_constraint_ * MatrixXd::Identity(n_c_active, n_c_active),
+        VectorXd::Zero(n_c_active), epsilon);
   }
   // 4. Tracking cost
-  for (unsigned int i = 0; i < tracking_data_vec_->size(); i++) {
-    tracking_cost_.push_back(prog_->AddQuadraticCost(MatrixXd::Zero(n_v_, n_v_),
-                                                     VectorXd::Zero(n_v_), dv_)
-                                  .evaluator()
-                                  .get());
+  qp->reduced_dv_cost = nullptr;
+  if (is_full) {
+    for (unsigned int i = 0; i < tracking_data_vec_->size(); i++) {
+      qp->tracking_cost.push_back(
+          prog.AddQuadraticCost(MatrixXd::Zero(n_v_, n_v_),
+                                VectorXd::Zero(n_v_), dv)
+              .evaluator()
+              .get());
+    }
+  } else {
+    qp->reduced_dv_cost =
+        prog.AddQuadraticCost(MatrixXd::Zero(n_z, n_z), VectorXd::Zero(n_z),
+                              {u, lambda_c})
+            .evaluator()
+            .get();
   }
 
   // Max solve duration
-  prog_->SetSolverOption(OsqpSolver().id(), "time_limit", kMaxSolveDuration);
+  prog.SetSolverOption(OsqpSolver::id(), "time_limit", kMaxSolveDuration);
+  // Solution polishing allocates memory inside OSQP
+  prog.SetSolverOption(OsqpSolver::id(), "polish", 0);
+
+  // Set up the solver once. Only the numeric values are updated in each solve.
+  if (make_qp_solver_) {
+    qp->solver = make_qp_solver_();
+  } else {
+    qp->solver = std::make_unique<solvers::FastOsqpSolver>();
+  }
+  qp->solver->InitializeSolver(prog);
+  if (is_full) {
+    qp->dv_start = 0;
+    qp->u_start = qp->dv_start + n_v_;
+    qp->lambda_c_start = qp->u_start + n_u_;
+    qp->lambda_h_start = qp->lambda_c_start + n_c;
+    qp->epsilon_start = qp->lambda_h_start + n_h_;
+  } else {
+    qp->dv_start = -1;
+    qp->u_start = 0;
+    qp->lambda_c_start = qp->u_start + n_u_;
+    qp->lambda_h_start = -1;
+    qp->epsilon_start = qp->lambda_c_start + n_c;
+  }
+  DRAKE_DEMAND(qp->epsilon_start + n_c_active == prog.num_vars());
+
+  // Allocate the buffers of the mode-dependent QP data
+  qp->J_c = MatrixXd::Zero(n_c, n_v_);
+  qp->J_c_active = MatrixXd::Zero(n_c_active, n_v_);
+  qp->JdotV_c_active = VectorXd::Zero(n_c_active);
+  qp->A_dyn = MatrixXd::Zero(n_v_, n_v_ + n_c + n_h_ + n_u_);
+  qp->A_dyn.block(0, n_v_ + n_c + n_h_, n_v_, n_u_) = -B_;
+  int n_c_cols = is_full ? n_v_ : n_z;
+  qp->A_c = MatrixXd::Zero(n_c_active, n_c_cols + n_c_active);
+  qp->A_c.block(0, n_c_cols, n_c_active, n_c_active) =
+      MatrixXd::Identity(n_c_active, n_c_active);
+  qp->b_c = VectorXd::Zero(n_c_active);
+  if (!is_full) {
+    qp->B_z = MatrixXd::Zero(n_v_, n_z);
+    qp->B_z.leftCols(n_u_) = B_;
+    qp->G = MatrixXd::Zero(n_v_, n_z);
+    qp->H = MatrixXd::Zero(n_h_, n_z);
+    qp->J_h_G = MatrixXd::Zero(n_h_, n_z);
+    qp->Q_dv_G = MatrixXd::Zero(n_v_, n_z);
+    qp->Q_z = MatrixXd::Zero(n_z, n_z);
+    qp->b_z = VectorXd::Zero(n_z);
+  }
+
+  return qp;
 }
 
 drake::systems::EventStatus OperationalSpaceControl::DiscreteVariableUpdate(
@@ -407,15 +586,15 @@ drake::systems::EventStatus OperationalSpaceControl::DiscreteVariableUpdate(
     drake::systems::DiscreteValues<double>* discrete_state) const {
   const BasicVector<double>* fsm_output =
       (BasicVector<double>*)this->EvalVectorInput(context, fsm_port_);
-  VectorXd fsm_state = fsm_output->get_value();
+  double fsm_state = fsm_output->get_value()(0);
   const OutputVector<double>* robot_output =
       (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
   double timestamp = robot_output->get_timestamp();
 
   auto prev_fsm_state = discrete_state->get_mutable_vector(prev_fsm_state_idx_)
                             .get_mutable_value();
-  if (fsm_state(0) != prev_fsm_state(0)) {
-    prev_fsm_state(0) = fsm_state(0);
+  if (fsm_state != prev_fsm_state(0)) {
+    prev_fsm_state(0) = fsm_state;
 
     discrete_state->get_mutable_vector(prev_event_time_idx_).get_mutable_value()
         << timestamp;
@@ -423,18 +602,18 @@ drake::systems::EventStatus OperationalSpaceControl::DiscreteVariableUpdate(
   return drake::systems::EventStatus::Succeeded();
 }
 
-VectorXd OperationalSpaceControl::SolveQp(
+const VectorXd& OperationalSpaceControl::SolveQp(
     const VectorXd& x_w_spr, const VectorXd& x_wo_spr,
     const drake::systems::Context<double>& context, double t, int fsm_state,
     double time_since_last_state_switch) const {
-  // Get active contact indices
-  std::set<int> active_contact_set = {};
+  // Get the QP of the active contact mode
+  ContactModeQp* qp = no_contact_qp_.get();
   if (single_contact_mode_) {
-    active_contact_set = contact_indices_map_.at(-1);
+    qp = contact_mode_qps_.at(-1).get();
   } else {
-    auto map_iterator = contact_indices_map_.find(fsm_state);
-    if (map_iterator != contact_indices_map_.end()) {
-      active_contact_set = map_iterator->second;
+    auto map_iterator = contact_mode_qps_.find(fsm_state);
+    if (map_iterator != contact_mode_qps_.end()) {
+      qp = map_iterator->second.get();
     } else {
       static const drake::logging::Warn log_once(const_cast<char*>(
           (std::to_string(fsm_state) +
@@ -442,6 +621,22 @@ VectorXd OperationalSpaceControl::SolveQp(
               .c_str()));
     }
   }
+  const int n_c = qp->n_c;
+  const int n_c_active = qp->n_c_active;
+
+  // Adds the time since the previous call to `stage`
+  std::chrono::steady_clock::time_point stage_start;
+  if (stage_timing_enabled_) {
+    stage_times_.fill(0);
+    stage_start = std::chrono::steady_clock::now();
+  }
+  auto end_stage = [&](Stage stage) {
+    if (!stage_timing_enabled_) return;
+    auto now = std::chrono::steady_clock::now();
+    stage_times_[stage] +=
+        std::chrono::duration<double>(now - stage_start).count();
+    stage_start = now;
+  };
 
   // Update context
   SetPositionsIfNew<double>(plant_w_spr_,
@@ -456,140 +651,175 @@ VectorXd OperationalSpaceControl::SolveQp(
   SetVelocitiesIfNew<double>(plant_wo_spr_,
                              x_wo_spr.tail(plant_wo_spr_.num_velocities()),
                              context_wo_spr_);
+  kinematics_cache_->NewTick();
+  end_stage(kContextUpdate);
 
   // Get M, f_cg, B matrices of the manipulator equation
-  MatrixXd B = plant_wo_spr_.MakeActuationMatrix();
-  MatrixXd M(n_v_, n_v_);
-  plant_wo_spr_.CalcMassMatrix(*context_wo_spr_, &M);
-  VectorXd bias(n_v_);
-  plant_wo_spr_.CalcBiasTerm(*context_wo_spr_, &bias);
-  drake::multibody::MultibodyForces<double> f_app(plant_wo_spr_);
-  plant_wo_spr_.CalcForceElementsContribution(*context_wo_spr_, &f_app);
-  VectorXd grav = plant_wo_spr_.CalcGravityGeneralizedForces(*context_wo_spr_);
-  bias = bias - grav;
+  plant_wo_spr_.CalcMassMatrix(*context_wo_spr_, &M_);
+  plant_wo_spr_.CalcBiasTerm(*context_wo_spr_, &bias_);
+  plant_wo_spr_.CalcForceElementsContribution(*context_wo_spr_, f_app_.get());
+  bias_ -= plant_wo_spr_.CalcGravityGeneralizedForces(*context_wo_spr_);
   // TODO (yangwill): Characterize damping in cassie model
-  //  bias = bias - f_app.generalized_forces();
+  //  bias_ = bias_ - f_app_->generalized_forces();
+  end_stage(kDynamics);
 
-  // Get J and JdotV for holonomic constraint
-  MatrixXd J_h(n_h_, n_v_);
-  VectorXd JdotV_h(n_h_);
+  // Get J and JdotV for holonomic constraint. The holonomic constraints and
+  // the contacts share the kinematics of their bodies.
+  body_kinematics_.Reset(plant_wo_spr_, *context_wo_spr_);
   if (kinematic_evaluators_ != nullptr) {
-    J_h = kinematic_evaluators_->EvalFullJacobian(*context_wo_spr_);
-    JdotV_h =
-        kinematic_evaluators_->EvalFullJacobianDotTimesV(*context_wo_spr_);
-  }
-
-  // Get J for external forces in equations of motion
-  MatrixXd J_c = MatrixXd::Zero(n_c_, n_v_);
-  for (unsigned int i = 0; i < all_contacts_.size(); i++) {
-    if (active_contact_set.find(i) != active_contact_set.end()) {
-      J_c.block(kSpaceDim * i, 0, kSpaceDim, n_v_) =
-          all_contacts_[i]->EvalFullJacobian(*context_wo_spr_);
-    }
+    kinematic_evaluators_->EvalFullJacobianAndJdotV(
+        *context_wo_spr_, &J_h_, &JdotV_h_, &body_kinematics_,
+        &kinematic_workspace_);
   }
 
   // Get J and JdotV for contact constraint
-  MatrixXd J_c_active = MatrixXd::Zero(n_c_active_, n_v_);
-  VectorXd JdotV_c_active = VectorXd::Zero(n_c_active_);
   int row_idx = 0;
-  for (unsigned int i = 0; i < all_contacts_.size(); i++) {
-    auto contact_i = all_contacts_[i];
-    if (active_contact_set.find(i) != active_contact_set.end()) {
-      // We don't call EvalActiveJacobian() because it'll repeat the computation
-      // of the Jacobian. (J_c_active is just a stack of slices of J_c)
-      for (int j = 0; j < contact_i->num_active(); j++) {
-        J_c_active.row(row_idx + j) =
-            J_c.row(kSpaceDim * i + contact_i->active_inds().at(j));
-      }
-      JdotV_c_active.segment(row_idx, contact_i->num_active()) =
-          contact_i->EvalActiveJacobianDotTimesV(*context_wo_spr_);
+  Eigen::Vector3d JdotV_c_k;
+  for (unsigned int k = 0; k < qp->contact_indices.size(); k++) {
+    auto contact_k = all_contacts_[qp->contact_indices[k]];
+    auto J_c_k = qp->J_c.block(kSpaceDim * k, 0, kSpaceDim, n_v_);
+    contact_k->EvalFullJacobianAndJdotV(*context_wo_spr_, &body_kinematics_,
+                                        &J_c_k, &JdotV_c_k,
+                                        &kinematic_workspace_);
+    // We don't call EvalActiveJacobianAndJdotV() because it'll repeat the
+    // computation of the Jacobian. (J_c_active is just a stack of slices of
+    // J_c)
+    for (int j = 0; j < contact_k->num_active(); j++) {
+      qp->J_c_active.row(row_idx + j) =
+          qp->J_c.row(kSpaceDim * k + contact_k->active_inds().at(j));
+      qp->JdotV_c_active(row_idx + j) =
+          JdotV_c_k(contact_k->active_inds().at(j));
     }
-    row_idx += contact_i->num_active();
+    row_idx += contact_k->num_active();
   }
+  end_stage(kContactJacobians);
 
   // Update constraints
-  // 1. Dynamics constraint
-  ///    M*dv + bias == J_c^T*lambda_c + J_h^T*lambda_h + B*u
-  /// -> M*dv - J_c^T*lambda_c - J_h^T*lambda_h - B*u == - bias
-  /// -> [M, -J_c^T, -J_h^T, -B]*[dv, lambda_c, lambda_h, u]^T = - bias
-  MatrixXd A_dyn = MatrixXd::Zero(n_v_, n_v_ + n_c_ + n_h_ + n_u_);
-  A_dyn.block(0, 0, n_v_, n_v_) = M;
-  A_dyn.block(0, n_v_, n_v_, n_c_) = -J_c.transpose();
-  A_dyn.block(0, n_v_ + n_c_, n_v_, n_h_) = -J_h.transpose();
-  A_dyn.block(0, n_v_ + n_c_ + n_h_, n_v_, n_u_) = -B;
-  dynamics_constraint_->UpdateCoefficients(A_dyn, -bias);
-  // 2. Holonomic constraint
-  ///    JdotV_h + J_h*dv == 0
-  /// -> J_h*dv == -JdotV_h
-  holonomic_constraint_->UpdateCoefficients(J_h, -JdotV_h);
-  // 3. Contact constraint
-  if (!all_contacts_.empty()) {
-    if (w_soft_constraint_ <= 0) {
-      ///    JdotV_c_active + J_c_active*dv == 0
-      /// -> J_c_active*dv == -JdotV_c_active
-      contact_constraints_->UpdateCoefficients(J_c_active, -JdotV_c_active);
-    } else {
-      // Relaxed version:
-      ///    JdotV_c_active + J_c_active*dv == -epsilon
-      /// -> J_c_active*dv + I*epsilon == -JdotV_c_active
-      /// -> [J_c_active, I]* [dv, epsilon]^T == -JdotV_c_active
-      MatrixXd A_c = MatrixXd::Zero(n_c_active_, n_v_ + n_c_active_);
-      A_c.block(0, 0, n_c_active_, n_v_) = J_c_active;
-      A_c.block(0, n_v_, n_c_active_, n_c_active_) =
-          MatrixXd::Identity(n_c_active_, n_c_active_);
-      contact_constraints_->UpdateCoefficients(A_c, -JdotV_c_active);
+  if (formulation_ == OscFormulation::kFull) {
+    // 1. Dynamics constraint
+    ///    M*dv + bias == J_c^T*lambda_c + J_h^T*lambda_h + B*u
+    /// -> M*dv - J_c^T*lambda_c - J_h^T*lambda_h - B*u == - bias
+    /// -> [M, -J_c^T, -J_h^T, -B]*[dv, lambda_c, lambda_h, u]^T = - bias
+    /// (J_c and lambda_c only contain the active contacts. The block of B is
+    /// constant and is set in Build())
+    kernels_.dynamics_constraint(M_, qp->J_c, J_h_, &qp->A_dyn);
+    b_dyn_ = -bias_;
+    qp->dynamics_constraint->UpdateCoefficients(qp->A_dyn, b_dyn_);
+    // 2. Holonomic constraint
+    ///    JdotV_h + J_h*dv == 0
+    /// -> J_h*dv == -JdotV_h
+    b_h_ = -JdotV_h_;
+    qp->holonomic_constraint->UpdateCoefficients(J_h_, b_h_);
+    // 3. Contact constraint
+    if (n_c > 0) {
+      qp->b_c = -qp->JdotV_c_active;
+      if (w_soft_constraint_ <= 0) {
+        ///    JdotV_c_active + J_c_active*dv == 0
+        /// -> J_c_active*dv == -JdotV_c_active
+        qp->contact_constraints->UpdateCoefficients(qp->J_c_active, qp->b_c);
+      } else {
+        // Relaxed version:
+        ///    JdotV_c_active + J_c_active*dv == -epsilon
+        /// -> J_c_active*dv + I*epsilon == -JdotV_c_active
+        /// -> [J_c_active, I]* [dv, epsilon]^T == -JdotV_c_active
+        /// (The identity block is constant and is set in Build())
+        qp->A_c.block(0, 0, n_c_active, n_v_) = qp->J_c_active;
+        qp->contact_constraints->UpdateCoefficients(qp->A_c, qp->b_c);
+      }
     }
-  }
-  // 4. Friction constraint (approximated firction cone)
-  /// For i = active contact indices
-  ///     mu_*lambda_c(3*i+2) >= lambda_c(3*i+0)
-  ///    -mu_*lambda_c(3*i+2) <= lambda_c(3*i+0)
-  ///     mu_*lambda_c(3*i+2) >= lambda_c(3*i+1)
-  ///    -mu_*lambda_c(3*i+2) <= lambda_c(3*i+1)
-  ///         lambda_c(3*i+2) >= 0
-  /// ->
-  ///     mu_*lambda_c(3*i+2) - lambda_c(3*i+0) >= 0
-  ///     mu_*lambda_c(3*i+2) + lambda_c(3*i+0) >= 0
-  ///     mu_*lambda_c(3*i+2) - lambda_c(3*i+1) >= 0
-  ///     mu_*lambda_c(3*i+2) + lambda_c(3*i+1) >= 0
-  ///                           lambda_c(3*i+2) >= 0
-  if (!all_contacts_.empty()) {
-    VectorXd inf_vectorxd(1);
-    inf_vectorxd << numeric_limits<double>::infinity();
-    for (unsigned int i = 0; i < all_contacts_.size(); i++) {
-      if (active_contact_set.find(i) != active_contact_set.end()) {
-        // when the contact is active
-        friction_constraints_.at(5 * i)->UpdateLowerBound(VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 1)->UpdateLowerBound(
-            VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 2)->UpdateLowerBound(
-            VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 3)->UpdateLowerBound(
-            VectorXd::Zero(1));
-        friction_constraints_.at(5 * i + 4)->UpdateLowerBound(
-            VectorXd::Zero(1));
+  } else {
+    // 1. & 2. Eliminate dv and lambda_h
+    /// With z = [u; lambda_c] and B_z = [B, J_c^T], the dynamics and the
+    /// holonomic constraint
+    ///    M*dv + bias == B_z*z + J_h^T*lambda_h
+    ///    J_h*dv + JdotV_h == 0
+    /// give
+    ///    Lambda_h*lambda_h == -J_h*M^-1*(B_z*z - bias) - JdotV_h
+    ///    dv == M^-1*(B_z*z - bias) + M^-1*J_h^T*lambda_h
+    /// where Lambda_h = J_h*M^-1*J_h^T. That is,
+    ///    lambda_h == H*z + h
+    ///    dv == G*z + g
+    /// with
+    ///    H = -Lambda_h^-1*J_h*M^-1*B_z
+    ///    h = -Lambda_h^-1*(J_h*M^-1*(-bias) + JdotV_h)
+    ///    G = M^-1*B_z + M^-1*J_h^T*H = N*M^-1*B_z
+    ///    g = M^-1*(-bias) + M^-1*J_h^T*h
+    /// and N = I - M^-1*J_h^T*Lambda_h^-1*J_h is the dynamically consistent
+    /// null-space projection of J_h.
+    /// (The block of B in B_z is constant and is set in Build())
+    qp->B_z.rightCols(n_c) = qp->J_c.transpose();
+    b_dyn_ = -bias_;
+    M_llt_.compute(M_);
+    qp->G = M_llt_.solve(qp->B_z);
+    g_ = M_llt_.solve(b_dyn_);
+    if (n_h_ > 0) {
+      Minv_J_hT_ = M_llt_.solve(J_h_.transpose());
+      Lambda_h_.noalias() = J_h_ * Minv_J_hT_;
+      Lambda_h_ldlt_.compute(Lambda_h_);
+      qp->J_h_G.noalias() = J_h_ * qp->G;
+      qp->H = Lambda_h_ldlt_.solve(qp->J_h_G);
+      qp->H *= -1;
+      J_h_g_ = JdotV_h_;
+      J_h_g_.noalias() += J_h_ * g_;
+      h_ = Lambda_h_ldlt_.solve(J_h_g_);
+      h_ *= -1;
+      qp->G.noalias() += Minv_J_hT_ * qp->H;
+      g_.noalias() += Minv_J_hT_ * h_;
+    }
+    // 3. Contact constraint
+    ///    JdotV_c_active + J_c_active*(G*z + g) == 0 (or -epsilon)
+    /// -> J_c_active*G*z (+ I*epsilon) == -JdotV_c_active - J_c_active*g
+    /// (The identity block is constant and is set in Build())
+    if (n_c > 0) {
+      int n_z = n_u_ + n_c;
+      qp->A_c.leftCols(n_z).noalias() = qp->J_c_active * qp->G;
+      qp->b_c = -qp->JdotV_c_active;
+      qp->b_c.noalias() -= qp->J_c_active * g_;
+      if (w_soft_constraint_ <= 0) {
+        qp->contact_constraints->UpdateCoefficients(qp->A_c.leftCols(n_z),
+                                                    qp->b_c);
       } else {
-        // when the contact is not active
-        friction_constraints_.at(5 * i)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 1)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 2)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 3)->UpdateLowerBound(-inf_vectorxd);
-        friction_constraints_.at(5 * i + 4)->UpdateLowerBound(-inf_vectorxd);
+        qp->contact_constraints->UpdateCoefficients(qp->A_c, qp->b_c);
       }
     }
   }
+  // 4. Friction constraint (approximated firction cone)
+  /// The friction constraints are constant (see BuildContactModeQp())
+  end_stage(kConstraints);
 
   // Update costs
-  // 4. Tracking cost
+  // 2. acceleration cost and 4. Tracking cost
+  /// In OscFormulation::kReduced, all the costs on dv are accumulated into
+  ///    0.5*dv^T*Q_dv*dv + b_dv^T*dv
+  /// and are mapped to z = [u; lambda_c] after the tracking data update.
+  if (formulation_ == OscFormulation::kReduced) {
+    if (W_joint_accel_.size() > 0) {
+      Q_dv_ = W_joint_accel_;
+    } else {
+      Q_dv_.setZero();
+    }
+    b_dv_.setZero();
+  }
   for (unsigned int i = 0; i < tracking_data_vec_->size(); i++) {
     auto tracking_data = tracking_data_vec_->at(i);
 
+    // Skip the tracking data which are inactive in the current state, without
+    // evaluating their desired trajectories
+    if (!tracking_data->UpdateTrackingFlag(fsm_state)) {
+      if (formulation_ == OscFormulation::kFull) {
+        qp->tracking_cost.at(i)->UpdateCoefficients(zero_Q_tracking_,
+                                                    zero_b_tracking_);
+      }
+      end_stage(kQpUpdate);
+      continue;
+    }
+
     // Check whether or not it is a constant trajectory, and update TrackingData
     if (fixed_position_vec_.at(i).size() != 0) {
-      // Create constant trajectory and update
-      tracking_data->Update(
-          x_w_spr, *context_w_spr_, x_wo_spr, *context_wo_spr_,
-          PiecewisePolynomial<double>(fixed_position_vec_.at(i)), t, fsm_state);
+      // Update with the constant trajectory (constructed in Build())
+      tracking_data->Update(x_w_spr, *context_w_spr_, x_wo_spr,
+                            *context_wo_spr_, fixed_position_traj_vec_.at(i),
+                            t, fsm_state);
     } else {
       // Read in traj from input port
       const string& traj_name = tracking_data->GetName();
@@ -603,8 +833,7 @@ VectorXd OperationalSpaceControl::SolveQp(
       tracking_data->Update(x_w_spr, *context_w_spr_, x_wo_spr,
                             *context_wo_spr_, traj, t, fsm_state);
     }
-    // TODO(yangwill): Should only really be updating the trajectory if it's
-    //  active
+    end_stage(kTrackingData);
     if (tracking_data->IsActive() &&
         time_since_last_state_switch >= t_s_vec_.at(i) &&
         time_since_last_state_switch <= t_e_vec_.at(i)) {
@@ -617,33 +846,127 @@ VectorXd OperationalSpaceControl::SolveQp(
       // We ignore the constant term
       // 0.5 * (JdotV - y_command)^T * W * (JdotV - y_command),
       // since it doesn't change the result of QP.
-      tracking_cost_.at(i)->UpdateCoefficients(
-          J_t.transpose() * W * J_t, J_t.transpose() * W * (JdotV_t - ddy_t));
+      kernels_.tracking_cost(tracking_data->GetYdotDim())(
+          W, J_t, JdotV_t, ddy_t, tracking_cost_buffer_.data(), &Q_tracking_,
+          &b_tracking_);
+      if (formulation_ == OscFormulation::kFull) {
+        qp->tracking_cost.at(i)->UpdateCoefficients(Q_tracking_, b_tracking_);
+      } else {
+        Q_dv_ += Q_tracking_;
+        b_dv_ += b_tracking_;
+      }
+    } else if (formulation_ == OscFormulation::kFull) {
+      qp->tracking_cost.at(i)->UpdateCoefficients(zero_Q_tracking_,
+                                                  zero_b_tracking_);
+    }
+    end_stage(kQpUpdate);
+  }
+  if (formulation_ == OscFormulation::kReduced) {
+    /// 0.5*(G*z + g)^T*Q_dv*(G*z + g) + b_dv^T*(G*z + g)
+    /// = 0.5*z^T*(G^T*Q_dv*G)*z + (G^T*(Q_dv*g + b_dv))^T*z + constant
+    kernels_.reduced_cost(Q_dv_, b_dv_, qp->G, g_, &qp->Q_dv_G, &Q_dv_g_,
+                          &qp->Q_z, &qp->b_z);
+    qp->reduced_dv_cost->UpdateCoefficients(qp->Q_z, qp->b_z);
+  }
+  end_stage(kQpUpdate);
+
+  // Solve the QP (with the time left before the deadline)
+  bool run_solver = true;
+  if (solve_deadline_ > 0) {
+    double time_left =
+        solve_deadline_ - std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - tick_start_)
+                              .count();
+    if (time_left > 0) {
+      qp->solver->SetTimeLimit(time_left);
     } else {
-      tracking_cost_.at(i)->UpdateCoefficients(MatrixXd::Zero(n_v_, n_v_),
-                                               VectorXd::Zero(n_v_));
+      run_solver = false;
     }
   }
+  if (run_solver) {
+    solution_result_ = qp->solver->Solve(*qp->prog);
+    solve_time_ = qp->solver->solve_time();
+    setup_time_ = qp->solver->setup_time();
+    num_iterations_ = qp->solver->iterations();
+  } else {
+    solution_result_ = SolutionResult::kIterationLimit;
+    solve_time_ = 0;
+    setup_time_ = 0;
+    num_iterations_ = 0;
+  }
+  // The solver measures its setup and solve times itself
+  if (stage_timing_enabled_) {
+    stage_times_[kSolverSetup] = setup_time_;
+    stage_times_[kSolve] = solve_time_;
+    stage_start = std::chrono::steady_clock::now();
+  }
+  used_fallback_ = solution_result_ != SolutionResult::kSolutionFound;
+  if (solve_deadline_ > 0 &&
+      std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                    tick_start_)
+              .count() > solve_deadline_) {
+    num_deadline_misses_++;
+    used_fallback_ = true;
+  }
 
-  // Solve the QP
-  const MathematicalProgramResult result = Solve(*prog_);
-
-  solve_time_ = result.get_solver_details<OsqpSolver>().run_time;
-
-  // Extract solutions
-  *dv_sol_ = result.GetSolution(dv_);
-  *u_sol_ = result.GetSolution(u_);
-  *lambda_c_sol_ = result.GetSolution(lambda_c_);
-  *lambda_h_sol_ = result.GetSolution(lambda_h_);
-  *epsilon_sol_ = result.GetSolution(epsilon_);
+  if (used_fallback_) {
+    // (The rest of the solution is kept from the previous tick)
+    num_consecutive_fallbacks_++;
+    CalcFallbackInput(t);
+  } else {
+    num_consecutive_fallbacks_ = 0;
+    // Extract solutions. The contact forces and the slack variables are mapped
+    // back to all_contacts_ (and are zero for the inactive contacts).
+    const auto& x_sol = qp->solver->primal_solution();
+    *u_sol_ = x_sol.segment(qp->u_start, n_u_);
+    if (formulation_ == OscFormulation::kFull) {
+      *dv_sol_ = x_sol.segment(qp->dv_start, n_v_);
+      *lambda_h_sol_ = x_sol.segment(qp->lambda_h_start, n_h_);
+    } else {
+      // Recover dv and lambda_h from z = [u; lambda_c]
+      const auto z = x_sol.head(n_u_ + n_c);
+      *dv_sol_ = g_;
+      dv_sol_->noalias() += qp->G * z;
+      *lambda_h_sol_ = h_;
+      lambda_h_sol_->noalias() += qp->H * z;
+    }
+    lambda_c_sol_->setZero();
+    epsilon_sol_->setZero();
+    row_idx = 0;
+    for (unsigned int k = 0; k < qp->contact_indices.size(); k++) {
+      int i = qp->contact_indices[k];
+      lambda_c_sol_->segment(kSpaceDim * i, kSpaceDim) =
+          x_sol.segment(qp->lambda_c_start + kSpaceDim * k, kSpaceDim);
+      if (w_soft_constraint_ > 0) {
+        int n_active_i = all_contacts_[i]->num_active();
+        epsilon_sol_->segment(epsilon_start_of_contact_[i], n_active_i) =
+            x_sol.segment(qp->epsilon_start + row_idx, n_active_i);
+        row_idx += n_active_i;
+      }
+    }
 
-  for (auto tracking_data : *tracking_data_vec_) {
-    if (tracking_data->IsActive()) tracking_data->SaveYddotCommandSol(*dv_sol_);
+    for (auto tracking_data : *tracking_data_vec_) {
+      if (tracking_data->IsActive()) {
+        tracking_data->SaveYddotCommandSol(*dv_sol_);
+      }
+    }
+    if (t > t_prev_) {
+      u_prev2_ = u_prev_;
+      t_prev2_ = t_prev_;
+      u_prev_ = *u_sol_;
+      t_prev_ = t;
+    }
+  }
+  end_stage(kSolutionExtraction);
+  if (stage_timing_enabled_) {
+    for (int stage = 0; stage < kNumStages; stage++) {
+      stage_histograms_[stage].Add(stage_times_[stage]);
+    }
   }
 
   // Print QP result
   if (print_tracking_info_) {
-    cout << "\n" << to_string(result.get_solution_result()) << endl;
+    cout << "\n" << to_string(solution_result_) << endl;
     cout << "fsm_state = " << fsm_state << endl;
     cout << "**********************\n";
     cout << "u_sol = " << u_sol_->transpose() << endl;
@@ -700,6 +1023,24 @@ VectorXd OperationalSpaceControl::SolveQp(
   return *u_sol_;
 }
 
+void OperationalSpaceControl::CalcFallbackInput(double t) const {
+  // (There is nothing to extrapolate before the first successful solve)
+  if (fallback_ == OscFallback::kExtrapolatePreviousInput &&
+      num_consecutive_fallbacks_ <= max_extrapolated_steps_ &&
+      std::isfinite(t_prev_)) {
+    *u_sol_ = u_prev_;
+    if (std::isfinite(t_prev2_) && t > t_prev_) {
+      *u_sol_ += (t - t_prev_) / (t_prev_ - t_prev2_) * (u_prev_ - u_prev2_);
+    }
+  } else {
+    // bias_ (the Coriolis and gravity terms) was computed in this tick
+    u_sol_->noalias() = B_pinv_ * bias_;
+    u_sol_->noalias() -=
+        (fallback_damping_ * B_.transpose()) * x_wo_spr_.tail(n_v_);
+  }
+  *u_sol_ = u_sol_->cwiseMax(u_min_).cwiseMin(u_max_);
+}
+
 void OperationalSpaceControl::AssignOscLcmOutput(
     const Context<double>& context, dairlib::lcmt_osc_output* output) const {
   auto state =
@@ -735,6 +1076,11 @@ void OperationalSpaceControl::AssignOscLcmOutput(
 
   lcmt_osc_qp_output qp_output;
   qp_output.solve_time = solve_time_;
+  qp_output.setup_time = setup_time_;
+  qp_output.iterations = num_iterations_;
+  qp_output.solution_result = to_string(solution_result_);
+  qp_output.used_fallback = used_fallback_;
+  qp_output.deadline_misses = num_deadline_misses_;
   qp_output.u_dim = n_u_;
   qp_output.lambda_c_dim = n_c_;
   qp_output.lambda_h_dim = n_h_;
@@ -745,6 +1091,21 @@ void OperationalSpaceControl::AssignOscLcmOutput(
   qp_output.lambda_h_sol = CopyVectorXdToStdVector(*lambda_h_sol_);
   qp_output.dv_sol = CopyVectorXdToStdVector(*dv_sol_);
   qp_output.epsilon_sol = CopyVectorXdToStdVector(*epsilon_sol_);
+  qp_output.num_stages = stage_timing_enabled_ ? kNumStages : 0;
+  qp_output.stage_names.clear();
+  qp_output.stage_times.clear();
+  qp_output.stage_time_p50.clear();
+  qp_output.stage_time_p99.clear();
+  qp_output.stage_time_max.clear();
+  for (int stage = 0; stage < qp_output.num_stages; stage++) {
+    qp_output.stage_names.push_back(kStageNames[stage]);
+    qp_output.stage_times.push_back(stage_times_[stage]);
+    qp_output.stage_time_p50.push_back(
+        stage_histograms_[stage].Percentile(50));
+    qp_output.stage_time_p99.push_back(
+        stage_histograms_[stage].Percentile(99));
+    qp_output.stage_time_max.push_back(stage_histograms_[stage].max());
+  }
   output->qp_output = qp_output;
 
   for (unsigned int i = 0; i < tracking_data_vec_->size(); i++) {
@@ -792,14 +1153,13 @@ void OperationalSpaceControl::AssignOscLcmOutput(
 void OperationalSpaceControl::CalcOptimalInput(
     const drake::systems::Context<double>& context,
     systems::TimestampedVector<double>* control) const {
+  // The deadline of the tick is measured from here
+  tick_start_ = std::chrono::steady_clock::now();
+
   // Read in current state and time
   const OutputVector<double>* robot_output =
       (OutputVector<double>*)this->EvalVectorInput(context, state_port_);
-  VectorXd q_w_spr = robot_output->GetPositions();
-  VectorXd v_w_spr = robot_output->GetVelocities();
-  VectorXd x_w_spr(plant_w_spr_.num_positions() +
-                   plant_w_spr_.num_velocities());
-  x_w_spr << q_w_spr, v_w_spr;
+  x_w_spr_ = robot_output->GetStateBlock();
 
   double timestamp = robot_output->get_timestamp();
   auto current_time = static_cast<double>(timestamp);
@@ -807,29 +1167,30 @@ void OperationalSpaceControl::CalcOptimalInput(
     cout << "\n\ncurrent_time = " << current_time << endl;
   }
 
-  VectorXd x_wo_spr(n_q_ + n_v_);
-  x_wo_spr << map_position_from_spring_to_no_spring_ * q_w_spr,
-      map_velocity_from_spring_to_no_spring_ * v_w_spr;
+  x_wo_spr_.head(n_q_).noalias() = map_position_from_spring_to_no_spring_ *
+                                   x_w_spr_.head(plant_w_spr_.num_positions());
+  x_wo_spr_.tail(n_v_).noalias() = map_velocity_from_spring_to_no_spring_ *
+                                   x_w_spr_.tail(plant_w_spr_.num_velocities());
 
-  VectorXd u_sol(n_u_);
   if (used_with_finite_state_machine_) {
     // Read in finite state machine
     const BasicVector<double>* fsm_output =
         (BasicVector<double>*)this->EvalVectorInput(context, fsm_port_);
-    VectorXd fsm_state = fsm_output->get_value();
+    double fsm_state = fsm_output->get_value()(0);
 
     // Get discrete states
     const auto prev_event_time =
         context.get_discrete_state(prev_event_time_idx_).get_value();
 
-    u_sol = SolveQp(x_w_spr, x_wo_spr, context, current_time, fsm_state(0),
-                    current_time - prev_event_time(0));
+    control->SetDataVector(SolveQp(x_w_spr_, x_wo_spr_, context, current_time,
+                                   fsm_state,
+                                   current_time - prev_event_time(0)));
   } else {
-    u_sol = SolveQp(x_w_spr, x_wo_spr, context, current_time, -1, current_time);
+    control->SetDataVector(SolveQp(x_w_spr_, x_wo_spr_, context, current_time,
+                                   -1, current_time));
   }
 
   // Assign the control input
-  control->SetDataVector(u_sol);
   control->set_timestamp(robot_output->get_timestamp());
 }
 
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -19,9 +23,12 @@
 #include "drake/solvers/osqp_solver.h"
 #include "drake/solvers/solve.h"
 
+#include "common/latency_histogram.h"
 #include "multibody/kinematic/kinematic_evaluator_set.h"
 #include "multibody/kinematic/world_point_evaluator.h"
+#include "solvers/fixed_structure_qp_solver.h"
 #include "systems/controllers/control_utils.h"
+#include "systems/controllers/osc/osc_fixed_size_kernels.h"
 #include "systems/controllers/osc/osc_tracking_data.h"
 #include "systems/framework/output_vector.h"
 
@@ -58,6 +65,18 @@ namespace dairlib::systems::controllers {
 /// If the robot doesn't have any springs, the user can just pass two identical
 /// MultibodyPlants into the constructor.
 
+/// `formulation` selects the decision variables of the QP:
+///  - OscFormulation::kFull (default) solves for [dv, u, lambda_c, lambda_h,
+///    epsilon] subject to the manipulator equation and the holonomic
+///    constraint (equality constraints).
+///  - OscFormulation::kReduced eliminates dv and lambda_h analytically. With
+///    a Cholesky factorization of M and the dynamically consistent null-space
+///    projection of J_h, dv and lambda_h are affine functions of u and
+///    lambda_c, so the QP is only solved over [u, lambda_c, epsilon]. The QP
+///    is smaller and denser, and it doesn't contain any equality constraint
+///    except for the contact constraint. The solutions of both formulations
+///    are the same. (J_h has to have full row rank.)
+
 /// Users define
 ///     costs,
 ///     constraints,
@@ -92,6 +111,21 @@ namespace dairlib::systems::controllers {
 ///      `OperationalSpaceControl`'s input ports to corresponding output ports
 ///      of the trajectory source.
 
+enum class OscFormulation { kFull, kReduced };
+
+/// Command of OSC when the QP misses its deadline or the QP solver fails (see
+/// OperationalSpaceControl::SetSolveDeadline())
+///  - kExtrapolatePreviousInput linearly extrapolates the latest two inputs
+///    which were solved in time (or holds the latest one), for a limited
+///    number of consecutive misses. Past that, and before the first
+///    successful solve, OSC uses kGravityCompensation instead (until a solve
+///    succeeds again).
+///  - kGravityCompensation cancels the gravity and Coriolis terms (in the
+///    least-squares sense through the actuation matrix) and damps the actuated
+///    joints.
+/// Both are saturated at the effort limits.
+enum class OscFallback { kExtrapolatePreviousInput, kGravityCompensation };
+
 class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
  public:
   OperationalSpaceControl(
@@ -100,7 +134,8 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
       drake::systems::Context<double>* context_w_spr,
       drake::systems::Context<double>* context_wo_spr,
       bool used_with_finite_state_machine = true,
-      bool print_tracking_info = false);
+      bool print_tracking_info = false,
+      OscFormulation formulation = OscFormulation::kFull);
 
   const drake::systems::OutputPort<double>& get_osc_output_port() const {
     return this->get_output_port(osc_output_port_);
@@ -155,6 +190,70 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
     return tracking_data_vec_->at(index);
   }
 
+  // QP solver
+  /// Sets the factory of the QP solver, which is called once for the QP of
+  /// each contact mode in Build(). The default solver is FastOsqpSolver (with
+  /// the "time_limit" and "polish" options set by OSC). Must be called before
+  /// Build().
+  void SetQpSolver(
+      std::function<std::unique_ptr<solvers::FixedStructureQpSolver>()>
+          make_solver) {
+    make_qp_solver_ = make_solver;
+  }
+
+  /// Bounds the time of each tick to `deadline` (in seconds), measured from
+  /// the moment OSC reads the robot state. The QP solver gets the time left
+  /// before the deadline as its time limit, and if the solve still misses the
+  /// deadline or doesn't find a solution, OSC outputs the `fallback` command
+  /// instead. `fallback_damping` is the joint damping gain of
+  /// OscFallback::kGravityCompensation. `max_extrapolated_steps` is the number
+  /// of consecutive fallback ticks OscFallback::kExtrapolatePreviousInput
+  /// extrapolates before switching to OscFallback::kGravityCompensation.
+  /// Without a deadline, OSC still outputs the default fallback
+  /// (kExtrapolatePreviousInput) when the QP solver fails.
+  /// The number of deadline misses, whether the latest output is a fallback
+  /// and the latest solution result are published in lcmt_osc_qp_output.
+  void SetSolveDeadline(
+      double deadline,
+      OscFallback fallback = OscFallback::kExtrapolatePreviousInput,
+      double fallback_damping = 0, int max_extrapolated_steps = 5) {
+    DRAKE_DEMAND(deadline > 0);
+    DRAKE_DEMAND(fallback_damping >= 0);
+    DRAKE_DEMAND(max_extrapolated_steps >= 0);
+    solve_deadline_ = deadline;
+    fallback_ = fallback;
+    fallback_damping_ = fallback_damping;
+    max_extrapolated_steps_ = max_extrapolated_steps;
+  }
+  int num_deadline_misses() const { return num_deadline_misses_; }
+
+  // Timing
+  /// Stages of each OSC tick whose durations are measured when the stage
+  /// timing is enabled
+  enum Stage {
+    kContextUpdate = 0,
+    kDynamics,          // mass matrix and bias
+    kContactJacobians,  // contact and holonomic constraint Jacobians
+    kConstraints,       // constraint coefficient updates (and, in
+                        // OscFormulation::kReduced, the elimination of dv and
+                        // lambda_h)
+    kTrackingData,      // tracking data updates
+    kQpUpdate,          // cost coefficient updates
+    kSolverSetup,       // copying the coefficients into the solver
+    kSolve,
+    kSolutionExtraction,
+    kNumStages
+  };
+  /// Enables the per-stage timing of each tick. The durations of the latest
+  /// tick are published in lcmt_osc_qp_output (stage_times), together with the
+  /// running p50/p99/max of each stage. Without it, the stage fields of
+  /// lcmt_osc_qp_output are empty.
+  void EnableStageTiming() { stage_timing_enabled_ = true; }
+  /// Durations of `stage` (in seconds) in the ticks since Build()
+  const LatencyHistogram& GetStageTimeHistogram(Stage stage) const {
+    return stage_histograms_.at(stage);
+  }
+
   // OSC LeafSystem builder
   void Build();
 
@@ -164,11 +263,13 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
   void CheckConstraintSettings();
 
   // Get solution of OSC
-  Eigen::VectorXd SolveQp(const Eigen::VectorXd& x_w_spr,
-                          const Eigen::VectorXd& x_wo_spr,
-                          const drake::systems::Context<double>& context,
-                          double t, int fsm_state,
-                          double time_since_last_state_switch) const;
+  const Eigen::VectorXd& SolveQp(const Eigen::VectorXd& x_w_spr,
+                                 const Eigen::VectorXd& x_wo_spr,
+                                 const drake::systems::Context<double>& context,
+                                 double t, int fsm_state,
+                                 double time_since_last_state_switch) const;
+  // Sets u_sol_ to the fallback command
+  void CalcFallbackInput(double t) const;
 
   // Discrete update that stores the previous state transition time
   drake::systems::EventStatus DiscreteVariableUpdate(
@@ -222,7 +323,8 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
   int n_c_active_;
 
   // Manually specified holonomic constraints (only valid for plants_wo_springs)
-  const multibody::KinematicEvaluatorSet<double>* kinematic_evaluators_;
+  const multibody::KinematicEvaluatorSet<double>* kinematic_evaluators_ =
+      nullptr;
 
   // robot input limits
   Eigen::VectorXd u_min_;
@@ -237,20 +339,107 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
   // floating base model flag
   bool is_quaternion_;
 
-  // MathematicalProgram
-  std::unique_ptr<drake::solvers::MathematicalProgram> prog_;
-  // Decision variables
-  drake::solvers::VectorXDecisionVariable dv_;
-  drake::solvers::VectorXDecisionVariable u_;
-  drake::solvers::VectorXDecisionVariable lambda_c_;
-  drake::solvers::VectorXDecisionVariable lambda_h_;
-  drake::solvers::VectorXDecisionVariable epsilon_;
-  // Cost and constraints
-  drake::solvers::LinearEqualityConstraint* dynamics_constraint_;
-  drake::solvers::LinearEqualityConstraint* holonomic_constraint_;
-  drake::solvers::LinearEqualityConstraint* contact_constraints_;
-  std::vector<drake::solvers::LinearConstraint*> friction_constraints_;
-  std::vector<drake::solvers::QuadraticCost*> tracking_cost_;
+  // Formulation of the QP
+  OscFormulation formulation_;
+
+  // QP of one contact mode. Only the contacts which are active in the mode have
+  // contact force variables, contact constraints and friction constraints, so
+  // that e.g. the QP of a single support phase doesn't carry the variables and
+  // constraints of the swing foot.
+  struct ContactModeQp {
+    // Indices (into all_contacts_) of the active contacts in ascending order
+    std::vector<int> contact_indices;
+    // Size of contact forces and active contact constraints of the mode
+    int n_c;
+    int n_c_active;
+
+    // MathematicalProgram
+    std::unique_ptr<drake::solvers::MathematicalProgram> prog;
+    // Persistent solver (the QP structure doesn't change between solves)
+    std::unique_ptr<solvers::FixedStructureQpSolver> solver;
+    // Cost and constraints
+    // (The dynamics constraint, holonomic constraint and tracking costs only
+    // exist in OscFormulation::kFull, and reduced_dv_cost only exists in
+    // OscFormulation::kReduced.)
+    drake::solvers::LinearEqualityConstraint* dynamics_constraint;
+    drake::solvers::LinearEqualityConstraint* holonomic_constraint;
+    drake::solvers::LinearEqualityConstraint* contact_constraints;
+    std::vector<drake::solvers::QuadraticCost*> tracking_cost;
+    drake::solvers::QuadraticCost* reduced_dv_cost;
+
+    // Offsets of the decision variables in the QP solution
+    // (dv_start and lambda_h_start are -1 in OscFormulation::kReduced)
+    int dv_start;
+    int u_start;
+    int lambda_c_start;
+    int lambda_h_start;
+    int epsilon_start;
+
+    // Preallocated buffers of the mode-dependent QP data
+    Eigen::MatrixXd J_c;
+    Eigen::MatrixXd J_c_active;
+    Eigen::VectorXd JdotV_c_active;
+    Eigen::MatrixXd A_dyn;
+    Eigen::MatrixXd A_c;
+    Eigen::VectorXd b_c;
+    // Buffers of OscFormulation::kReduced, where z = [u; lambda_c],
+    // dv = G*z + g and lambda_h = H*z + h
+    Eigen::MatrixXd B_z;  // [B, J_c^T]
+    Eigen::MatrixXd G;
+    Eigen::MatrixXd H;
+    Eigen::MatrixXd J_h_G;
+    Eigen::MatrixXd Q_dv_G;
+    Eigen::MatrixXd Q_z;
+    Eigen::VectorXd b_z;
+  };
+  std::unique_ptr<ContactModeQp> BuildContactModeQp(
+      const std::set<int>& active_contact_set) const;
+
+  // QP of each finite state machine state in contact_indices_map_
+  std::map<int, std::unique_ptr<ContactModeQp>> contact_mode_qps_;
+  // QP of the finite state machine states which have no contacts
+  std::unique_ptr<ContactModeQp> no_contact_qp_;
+  // Start index of each contact of all_contacts_ in epsilon_sol_
+  std::vector<int> epsilon_start_of_contact_;
+
+  // Kinematics queries of the tracking data
+  std::unique_ptr<OscKinematicsCache> kinematics_cache_;
+
+  // Dense kernels of the QP assembly (fixed-size for Cassie's dimensions)
+  OscFixedSizeKernelTable kernels_;
+
+  // Preallocated buffers of SolveQp. They are sized in Build() so that the
+  // control loop doesn't allocate memory (mutable because SolveQp is const).
+  Eigen::MatrixXd B_;
+  std::unique_ptr<drake::multibody::MultibodyForces<double>> f_app_;
+  mutable Eigen::VectorXd x_w_spr_;
+  mutable Eigen::VectorXd x_wo_spr_;
+  mutable Eigen::MatrixXd M_;
+  mutable Eigen::VectorXd bias_;
+  mutable Eigen::MatrixXd J_h_;
+  mutable Eigen::VectorXd JdotV_h_;
+  mutable multibody::BodyKinematics<double> body_kinematics_;
+  mutable multibody::KinematicWorkspace<double> kinematic_workspace_;
+  mutable Eigen::VectorXd b_dyn_;
+  mutable Eigen::VectorXd b_h_;
+  mutable Eigen::MatrixXd Q_tracking_;
+  mutable Eigen::VectorXd b_tracking_;
+  // Scratch space of the dynamically sized tracking cost kernels
+  mutable Eigen::VectorXd tracking_cost_buffer_;
+  Eigen::MatrixXd zero_Q_tracking_;
+  Eigen::VectorXd zero_b_tracking_;
+  // Buffers of OscFormulation::kReduced. Q_dv_ and b_dv_ accumulate all the
+  // costs on dv.
+  mutable Eigen::LLT<Eigen::MatrixXd> M_llt_;
+  mutable Eigen::LDLT<Eigen::MatrixXd> Lambda_h_ldlt_;
+  mutable Eigen::MatrixXd Minv_J_hT_;
+  mutable Eigen::MatrixXd Lambda_h_;
+  mutable Eigen::VectorXd g_;
+  mutable Eigen::VectorXd h_;
+  mutable Eigen::VectorXd J_h_g_;
+  mutable Eigen::MatrixXd Q_dv_;
+  mutable Eigen::VectorXd b_dv_;
+  mutable Eigen::VectorXd Q_dv_g_;
 
   // OSC solution
   std::unique_ptr<Eigen::VectorXd> dv_sol_;
@@ -259,6 +448,39 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
   std::unique_ptr<Eigen::VectorXd> lambda_h_sol_;
   std::unique_ptr<Eigen::VectorXd> epsilon_sol_;
   mutable double solve_time_;
+  mutable double setup_time_;
+  mutable int num_iterations_ = 0;
+
+  // Deadline (see SetSolveDeadline()). Disabled when nonpositive.
+  double solve_deadline_ = 0;
+  OscFallback fallback_ = OscFallback::kExtrapolatePreviousInput;
+  double fallback_damping_ = 0;
+  int max_extrapolated_steps_ = 5;
+  mutable std::chrono::steady_clock::time_point tick_start_;
+  mutable drake::solvers::SolutionResult solution_result_ =
+      drake::solvers::SolutionResult::kSolutionFound;
+  mutable bool used_fallback_ = false;
+  mutable int num_deadline_misses_ = 0;
+  // Number of fallback ticks since the latest successful solve
+  mutable int num_consecutive_fallbacks_ = 0;
+  // The latest two inputs solved in time and their times, for
+  // OscFallback::kExtrapolatePreviousInput (u_prev_ is the latest). The times
+  // are -inf before the first successful solves.
+  mutable Eigen::VectorXd u_prev_;
+  mutable Eigen::VectorXd u_prev2_;
+  mutable double t_prev_ = -std::numeric_limits<double>::infinity();
+  mutable double t_prev2_ = -std::numeric_limits<double>::infinity();
+  // Pseudoinverse of B_, for OscFallback::kGravityCompensation
+  Eigen::MatrixXd B_pinv_;
+
+  // Per-stage timing (see Stage)
+  bool stage_timing_enabled_ = false;
+  mutable std::array<double, kNumStages> stage_times_{};
+  mutable std::vector<LatencyHistogram> stage_histograms_;
+
+  // Factory of the QP solver (FastOsqpSolver if empty)
+  std::function<std::unique_ptr<solvers::FixedStructureQpSolver>()>
+      make_qp_solver_;
 
   // OSC cost members
   /// Using u cost would push the robot away from the fixed point, so the user
@@ -286,6 +508,10 @@ class OperationalSpaceControl : public drake::systems::LeafSystem<double> {
 
   // Fixed position of constant trajectories
   std::vector<Eigen::VectorXd> fixed_position_vec_;
+  // Constant trajectories constructed from fixed_position_vec_ in Build()
+  // (empty for the non-constant trajectories)
+  std::vector<drake::trajectories::PiecewisePolynomial<double>>
+      fixed_position_traj_vec_;
 
   // Set a period during which we apply control (Unit: seconds)
   // Let t be the elapsed time since fsm switched to a new state.
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+
+/// OscFixedSizeKernels contains the dense matrix products of the OSC QP
+/// assembly, with the number of generalized velocities `kNv` (and the output
+/// dimension `kNy` of the tracking data) known at compile time. The inputs and
+/// outputs are the (dynamically sized) buffers of OperationalSpaceControl,
+/// which are mapped to fixed-size matrices, so that the products run on
+/// fixed-size, vectorizable loops and the temporaries live on the stack.
+///
+/// With kNv = Eigen::Dynamic (and kNy = Eigen::Dynamic), the kernels are the
+/// generic versions used for any robot.
+///
+/// OperationalSpaceControl picks the instantiation in Build() (see
+/// OscFixedSizeKernelTable below). The instantiations for Cassie are
+///   kNv = 22 (the plant with springs) and 18 (the plant without springs)
+///   kNy = 1 (JointSpaceTrackingData) and 3 (the other tracking data).
+template <int kNv>
+struct OscFixedSizeKernels {
+  template <int kNy>
+  using JMatrix = Eigen::Matrix<double, kNy, kNv>;
+  template <int kNy>
+  using WMatrix = Eigen::Matrix<double, kNy, kNy>;
+  template <int kNy>
+  using YVector = Eigen::Matrix<double, kNy, 1>;
+  using QMatrix = Eigen::Matrix<double, kNv, kNv>;
+  using DvVector = Eigen::Matrix<double, kNv, 1>;
+  using NvRowsMatrix = Eigen::Matrix<double, kNv, Eigen::Dynamic>;
+
+  /// Tracking cost 0.5*dv^T*Q*dv + b^T*dv of the tracking data with weight
+  /// `W`, Jacobian `J` and command `yddot_command`, i.e.
+  ///   Q = J^T*W*J
+  ///   b = J^T*W*(JdotV - yddot_command)
+  /// `buffer` is the scratch space of the dynamically sized temporaries (it
+  /// must hold at least J.rows()*(J.cols() + 2) entries). Q and b must be sized
+  /// already.
+  template <int kNy>
+  static void CalcTrackingCost(const Eigen::MatrixXd& W,
+                               const Eigen::MatrixXd& J,
+                               const Eigen::VectorXd& JdotV,
+                               const Eigen::VectorXd& yddot_command,
+                               double* buffer, Eigen::MatrixXd* Q,
+                               Eigen::VectorXd* b) {
+    const int n_y = J.rows();
+    const int n_v = J.cols();
+    Eigen::Map<const JMatrix<kNy>> J_map(J.data(), n_y, n_v);
+    Eigen::Map<const WMatrix<kNy>> W_map(W.data(), n_y, n_y);
+    Eigen::Map<const YVector<kNy>> JdotV_map(JdotV.data(), n_y);
+    Eigen::Map<const YVector<kNy>> yddot_command_map(yddot_command.data(),
+                                                      n_y);
+    Eigen::Map<QMatrix> Q_map(Q->data(), n_v, n_v);
+    Eigen::Map<DvVector> b_map(b->data(), n_v);
+
+    if constexpr (kNy != Eigen::Dynamic && kNv != Eigen::Dynamic) {
+      const JMatrix<kNy> WJ = W_map * J_map;
+      const YVector<kNy> W_error = W_map * (JdotV_map - yddot_command_map);
+      Q_map.noalias() = J_map.transpose() * WJ;
+      b_map.noalias() = J_map.transpose() * W_error;
+    } else {
+      Eigen::Map<JMatrix<kNy>> WJ(buffer, n_y, n_v);
+      Eigen::Map<YVector<kNy>> error(buffer + n_y * n_v, n_y);
+      Eigen::Map<YVector<kNy>> W_error(buffer + n_y * (n_v + 1), n_y);
+      WJ.noalias() = W_map * J_map;
+      Q_map.noalias() = J_map.transpose() * WJ;
+      error = JdotV_map - yddot_command_map;
+      W_error.noalias() = W_map * error;
+      b_map.noalias() = J_map.transpose() * W_error;
+    }
+  }
+
+  /// Writes the mode-dependent blocks of the dynamics constraint
+  ///   [M, -J_c^T, -J_h^T, -B]*[dv, lambda_c, lambda_h, u]^T = -bias
+  /// into the leftmost columns of A_dyn (the block of B is constant).
+  static void AssembleDynamicsConstraint(const Eigen::MatrixXd& M,
+                                         const Eigen::MatrixXd& J_c,
+                                         const Eigen::MatrixXd& J_h,
+                                         Eigen::MatrixXd* A_dyn) {
+    const int n_v = M.rows();
+    const int n_c = J_c.rows();
+    const int n_h = J_h.rows();
+    // A_dyn is column-major with n_v rows, so each block of columns is a
+    // contiguous n_v-by-k matrix.
+    Eigen::Map<QMatrix>(A_dyn->data(), n_v, n_v) =
+        Eigen::Map<const QMatrix>(M.data(), n_v, n_v);
+    Eigen::Map<NvRowsMatrix>(A_dyn->data() + n_v * n_v, n_v, n_c) =
+        -J_c.transpose();
+    Eigen::Map<NvRowsMatrix>(A_dyn->data() + n_v * (n_v + n_c), n_v, n_h) =
+        -J_h.transpose();
+  }
+
+  /// Maps the cost 0.5*dv^T*Q_dv*dv + b_dv^T*dv with dv = G*z + g to z, i.e.
+  ///   Q_z = G^T*Q_dv*G
+  ///   b_z = G^T*(Q_dv*g + b_dv)
+  /// (up to a constant). Q_dv_G, Q_dv_g, Q_z and b_z must be sized already.
+  static void CalcReducedCost(const Eigen::MatrixXd& Q_dv,
+                              const Eigen::VectorXd& b_dv,
+                              const Eigen::MatrixXd& G,
+                              const Eigen::VectorXd& g,
+                              Eigen::MatrixXd* Q_dv_G, Eigen::VectorXd* Q_dv_g,
+                              Eigen::MatrixXd* Q_z, Eigen::VectorXd* b_z) {
+    const int n_v = Q_dv.rows();
+    const int n_z = G.cols();
+    Eigen::Map<const QMatrix> Q_dv_map(Q_dv.data(), n_v, n_v);
+    Eigen::Map<const NvRowsMatrix> G_map(G.data(), n_v, n_z);
+    Eigen::Map<NvRowsMatrix> Q_dv_G_map(Q_dv_G->data(), n_v, n_z);
+    Eigen::Map<DvVector> Q_dv_g_map(Q_dv_g->data(), n_v);
+    Q_dv_G_map.noalias() = Q_dv_map * G_map;
+    Q_z->noalias() = G_map.transpose() * Q_dv_G_map;
+    Q_dv_g_map = Eigen::Map<const DvVector>(b_dv.data(), n_v);
+    Q_dv_g_map.noalias() +=
+        Q_dv_map * Eigen::Map<const DvVector>(g.data(), n_v);
+    b_z->noalias() = G_map.transpose() * Q_dv_g_map;
+  }
+};
+
+/// Function pointers to the OscFixedSizeKernels instantiation of a plant
+struct OscFixedSizeKernelTable {
+  using TrackingCostFn = void (*)(const Eigen::MatrixXd&,
+                                  const Eigen::MatrixXd&,
+                                  const Eigen::VectorXd&,
+                                  const Eigen::VectorXd&, double*,
+                                  Eigen::MatrixXd*, Eigen::VectorXd*);
+  using DynamicsConstraintFn = void (*)(const Eigen::MatrixXd&,
+                                        const Eigen::MatrixXd&,
+                                        const Eigen::MatrixXd&,
+                                        Eigen::MatrixXd*);
+  using ReducedCostFn = void (*)(const Eigen::MatrixXd&,
+                                 const Eigen::VectorXd&,
+                                 const Eigen::MatrixXd&,
+                                 const Eigen::VectorXd&, Eigen::MatrixXd*,
+                                 Eigen::VectorXd*, Eigen::MatrixXd*,
+                                 Eigen::VectorXd*);
+
+  // Tracking cost with n_y = 1, 3 and any other n_y
+  TrackingCostFn tracking_cost_1;
+  TrackingCostFn tracking_cost_3;
+  TrackingCostFn tracking_cost_dynamic;
+  DynamicsConstraintFn dynamics_constraint;
+  ReducedCostFn reduced_cost;
+
+  TrackingCostFn tracking_cost(int n_y) const {
+    if (n_y == 1) return tracking_cost_1;
+    if (n_y == 3) return tracking_cost_3;
+    return tracking_cost_dynamic;
+  }
+
+  template <int kNv>
+  static OscFixedSizeKernelTable Make() {
+    using Kernels = OscFixedSizeKernels<kNv>;
+    OscFixedSizeKernelTable table;
+    table.tracking_cost_1 = &Kernels::template CalcTrackingCost<1>;
+    table.tracking_cost_3 = &Kernels::template CalcTrackingCost<3>;
+    table.tracking_cost_dynamic =
+        &Kernels::template CalcTrackingCost<Eigen::Dynamic>;
+    table.dynamics_constraint = &Kernels::AssembleDynamicsConstraint;
+    table.reduced_cost = &Kernels::CalcReducedCost;
+    return table;
+  }
+
+  /// Fixed-size kernels for Cassie's number of velocities (with and without
+  /// springs), and the generic ones otherwise
+  static OscFixedSizeKernelTable ForNumVelocities(int n_v) {
+    switch (n_v) {
+      case 22:
+        return Make<22>();
+      case 18:
+        return Make<18>();
+      default:
+        return Make<Eigen::Dynamic>();
+    }
+  }
+};
+
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,202 @@
+#include "systems/controllers/osc/osc_kinematics_cache.h"
+
+#include "drake/common/drake_assert.h"
+
+using drake::multibody::BodyFrame;
+using drake::multibody::JacobianWrtVariable;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+
+namespace dairlib::systems::controllers {
+
+OscKinematicsCache::OscKinematicsCache(
+    const MultibodyPlant<double>& plant_w_spr,
+    const Context<double>& context_w_spr,
+    const MultibodyPlant<double>& plant_wo_spr,
+    const Context<double>& context_wo_spr) {
+  slots_.push_back({&plant_w_spr, &context_w_spr});
+  if (&plant_w_spr == &plant_wo_spr && &context_w_spr == &context_wo_spr) {
+    wo_spr_slot_ = 0;
+  } else {
+    slots_.push_back({&plant_wo_spr, &context_wo_spr});
+    wo_spr_slot_ = 1;
+  }
+}
+
+int OscKinematicsCache::FindOrAddPointEntry(int slot,
+                                            const BodyFrame<double>& frame,
+                                            const Vector3d& pt_on_body) {
+  for (unsigned int i = 0; i < point_entries_.size(); i++) {
+    const auto& entry = point_entries_[i];
+    if (entry.slot == slot && entry.frame == &frame &&
+        entry.pt_on_body == pt_on_body) {
+      return i;
+    }
+  }
+  PointEntry entry;
+  entry.slot = slot;
+  entry.frame = &frame;
+  entry.pt_on_body = pt_on_body;
+  entry.J_spatial = MatrixXd::Zero(6, slots_[slot].plant->num_velocities());
+  point_entries_.push_back(entry);
+  return point_entries_.size() - 1;
+}
+
+int OscKinematicsCache::AddPointRequest(Model model,
+                                        const BodyFrame<double>& frame,
+                                        const Vector3d& pt_on_body) {
+  DRAKE_DEMAND(!finalized_);
+  return FindOrAddPointEntry(GetSlot(model), frame, pt_on_body);
+}
+
+int OscKinematicsCache::AddRotationRequest(Model model,
+                                           const BodyFrame<double>& frame) {
+  DRAKE_DEMAND(!finalized_);
+  rotation_requests_.push_back({GetSlot(model), &frame});
+  return rotation_requests_.size() - 1;
+}
+
+int OscKinematicsCache::AddCenterOfMassRequest(Model model) {
+  DRAKE_DEMAND(!finalized_);
+  int slot = GetSlot(model);
+  for (unsigned int i = 0; i < com_entries_.size(); i++) {
+    if (com_entries_[i].slot == slot) {
+      return i;
+    }
+  }
+  ComEntry entry;
+  entry.slot = slot;
+  entry.J = MatrixXd::Zero(3, slots_[slot].plant->num_velocities());
+  com_entries_.push_back(entry);
+  return com_entries_.size() - 1;
+}
+
+void OscKinematicsCache::Finalize() {
+  DRAKE_DEMAND(!finalized_);
+  // Attach each rotation request to a point request on the same body, or to
+  // the body origin if there is none
+  for (auto& request : rotation_requests_) {
+    for (unsigned int i = 0; i < point_entries_.size(); i++) {
+      if (point_entries_[i].slot == request.slot &&
+          point_entries_[i].frame == request.frame) {
+        request.point_entry = i;
+        break;
+      }
+    }
+    if (request.point_entry < 0) {
+      request.point_entry =
+          FindOrAddPointEntry(request.slot, *request.frame, Vector3d::Zero());
+    }
+  }
+  finalized_ = true;
+}
+
+void OscKinematicsCache::UpdatePointJacobian(PointEntry* entry) {
+  if (entry->J_tick == tick_) return;
+  const auto& slot = slots_[entry->slot];
+  const auto& world = slot.plant->world_frame();
+  slot.plant->CalcJacobianSpatialVelocity(
+      *slot.context, JacobianWrtVariable::kV, *entry->frame, entry->pt_on_body,
+      world, world, &entry->J_spatial);
+  entry->J_tick = tick_;
+}
+
+void OscKinematicsCache::UpdatePointJdotV(PointEntry* entry) {
+  if (entry->JdotV_tick == tick_) return;
+  const auto& slot = slots_[entry->slot];
+  const auto& world = slot.plant->world_frame();
+  const auto A_bias = slot.plant->CalcBiasSpatialAcceleration(
+      *slot.context, JacobianWrtVariable::kV, *entry->frame,
+      entry->pt_on_body, world, world);
+  entry->JdotV_rotational = A_bias.rotational();
+  entry->JdotV_translational = A_bias.translational();
+  entry->JdotV_tick = tick_;
+}
+
+const Vector3d& OscKinematicsCache::GetPointPosition(int point_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry = point_entries_.at(point_request);
+  if (entry.position_tick != tick_) {
+    const auto& slot = slots_[entry.slot];
+    entry.position =
+        slot.plant->EvalBodyPoseInWorld(*slot.context, entry.frame->body()) *
+        entry.pt_on_body;
+    entry.position_tick = tick_;
+  }
+  return entry.position;
+}
+
+Eigen::Block<const MatrixXd> OscKinematicsCache::GetPointJacobian(
+    int point_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry = point_entries_.at(point_request);
+  UpdatePointJacobian(&entry);
+  const MatrixXd& J_spatial = entry.J_spatial;
+  return J_spatial.bottomRows(3);
+}
+
+const Vector3d& OscKinematicsCache::GetPointJdotV(int point_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry = point_entries_.at(point_request);
+  UpdatePointJdotV(&entry);
+  return entry.JdotV_translational;
+}
+
+Eigen::Block<const MatrixXd> OscKinematicsCache::GetRotationJacobian(
+    int rotation_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry =
+      point_entries_.at(rotation_requests_.at(rotation_request).point_entry);
+  UpdatePointJacobian(&entry);
+  const MatrixXd& J_spatial = entry.J_spatial;
+  return J_spatial.topRows(3);
+}
+
+const Vector3d& OscKinematicsCache::GetRotationJdotV(int rotation_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry =
+      point_entries_.at(rotation_requests_.at(rotation_request).point_entry);
+  UpdatePointJdotV(&entry);
+  return entry.JdotV_rotational;
+}
+
+const Vector3d& OscKinematicsCache::GetCenterOfMassPosition(int com_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry = com_entries_.at(com_request);
+  if (entry.position_tick != tick_) {
+    const auto& slot = slots_[entry.slot];
+    entry.position = slot.plant->CalcCenterOfMassPosition(*slot.context);
+    entry.position_tick = tick_;
+  }
+  return entry.position;
+}
+
+const MatrixXd& OscKinematicsCache::GetCenterOfMassJacobian(int com_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry = com_entries_.at(com_request);
+  if (entry.J_tick != tick_) {
+    const auto& slot = slots_[entry.slot];
+    const auto& world = slot.plant->world_frame();
+    slot.plant->CalcJacobianCenterOfMassTranslationalVelocity(
+        *slot.context, JacobianWrtVariable::kV, world, world, &entry.J);
+    entry.J_tick = tick_;
+  }
+  return entry.J;
+}
+
+const Vector3d& OscKinematicsCache::GetCenterOfMassJdotV(int com_request) {
+  DRAKE_ASSERT(finalized_);
+  auto& entry = com_entries_.at(com_request);
+  if (entry.JdotV_tick != tick_) {
+    const auto& slot = slots_[entry.slot];
+    const auto& world = slot.plant->world_frame();
+    entry.JdotV = slot.plant->CalcBiasCenterOfMassTranslationalAcceleration(
+        *slot.context, JacobianWrtVariable::kV, world, world);
+    entry.JdotV_tick = tick_;
+  }
+  return entry.JdotV;
+}
+
+}  // namespace dairlib::systems::controllers
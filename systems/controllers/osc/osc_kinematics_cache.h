@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <drake/multibody/plant/multibody_plant.h>
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+
+/// OscKinematicsCache is a per-tick registry of the kinematics queries of the
+/// OSC tracking data.
+///
+/// Each tracking data registers its queries (points and frames of bodies, and
+/// the center of mass) once in OperationalSpaceControl::Build(), and gets a
+/// request index back. In the control loop, the requested values are
+/// evaluated on their first access after NewTick() and are shared by all the
+/// tracking data afterwards, so that e.g. the swing foot translation and the
+/// swing toe rotation don't repeat the same Jacobian computation.
+///
+/// Requests are evaluated lazily (instead of all at once at the beginning of
+/// the tick), since the tracking data of the other finite state machine states
+/// are inactive and don't need their kinematics.
+///
+/// Queries are merged as follows:
+///  - point requests on the same body, point and plant share the spatial
+///    Jacobian and the bias spatial acceleration of the point. (The
+///    translational part is the point's, and the rotational part is the
+///    body's.)
+///  - rotation requests on a body share the rotational part of any point
+///    request on the same body and plant (the rotational velocity of a body
+///    doesn't depend on the point).
+///  - if the plants with and without springs (and their contexts) are the same
+///    objects, their requests are merged as well.
+class OscKinematicsCache {
+ public:
+  enum class Model { kWithSprings, kWithoutSprings };
+
+  OscKinematicsCache(
+      const drake::multibody::MultibodyPlant<double>& plant_w_spr,
+      const drake::systems::Context<double>& context_w_spr,
+      const drake::multibody::MultibodyPlant<double>& plant_wo_spr,
+      const drake::systems::Context<double>& context_wo_spr);
+
+  OscKinematicsCache(const OscKinematicsCache&) = delete;
+  OscKinematicsCache& operator=(const OscKinematicsCache&) = delete;
+
+  /// Requests (before Finalize()). They return the index of the request.
+  /// Position, velocity Jacobian and bias acceleration of the point
+  /// `pt_on_body` (expressed in the body frame) of `frame`'s body
+  int AddPointRequest(Model model,
+                      const drake::multibody::BodyFrame<double>& frame,
+                      const Eigen::Vector3d& pt_on_body);
+  /// Rotational velocity Jacobian and bias acceleration of `frame`'s body
+  int AddRotationRequest(Model model,
+                         const drake::multibody::BodyFrame<double>& frame);
+  /// Position, velocity Jacobian and bias acceleration of the center of mass
+  int AddCenterOfMassRequest(Model model);
+
+  /// Resolves the rotation requests. No request can be added afterwards.
+  void Finalize();
+
+  /// Invalidates the values of the previous tick. Must be called after the
+  /// states of the plant contexts are updated.
+  void NewTick() { tick_++; }
+
+  /// Accessors of the point requests. Everything is expressed in the world
+  /// frame, and the Jacobians are with respect to v.
+  const Eigen::Vector3d& GetPointPosition(int point_request);
+  Eigen::Block<const Eigen::MatrixXd> GetPointJacobian(int point_request);
+  const Eigen::Vector3d& GetPointJdotV(int point_request);
+
+  /// Accessors of the rotation requests
+  Eigen::Block<const Eigen::MatrixXd> GetRotationJacobian(
+      int rotation_request);
+  const Eigen::Vector3d& GetRotationJdotV(int rotation_request);
+
+  /// Accessors of the center of mass requests
+  const Eigen::Vector3d& GetCenterOfMassPosition(int com_request);
+  const Eigen::MatrixXd& GetCenterOfMassJacobian(int com_request);
+  const Eigen::Vector3d& GetCenterOfMassJdotV(int com_request);
+
+  /// Number of distinct point and center of mass queries (after merging)
+  int num_point_entries() const { return point_entries_.size(); }
+  int num_com_entries() const { return com_entries_.size(); }
+
+ private:
+  // Plant and context of a model. Two models which share both the plant and
+  // the context share the slot.
+  struct Slot {
+    const drake::multibody::MultibodyPlant<double>* plant;
+    const drake::systems::Context<double>* context;
+  };
+
+  // Point of a body, with the values of the latest tick in which they were
+  // evaluated
+  struct PointEntry {
+    int slot;
+    const drake::multibody::BodyFrame<double>* frame;
+    Eigen::Vector3d pt_on_body;
+
+    Eigen::Vector3d position;
+    // Spatial Jacobian [rotational; translational]
+    Eigen::MatrixXd J_spatial;
+    Eigen::Vector3d JdotV_rotational;
+    Eigen::Vector3d JdotV_translational;
+    int position_tick = -1;
+    int J_tick = -1;
+    int JdotV_tick = -1;
+  };
+
+  struct RotationRequest {
+    int slot;
+    const drake::multibody::BodyFrame<double>* frame;
+    // Index of the point entry which the request reads from
+    int point_entry = -1;
+  };
+
+  struct ComEntry {
+    int slot;
+    Eigen::Vector3d position;
+    Eigen::MatrixXd J;
+    Eigen::Vector3d JdotV;
+    int position_tick = -1;
+    int J_tick = -1;
+    int JdotV_tick = -1;
+  };
+
+  int GetSlot(Model model) const {
+    return (model == Model::kWithSprings) ? 0 : wo_spr_slot_;
+  }
+  int FindOrAddPointEntry(int slot,
+                          const drake::multibody::BodyFrame<double>& frame,
+                          const Eigen::Vector3d& pt_on_body);
+  void UpdatePointJacobian(PointEntry* entry);
+  void UpdatePointJdotV(PointEntry* entry);
+
+  std::vector<Slot> slots_;
+  int wo_spr_slot_;
+
+  std::vector<PointEntry> point_entries_;
+  std::vector<RotationRequest> rotation_requests_;
+  std::vector<ComEntry> com_entries_;
+
+  bool finalized_ = false;
+  int tick_ = 0;
+};
+
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
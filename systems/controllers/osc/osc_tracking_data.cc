@@ -11,7 +11,6 @@
 using std::cout;
 using std::endl;
 
-using drake::multibody::JacobianWrtVariable;
 using drake::multibody::MultibodyPlant;
 using drake::systems::Context;
 using Eigen::Isometry3d;
@@ -57,19 +56,13 @@ bool OscTrackingData::Update(
   if (track_at_current_state_) {
     // Careful: must update y_des_ before calling UpdateYAndError()
     // Update desired output
-    y_des_ = traj.value(t);
-    if (traj.has_derivative()) {
-      ydot_des_ = traj.EvalDerivative(t, 1);
-      yddot_des_ = traj.EvalDerivative(t, 2);
-    }
-    // TODO (yangwill): Remove this edge case after EvalDerivative has been
-    // implemented for ExponentialPlusPiecewisePolynomial
-    else {
-      ydot_des_ = traj.MakeDerivative(1)->value(t);
-      yddot_des_ = traj.MakeDerivative(2)->value(t);
-    }
+    traj_cache_.Eval(traj, t);
+    y_des_ = traj_cache_.value();
+    ydot_des_ = traj_cache_.first_derivative();
+    yddot_des_ = traj_cache_.second_derivative();
 
     // Update feedback output (Calling virtual methods)
+    DRAKE_DEMAND(kinematics_cache_ != nullptr);
     UpdateYAndError(x_w_spr, context_w_spr);
     UpdateYdotAndError(x_w_spr, context_w_spr);
     UpdateYddotDes();
@@ -77,22 +70,24 @@ bool OscTrackingData::Update(
     UpdateJdotV(x_wo_spr, context_wo_spr);
 
     // Update command output (desired output with pd control)
-    yddot_command_ =
-        yddot_des_converted_ + K_p_ * (error_y_) + K_d_ * (error_ydot_);
+    yddot_command_ = yddot_des_converted_;
+    yddot_command_.noalias() += K_p_ * error_y_;
+    yddot_command_.noalias() += K_d_ * error_ydot_;
   }
   return track_at_current_state_;
 }
 
-void OscTrackingData::UpdateTrackingFlag(int finite_state_machine_state) {
+bool OscTrackingData::UpdateTrackingFlag(int finite_state_machine_state) {
   if (state_.empty()) {
     track_at_current_state_ = true;
     state_idx_ = 0;
-    return;
+    return track_at_current_state_;
   }
 
   auto it = find(state_.begin(), state_.end(), finite_state_machine_state);
   state_idx_ = std::distance(state_.begin(), it);
   track_at_current_state_ = it != state_.end();
+  return track_at_current_state_;
 }
 
 void OscTrackingData::PrintFeedbackAndDesiredValues(const VectorXd& dv) {
@@ -112,7 +107,8 @@ void OscTrackingData::PrintFeedbackAndDesiredValues(const VectorXd& dv) {
 
 void OscTrackingData::SaveYddotCommandSol(const VectorXd& dv) {
   DRAKE_ASSERT(track_at_current_state_);
-  yddot_command_sol_ = J_ * dv + JdotV_;
+  yddot_command_sol_ = JdotV_;
+  yddot_command_sol_.noalias() += J_ * dv;
 }
 
 void OscTrackingData::AddState(int state) {
@@ -123,6 +119,11 @@ void OscTrackingData::AddState(int state) {
   state_.push_back(state);
 }
 
+void OscTrackingData::RegisterKinematicsRequests(OscKinematicsCache* cache) {
+  kinematics_cache_ = cache;
+  AddKinematicsRequests();
+}
+
 // Run this function in OSC constructor to make sure that users constructed
 // OscTrackingData correctly.
 void OscTrackingData::CheckOscTrackingData() {
@@ -151,17 +152,15 @@ void ComTrackingData::AddStateToTrack(int state) { AddState(state); }
 
 void ComTrackingData::UpdateYAndError(const VectorXd& x_w_spr,
                                       const Context<double>& context_w_spr) {
-  y_ = plant_w_spr_.CalcCenterOfMassPosition(context_w_spr);
+  y_ = kinematics_cache_->GetCenterOfMassPosition(com_request_w_spr_);
   error_y_ = y_des_ - y_;
 }
 
 void ComTrackingData::UpdateYdotAndError(const VectorXd& x_w_spr,
                                          const Context<double>& context_w_spr) {
-  MatrixXd J_w_spr(kSpaceDim, plant_w_spr_.num_velocities());
-  plant_w_spr_.CalcJacobianCenterOfMassTranslationalVelocity(
-      context_w_spr, JacobianWrtVariable::kV, world_w_spr_, world_w_spr_,
-      &J_w_spr);
-  ydot_ = J_w_spr * x_w_spr.tail(plant_w_spr_.num_velocities());
+  ydot_.noalias() =
+      kinematics_cache_->GetCenterOfMassJacobian(com_request_w_spr_) *
+      x_w_spr.tail(plant_w_spr_.num_velocities());
   error_ydot_ = ydot_des_ - ydot_;
 }
 
@@ -169,19 +168,23 @@ void ComTrackingData::UpdateYddotDes() { yddot_des_converted_ = yddot_des_; }
 
 void ComTrackingData::UpdateJ(const VectorXd& x_wo_spr,
                               const Context<double>& context_wo_spr) {
-  J_ = MatrixXd::Zero(kSpaceDim, plant_wo_spr_.num_velocities());
-  plant_wo_spr_.CalcJacobianCenterOfMassTranslationalVelocity(
-      context_wo_spr, JacobianWrtVariable::kV, world_w_spr_, world_w_spr_, &J_);
+  J_ = kinematics_cache_->GetCenterOfMassJacobian(com_request_wo_spr_);
 }
 
 void ComTrackingData::UpdateJdotV(const VectorXd& x_wo_spr,
                                   const Context<double>& context_wo_spr) {
-  JdotV_ = plant_wo_spr_.CalcBiasCenterOfMassTranslationalAcceleration(
-      context_wo_spr, JacobianWrtVariable::kV, world_wo_spr_, world_wo_spr_);
+  JdotV_ = kinematics_cache_->GetCenterOfMassJdotV(com_request_wo_spr_);
 }
 
 void ComTrackingData::CheckDerivedOscTrackingData() {}
 
+void ComTrackingData::AddKinematicsRequests() {
+  com_request_w_spr_ = kinematics_cache_->AddCenterOfMassRequest(
+      OscKinematicsCache::Model::kWithSprings);
+  com_request_wo_spr_ = kinematics_cache_->AddCenterOfMassRequest(
+      OscKinematicsCache::Model::kWithoutSprings);
+}
+
 /**** TaskSpaceTrackingData ****/
 TaskSpaceTrackingData::TaskSpaceTrackingData(
     const string& name, int n_y, int n_ydot, const MatrixXd& K_p,
@@ -228,12 +231,9 @@ void TransTaskSpaceTrackingData::UpdateYAndError(
 
 void TransTaskSpaceTrackingData::UpdateYdotAndError(
     const VectorXd& x_w_spr, const Context<double>& context_w_spr) {
-  MatrixXd J(kSpaceDim, plant_w_spr_.num_velocities());
-  plant_w_spr_.CalcJacobianTranslationalVelocity(
-      context_w_spr, JacobianWrtVariable::kV,
-      *body_frames_w_spr_.at(GetStateIdx()), pts_on_body_.at(GetStateIdx()),
-      world_w_spr_, world_w_spr_, &J);
-  ydot_ = J * x_w_spr.tail(plant_w_spr_.num_velocities());
+  ydot_.noalias() = kinematics_cache_->GetPointJacobian(
+                        point_requests_w_spr_.at(GetStateIdx())) *
+                    x_w_spr.tail(plant_w_spr_.num_velocities());
   error_ydot_ = ydot_des_ - ydot_;
 }
 
@@ -243,19 +243,14 @@ void TransTaskSpaceTrackingData::UpdateYddotDes() {
 
 void TransTaskSpaceTrackingData::UpdateJ(
     const VectorXd& x_wo_spr, const Context<double>& context_wo_spr) {
-  J_ = MatrixXd::Zero(kSpaceDim, plant_wo_spr_.num_velocities());
-  plant_wo_spr_.CalcJacobianTranslationalVelocity(
-      context_wo_spr, JacobianWrtVariable::kV,
-      *body_frames_wo_spr_.at(GetStateIdx()), pts_on_body_.at(GetStateIdx()),
-      world_wo_spr_, world_wo_spr_, &J_);
+  J_ = kinematics_cache_->GetPointJacobian(
+      point_requests_wo_spr_.at(GetStateIdx()));
 }
 
 void TransTaskSpaceTrackingData::UpdateJdotV(
     const VectorXd& x_wo_spr, const Context<double>& context_wo_spr) {
-  JdotV_ = plant_wo_spr_.CalcBiasTranslationalAcceleration(
-      context_wo_spr, drake::multibody::JacobianWrtVariable::kV,
-      *body_frames_wo_spr_.at(GetStateIdx()), pts_on_body_.at(GetStateIdx()),
-      world_wo_spr_, world_wo_spr_);
+  JdotV_ = kinematics_cache_->GetPointJdotV(
+      point_requests_wo_spr_.at(GetStateIdx()));
 }
 
 void TransTaskSpaceTrackingData::CheckDerivedOscTrackingData() {
@@ -272,6 +267,19 @@ void TransTaskSpaceTrackingData::CheckDerivedOscTrackingData() {
   }
 }
 
+void TransTaskSpaceTrackingData::AddKinematicsRequests() {
+  point_requests_w_spr_.clear();
+  point_requests_wo_spr_.clear();
+  for (unsigned int i = 0; i < pts_on_body_.size(); i++) {
+    point_requests_w_spr_.push_back(kinematics_cache_->AddPointRequest(
+        OscKinematicsCache::Model::kWithSprings, *body_frames_w_spr_.at(i),
+        pts_on_body_.at(i)));
+    point_requests_wo_spr_.push_back(kinematics_cache_->AddPointRequest(
+        OscKinematicsCache::Model::kWithoutSprings, *body_frames_wo_spr_.at(i),
+        pts_on_body_.at(i)));
+  }
+}
+
 /**** RotTaskSpaceTrackingData ****/
 RotTaskSpaceTrackingData::RotTaskSpaceTrackingData(
     const string& name, const MatrixXd& K_p, const MatrixXd& K_d,
@@ -323,14 +331,9 @@ void RotTaskSpaceTrackingData::UpdateYAndError(
 
 void RotTaskSpaceTrackingData::UpdateYdotAndError(
     const VectorXd& x_w_spr, const Context<double>& context_w_spr) {
-  MatrixXd J_spatial(6, plant_w_spr_.num_velocities());
-  plant_w_spr_.CalcJacobianSpatialVelocity(
-      context_w_spr, JacobianWrtVariable::kV,
-      *body_frames_w_spr_.at(GetStateIdx()),
-      frame_pose_.at(GetStateIdx()).translation(), world_w_spr_, world_w_spr_,
-      &J_spatial);
-  ydot_ = J_spatial.block(0, 0, kSpaceDim, J_spatial.cols()) *
-          x_w_spr.tail(plant_w_spr_.num_velocities());
+  ydot_.noalias() = kinematics_cache_->GetRotationJacobian(
+                        rotation_requests_w_spr_.at(GetStateIdx())) *
+                    x_w_spr.tail(plant_w_spr_.num_velocities());
   // Transform qdot to w
   Quaterniond y_quat_des(y_des_(0), y_des_(1), y_des_(2), y_des_(3));
   Quaterniond dy_quat_des(ydot_des_(0), ydot_des_(1), ydot_des_(2),
@@ -350,24 +353,14 @@ void RotTaskSpaceTrackingData::UpdateYddotDes() {
 
 void RotTaskSpaceTrackingData::UpdateJ(const VectorXd& x_wo_spr,
                                        const Context<double>& context_wo_spr) {
-  MatrixXd J_spatial(6, plant_wo_spr_.num_velocities());
-  plant_wo_spr_.CalcJacobianSpatialVelocity(
-      context_wo_spr, JacobianWrtVariable::kV,
-      *body_frames_wo_spr_.at(GetStateIdx()),
-      frame_pose_.at(GetStateIdx()).translation(), world_wo_spr_, world_wo_spr_,
-      &J_spatial);
-  J_ = J_spatial.block(0, 0, kSpaceDim, J_spatial.cols());
+  J_ = kinematics_cache_->GetRotationJacobian(
+      rotation_requests_wo_spr_.at(GetStateIdx()));
 }
 
 void RotTaskSpaceTrackingData::UpdateJdotV(
     const VectorXd& x_wo_spr, const Context<double>& context_wo_spr) {
-  JdotV_ = plant_wo_spr_
-               .CalcBiasSpatialAcceleration(
-                   context_wo_spr, JacobianWrtVariable::kV,
-                   *body_frames_wo_spr_.at(GetStateIdx()),
-                   frame_pose_.at(GetStateIdx()).translation(), world_wo_spr_,
-                   world_wo_spr_)
-               .rotational();
+  JdotV_ = kinematics_cache_->GetRotationJdotV(
+      rotation_requests_wo_spr_.at(GetStateIdx()));
 }
 
 void RotTaskSpaceTrackingData::CheckDerivedOscTrackingData() {
@@ -384,6 +377,20 @@ void RotTaskSpaceTrackingData::CheckDerivedOscTrackingData() {
   }
 }
 
+void RotTaskSpaceTrackingData::AddKinematicsRequests() {
+  // (The rotational velocity of the frame doesn't depend on its offset from
+  // the body origin)
+  rotation_requests_w_spr_.clear();
+  rotation_requests_wo_spr_.clear();
+  for (unsigned int i = 0; i < frame_pose_.size(); i++) {
+    rotation_requests_w_spr_.push_back(kinematics_cache_->AddRotationRequest(
+        OscKinematicsCache::Model::kWithSprings, *body_frames_w_spr_.at(i)));
+    rotation_requests_wo_spr_.push_back(kinematics_cache_->AddRotationRequest(
+        OscKinematicsCache::Model::kWithoutSprings,
+        *body_frames_wo_spr_.at(i)));
+  }
+}
+
 /**** JointSpaceTrackingData ****/
 JointSpaceTrackingData::JointSpaceTrackingData(
     const string& name, const MatrixXd& K_p, const MatrixXd& K_d,
@@ -418,9 +425,9 @@ void JointSpaceTrackingData::UpdateYAndError(
 
 void JointSpaceTrackingData::UpdateYdotAndError(
     const VectorXd& x_w_spr, const Context<double>& context_w_spr) {
-  MatrixXd J = MatrixXd::Zero(1, plant_w_spr_.num_velocities());
-  J(0, joint_vel_idx_w_spr_.at(GetStateIdx())) = 1;
-  ydot_ = J * x_w_spr.tail(plant_w_spr_.num_velocities());
+  ydot_ = x_w_spr.segment(
+      plant_w_spr_.num_positions() + joint_vel_idx_w_spr_.at(GetStateIdx()),
+      1);
   error_ydot_ = ydot_des_ - ydot_;
 }
 
@@ -6,6 +6,8 @@
 #include <drake/common/trajectories/trajectory.h>
 #include <drake/multibody/plant/multibody_plant.h>
 
+#include "systems/controllers/osc/osc_kinematics_cache.h"
+#include "systems/controllers/osc/trajectory_eval_cache.h"
 #include "systems/framework/output_vector.h"
 
 namespace dairlib {
@@ -91,6 +93,12 @@ class OscTrackingData {
               const drake::trajectories::Trajectory<double>& traj, double t,
               int finite_state_machine_state);
 
+  // Updates and returns whether the tracking data is active in
+  // `finite_state_machine_state`. (Update() calls it as well. OSC calls it
+  // beforehand to skip the inactive tracking data without evaluating their
+  // desired trajectories.)
+  bool UpdateTrackingFlag(int finite_state_machine_state);
+
   // Getters for debugging
   const Eigen::VectorXd& GetY() const { return y_; }
   const Eigen::VectorXd& GetYDes() const { return y_des_; }
@@ -127,6 +135,11 @@ class OscTrackingData {
   // correctly.
   void CheckOscTrackingData();
 
+  // Register the kinematics queries in `cache`, which the tracking data reads
+  // the kinematics from in Update(). Must be called after
+  // CheckOscTrackingData().
+  void RegisterKinematicsRequests(OscKinematicsCache* cache);
+
  protected:
   int GetStateIdx() const { return state_idx_; };
   void AddState(int state);
@@ -165,9 +178,10 @@ class OscTrackingData {
   const drake::multibody::BodyFrame<double>& world_w_spr_;
   const drake::multibody::BodyFrame<double>& world_wo_spr_;
 
+  // Kinematics shared by all the tracking data of the OSC
+  OscKinematicsCache* kinematics_cache_ = nullptr;
+
  private:
-  // Check if we should do tracking in the current state
-  void UpdateTrackingFlag(int finite_state_machine_state);
 
   // Updaters of feedback output, jacobian and dJ/dt * v
   virtual void UpdateYAndError(
@@ -188,6 +202,9 @@ class OscTrackingData {
   // correctly.
   virtual void CheckDerivedOscTrackingData() = 0;
 
+  // Add the kinematics queries of the derived class to kinematics_cache_
+  virtual void AddKinematicsRequests() = 0;
+
   // Trajectory name
   std::string name_;
 
@@ -202,6 +219,9 @@ class OscTrackingData {
   // Cost weights
   Eigen::MatrixXd W_;
 
+  // Evaluation of the desired trajectory
+  TrajectoryEvalCache traj_cache_;
+
   // Store whether or not the tracking data is active
   bool track_at_current_state_;
   int state_idx_ = 0;
@@ -234,6 +254,11 @@ class ComTrackingData final : public OscTrackingData {
                    const drake::systems::Context<double>& context_wo_spr) final;
 
   void CheckDerivedOscTrackingData() final;
+  void AddKinematicsRequests() final;
+
+  // Indices of the center of mass requests in kinematics_cache_
+  int com_request_w_spr_;
+  int com_request_wo_spr_;
 };
 
 // TaskSpaceTrackingData is still a virtual class
@@ -297,9 +322,14 @@ class TransTaskSpaceTrackingData final : public TaskSpaceTrackingData {
                    const drake::systems::Context<double>& context_wo_spr) final;
 
   void CheckDerivedOscTrackingData() final;
+  void AddKinematicsRequests() final;
 
   // `pt_on_body` is the position w.r.t. the origin of the body
   std::vector<Eigen::Vector3d> pts_on_body_;
+
+  // Indices of the point requests (of each state) in kinematics_cache_
+  std::vector<int> point_requests_w_spr_;
+  std::vector<int> point_requests_wo_spr_;
 };
 
 /// RotTaskSpaceTrackingData is used when we want to track a trajectory
@@ -345,10 +375,15 @@ class RotTaskSpaceTrackingData final : public TaskSpaceTrackingData {
                    const drake::systems::Context<double>& context_wo_spr) final;
 
   void CheckDerivedOscTrackingData() final;
+  void AddKinematicsRequests() final;
 
   // frame_pose_ represents the pose of the frame (w.r.t. the body's frame)
   // which follows the desired rotation.
   std::vector<Eigen::Isometry3d> frame_pose_;
+
+  // Indices of the rotation requests (of each state) in kinematics_cache_
+  std::vector<int> rotation_requests_w_spr_;
+  std::vector<int> rotation_requests_wo_spr_;
 };
 
 /// JointSpaceTrackingData is used when we want to track a trajectory
@@ -391,6 +426,7 @@ class JointSpaceTrackingData final : public OscTrackingData {
                    const drake::systems::Context<double>& context_wo_spr) final;
 
   void CheckDerivedOscTrackingData() final;
+  void AddKinematicsRequests() final {}
 
   // `joint_pos_idx_wo_spr` is the index of the joint position
   // `joint_vel_idx_wo_spr` is the index of the joint velocity
@@ -0,0 +1,372 @@
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/common/test_utilities/limit_malloc.h"
+#include "drake/multibody/parsing/parser.h"
+#include "common/find_resource.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "solvers/fast_osqp_solver.h"
+#include "systems/controllers/osc/operational_space_control.h"
+#include "systems/framework/output_vector.h"
+
+namespace dairlib::systems::controllers {
+namespace {
+
+using drake::CompareMatrices;
+using drake::multibody::MultibodyPlant;
+using drake::solvers::MathematicalProgram;
+using drake::solvers::SolutionResult;
+using drake::systems::Context;
+using Eigen::Matrix3d;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using multibody::WorldPointEvaluator;
+
+// Forwards to FastOsqpSolver
+class ForwardingQpSolver : public solvers::FixedStructureQpSolver {
+ public:
+  void InitializeSolver(const MathematicalProgram& prog) override {
+    solver_.InitializeSolver(prog);
+  }
+  bool IsInitialized() const override { return solver_.IsInitialized(); }
+  void SetTimeLimit(double time_limit) override {
+    solver_.SetTimeLimit(time_limit);
+  }
+  SolutionResult Solve(const MathematicalProgram& prog) override {
+    return solver_.Solve(prog);
+  }
+  Eigen::Map<const VectorXd> primal_solution() const override {
+    return solver_.primal_solution();
+  }
+  int iterations() const override { return solver_.iterations(); }
+  double setup_time() const override { return solver_.setup_time(); }
+  double solve_time() const override { return solver_.solve_time(); }
+
+ private:
+  solvers::FastOsqpSolver solver_;
+};
+
+// Fails the test if any Solve() but the first one touches the heap
+class MallocCheckedQpSolver final : public ForwardingQpSolver {
+ public:
+  SolutionResult Solve(const MathematicalProgram& prog) final {
+    if (num_solves_++ == 0) {
+      return ForwardingQpSolver::Solve(prog);
+    }
+    drake::test::LimitMalloc guard;
+    return ForwardingQpSolver::Solve(prog);
+  }
+
+ private:
+  int num_solves_ = 0;
+};
+
+// Reports a failure (after solving) while *fail is true
+class FailingQpSolver final : public ForwardingQpSolver {
+ public:
+  explicit FailingQpSolver(const bool* fail) : fail_(fail) {}
+  SolutionResult Solve(const MathematicalProgram& prog) final {
+    SolutionResult result = ForwardingQpSolver::Solve(prog);
+    return *fail_ ? SolutionResult::kSolverSpecificError : result;
+  }
+
+ private:
+  const bool* fail_;
+};
+
+// Appends its index and the number of decision variables of the QP to *log on
+// each Solve()
+class RecordingQpSolver final : public ForwardingQpSolver {
+ public:
+  RecordingQpSolver(int index, std::vector<std::pair<int, int>>* log)
+      : index_(index), log_(log) {}
+  SolutionResult Solve(const MathematicalProgram& prog) final {
+    log_->emplace_back(index_, prog.num_vars());
+    return ForwardingQpSolver::Solve(prog);
+  }
+
+ private:
+  int index_;
+  std::vector<std::pair<int, int>>* log_;
+};
+
+// The planar walker with its base welded to the world (so that the planar
+// joints make up a floating base in the x-z plane)
+class OperationalSpaceControlTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    drake::multibody::Parser(plant_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->WeldFrames(plant_->world_frame(), plant_->GetFrameByName("base"),
+                       drake::math::RigidTransform<double>());
+    plant_->Finalize();
+    context_ = plant_->CreateDefaultContext();
+    n_q_ = plant_->num_positions();
+    n_v_ = plant_->num_velocities();
+    n_u_ = plant_->num_actuators();
+
+    hip_traj_ = MakeHipTrajectory();
+  }
+
+  // Tracking data of the hip angle. (Each OSC needs its own, since Build()
+  // binds the tracking data to the OSC.)
+  std::unique_ptr<JointSpaceTrackingData> MakeHipTrajectory() const {
+    auto hip_traj = std::make_unique<JointSpaceTrackingData>(
+        "hip_traj", 100 * MatrixXd::Identity(1, 1),
+        10 * MatrixXd::Identity(1, 1), MatrixXd::Identity(1, 1), *plant_,
+        *plant_);
+    hip_traj->AddJointToTrack("hip_pin", "hip_pindot");
+    return hip_traj;
+  }
+
+  // Contact of the foot at the end of `lower_leg`, in the x-z plane
+  std::unique_ptr<WorldPointEvaluator<double>> MakeFootContact(
+      const std::string& lower_leg) const {
+    return std::make_unique<WorldPointEvaluator<double>>(
+        *plant_, Vector3d(0, 0, -0.5), plant_->GetFrameByName(lower_leg),
+        Matrix3d::Identity(), Vector3d::Zero(), std::vector<int>({0, 2}));
+  }
+
+  // Sets the robot state and time of `osc_context` and returns the OSC output
+  VectorXd CalcInput(const OperationalSpaceControl& osc,
+                     Context<double>* osc_context, const VectorXd& q,
+                     const VectorXd& v, double t) {
+    OutputVector<double> robot_output(n_q_, n_v_, n_u_);
+    robot_output.SetPositions(q);
+    robot_output.SetVelocities(v);
+    robot_output.SetEfforts(VectorXd::Zero(n_u_));
+    robot_output.set_timestamp(t);
+    osc.get_robot_output_input_port().FixValue(osc_context, robot_output);
+    auto u_output = osc.get_osc_output_port().Allocate();
+    osc.get_osc_output_port().Calc(*osc_context, u_output.get());
+    return u_output->get_value<drake::systems::BasicVector<double>>()
+        .get_value();
+  }
+
+  // The fallback input OscFallback::kGravityCompensation at (q, v)
+  VectorXd CalcGravityCompensation(const VectorXd& q, const VectorXd& v,
+                                   double damping) {
+    auto context = plant_->CreateDefaultContext();
+    plant_->SetPositions(context.get(), q);
+    plant_->SetVelocities(context.get(), v);
+    VectorXd bias(n_v_);
+    plant_->CalcBiasTerm(*context, &bias);
+    bias -= plant_->CalcGravityGeneralizedForces(*context);
+    const MatrixXd B = plant_->MakeActuationMatrix();
+    VectorXd u = B.completeOrthogonalDecomposition().pseudoInverse() * bias;
+    u -= damping * B.transpose() * v;
+    VectorXd u_max(n_u_);
+    for (int i = 0; i < n_u_; i++) {
+      u_max(i) = plant_->get_joint_actuator(
+                           drake::multibody::JointActuatorIndex(i))
+                     .effort_limit();
+    }
+    return u.cwiseMax(-u_max).cwiseMin(u_max);
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<Context<double>> context_;
+  std::unique_ptr<JointSpaceTrackingData> hip_traj_;
+  int n_q_;
+  int n_v_;
+  int n_u_;
+};
+
+// A second tick with the same QP size updates and solves the QP without
+// touching the heap
+TEST_F(OperationalSpaceControlTest, NoSolverHeapAllocationAfterFirstTick) {
+  OperationalSpaceControl osc(*plant_, *plant_, context_.get(), context_.get(),
+                              false, false);
+  osc.SetAccelerationCostForAllJoints(1e-4 * MatrixXd::Identity(n_v_, n_v_));
+  osc.SetInputCost(1e-6 * MatrixXd::Identity(n_u_, n_u_));
+  osc.AddConstTrackingData(hip_traj_.get(), VectorXd::Constant(1, 0.3));
+  osc.SetQpSolver([]() { return std::make_unique<MallocCheckedQpSolver>(); });
+  osc.Build();
+  auto osc_context = osc.CreateDefaultContext();
+
+  CalcInput(osc, osc_context.get(), VectorXd::LinSpaced(n_q_, -0.2, 0.2),
+            VectorXd::Zero(n_v_), 0);
+  // Same problem size, different state
+  const VectorXd u =
+      CalcInput(osc, osc_context.get(), VectorXd::LinSpaced(n_q_, -0.2, 0.2),
+                VectorXd::LinSpaced(n_v_, 0.1, 0.5), 0.001);
+  EXPECT_TRUE(u.allFinite());
+  EXPECT_GT(u.norm(), 0);
+}
+
+// A failed solve outputs the extrapolation of the previous inputs, or the
+// gravity compensation before the first successful solve (even without a
+// deadline)
+TEST_F(OperationalSpaceControlTest, FallbackOnSolverFailure) {
+  OperationalSpaceControl osc(*plant_, *plant_, context_.get(), context_.get(),
+                              false, false);
+  osc.SetAccelerationCostForAllJoints(1e-4 * MatrixXd::Identity(n_v_, n_v_));
+  osc.SetInputCost(1e-6 * MatrixXd::Identity(n_u_, n_u_));
+  osc.AddConstTrackingData(hip_traj_.get(), VectorXd::Constant(1, 0.3));
+  bool fail = true;
+  osc.SetQpSolver(
+      [&fail]() { return std::make_unique<FailingQpSolver>(&fail); });
+  osc.Build();
+  auto osc_context = osc.CreateDefaultContext();
+  const VectorXd q = VectorXd::LinSpaced(n_q_, -0.2, 0.2);
+  const VectorXd v = VectorXd::Zero(n_v_);
+
+  VectorXd u = CalcInput(osc, osc_context.get(), q, v, 0);
+  EXPECT_TRUE(CompareMatrices(u, CalcGravityCompensation(q, v, 0), 1e-10));
+
+  fail = false;
+  const VectorXd u_1 = CalcInput(osc, osc_context.get(), q, v, 0.001);
+  const VectorXd u_2 = CalcInput(osc, osc_context.get(), 1.1 * q, v, 0.002);
+  EXPECT_FALSE(CompareMatrices(u_1, u_2, 1e-6));
+
+  fail = true;
+  u = CalcInput(osc, osc_context.get(), 1.2 * q, v, 0.004);
+  EXPECT_TRUE(CompareMatrices(u, u_2 + 2 * (u_2 - u_1), 1e-10));
+  EXPECT_EQ(osc.num_deadline_misses(), 0);
+}
+
+// A tick which misses the deadline outputs the fallback input
+TEST_F(OperationalSpaceControlTest, FallbackOnDeadlineMiss) {
+  OperationalSpaceControl osc(*plant_, *plant_, context_.get(), context_.get(),
+                              false, false);
+  osc.SetAccelerationCostForAllJoints(1e-4 * MatrixXd::Identity(n_v_, n_v_));
+  osc.SetInputCost(1e-6 * MatrixXd::Identity(n_u_, n_u_));
+  osc.AddConstTrackingData(hip_traj_.get(), VectorXd::Constant(1, 0.3));
+  const double damping = 2;
+  osc.SetSolveDeadline(1e-12, OscFallback::kGravityCompensation, damping);
+  osc.Build();
+  auto osc_context = osc.CreateDefaultContext();
+  const VectorXd q = VectorXd::LinSpaced(n_q_, -0.2, 0.2);
+  const VectorXd v = VectorXd::LinSpaced(n_v_, 0.1, 0.5);
+
+  const VectorXd u = CalcInput(osc, osc_context.get(), q, v, 0);
+  EXPECT_EQ(osc.num_deadline_misses(), 1);
+  EXPECT_TRUE(
+      CompareMatrices(u, CalcGravityCompensation(q, v, damping), 1e-10));
+}
+
+// OscFormulation::kReduced solves the same problem as OscFormulation::kFull
+TEST_F(OperationalSpaceControlTest, ReducedFormulationMatchesFull) {
+  auto left_foot = MakeFootContact("left_lower_leg");
+  std::vector<std::unique_ptr<JointSpaceTrackingData>> hip_trajs;
+  std::vector<std::unique_ptr<OperationalSpaceControl>> oscs;
+  for (auto formulation : {OscFormulation::kFull, OscFormulation::kReduced}) {
+    hip_trajs.push_back(MakeHipTrajectory());
+    oscs.push_back(std::make_unique<OperationalSpaceControl>(
+        *plant_, *plant_, context_.get(), context_.get(), false, false,
+        formulation));
+    auto& osc = *oscs.back();
+    osc.SetAccelerationCostForAllJoints(1e-2 * MatrixXd::Identity(n_v_, n_v_));
+    osc.SetInputCost(1e-3 * MatrixXd::Identity(n_u_, n_u_));
+    osc.AddContactPoint(left_foot.get());
+    osc.SetContactFriction(0.8);
+    osc.AddConstTrackingData(hip_trajs.back().get(),
+                             VectorXd::Constant(1, 0.3));
+    osc.Build();
+  }
+  auto full_context = oscs[0]->CreateDefaultContext();
+  auto reduced_context = oscs[1]->CreateDefaultContext();
+
+  for (double scale : {1.0, -0.5}) {
+    const VectorXd q = scale * VectorXd::LinSpaced(n_q_, -0.2, 0.2);
+    const VectorXd v = scale * VectorXd::LinSpaced(n_v_, 0.1, 0.5);
+    const VectorXd u_full = CalcInput(*oscs[0], full_context.get(), q, v, 0);
+    const VectorXd u_reduced =
+        CalcInput(*oscs[1], reduced_context.get(), q, v, 0);
+    EXPECT_GT(u_full.norm(), 0);
+    EXPECT_TRUE(CompareMatrices(u_reduced, u_full, 1e-3)) << scale;
+  }
+}
+
+// Each finite state machine state solves the QP of its contact mode, which
+// gives the same input as an OSC with only the contacts of that mode
+TEST_F(OperationalSpaceControlTest, ContactModeQpPerState) {
+  auto left_foot = MakeFootContact("left_lower_leg");
+  auto right_foot = MakeFootContact("right_lower_leg");
+  const std::vector<const WorldPointEvaluator<double>*> stance_foot = {
+      left_foot.get(), right_foot.get()};
+  // The solvers are made in Build(), in the order of the states (and then
+  // for the states without contacts)
+  const auto make_recording_solver =
+      [](std::vector<std::pair<int, int>>* log) {
+        auto num_solvers = std::make_shared<int>(0);
+        return [log, num_solvers]() {
+          return std::make_unique<RecordingQpSolver>((*num_solvers)++, log);
+        };
+      };
+  const auto configure = [this](OperationalSpaceControl* osc,
+                                JointSpaceTrackingData* hip_traj) {
+    osc->SetAccelerationCostForAllJoints(1e-2 *
+                                         MatrixXd::Identity(n_v_, n_v_));
+    osc->SetInputCost(1e-3 * MatrixXd::Identity(n_u_, n_u_));
+    osc->SetContactFriction(0.8);
+    osc->AddConstTrackingData(hip_traj, VectorXd::Constant(1, 0.3));
+  };
+
+  // Left stance in state 0 and right stance in state 1
+  auto hip_traj = MakeHipTrajectory();
+  OperationalSpaceControl osc(*plant_, *plant_, context_.get(), context_.get(),
+                              true, false);
+  configure(&osc, hip_traj.get());
+  for (int state : {0, 1}) {
+    osc.AddStateAndContactPoint(state, stance_foot[state]);
+  }
+  std::vector<std::pair<int, int>> log;
+  osc.SetQpSolver(make_recording_solver(&log));
+  osc.Build();
+  auto osc_context = osc.CreateDefaultContext();
+
+  // The same stances without the finite state machine
+  std::vector<std::unique_ptr<JointSpaceTrackingData>> single_hip_trajs;
+  std::vector<std::unique_ptr<OperationalSpaceControl>> single_oscs;
+  std::vector<std::unique_ptr<Context<double>>> single_contexts;
+  std::vector<std::pair<int, int>> single_log;
+  for (int state : {0, 1}) {
+    single_hip_trajs.push_back(MakeHipTrajectory());
+    single_oscs.push_back(std::make_unique<OperationalSpaceControl>(
+        *plant_, *plant_, context_.get(), context_.get(), false, false));
+    configure(single_oscs.back().get(), single_hip_trajs.back().get());
+    single_oscs.back()->AddContactPoint(stance_foot[state]);
+    single_oscs.back()->SetQpSolver(make_recording_solver(&single_log));
+    single_oscs.back()->Build();
+    single_contexts.push_back(single_oscs.back()->CreateDefaultContext());
+  }
+
+  const VectorXd q = VectorXd::LinSpaced(n_q_, -0.2, 0.2);
+  const VectorXd v = VectorXd::LinSpaced(n_v_, 0.1, 0.5);
+  double t = 0;
+  for (int state : {0, 1, 0}) {
+    osc.get_fsm_input_port().FixValue(
+        osc_context.get(),
+        drake::systems::BasicVector<double>(VectorXd::Constant(1, state)));
+    const VectorXd u = CalcInput(osc, osc_context.get(), q, v, t);
+    const VectorXd u_single =
+        CalcInput(*single_oscs[state], single_contexts[state].get(), q, v, t);
+    t += 0.001;
+
+    ASSERT_FALSE(log.empty());
+    ASSERT_FALSE(single_log.empty());
+    EXPECT_EQ(log.back().first, state);
+    EXPECT_EQ(log.back().second, single_log.back().second);
+    EXPECT_GT(u.norm(), 0);
+    EXPECT_TRUE(CompareMatrices(u, u_single, 1e-3)) << state;
+  }
+  // One solve per tick
+  EXPECT_EQ(log.size(), 3u);
+}
+
+}  // namespace
+}  // namespace dairlib::systems::controllers
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,119 @@
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "systems/controllers/osc/osc_fixed_size_kernels.h"
+
+namespace dairlib::systems::controllers {
+namespace {
+
+using drake::CompareMatrices;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+// The fixed-size kernels of the numbers of velocities of Cassie (with and
+// without springs) give the same results as the dynamic-size ones
+class OscFixedSizeKernelsTest : public ::testing::TestWithParam<int> {
+ protected:
+  void SetUp() override {
+    std::srand(1234);
+    n_v_ = GetParam();
+    fixed_ = OscFixedSizeKernelTable::ForNumVelocities(n_v_);
+    dynamic_ = OscFixedSizeKernelTable::Make<Eigen::Dynamic>();
+  }
+
+  int n_v_;
+  OscFixedSizeKernelTable fixed_;
+  OscFixedSizeKernelTable dynamic_;
+};
+
+TEST_P(OscFixedSizeKernelsTest, TrackingCost) {
+  // n_y = 1 and 3 have their own kernels, and 6 goes to the dynamic one
+  for (int n_y : {1, 3, 6}) {
+    const MatrixXd W_half = MatrixXd::Random(n_y, n_y);
+    const MatrixXd W = W_half.transpose() * W_half;
+    const MatrixXd J = MatrixXd::Random(n_y, n_v_);
+    const VectorXd JdotV = VectorXd::Random(n_y);
+    const VectorXd yddot_command = VectorXd::Random(n_y);
+    std::vector<double> buffer(n_y * (n_v_ + 2));
+
+    MatrixXd Q_fixed(n_v_, n_v_);
+    VectorXd b_fixed(n_v_);
+    fixed_.tracking_cost(n_y)(W, J, JdotV, yddot_command, buffer.data(),
+                              &Q_fixed, &b_fixed);
+    MatrixXd Q_dynamic(n_v_, n_v_);
+    VectorXd b_dynamic(n_v_);
+    dynamic_.tracking_cost(n_y)(W, J, JdotV, yddot_command, buffer.data(),
+                                &Q_dynamic, &b_dynamic);
+
+    EXPECT_TRUE(CompareMatrices(Q_fixed, Q_dynamic, 1e-10)) << n_y;
+    EXPECT_TRUE(CompareMatrices(b_fixed, b_dynamic, 1e-10)) << n_y;
+    EXPECT_TRUE(CompareMatrices(Q_dynamic, J.transpose() * W * J, 1e-10))
+        << n_y;
+    EXPECT_TRUE(CompareMatrices(
+        b_dynamic, J.transpose() * W * (JdotV - yddot_command), 1e-10))
+        << n_y;
+  }
+}
+
+TEST_P(OscFixedSizeKernelsTest, DynamicsConstraint) {
+  const int n_c = 6;
+  const int n_h = 2;
+  const int n_u = 10;
+  const MatrixXd M = MatrixXd::Random(n_v_, n_v_);
+  const MatrixXd J_c = MatrixXd::Random(n_c, n_v_);
+  const MatrixXd J_h = MatrixXd::Random(n_h, n_v_);
+  // The block of B is left untouched
+  const MatrixXd A_dyn_init = MatrixXd::Random(n_v_, n_v_ + n_c + n_h + n_u);
+
+  MatrixXd A_fixed = A_dyn_init;
+  fixed_.dynamics_constraint(M, J_c, J_h, &A_fixed);
+  MatrixXd A_dynamic = A_dyn_init;
+  dynamic_.dynamics_constraint(M, J_c, J_h, &A_dynamic);
+
+  MatrixXd A_expected = A_dyn_init;
+  A_expected.leftCols(n_v_ + n_c + n_h) << M, -J_c.transpose(),
+      -J_h.transpose();
+  EXPECT_TRUE(CompareMatrices(A_fixed, A_dynamic, 0));
+  EXPECT_TRUE(CompareMatrices(A_dynamic, A_expected, 0));
+}
+
+TEST_P(OscFixedSizeKernelsTest, ReducedCost) {
+  const int n_z = 12;
+  const MatrixXd Q_half = MatrixXd::Random(n_v_, n_v_);
+  const MatrixXd Q_dv = Q_half.transpose() * Q_half;
+  const VectorXd b_dv = VectorXd::Random(n_v_);
+  const MatrixXd G = MatrixXd::Random(n_v_, n_z);
+  const VectorXd g = VectorXd::Random(n_v_);
+
+  MatrixXd Q_dv_G(n_v_, n_z);
+  VectorXd Q_dv_g(n_v_);
+  MatrixXd Q_z_fixed(n_z, n_z);
+  VectorXd b_z_fixed(n_z);
+  fixed_.reduced_cost(Q_dv, b_dv, G, g, &Q_dv_G, &Q_dv_g, &Q_z_fixed,
+                      &b_z_fixed);
+  MatrixXd Q_z_dynamic(n_z, n_z);
+  VectorXd b_z_dynamic(n_z);
+  dynamic_.reduced_cost(Q_dv, b_dv, G, g, &Q_dv_G, &Q_dv_g, &Q_z_dynamic,
+                        &b_z_dynamic);
+
+  EXPECT_TRUE(CompareMatrices(Q_z_fixed, Q_z_dynamic, 1e-10));
+  EXPECT_TRUE(CompareMatrices(b_z_fixed, b_z_dynamic, 1e-10));
+  EXPECT_TRUE(
+      CompareMatrices(Q_z_dynamic, G.transpose() * Q_dv * G, 1e-10));
+  EXPECT_TRUE(
+      CompareMatrices(b_z_dynamic, G.transpose() * (Q_dv * g + b_dv), 1e-10));
+}
+
+INSTANTIATE_TEST_SUITE_P(CassieNumVelocities, OscFixedSizeKernelsTest,
+                         ::testing::Values(22, 18));
+
+}  // namespace
+}  // namespace dairlib::systems::controllers
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,202 @@
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/multibody/parsing/parser.h"
+#include "common/find_resource.h"
+#include "systems/controllers/osc/osc_kinematics_cache.h"
+
+namespace dairlib::systems::controllers {
+namespace {
+
+using drake::CompareMatrices;
+using drake::multibody::BodyFrame;
+using drake::multibody::JacobianWrtVariable;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using Model = OscKinematicsCache::Model;
+
+class OscKinematicsCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    drake::multibody::Parser(plant_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->WeldFrames(plant_->world_frame(), plant_->GetFrameByName("base"),
+                       drake::math::RigidTransform<double>());
+    plant_->Finalize();
+    n_q_ = plant_->num_positions();
+    n_v_ = plant_->num_velocities();
+    context_ = plant_->CreateDefaultContext();
+    other_context_ = plant_->CreateDefaultContext();
+  }
+
+  void SetState(Context<double>* context, double scale) {
+    plant_->SetPositions(context, scale * VectorXd::LinSpaced(n_q_, -0.3, 0.4));
+    plant_->SetVelocities(context,
+                          scale * VectorXd::LinSpaced(n_v_, 0.5, -0.2));
+  }
+
+  const BodyFrame<double>& frame(const std::string& body_name) const {
+    return plant_->GetBodyByName(body_name).body_frame();
+  }
+
+  // Compares the point request to the uncached values at `context`
+  void ExpectPointMatches(OscKinematicsCache* cache, int request,
+                          const Context<double>& context,
+                          const BodyFrame<double>& body_frame,
+                          const Vector3d& pt_on_body) {
+    const auto& world = plant_->world_frame();
+    Vector3d position;
+    plant_->CalcPointsPositions(context, body_frame, pt_on_body, world,
+                                &position);
+    MatrixXd J(3, n_v_);
+    plant_->CalcJacobianTranslationalVelocity(context, JacobianWrtVariable::kV,
+                                              body_frame, pt_on_body, world,
+                                              world, &J);
+    const Vector3d JdotV = plant_->CalcBiasTranslationalAcceleration(
+        context, JacobianWrtVariable::kV, body_frame, pt_on_body, world,
+        world);
+    EXPECT_TRUE(CompareMatrices(cache->GetPointPosition(request), position,
+                                1e-12));
+    EXPECT_TRUE(CompareMatrices(MatrixXd(cache->GetPointJacobian(request)), J,
+                                1e-12));
+    EXPECT_TRUE(CompareMatrices(cache->GetPointJdotV(request), JdotV, 1e-12));
+  }
+
+  // Compares the rotation request to the uncached values at `context`
+  void ExpectRotationMatches(OscKinematicsCache* cache, int request,
+                             const Context<double>& context,
+                             const BodyFrame<double>& body_frame) {
+    const auto& world = plant_->world_frame();
+    MatrixXd J(3, n_v_);
+    plant_->CalcJacobianAngularVelocity(context, JacobianWrtVariable::kV,
+                                        body_frame, world, world, &J);
+    const Vector3d JdotV =
+        plant_
+            ->CalcBiasSpatialAcceleration(context, JacobianWrtVariable::kV,
+                                          body_frame, Vector3d::Zero(), world,
+                                          world)
+            .rotational();
+    EXPECT_TRUE(CompareMatrices(MatrixXd(cache->GetRotationJacobian(request)),
+                                J, 1e-12));
+    EXPECT_TRUE(
+        CompareMatrices(cache->GetRotationJdotV(request), JdotV, 1e-12));
+  }
+
+  // Compares the center of mass request to the uncached values at `context`
+  void ExpectCenterOfMassMatches(OscKinematicsCache* cache, int request,
+                                 const Context<double>& context) {
+    const auto& world = plant_->world_frame();
+    MatrixXd J(3, n_v_);
+    plant_->CalcJacobianCenterOfMassTranslationalVelocity(
+        context, JacobianWrtVariable::kV, world, world, &J);
+    const Vector3d JdotV =
+        plant_->CalcBiasCenterOfMassTranslationalAcceleration(
+            context, JacobianWrtVariable::kV, world, world);
+    EXPECT_TRUE(CompareMatrices(cache->GetCenterOfMassPosition(request),
+                                plant_->CalcCenterOfMassPosition(context),
+                                1e-12));
+    EXPECT_TRUE(
+        CompareMatrices(cache->GetCenterOfMassJacobian(request), J, 1e-12));
+    EXPECT_TRUE(
+        CompareMatrices(cache->GetCenterOfMassJdotV(request), JdotV, 1e-12));
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<Context<double>> context_;
+  std::unique_ptr<Context<double>> other_context_;
+  int n_q_;
+  int n_v_;
+};
+
+// The cached values match the uncached ones, across ticks
+TEST_F(OscKinematicsCacheTest, MatchesUncached) {
+  OscKinematicsCache cache(*plant_, *context_, *plant_, *context_);
+  const Vector3d foot(0, 0, -0.5);
+  const int left_foot = cache.AddPointRequest(Model::kWithSprings,
+                                              frame("left_lower_leg"), foot);
+  const int right_knee = cache.AddPointRequest(
+      Model::kWithoutSprings, frame("right_lower_leg"), Vector3d::Zero());
+  // Reads the angular rows of the left foot request
+  const int left_rotation =
+      cache.AddRotationRequest(Model::kWithSprings, frame("left_lower_leg"));
+  // Reads the angular rows of a new request at the body origin
+  const int right_upper_rotation = cache.AddRotationRequest(
+      Model::kWithoutSprings, frame("right_upper_leg"));
+  const int com = cache.AddCenterOfMassRequest(Model::kWithSprings);
+  cache.Finalize();
+
+  for (double scale : {1.0, -0.7, 1.3}) {
+    SetState(context_.get(), scale);
+    cache.NewTick();
+    ExpectPointMatches(&cache, left_foot, *context_, frame("left_lower_leg"),
+                       foot);
+    ExpectPointMatches(&cache, right_knee, *context_, frame("right_lower_leg"),
+                       Vector3d::Zero());
+    ExpectRotationMatches(&cache, left_rotation, *context_,
+                          frame("left_lower_leg"));
+    ExpectRotationMatches(&cache, right_upper_rotation, *context_,
+                          frame("right_upper_leg"));
+    ExpectCenterOfMassMatches(&cache, com, *context_);
+  }
+}
+
+// Identical requests are merged when the plants and contexts with and without
+// springs are the same, and kept apart otherwise
+TEST_F(OscKinematicsCacheTest, MergesRequests) {
+  const Vector3d foot(0, 0, -0.5);
+  {
+    OscKinematicsCache cache(*plant_, *context_, *plant_, *context_);
+    const int w_spr = cache.AddPointRequest(Model::kWithSprings,
+                                            frame("left_lower_leg"), foot);
+    const int wo_spr = cache.AddPointRequest(Model::kWithoutSprings,
+                                             frame("left_lower_leg"), foot);
+    cache.AddRotationRequest(Model::kWithSprings, frame("left_lower_leg"));
+    cache.AddCenterOfMassRequest(Model::kWithSprings);
+    cache.AddCenterOfMassRequest(Model::kWithoutSprings);
+    cache.Finalize();
+    EXPECT_EQ(w_spr, wo_spr);
+    EXPECT_EQ(cache.num_point_entries(), 1);
+    EXPECT_EQ(cache.num_com_entries(), 1);
+  }
+
+  // Same plant, different contexts: each request reads its own context
+  OscKinematicsCache cache(*plant_, *context_, *plant_, *other_context_);
+  const int w_spr = cache.AddPointRequest(Model::kWithSprings,
+                                          frame("left_lower_leg"), foot);
+  const int wo_spr = cache.AddPointRequest(Model::kWithoutSprings,
+                                           frame("left_lower_leg"), foot);
+  const int rotation_wo_spr =
+      cache.AddRotationRequest(Model::kWithoutSprings, frame("left_lower_leg"));
+  const int com_w_spr = cache.AddCenterOfMassRequest(Model::kWithSprings);
+  const int com_wo_spr = cache.AddCenterOfMassRequest(Model::kWithoutSprings);
+  cache.Finalize();
+  EXPECT_EQ(cache.num_point_entries(), 2);
+  EXPECT_EQ(cache.num_com_entries(), 2);
+
+  SetState(context_.get(), 1.0);
+  SetState(other_context_.get(), -0.5);
+  cache.NewTick();
+  ExpectPointMatches(&cache, w_spr, *context_, frame("left_lower_leg"), foot);
+  ExpectPointMatches(&cache, wo_spr, *other_context_, frame("left_lower_leg"),
+                     foot);
+  ExpectRotationMatches(&cache, rotation_wo_spr, *other_context_,
+                        frame("left_lower_leg"));
+  ExpectCenterOfMassMatches(&cache, com_w_spr, *context_);
+  ExpectCenterOfMassMatches(&cache, com_wo_spr, *other_context_);
+}
+
+}  // namespace
+}  // namespace dairlib::systems::controllers
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,79 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "systems/controllers/osc/trajectory_eval_cache.h"
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/common/trajectories/exponential_plus_piecewise_polynomial.h"
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+namespace {
+
+using drake::CompareMatrices;
+using drake::trajectories::ExponentialPlusPiecewisePolynomial;
+using drake::trajectories::PiecewisePolynomial;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+void CheckEval(const drake::trajectories::Trajectory<double>& traj,
+               TrajectoryEvalCache* cache, double t) {
+  cache->Eval(traj, t);
+  EXPECT_TRUE(CompareMatrices(cache->value(), traj.value(t), 1e-10));
+  EXPECT_TRUE(CompareMatrices(cache->first_derivative(),
+                              traj.MakeDerivative(1)->value(t), 1e-10));
+  EXPECT_TRUE(CompareMatrices(cache->second_derivative(),
+                              traj.MakeDerivative(2)->value(t), 1e-10));
+}
+
+TEST(TrajectoryEvalCacheTest, PiecewisePolynomial) {
+  std::vector<double> breaks = {0, 0.3, 0.5, 1.2, 2};
+  std::vector<MatrixXd> knots;
+  for (unsigned int i = 0; i < breaks.size(); i++) {
+    knots.push_back(MatrixXd::Random(3, 1));
+  }
+  auto pp = PiecewisePolynomial<double>::CubicShapePreserving(breaks, knots);
+
+  TrajectoryEvalCache cache;
+  // Monotonically increasing time (including the breaks and the times out of
+  // the time span)
+  for (double t = -0.1; t < 2.2; t += 0.05) {
+    CheckEval(pp, &cache, t);
+  }
+  CheckEval(pp, &cache, 0.5);
+  EXPECT_EQ(cache.segment_hint(), 2);
+  // Going back in time
+  CheckEval(pp, &cache, 0.1);
+  EXPECT_EQ(cache.segment_hint(), 0);
+
+  // Replace the trajectory with one with fewer segments
+  auto pp_short = PiecewisePolynomial<double>::FirstOrderHold(
+      std::vector<double>{0, 1}, std::vector<MatrixXd>{knots[0], knots[1]});
+  CheckEval(pp, &cache, 1.5);
+  CheckEval(pp_short, &cache, 0.5);
+}
+
+TEST(TrajectoryEvalCacheTest, ExponentialPlusPiecewisePolynomial) {
+  MatrixXd K = MatrixXd::Identity(2, 2);
+  MatrixXd A = -MatrixXd::Identity(2, 2);
+  MatrixXd alpha = MatrixXd::Ones(2, 1);
+  auto pp = PiecewisePolynomial<double>::FirstOrderHold(
+      std::vector<double>{0, 1},
+      std::vector<MatrixXd>{MatrixXd::Zero(2, 1), MatrixXd::Ones(2, 1)});
+  ExponentialPlusPiecewisePolynomial<double> traj(K, A, alpha, pp);
+
+  TrajectoryEvalCache cache;
+  CheckEval(traj, &cache, 0.2);
+  CheckEval(traj, &cache, 0.7);
+}
+
+}  // namespace
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
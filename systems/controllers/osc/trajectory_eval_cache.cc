@@ -0,0 +1,91 @@
+#include "systems/controllers/osc/trajectory_eval_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "drake/common/drake_assert.h"
+
+using drake::trajectories::PiecewisePolynomial;
+using drake::trajectories::Trajectory;
+
+namespace dairlib::systems::controllers {
+
+int TrajectoryEvalCache::FindSegment(const PiecewisePolynomial<double>& pp,
+                                     double t) {
+  const std::vector<double>& breaks = pp.get_segment_times();
+  const int n_segments = pp.get_number_of_segments();
+  // Segment i contains [breaks[i], breaks[i + 1]), and the last segment also
+  // contains its end time.
+  auto contains = [&](int i) {
+    return (i < n_segments) && (breaks[i] <= t) &&
+           ((t < breaks[i + 1]) || (i == n_segments - 1));
+  };
+  if (contains(segment_hint_)) {
+    return segment_hint_;
+  }
+  if (contains(segment_hint_ + 1)) {
+    return ++segment_hint_;
+  }
+  segment_hint_ = pp.get_segment_index(t);
+  return segment_hint_;
+}
+
+void TrajectoryEvalCache::Eval(const Trajectory<double>& traj, double t) {
+  const auto* pp = dynamic_cast<const PiecewisePolynomial<double>*>(&traj);
+  if (pp == nullptr || pp->get_number_of_segments() == 0) {
+    value_ = traj.value(t);
+    if (traj.has_derivative()) {
+      first_derivative_ = traj.EvalDerivative(t, 1);
+      second_derivative_ = traj.EvalDerivative(t, 2);
+    }
+    // TODO (yangwill): Remove this edge case after EvalDerivative has been
+    // implemented for ExponentialPlusPiecewisePolynomial
+    else {
+      first_derivative_ = traj.MakeDerivative(1)->value(t);
+      second_derivative_ = traj.MakeDerivative(2)->value(t);
+    }
+    return;
+  }
+
+  DRAKE_DEMAND(pp->cols() == 1);
+  const int n = pp->rows();
+  value_.resize(n);
+  first_derivative_.resize(n);
+  second_derivative_.resize(n);
+
+  // PiecewisePolynomial is evaluated at the closest time within its time span
+  const double t_clamped =
+      std::min(std::max(t, pp->start_time()), pp->end_time());
+  const int segment = FindSegment(*pp, t_clamped);
+  const double dt = t_clamped - pp->start_time(segment);
+  const auto& poly_mat = pp->getPolynomialMatrix(segment);
+  for (int i = 0; i < n; i++) {
+    // c*dt^p, p*c*dt^(p-1) and p*(p-1)*c*dt^(p-2) of each monomial
+    double value = 0;
+    double first_derivative = 0;
+    double second_derivative = 0;
+    for (const auto& monomial : poly_mat(i, 0).GetMonomials()) {
+      const int power = monomial.terms.empty() ? 0 : monomial.terms[0].power;
+      const double c = monomial.coefficient;
+      if (power == 0) {
+        value += c;
+      } else if (power == 1) {
+        value += c * dt;
+        first_derivative += c;
+      } else {
+        double dt_pow = 1;  // dt^(p-2)
+        for (int k = 0; k < power - 2; k++) {
+          dt_pow *= dt;
+        }
+        second_derivative += power * (power - 1) * c * dt_pow;
+        first_derivative += power * c * dt_pow * dt;
+        value += c * dt_pow * dt * dt;
+      }
+    }
+    value_(i) = value;
+    first_derivative_(i) = first_derivative;
+    second_derivative_(i) = second_derivative;
+  }
+}
+
+}  // namespace dairlib::systems::controllers
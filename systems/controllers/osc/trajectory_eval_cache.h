@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <drake/common/trajectories/piecewise_polynomial.h>
+#include <drake/common/trajectories/trajectory.h>
+
+namespace dairlib {
+namespace systems {
+namespace controllers {
+
+/// TrajectoryEvalCache evaluates the value and the first two time derivatives
+/// of a trajectory at once.
+///
+/// For a PiecewisePolynomial, the segment is looked up once per Eval() (the
+/// three separate calls of value() and EvalDerivative() each search for the
+/// segment and allocate the result). The segment of the previous Eval() is
+/// kept as a hint, so that with a monotonically increasing t (as in the control
+/// loop) the lookup is usually a comparison with the breaks of the hinted
+/// segment and the next one. The hint is always checked against the breaks of
+/// the trajectory, so it stays correct when the trajectory is replaced.
+///
+/// Other trajectories are evaluated with value() and EvalDerivative() (or
+/// MakeDerivative() when the trajectory doesn't implement EvalDerivative()).
+class TrajectoryEvalCache {
+ public:
+  TrajectoryEvalCache() = default;
+
+  /// Evaluates `traj` (a column vector) at time `t`
+  void Eval(const drake::trajectories::Trajectory<double>& traj, double t);
+
+  const Eigen::VectorXd& value() const { return value_; }
+  const Eigen::VectorXd& first_derivative() const { return first_derivative_; }
+  const Eigen::VectorXd& second_derivative() const {
+    return second_derivative_;
+  }
+
+  /// Segment of the latest PiecewisePolynomial evaluation
+  int segment_hint() const { return segment_hint_; }
+
+ private:
+  // Segment index of `t` (same as PiecewisePolynomial::get_segment_index())
+  int FindSegment(const drake::trajectories::PiecewisePolynomial<double>& pp,
+                  double t);
+
+  int segment_hint_ = 0;
+  Eigen::VectorXd value_;
+  Eigen::VectorXd first_derivative_;
+  Eigen::VectorXd second_derivative_;
+};
+
+}  // namespace controllers
+}  // namespace systems
+}  // namespace dairlib
@@ -94,6 +94,12 @@ public:
       num_positions_ + num_velocities_);
   }
 
+  /// Returns a const state block, without copying the data
+  auto GetStateBlock() const {
+    return this->get_value().segment(position_start_,
+                                     num_positions_ + num_velocities_);
+  }
+
   /// Returns a const positions vector
   const VectorX<T> GetPositions() const {
     return this->get_data().segment(position_start_, num_positions_);
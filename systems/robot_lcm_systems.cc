@@ -1,5 +1,7 @@
 #include "robot_lcm_systems.h"
 
+#include <stdexcept>
+
 #include "multibody/multibody_utils.h"
 
 namespace dairlib {
@@ -13,23 +15,129 @@ using Eigen::VectorXd;
 using std::string;
 using systems::OutputVector;
 
+namespace {
+
+// Indices of `names`, by `index` (e.g. StateIndexLayout::position_index)
+template <typename IndexFunction>
+std::vector<int> LookUp(const std::vector<string>& names,
+                        IndexFunction index) {
+  std::vector<int> indices(names.size());
+  for (size_t i = 0; i < names.size(); i++) {
+    indices[i] = index(names[i]);
+  }
+  return indices;
+}
+
+// Copies `values` to the entries `indices` of `vector`
+void Scatter(const std::vector<int>& indices,
+             const std::vector<double>& values,
+             Eigen::Ref<VectorXd> vector) {
+  DRAKE_THROW_UNLESS(indices.size() == values.size());
+  for (size_t i = 0; i < indices.size(); i++) {
+    vector(indices[i]) = values[i];
+  }
+}
+
+}  // namespace
+
+/*--------------------------------------------------------------------------*/
+// methods implementation for the schemas of the compact messages.
+
+lcmt_robot_schema MakeRobotSchema(const multibody::StateIndexLayout& layout,
+                                  bool include_state, bool include_efforts) {
+  lcmt_robot_schema schema;
+  if (include_state) {
+    schema.position_names = layout.position_names();
+    schema.velocity_names = layout.velocity_names();
+  }
+  if (include_efforts) {
+    schema.effort_names = layout.actuator_names();
+  }
+  schema.num_positions = schema.position_names.size();
+  schema.num_velocities = schema.velocity_names.size();
+  schema.num_efforts = schema.effort_names.size();
+  schema.schema_hash = RobotSchemaHash(schema);
+  return schema;
+}
+
+int64_t RobotSchemaHash(const lcmt_robot_schema& schema) {
+  std::vector<string> names = schema.position_names;
+  names.insert(names.end(), schema.velocity_names.begin(),
+               schema.velocity_names.end());
+  names.insert(names.end(), schema.effort_names.begin(),
+               schema.effort_names.end());
+  // The sizes split the names into positions, velocities and efforts
+  uint64_t hash = multibody::NameListHash(names);
+  for (int64_t size :
+       {schema.num_positions, schema.num_velocities, schema.num_efforts}) {
+    hash = (hash ^ static_cast<uint64_t>(size)) * 1099511628211ull;
+  }
+  return static_cast<int64_t>(hash);
+}
+
+RobotSchemaIndices::RobotSchemaIndices(
+    const multibody::StateIndexLayout& layout)
+    : layout_(layout) {}
+
+void RobotSchemaIndices::Add(const lcmt_robot_schema& schema) {
+  if (indices_.count(schema.schema_hash) ||
+      schema.schema_hash != RobotSchemaHash(schema)) {
+    return;
+  }
+  Indices indices;
+  indices.positions = LookUp(schema.position_names, [this](const string& n) {
+    return layout_.position_index(n);
+  });
+  indices.velocities = LookUp(schema.velocity_names, [this](const string& n) {
+    return layout_.velocity_index(n);
+  });
+  indices.efforts = LookUp(schema.effort_names, [this](const string& n) {
+    return layout_.actuator_index(n);
+  });
+  indices_[schema.schema_hash] = indices;
+}
+
+const RobotSchemaIndices::Indices* RobotSchemaIndices::Find(
+    int64_t schema_hash) const {
+  const auto it = indices_.find(schema_hash);
+  return (it == indices_.end()) ? nullptr : &it->second;
+}
+
 /*--------------------------------------------------------------------------*/
 // methods implementation for RobotOutputReceiver.
 
 RobotOutputReceiver::RobotOutputReceiver(
-    const drake::multibody::MultibodyPlant<double>& plant) {
+    const drake::multibody::MultibodyPlant<double>& plant, bool compact)
+    : layout_(plant),
+      position_ordering_(layout_.position_names()),
+      velocity_ordering_(layout_.velocity_names()),
+      effort_ordering_(layout_.actuator_names()),
+      schemas_(layout_) {
   num_positions_ = plant.num_positions();
   num_velocities_ = plant.num_velocities();
   num_efforts_ = plant.num_actuators();
-  positionIndexMap_ = multibody::makeNameToPositionsMap(plant);
-  velocityIndexMap_ = multibody::makeNameToVelocitiesMap(plant);
-  effortIndexMap_ = multibody::makeNameToActuatorsMap(plant);
-  this->DeclareAbstractInputPort("lcmt_robot_output",
-                                 drake::Value<dairlib::lcmt_robot_output>{});
-  this->DeclareVectorOutputPort(
-      OutputVector<double>(plant.num_positions(), plant.num_velocities(),
-                           plant.num_actuators()),
-      &RobotOutputReceiver::CopyOutput);
+  const OutputVector<double> model_vector(
+      plant.num_positions(), plant.num_velocities(), plant.num_actuators());
+  if (!compact) {
+    this->DeclareAbstractInputPort("lcmt_robot_output",
+                                   drake::Value<dairlib::lcmt_robot_output>{});
+    this->DeclareVectorOutputPort(model_vector,
+                                  &RobotOutputReceiver::CopyOutput);
+    return;
+  }
+
+  this->DeclareAbstractInputPort(
+      "lcmt_robot_output_compact",
+      drake::Value<dairlib::lcmt_robot_output_compact>{});
+  schema_input_port_ =
+      this->DeclareAbstractInputPort("lcmt_robot_schema",
+                                     drake::Value<dairlib::lcmt_robot_schema>{})
+          .get_index();
+  this->DeclareVectorOutputPort(model_vector,
+                                &RobotOutputReceiver::CopyCompactOutput);
+  // Senders with the names of the plant, with or without efforts
+  schemas_.Add(MakeRobotSchema(layout_, true, true));
+  schemas_.Add(MakeRobotSchema(layout_, true, false));
 }
 
 void RobotOutputReceiver::CopyOutput(const Context<double>& context,
@@ -38,20 +146,62 @@ void RobotOutputReceiver::CopyOutput(const Context<double>& context,
   DRAKE_ASSERT(input != nullptr);
   const auto& state_msg = input->get_value<dairlib::lcmt_robot_output>();
 
-  VectorXd positions = VectorXd::Zero(num_positions_);
-  for (int i = 0; i < state_msg.num_positions; i++) {
-    int j = positionIndexMap_.at(state_msg.position_names[i]);
-    positions(j) = state_msg.position[i];
+  // Coordinates missing from the message are zero
+  auto positions = output->GetMutablePositions();
+  positions.setZero();
+  position_ordering_.Copy(state_msg.position_names, state_msg.position,
+                          positions);
+  auto velocities = output->GetMutableVelocities();
+  velocities.setZero();
+  velocity_ordering_.Copy(state_msg.velocity_names, state_msg.velocity,
+                          velocities);
+  auto efforts = output->GetMutableEfforts();
+  efforts.setZero();
+  effort_ordering_.Copy(state_msg.effort_names, state_msg.effort, efforts);
+
+  VectorXd imu = VectorXd::Zero(3);
+  if (num_positions_ != num_velocities_) {
+    for (int i = 0; i < 3; ++i) {
+      imu[i] = state_msg.imu_accel[i];
+    }
   }
-  VectorXd velocities = VectorXd::Zero(num_velocities_);
-  for (int i = 0; i < state_msg.num_velocities; i++) {
-    int j = velocityIndexMap_.at(state_msg.velocity_names[i]);
-    velocities(j) = state_msg.velocity[i];
+
+  output->SetIMUAccelerations(imu);
+  output->set_timestamp(state_msg.utime * 1.0e-6);
+}
+
+void RobotOutputReceiver::CopyCompactOutput(
+    const Context<double>& context, OutputVector<double>* output) const {
+  const drake::AbstractValue* input = this->EvalAbstractInput(context, 0);
+  DRAKE_ASSERT(input != nullptr);
+  const auto& state_msg =
+      input->get_value<dairlib::lcmt_robot_output_compact>();
+  const drake::AbstractValue* schema =
+      this->EvalAbstractInput(context, schema_input_port_);
+  if (schema != nullptr) {
+    schemas_.Add(schema->get_value<dairlib::lcmt_robot_schema>());
   }
-  VectorXd efforts = VectorXd::Zero(num_efforts_);
-  for (int i = 0; i < state_msg.num_efforts; i++) {
-    int j = effortIndexMap_.at(state_msg.effort_names[i]);
-    efforts(j) = state_msg.effort[j];
+
+  // Coordinates missing from the message are zero
+  auto positions = output->GetMutablePositions();
+  auto velocities = output->GetMutableVelocities();
+  auto efforts = output->GetMutableEfforts();
+  positions.setZero();
+  velocities.setZero();
+  efforts.setZero();
+  // Messages without entries (e.g. before the first one is received) don't
+  // need a schema
+  if (state_msg.num_positions + state_msg.num_velocities +
+          state_msg.num_efforts > 0) {
+    const auto* indices = schemas_.Find(state_msg.schema_hash);
+    if (indices == nullptr) {
+      throw std::runtime_error(
+          "RobotOutputReceiver: received a lcmt_robot_output_compact with an "
+          "unknown schema. Is its lcmt_robot_schema received?");
+    }
+    Scatter(indices->positions, state_msg.position, positions);
+    Scatter(indices->velocities, state_msg.velocity, velocities);
+    Scatter(indices->efforts, state_msg.effort, efforts);
   }
 
   VectorXd imu = VectorXd::Zero(3);
@@ -61,9 +211,6 @@ void RobotOutputReceiver::CopyOutput(const Context<double>& context,
     }
   }
 
-  output->SetPositions(positions);
-  output->SetVelocities(velocities);
-  output->SetEfforts(efforts);
   output->SetIMUAccelerations(imu);
   output->set_timestamp(state_msg.utime * 1.0e-6);
 }
@@ -73,43 +220,16 @@ void RobotOutputReceiver::CopyOutput(const Context<double>& context,
 
 RobotOutputSender::RobotOutputSender(
     const drake::multibody::MultibodyPlant<double>& plant,
-    const bool publish_efforts, const bool publish_imu)
+    const bool publish_efforts, const bool publish_imu, const bool compact)
     : publish_efforts_(publish_efforts), publish_imu_(publish_imu) {
   num_positions_ = plant.num_positions();
   num_velocities_ = plant.num_velocities();
   num_efforts_ = plant.num_actuators();
 
-  positionIndexMap_ = multibody::makeNameToPositionsMap(plant);
-  velocityIndexMap_ = multibody::makeNameToVelocitiesMap(plant);
-  effortIndexMap_ = multibody::makeNameToActuatorsMap(plant);
-
-  // Loop through the maps to extract ordered names
-  for (int i = 0; i < num_positions_; ++i) {
-    for (auto& x : positionIndexMap_) {
-      if (x.second == i) {
-        ordered_position_names_.push_back(x.first);
-        break;
-      }
-    }
-  }
-
-  for (int i = 0; i < num_velocities_; ++i) {
-    for (auto& x : velocityIndexMap_) {
-      if (x.second == i) {
-        ordered_velocity_names_.push_back(x.first);
-        break;
-      }
-    }
-  }
-
-  for (int i = 0; i < num_efforts_; i++) {
-    for (auto& x : effortIndexMap_) {
-      if (x.second == i) {
-        ordered_effort_names_.push_back(x.first);
-        break;
-      }
-    }
-  }
+  const multibody::StateIndexLayout layout(plant);
+  ordered_position_names_ = layout.position_names();
+  ordered_velocity_names_ = layout.velocity_names();
+  ordered_effort_names_ = layout.actuator_names();
 
   state_input_port_ =
       this->DeclareVectorInputPort(
@@ -125,7 +245,15 @@ RobotOutputSender::RobotOutputSender(
         this->DeclareVectorInputPort(BasicVector<double>(3)).get_index();
   }
 
-  this->DeclareAbstractOutputPort(&RobotOutputSender::Output);
+  if (!compact) {
+    this->DeclareAbstractOutputPort(&RobotOutputSender::Output);
+    return;
+  }
+  schema_ = MakeRobotSchema(layout, true, publish_efforts_);
+  this->DeclareAbstractOutputPort(&RobotOutputSender::OutputCompact);
+  schema_output_port_ =
+      this->DeclareAbstractOutputPort(&RobotOutputSender::OutputSchema)
+          .get_index();
 }
 
 /// Populate a state message with all states
@@ -173,17 +301,77 @@ void RobotOutputSender::Output(const Context<double>& context,
   }
 }
 
+/// Populate a compact state message with all states
+void RobotOutputSender::OutputCompact(
+    const Context<double>& context,
+    dairlib::lcmt_robot_output_compact* state_msg) const {
+  const auto state = this->EvalVectorInput(context, state_input_port_);
+
+  // using the time from the context
+  state_msg->utime = context.get_time() * 1e6;
+  state_msg->schema_hash = schema_.schema_hash;
+
+  state_msg->num_positions = num_positions_;
+  state_msg->num_velocities = num_velocities_;
+  state_msg->position.resize(num_positions_);
+  state_msg->velocity.resize(num_velocities_);
+  for (int i = 0; i < num_positions_; i++) {
+    state_msg->position[i] = state->GetAtIndex(i);
+  }
+  for (int i = 0; i < num_velocities_; i++) {
+    state_msg->velocity[i] = state->GetAtIndex(num_positions_ + i);
+  }
+
+  if (publish_efforts_) {
+    const auto efforts = this->EvalVectorInput(context, effort_input_port_);
+    state_msg->num_efforts = num_efforts_;
+    state_msg->effort.resize(num_efforts_);
+    for (int i = 0; i < num_efforts_; i++) {
+      state_msg->effort[i] = efforts->GetAtIndex(i);
+    }
+  }
+
+  if (publish_imu_) {
+    const auto imu = this->EvalVectorInput(context, imu_input_port_);
+    for (int i = 0; i < 3; ++i) {
+      state_msg->imu_accel[i] = imu->get_value()[i];
+    }
+  }
+}
+
+void RobotOutputSender::OutputSchema(
+    const Context<double>& context, dairlib::lcmt_robot_schema* schema) const {
+  *schema = schema_;
+}
+
 /*--------------------------------------------------------------------------*/
 // methods implementation for RobotInputReceiver.
 
 RobotInputReceiver::RobotInputReceiver(
-    const drake::multibody::MultibodyPlant<double>& plant) {
+    const drake::multibody::MultibodyPlant<double>& plant, bool compact)
+    : layout_(plant),
+      actuator_ordering_(layout_.actuator_names()),
+      schemas_(layout_) {
   num_actuators_ = plant.num_actuators();
-  actuatorIndexMap_ = multibody::makeNameToActuatorsMap(plant);
-  this->DeclareAbstractInputPort("lcmt_robot_input",
-                                 drake::Value<dairlib::lcmt_robot_input>{});
+  if (!compact) {
+    this->DeclareAbstractInputPort("lcmt_robot_input",
+                                   drake::Value<dairlib::lcmt_robot_input>{});
+    this->DeclareVectorOutputPort(TimestampedVector<double>(num_actuators_),
+                                  &RobotInputReceiver::CopyInputOut);
+    return;
+  }
+
+  this->DeclareAbstractInputPort(
+      "lcmt_robot_input_compact",
+      drake::Value<dairlib::lcmt_robot_input_compact>{});
+  schema_input_port_ =
+      this->DeclareAbstractInputPort("lcmt_robot_schema",
+                                     drake::Value<dairlib::lcmt_robot_schema>{})
+          .get_index();
   this->DeclareVectorOutputPort(TimestampedVector<double>(num_actuators_),
-                                &RobotInputReceiver::CopyInputOut);
+                                &RobotInputReceiver::CopyCompactInputOut);
+  // Senders with the names of the plant
+  schemas_.Add(MakeRobotSchema(layout_, false, true));
 }
 
 void RobotInputReceiver::CopyInputOut(const Context<double>& context,
@@ -192,13 +380,39 @@ void RobotInputReceiver::CopyInputOut(const Context<double>& context,
   DRAKE_ASSERT(input != nullptr);
   const auto& input_msg = input->get_value<dairlib::lcmt_robot_input>();
 
-  VectorXd input_vector = VectorXd::Zero(num_actuators_);
+  // Actuators missing from the message are zero
+  auto input_vector = output->get_mutable_data();
+  input_vector.setZero();
+  actuator_ordering_.Copy(input_msg.effort_names, input_msg.efforts,
+                          input_vector);
+  output->set_timestamp(input_msg.utime * 1.0e-6);
+}
+
+void RobotInputReceiver::CopyCompactInputOut(
+    const Context<double>& context, TimestampedVector<double>* output) const {
+  const drake::AbstractValue* input = this->EvalAbstractInput(context, 0);
+  DRAKE_ASSERT(input != nullptr);
+  const auto& input_msg = input->get_value<dairlib::lcmt_robot_input_compact>();
+  const drake::AbstractValue* schema =
+      this->EvalAbstractInput(context, schema_input_port_);
+  if (schema != nullptr) {
+    schemas_.Add(schema->get_value<dairlib::lcmt_robot_schema>());
+  }
 
-  for (int i = 0; i < input_msg.num_efforts; i++) {
-    int j = actuatorIndexMap_.at(input_msg.effort_names[i]);
-    input_vector(j) = input_msg.efforts[i];
+  // Actuators missing from the message are zero
+  auto input_vector = output->get_mutable_data();
+  input_vector.setZero();
+  // Messages without entries (e.g. before the first one is received) don't
+  // need a schema
+  if (input_msg.num_efforts > 0) {
+    const auto* indices = schemas_.Find(input_msg.schema_hash);
+    if (indices == nullptr) {
+      throw std::runtime_error(
+          "RobotInputReceiver: received a lcmt_robot_input_compact with an "
+          "unknown schema. Is its lcmt_robot_schema received?");
+    }
+    Scatter(indices->efforts, input_msg.efforts, input_vector);
   }
-  output->SetDataVector(input_vector);
   output->set_timestamp(input_msg.utime * 1.0e-6);
 }
 
@@ -206,7 +420,7 @@ void RobotInputReceiver::CopyInputOut(const Context<double>& context,
 // methods implementation for RobotCommandSender.
 
 RobotCommandSender::RobotCommandSender(
-    const drake::multibody::MultibodyPlant<double>& plant) {
+    const drake::multibody::MultibodyPlant<double>& plant, bool compact) {
   num_actuators_ = plant.num_actuators();
   actuatorIndexMap_ = multibody::makeNameToActuatorsMap(plant);
 
@@ -215,7 +429,15 @@ RobotCommandSender::RobotCommandSender(
   }
 
   this->DeclareVectorInputPort(TimestampedVector<double>(num_actuators_));
-  this->DeclareAbstractOutputPort(&RobotCommandSender::OutputCommand);
+  if (!compact) {
+    this->DeclareAbstractOutputPort(&RobotCommandSender::OutputCommand);
+    return;
+  }
+  schema_ = MakeRobotSchema(multibody::StateIndexLayout(plant), false, true);
+  this->DeclareAbstractOutputPort(&RobotCommandSender::OutputCompactCommand);
+  schema_output_port_ =
+      this->DeclareAbstractOutputPort(&RobotCommandSender::OutputSchema)
+          .get_index();
 }
 
 void RobotCommandSender::OutputCommand(
@@ -234,5 +456,25 @@ void RobotCommandSender::OutputCommand(
   }
 }
 
+void RobotCommandSender::OutputCompactCommand(
+    const Context<double>& context,
+    dairlib::lcmt_robot_input_compact* input_msg) const {
+  const TimestampedVector<double>* command =
+      (TimestampedVector<double>*)this->EvalVectorInput(context, 0);
+
+  input_msg->utime = command->get_timestamp() * 1e6;
+  input_msg->schema_hash = schema_.schema_hash;
+  input_msg->num_efforts = num_actuators_;
+  input_msg->efforts.resize(num_actuators_);
+  for (int i = 0; i < num_actuators_; i++) {
+    input_msg->efforts[i] = command->GetAtIndex(i);
+  }
+}
+
+void RobotCommandSender::OutputSchema(
+    const Context<double>& context, dairlib::lcmt_robot_schema* schema) const {
+  *schema = schema_;
+}
+
 }  // namespace systems
 }  // namespace dairlib
@@ -1,11 +1,16 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
 #include "dairlib/lcmt_robot_input.hpp"
+#include "dairlib/lcmt_robot_input_compact.hpp"
 #include "dairlib/lcmt_robot_output.hpp"
+#include "dairlib/lcmt_robot_output_compact.hpp"
+#include "dairlib/lcmt_robot_schema.hpp"
+#include "multibody/multibody_utils.h"
 #include "systems/framework/output_vector.h"
 #include "systems/framework/timestamped_vector.h"
 
@@ -18,32 +23,100 @@ namespace systems {
 /// @file This file contains classes dealing with sending/receiving
 /// LCM messages related to a robot. The classes in this file are based on
 /// acrobot_lcm.h
+///
+/// The senders and receivers also handle compact messages,
+/// lcmt_robot_output_compact and lcmt_robot_input_compact, which carry a
+/// schema hash instead of the names of their entries. The names are sent
+/// separately, as an lcmt_robot_schema, at a low rate (on the channel of the
+/// messages followed by "_SCHEMA"). A receiver whose plant has the same
+/// names in the same order as the sender's doesn't need the schema. Compact
+/// messages go on their own channels (by convention, the channel of the full
+/// messages followed by "_COMPACT"), since the full ones are decoded as
+/// lcmt_robot_output or lcmt_robot_input.
+
+/// The schema of a sender of compact messages for `layout`, with its
+/// positions and velocities if `include_state` and its efforts if
+/// `include_efforts`
+lcmt_robot_schema MakeRobotSchema(const multibody::StateIndexLayout& layout,
+                                  bool include_state, bool include_efforts);
+
+/// Hash of a schema: the multibody::NameListHash() of the position, velocity
+/// and effort names, in this order, mixed with the number of each (so that
+/// the same names split differently don't collide)
+int64_t RobotSchemaHash(const lcmt_robot_schema& schema);
+
+/// Indices in `layout` of the entries of the compact messages of each schema
+/// added, so that a receiver looks the names up once per schema.
+class RobotSchemaIndices {
+ public:
+  struct Indices {
+    std::vector<int> positions;
+    std::vector<int> velocities;
+    std::vector<int> efforts;
+  };
+
+  /// `layout` must outlive this object
+  explicit RobotSchemaIndices(const multibody::StateIndexLayout& layout);
+
+  /// Adds the indices of `schema` if it is new. Schemas whose hash doesn't
+  /// match their names (e.g. an empty message) are ignored. Throws if a name
+  /// isn't in the layout.
+  void Add(const lcmt_robot_schema& schema);
+
+  /// The indices of the schema with hash `schema_hash`, or nullptr if it
+  /// wasn't added
+  const Indices* Find(int64_t schema_hash) const;
+
+ private:
+  const multibody::StateIndexLayout& layout_;
+  std::map<int64_t, Indices> indices_;
+};
 
 /// Receives the output of an LcmSubsriberSystem that subsribes to the
 /// Robot output channel with LCM type lcmt_robot_output, and outputs the
-/// robot states as a OutputVector.
+/// robot states as a OutputVector. The names of the messages are only
+/// looked up when their ordering changes (see multibody::NameOrdering).
+///
+/// If `compact`, the input port 0 takes lcmt_robot_output_compact messages
+/// instead, and get_input_port_schema() their lcmt_robot_schema (which may
+/// be left unconnected if the sender uses the names of `plant`).
 class RobotOutputReceiver : public drake::systems::LeafSystem<double> {
  public:
   explicit RobotOutputReceiver(
-      const drake::multibody::MultibodyPlant<double>& plant);
+      const drake::multibody::MultibodyPlant<double>& plant,
+      bool compact = false);
+
+  const drake::systems::InputPort<double>& get_input_port_schema() const {
+    return this->get_input_port(schema_input_port_);
+  }
 
  private:
   void CopyOutput(const drake::systems::Context<double>& context,
                   OutputVector<double>* output) const;
+  void CopyCompactOutput(const drake::systems::Context<double>& context,
+                         OutputVector<double>* output) const;
   int num_positions_;
   int num_velocities_;
   int num_efforts_;
-  std::map<std::string, int> positionIndexMap_;
-  std::map<std::string, int> velocityIndexMap_;
-  std::map<std::string, int> effortIndexMap_;
+  int schema_input_port_ = -1;
+  const multibody::StateIndexLayout layout_;
+  // Orderings of the last message
+  mutable multibody::NameOrdering position_ordering_;
+  mutable multibody::NameOrdering velocity_ordering_;
+  mutable multibody::NameOrdering effort_ordering_;
+  // Schemas of the compact messages
+  mutable RobotSchemaIndices schemas_;
 };
 
-/// Converts a OutputVector object to LCM type lcmt_robot_output
+/// Converts a OutputVector object to LCM type lcmt_robot_output, or to
+/// lcmt_robot_output_compact if `compact`. Compact senders also output their
+/// (constant) schema on get_output_port_schema().
 class RobotOutputSender : public drake::systems::LeafSystem<double> {
  public:
   explicit RobotOutputSender(
       const drake::multibody::MultibodyPlant<double>& plant,
-      const bool publish_efforts = false, const bool publish_imu = false);
+      const bool publish_efforts = false, const bool publish_imu = false,
+      const bool compact = false);
 
   const drake::systems::InputPort<double>& get_input_port_state() const {
     return this->get_input_port(state_input_port_);
@@ -57,9 +130,17 @@ class RobotOutputSender : public drake::systems::LeafSystem<double> {
     return this->get_input_port(imu_input_port_);
   }
 
+  const drake::systems::OutputPort<double>& get_output_port_schema() const {
+    return this->get_output_port(schema_output_port_);
+  }
+
  private:
   void Output(const drake::systems::Context<double>& context,
               dairlib::lcmt_robot_output* output) const;
+  void OutputCompact(const drake::systems::Context<double>& context,
+                     dairlib::lcmt_robot_output_compact* output) const;
+  void OutputSchema(const drake::systems::Context<double>& context,
+                    dairlib::lcmt_robot_schema* output) const;
 
   int num_positions_;
   int num_velocities_;
@@ -67,47 +148,76 @@ class RobotOutputSender : public drake::systems::LeafSystem<double> {
   std::vector<std::string> ordered_position_names_;
   std::vector<std::string> ordered_velocity_names_;
   std::vector<std::string> ordered_effort_names_;
-  std::map<std::string, int> positionIndexMap_;
-  std::map<std::string, int> velocityIndexMap_;
-  std::map<std::string, int> effortIndexMap_;
   int state_input_port_;
   int effort_input_port_;
   int imu_input_port_;
+  int schema_output_port_ = -1;
   bool publish_efforts_;
   bool publish_imu_;
+  lcmt_robot_schema schema_;
 };
 
 /// Receives the output of an LcmSubsriberSystem that subsribes to the
 /// robot input channel with LCM type lcmt_robot_input and outputs the
 /// robot inputs as a TimestampedVector.
+///
+/// If `compact`, the input port 0 takes lcmt_robot_input_compact messages
+/// instead, and get_input_port_schema() their lcmt_robot_schema (which may
+/// be left unconnected if the sender uses the names of `plant`).
 class RobotInputReceiver : public drake::systems::LeafSystem<double> {
  public:
   explicit RobotInputReceiver(
-      const drake::multibody::MultibodyPlant<double>& plant);
+      const drake::multibody::MultibodyPlant<double>& plant,
+      bool compact = false);
+
+  const drake::systems::InputPort<double>& get_input_port_schema() const {
+    return this->get_input_port(schema_input_port_);
+  }
 
  private:
   void CopyInputOut(const drake::systems::Context<double>& context,
                     TimestampedVector<double>* output) const;
+  void CopyCompactInputOut(const drake::systems::Context<double>& context,
+                           TimestampedVector<double>* output) const;
 
   int num_actuators_;
-  std::map<std::string, int> actuatorIndexMap_;
+  int schema_input_port_ = -1;
+  const multibody::StateIndexLayout layout_;
+  // Ordering of the last message
+  mutable multibody::NameOrdering actuator_ordering_;
+  // Schemas of the compact messages
+  mutable RobotSchemaIndices schemas_;
 };
 
 /// Receives the output of a controller, and outputs it as an LCM
 /// message with type lcm_robot_u. Its output port is usually connected to
 /// an LcmPublisherSystem to publish the messages it generates.
+///
+/// If `compact`, the messages are lcmt_robot_input_compact, and their
+/// (constant) schema is output on get_output_port_schema().
 class RobotCommandSender : public drake::systems::LeafSystem<double> {
  public:
   explicit RobotCommandSender(
-      const drake::multibody::MultibodyPlant<double>& plant);
+      const drake::multibody::MultibodyPlant<double>& plant,
+      bool compact = false);
+
+  const drake::systems::OutputPort<double>& get_output_port_schema() const {
+    return this->get_output_port(schema_output_port_);
+  }
 
  private:
   void OutputCommand(const drake::systems::Context<double>& context,
                      dairlib::lcmt_robot_input* output) const;
+  void OutputCompactCommand(const drake::systems::Context<double>& context,
+                            dairlib::lcmt_robot_input_compact* output) const;
+  void OutputSchema(const drake::systems::Context<double>& context,
+                    dairlib::lcmt_robot_schema* output) const;
 
   int num_actuators_;
+  int schema_output_port_ = -1;
   std::vector<std::string> ordered_actuator_names_;
   std::map<std::string, int> actuatorIndexMap_;
+  lcmt_robot_schema schema_;
 };
 
 }  // namespace systems
@@ -0,0 +1,187 @@
+#include "systems/robot_lcm_systems.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/find_resource.h"
+#include "multibody/multibody_utils.h"
+
+#include "drake/multibody/parsing/parser.h"
+
+namespace dairlib {
+namespace systems {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using Eigen::VectorXd;
+
+class RobotLcmSystemsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    drake::multibody::Parser(plant_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->Finalize();
+    nq_ = plant_->num_positions();
+    nv_ = plant_->num_velocities();
+    nu_ = plant_->num_actuators();
+    std::srand(0);
+  }
+
+  // Output of `receiver` with its message port fixed to `msg`, and its
+  // schema port to `schema` (if not nullptr)
+  template <typename Receiver, typename Message>
+  std::unique_ptr<drake::systems::SystemOutput<double>> Receive(
+      const Receiver& receiver, const Message& msg,
+      const lcmt_robot_schema* schema = nullptr) {
+    auto context = receiver.CreateDefaultContext();
+    receiver.get_input_port(0).FixValue(context.get(), msg);
+    if (schema) {
+      receiver.get_input_port_schema().FixValue(context.get(), *schema);
+    }
+    auto output = receiver.AllocateOutput();
+    receiver.CalcOutput(*context, output.get());
+    return output;
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  int nq_;
+  int nv_;
+  int nu_;
+};
+
+TEST_F(RobotLcmSystemsTest, CompactOutputRoundTrip) {
+  const RobotOutputSender sender(*plant_, true, true, /*compact=*/true);
+  auto context = sender.CreateDefaultContext();
+  context->SetTime(1.5);
+  const VectorXd x = VectorXd::Random(nq_ + nv_);
+  const VectorXd u = VectorXd::Random(nu_);
+  sender.get_input_port_state().FixValue(context.get(), x);
+  sender.get_input_port_effort().FixValue(context.get(), u);
+  sender.get_input_port_imu().FixValue(context.get(), VectorXd::Zero(3));
+  const auto& msg =
+      sender.get_output_port(0).Eval<lcmt_robot_output_compact>(*context);
+  const auto& schema =
+      sender.get_output_port_schema().Eval<lcmt_robot_schema>(*context);
+  EXPECT_EQ(msg.schema_hash, schema.schema_hash);
+  EXPECT_EQ(schema.schema_hash, RobotSchemaHash(schema));
+
+  // The receiver knows the schema of its own plant, with or without the
+  // schema message
+  const RobotOutputReceiver receiver(*plant_, /*compact=*/true);
+  for (const lcmt_robot_schema* schema_msg : {&schema, nullptr}) {
+    auto output = Receive(receiver, msg, schema_msg);
+    const auto* state =
+        dynamic_cast<const OutputVector<double>*>(output->get_vector_data(0));
+    ASSERT_NE(state, nullptr);
+    EXPECT_EQ(state->GetState(), x);
+    EXPECT_EQ(state->GetEfforts(), u);
+    EXPECT_EQ(state->get_timestamp(), 1.5);
+  }
+}
+
+TEST_F(RobotLcmSystemsTest, CompactInputRoundTrip) {
+  const RobotCommandSender sender(*plant_, /*compact=*/true);
+  auto context = sender.CreateDefaultContext();
+  const VectorXd u = VectorXd::Random(nu_);
+  TimestampedVector<double> command(u);
+  command.set_timestamp(0.25);
+  sender.get_input_port(0).FixValue(context.get(), command);
+  const auto& msg =
+      sender.get_output_port(0).Eval<lcmt_robot_input_compact>(*context);
+
+  const RobotInputReceiver receiver(*plant_, /*compact=*/true);
+  auto output = Receive(receiver, msg);
+  const auto* efforts = dynamic_cast<const TimestampedVector<double>*>(
+      output->get_vector_data(0));
+  ASSERT_NE(efforts, nullptr);
+  EXPECT_EQ(efforts->get_data(), u);
+  EXPECT_EQ(efforts->get_timestamp(), 0.25);
+}
+
+TEST_F(RobotLcmSystemsTest, UnknownSchemaThrows) {
+  lcmt_robot_output_compact msg{};
+  msg.num_positions = nq_;
+  msg.position = std::vector<double>(nq_, 1.0);
+  msg.num_velocities = 0;
+  msg.num_efforts = 0;
+  msg.schema_hash = 12345;
+  const RobotOutputReceiver receiver(*plant_, /*compact=*/true);
+  EXPECT_THROW(Receive(receiver, msg), std::runtime_error);
+
+  lcmt_robot_input_compact input_msg{};
+  input_msg.num_efforts = nu_;
+  input_msg.efforts = std::vector<double>(nu_, 1.0);
+  input_msg.schema_hash = 12345;
+  const RobotInputReceiver input_receiver(*plant_, /*compact=*/true);
+  EXPECT_THROW(Receive(input_receiver, input_msg), std::runtime_error);
+}
+
+// A sender whose names are in the reverse order of the plant's
+TEST_F(RobotLcmSystemsTest, ForeignOrdering) {
+  const multibody::StateIndexLayout layout(*plant_);
+  lcmt_robot_schema schema = MakeRobotSchema(layout, true, true);
+  std::reverse(schema.position_names.begin(), schema.position_names.end());
+  std::reverse(schema.velocity_names.begin(), schema.velocity_names.end());
+  std::reverse(schema.effort_names.begin(), schema.effort_names.end());
+  schema.schema_hash = RobotSchemaHash(schema);
+  ASSERT_NE(schema.schema_hash,
+            MakeRobotSchema(layout, true, true).schema_hash);
+
+  const VectorXd q = VectorXd::Random(nq_);
+  const VectorXd v = VectorXd::Random(nv_);
+  const VectorXd u = VectorXd::Random(nu_);
+  lcmt_robot_output_compact msg{};
+  msg.schema_hash = schema.schema_hash;
+  msg.num_positions = nq_;
+  msg.num_velocities = nv_;
+  msg.num_efforts = nu_;
+  msg.position = std::vector<double>(q.data(), q.data() + nq_);
+  msg.velocity = std::vector<double>(v.data(), v.data() + nv_);
+  msg.effort = std::vector<double>(u.data(), u.data() + nu_);
+  std::reverse(msg.position.begin(), msg.position.end());
+  std::reverse(msg.velocity.begin(), msg.velocity.end());
+  std::reverse(msg.effort.begin(), msg.effort.end());
+
+  const RobotOutputReceiver receiver(*plant_, /*compact=*/true);
+  EXPECT_THROW(Receive(receiver, msg), std::runtime_error);
+  auto output = Receive(receiver, msg, &schema);
+  const auto* state =
+      dynamic_cast<const OutputVector<double>*>(output->get_vector_data(0));
+  ASSERT_NE(state, nullptr);
+  EXPECT_EQ(state->GetPositions(), q);
+  EXPECT_EQ(state->GetVelocities(), v);
+  EXPECT_EQ(state->GetEfforts(), u);
+}
+
+// The same names split differently between positions, velocities and
+// efforts have different hashes
+TEST_F(RobotLcmSystemsTest, SchemaHashCoversSizes) {
+  lcmt_robot_schema a{};
+  a.num_positions = 2;
+  a.position_names = {"x", "y"};
+  a.num_velocities = 1;
+  a.velocity_names = {"z"};
+  a.num_efforts = 0;
+  lcmt_robot_schema b{};
+  b.num_positions = 1;
+  b.position_names = {"x"};
+  b.num_velocities = 2;
+  b.velocity_names = {"y", "z"};
+  b.num_efforts = 0;
+  EXPECT_NE(RobotSchemaHash(a), RobotSchemaHash(b));
+}
+
+}  // namespace
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
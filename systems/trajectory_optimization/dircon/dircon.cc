@@ -1,5 +1,14 @@
 #include "systems/trajectory_optimization/dircon/dircon.h"
 
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "drake/math/autodiff.h"
+#include "drake/math/autodiff_gradient.h"
 #include "multibody/kinematic/kinematic_constraints.h"
 #include "multibody/multibody_utils.h"
 #include "systems/trajectory_optimization/dircon/dircon_opt_constraints.h"
@@ -23,22 +32,27 @@ using multibody::KinematicAccelerationConstraint;
 using multibody::KinematicPositionConstraint;
 using multibody::KinematicVelocityConstraint;
 
+// Size of the DynamicsCache of each constraint with parallel evaluation (the
+// collocation constraint evaluates the dynamics at three points)
+static constexpr int kConstraintCacheSize = 4;
+
 template <typename T>
-Dircon<T>::Dircon(const DirconModeSequence<T>& mode_sequence)
+Dircon<T>::Dircon(const DirconModeSequence<T>& mode_sequence, int num_threads)
     : Dircon<T>({}, &mode_sequence, mode_sequence.plant(),
-                mode_sequence.count_knotpoints()) {}
+                mode_sequence.count_knotpoints(), num_threads) {}
 
 template <typename T>
-Dircon<T>::Dircon(DirconMode<T>* mode)
+Dircon<T>::Dircon(DirconMode<T>* mode, int num_threads)
     : Dircon<T>(std::make_unique<DirconModeSequence<T>>(mode), nullptr,
-                mode->plant(), mode->num_knotpoints()) {}
+                mode->plant(), mode->num_knotpoints(), num_threads) {}
 
 /// Private constructor. Determines which DirconModeSequence was provided,
 /// a locally owned unique_ptr or an externally owned const reference
 template <typename T>
 Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
                   const DirconModeSequence<T>* ext_sequence,
-                  const MultibodyPlant<T>& plant, int num_knotpoints)
+                  const MultibodyPlant<T>& plant, int num_knotpoints,
+                  int num_threads)
     : drake::systems::trajectory_optimization::MultipleShooting(
           plant.num_actuators(), plant.num_positions() + plant.num_velocities(),
           num_knotpoints, 1e-8, 1e8),
@@ -46,7 +60,17 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
       plant_(plant),
       mode_sequence_(ext_sequence ? *ext_sequence : *my_sequence_),
       contexts_(num_modes()),
-      mode_start_(num_modes()) {
+      knot_dynamics_(num_modes()),
+      mode_start_(num_modes()),
+      num_threads_(num_threads) {
+  DRAKE_DEMAND(num_threads >= 1);
+  if (num_threads_ > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>(num_threads_);
+  }
+  // AutoDiffXd copy of the plant for the constraint Jacobians
+  if constexpr (std::is_same<T, double>::value) {
+    plant_ad_ = drake::systems::System<double>::ToAutoDiffXd(plant_);
+  }
   // Loop over all modes
   for (int i_mode = 0; i_mode < num_modes(); i_mode++) {
     const auto& mode = get_mode(i_mode);
@@ -114,7 +138,18 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
     //
     for (int j = 0; j < mode.num_knotpoints(); j++) {
       contexts_[i_mode].push_back(std::move(plant_.CreateDefaultContext()));
+      knot_dynamics_[i_mode].push_back(
+          std::make_unique<KnotDynamics<T>>(plant_, mode.evaluators()));
     }
+    // With parallel evaluation, the constraints create their own contexts
+    // (and dynamics)
+    auto knot_context = [&](int mode_index, int j) -> Context<T>* {
+      return (num_threads_ > 1) ? nullptr : contexts_[mode_index].at(j).get();
+    };
+    auto knot_dynamics = [&](int mode_index, int j) -> KnotDynamics<T>* {
+      return (num_threads_ > 1) ? nullptr
+                                : knot_dynamics_[mode_index].at(j).get();
+    };
 
     // We only need an impact if the post-impact constraint set contains
     // anything not already in the pre-impact constraint set.
@@ -138,14 +173,25 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
     // declared every decision variable yet (see impulse variables below), the
     // impulse variables do not enter into any dynamics evaluations, so we are
     // safe. Add a small factor (10%) just for safety margin.
+    // With parallel evaluation, every constraint gets its own (small) cache
     int cache_size = 1.1 * num_vars();
     cache_.push_back(
         std::make_unique<DynamicsCache<T>>(mode.evaluators(), cache_size));
+    DynamicsCache<T>* mode_cache = cache_.back().get();
+    auto constraint_cache = [&]() {
+      if (num_threads_ == 1) return mode_cache;
+      cache_.push_back(std::make_unique<DynamicsCache<T>>(
+          mode.evaluators(), kConstraintCacheSize));
+      return cache_.back().get();
+    };
     for (int j = 0; j < mode.num_knotpoints() - 1; j++) {
       auto constraint = std::make_shared<DirconCollocationConstraint<T>>(
-          plant_, mode.evaluators(), contexts_[i_mode].at(j).get(),
-          contexts_[i_mode].at(j + 1).get(), i_mode, j, cache_[i_mode].get());
+          plant_, mode.evaluators(), knot_context(i_mode, j),
+          knot_context(i_mode, j + 1), i_mode, j, constraint_cache(),
+          plant_ad_.get(), knot_dynamics(i_mode, j),
+          knot_dynamics(i_mode, j + 1));
       constraint->SetConstraintScaling(mode.GetDynamicsScale());
+      dircon_constraints_.insert(constraint.get());
       AddConstraint(
           constraint,
           {timestep(mode_start_[i_mode] + j), state_vars(i_mode, j),
@@ -182,10 +228,11 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
 
         auto pos_constraint = std::make_shared<KinematicPositionConstraint<T>>(
             plant_, mode.evaluators(), lb, ub, mode.relative_constraints(),
-            contexts_[i_mode].at(j).get(),
+            knot_context(i_mode, j),
             "kinematic_position[" + std::to_string(i_mode) + "][" +
                 std::to_string(j) + "]");
         pos_constraint->SetConstraintScaling(mode.GetKinPositionScale());
+        dircon_constraints_.insert(pos_constraint.get());
         AddConstraint(pos_constraint,
                       {state_vars(i_mode, j).head(plant_.num_positions()),
                        offset_vars(i_mode)});
@@ -201,21 +248,23 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
                   plant_, mode.evaluators(),
                   VectorXd::Zero(mode.evaluators().count_active()),
                   VectorXd::Zero(mode.evaluators().count_active()),
-                  contexts_[i_mode].at(j).get(),
+                  knot_context(i_mode, j),
                   "kinematic_velocity[" + std::to_string(i_mode) + "][" +
                       std::to_string(j) + "]");
           vel_constraint->SetConstraintScaling(mode.GetKinVelocityScale());
+          dircon_constraints_.insert(vel_constraint.get());
           AddConstraint(vel_constraint, state_vars(i_mode, j));
         }
       }
 
       // Acceleration constraints (always)
       auto accel_constraint = std::make_shared<CachedAccelerationConstraint<T>>(
-          plant_, mode.evaluators(), contexts_[i_mode].at(j).get(),
+          plant_, mode.evaluators(), knot_context(i_mode, j),
           "kinematic_acceleration[" + std::to_string(i_mode) + "][" +
               std::to_string(j) + "]",
-          cache_[i_mode].get());
+          constraint_cache(), plant_ad_.get(), knot_dynamics(i_mode, j));
       accel_constraint->SetConstraintScaling(mode.GetKinAccelerationScale());
+      dircon_constraints_.insert(accel_constraint.get());
       AddConstraint(accel_constraint,
                     {state_vars(i_mode, j), input_vars(i_mode, j),
                      force_vars(i_mode, j)});
@@ -233,9 +282,12 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
 
         // Use pre-impact context
         auto impact_constraint = std::make_shared<ImpactConstraint<T>>(
-            plant_, mode.evaluators(), contexts_[i_mode - 1].back().get(),
-            "impact[" + std::to_string(i_mode) + "]");
+            plant_, mode.evaluators(),
+            knot_context(i_mode - 1, pre_impact_index),
+            "impact[" + std::to_string(i_mode) + "]",
+            knot_dynamics(i_mode - 1, pre_impact_index));
         impact_constraint->SetConstraintScaling(mode.GetImpactScale());
+        dircon_constraints_.insert(impact_constraint.get());
 
         AddConstraint(
             impact_constraint,
@@ -258,6 +310,8 @@ Dircon<T>::Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
     // Create and add quaternion constraints
     //
     auto quaternion_constraint = std::make_shared<QuaternionConstraint<T>>();
+    // (QuaternionConstraint doesn't have any state, so it can be shared)
+    dircon_constraints_.insert(quaternion_constraint.get());
     for (int j = 0; j < mode.num_knotpoints(); j++) {
       if (!mode.IsSkipQuaternionConstraint(j)) {
         auto start_indices = multibody::QuaternionStartIndices(plant_);
@@ -412,6 +466,68 @@ const VectorXDecisionVariable Dircon<T>::impulse_vars(
   return impulse_vars_.at(mode_transition_index);
 }
 
+template <typename T>
+DynamicsCacheStats Dircon<T>::GetDynamicsCacheStats() const {
+  DynamicsCacheStats stats;
+  for (const auto& cache : cache_) {
+    stats += cache->stats();
+  }
+  return stats;
+}
+
+template <typename T>
+void Dircon<T>::EvalGenericConstraints(
+    const Eigen::Ref<const VectorXd>& decision_variables,
+    std::vector<VectorXd>* values, std::vector<MatrixXd>* gradients) const {
+  DRAKE_DEMAND(decision_variables.size() == num_vars());
+  const auto& bindings = generic_constraints();
+  values->resize(bindings.size());
+  if (gradients) {
+    gradients->resize(bindings.size());
+  }
+
+  // Each binding only writes its own outputs
+  auto eval_binding = [&](int i) {
+    const auto& binding = bindings[i];
+    VectorXd x(binding.GetNumElements());
+    for (int k = 0; k < x.size(); k++) {
+      x(k) = decision_variables(
+          FindDecisionVariableIndex(binding.variables()(k)));
+    }
+    if (gradients) {
+      drake::AutoDiffVecXd y;
+      binding.evaluator()->Eval(drake::math::initializeAutoDiff(x), &y);
+      values->at(i) = drake::math::autoDiffToValueMatrix(y);
+      gradients->at(i) = drake::math::autoDiffToGradientMatrix(y);
+      // (The gradient is empty if y doesn't depend on x)
+      if (gradients->at(i).cols() != x.size()) {
+        gradients->at(i) = MatrixXd::Zero(y.size(), x.size());
+      }
+    } else {
+      binding.evaluator()->Eval(x, &values->at(i));
+    }
+  };
+
+  std::vector<int> parallel_bindings;
+  std::vector<int> serial_bindings;
+  for (int i = 0; i < static_cast<int>(bindings.size()); i++) {
+    if (thread_pool_ &&
+        dircon_constraints_.count(bindings[i].evaluator().get())) {
+      parallel_bindings.push_back(i);
+    } else {
+      serial_bindings.push_back(i);
+    }
+  }
+  if (thread_pool_) {
+    thread_pool_->ParallelFor(parallel_bindings.size(), [&](int k) {
+      eval_binding(parallel_bindings[k]);
+    });
+  }
+  for (int i : serial_bindings) {
+    eval_binding(i);
+  }
+}
+
 template <typename T>
 void Dircon<T>::CreateVisualizationCallback(
     std::string model_file, std::vector<unsigned int> poses_per_mode,
@@ -464,17 +580,37 @@ void Dircon<T>::CreateVisualizationCallback(
       model_file, num_poses, alpha_vec, weld_frame_to_world);
 
   // Callback lambda function
-  auto my_callback = [this, num_poses](const Eigen::Ref<const VectorXd>& vars) {
-    VectorXd vars_copy = vars;
-    Eigen::Map<MatrixXd> states(vars_copy.data(), this->plant_.num_positions(),
-                                num_poses);
-
-    this->callback_visualizer_->DrawPoses(states);
+  auto my_callback = [this](const Eigen::Ref<const VectorXd>& vars) {
+    if (this->visualization_worker_) {
+      this->visualization_worker_->Push(vars);
+    } else {
+      this->DrawVisualizationPoses(vars);
+    }
   };
 
   AddVisualizationCallback(my_callback, vars);
 }
 
+template <typename T>
+void Dircon<T>::DrawVisualizationPoses(
+    const Eigen::Ref<const VectorXd>& vars) {
+  const int num_poses = vars.size() / plant_.num_positions();
+  callback_visualizer_->DrawPoses(Eigen::Map<const MatrixXd>(
+      vars.data(), plant_.num_positions(), num_poses));
+}
+
+template <typename T>
+void Dircon<T>::SetAsyncVisualization(double max_rate) {
+  DRAKE_DEMAND(max_rate >= 0);
+  // (Destroying the worker draws its pending iterate)
+  visualization_worker_.reset();
+  if (max_rate > 0) {
+    visualization_worker_ = std::make_unique<ThrottledWorker<VectorXd>>(
+        [this](const VectorXd& vars) { DrawVisualizationPoses(vars); },
+        max_rate);
+  }
+}
+
 template <typename T>
 void Dircon<T>::CreateVisualizationCallback(std::string model_file,
                                             unsigned int num_poses,
@@ -865,6 +1001,165 @@ void Dircon<T>::ScaleKinConstraintSlackVariables(int mode,
   }
 }
 
+template <typename T>
+void Dircon<T>::AutoScale(ScalingMethod method, int num_passes) {
+  DRAKE_DEMAND(num_passes >= 1);
+  VectorXd z = initial_guess();
+  for (int i = 0; i < z.size(); i++) {
+    if (std::isnan(z(i))) z(i) = 0;
+  }
+  std::vector<VectorXd> values;
+  std::vector<MatrixXd> gradients;
+  EvalGenericConstraints(z, &values, &gradients);
+
+  // Columns: the variables scaled together by the setters above share a group
+  std::vector<int> group(num_vars(), -1);
+  int num_groups = 0;
+  auto add_to_group = [&](const drake::symbolic::Variable& var, int g) {
+    group[FindDecisionVariableIndex(var)] = g;
+  };
+  const int n_q = plant_.num_positions();
+  const int n_x = n_q + plant_.num_velocities();
+  for (int i = 0; i < h_vars().size(); i++) {
+    add_to_group(h_vars()(i), num_groups);
+  }
+  num_groups++;
+  for (int i = 0; i < n_x; i++, num_groups++) {
+    for (int j = 0; j < N(); j++) {
+      add_to_group(this->state(j)(i), num_groups);
+    }
+    for (int mode = 0; i >= n_q && mode < num_modes() - 1; mode++) {
+      add_to_group(post_impact_velocity_vars(mode)(i - n_q), num_groups);
+    }
+  }
+  for (int i = 0; i < plant_.num_actuators(); i++, num_groups++) {
+    for (int j = 0; j < N(); j++) {
+      add_to_group(this->input(j)(i), num_groups);
+    }
+  }
+  for (int mode = 0; mode < num_modes(); mode++) {
+    for (int k = 0; k < get_mode(mode).evaluators().count_full(); k++) {
+      for (int j = 0; j < mode_length(mode); j++) {
+        add_to_group(force_vars(mode, j)(k), num_groups);
+      }
+      for (int j = 0; j < mode_length(mode) - 1; j++) {
+        add_to_group(collocation_force_vars(mode, j)(k), num_groups);
+        add_to_group(collocation_slack_vars(mode, j)(k), num_groups + 1);
+      }
+      num_groups += 2;
+    }
+  }
+  for (int j = 0; j < num_vars(); j++) {
+    if (group[j] < 0) group[j] = num_groups++;
+  }
+
+  // Rows: those of each NonlinearConstraint (shared by all of its bindings).
+  // The other constraints keep their scaling, with row -1.
+  std::vector<std::pair<solvers::NonlinearConstraint<T>*, int>> row_starts;
+  std::unordered_map<const drake::solvers::EvaluatorBase*, int> row_start;
+  int num_rows = 0;
+  struct Entry {
+    int row;
+    int group;
+    double value;
+  };
+  std::vector<Entry> entries;
+  const auto& variable_scaling = GetVariableScaling();
+  const auto& bindings = generic_constraints();
+  for (size_t i = 0; i < bindings.size(); i++) {
+    auto constraint = dynamic_cast<solvers::NonlinearConstraint<T>*>(
+        bindings[i].evaluator().get());
+    int start = -1;
+    if (constraint) {
+      const auto it = row_start.emplace(constraint, num_rows);
+      if (it.second) {
+        row_starts.emplace_back(constraint, num_rows);
+        num_rows += constraint->num_outputs();
+      }
+      start = it.first->second;
+    }
+    for (int k = 0; k < gradients[i].cols(); k++) {
+      const int j = FindDecisionVariableIndex(bindings[i].variables()(k));
+      const double s =
+          variable_scaling.count(j) ? variable_scaling.at(j) : 1;
+      for (int r = 0; r < gradients[i].rows(); r++) {
+        const double value = std::abs(gradients[i](r, k)) * s;
+        if (std::isfinite(value) && value > 0) {
+          entries.push_back({start >= 0 ? start + r : -1, group[j], value});
+        }
+      }
+    }
+  }
+
+  // Alternately equilibrate the rows and the columns
+  VectorXd row_factor = VectorXd::Ones(num_rows);
+  VectorXd col_factor = VectorXd::Ones(num_groups);
+  auto update = [method](const VectorXd& max, const VectorXd& min,
+                         VectorXd* factor) {
+    for (int i = 0; i < factor->size(); i++) {
+      if (max(i) > 0) {
+        (*factor)(i) /= (method == ScalingMethod::kRuiz)
+                            ? std::sqrt(max(i))
+                            : std::sqrt(max(i) * min(i));
+      }
+    }
+  };
+  const double inf = std::numeric_limits<double>::infinity();
+  for (int pass = 0; pass < num_passes; pass++) {
+    VectorXd max = VectorXd::Zero(num_rows);
+    VectorXd min = VectorXd::Constant(num_rows, inf);
+    for (const auto& entry : entries) {
+      if (entry.row < 0) continue;
+      const double value =
+          entry.value * row_factor(entry.row) * col_factor(entry.group);
+      max(entry.row) = std::max(max(entry.row), value);
+      min(entry.row) = std::min(min(entry.row), value);
+    }
+    update(max, min, &row_factor);
+
+    max = VectorXd::Zero(num_groups);
+    min = VectorXd::Constant(num_groups, inf);
+    for (const auto& entry : entries) {
+      const double value = entry.value * col_factor(entry.group) *
+                           (entry.row < 0 ? 1 : row_factor(entry.row));
+      max(entry.group) = std::max(max(entry.group), value);
+      min(entry.group) = std::min(min(entry.group), value);
+    }
+    update(max, min, &col_factor);
+  }
+  row_factor = row_factor.cwiseMax(1e-4).cwiseMin(1e4);
+  col_factor = col_factor.cwiseMax(1e-4).cwiseMin(1e4);
+
+  // Scaling a row multiplies it (and its bounds, so that the feasible set
+  // doesn't change), and scaling a variable (x = s * x_scaled) multiplies its
+  // column
+  for (const auto& [constraint, start] : row_starts) {
+    auto scaling = constraint->GetConstraintScaling();
+    const VectorXd factor =
+        row_factor.segment(start, constraint->num_outputs());
+    for (int r = 0; r < constraint->num_outputs(); r++) {
+      if (factor(r) != 1) {
+        const double old_scale = scaling.count(r) ? scaling.at(r) : 1;
+        scaling[r] = old_scale * factor(r);
+      }
+    }
+    constraint->SetConstraintScaling(scaling);
+    // (0 and infinite bounds are unchanged)
+    constraint->UpdateLowerBound(
+        constraint->lower_bound().cwiseProduct(factor));
+    constraint->UpdateUpperBound(
+        constraint->upper_bound().cwiseProduct(factor));
+  }
+  for (int j = 0; j < num_vars(); j++) {
+    if (col_factor(group[j]) != 1) {
+      const double old_scale =
+          variable_scaling.count(j) ? variable_scaling.at(j) : 1;
+      this->SetVariableScaling(decision_variable(j),
+                               old_scale * col_factor(group[j]));
+    }
+  }
+}
+
 template <typename T>
 Eigen::MatrixXd Dircon<T>::GetStateSamplesByMode(
     const MathematicalProgramResult& result, int mode) const {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <unordered_set>
 #include <vector>
 #include <memory.h>
 
@@ -9,8 +10,11 @@
 #include "drake/solvers/constraint.h"
 #include "drake/systems/trajectory_optimization/multiple_shooting.h"
 
+#include "common/thread_pool.h"
+#include "common/throttled_worker.h"
 #include "systems/trajectory_optimization/dircon/dircon_mode.h"
 #include "systems/trajectory_optimization/dircon/dynamics_cache.h"
+#include "systems/trajectory_optimization/dircon/knot_dynamics.h"
 #include "multibody/multipose_visualizer.h"
 
 namespace dairlib {
@@ -28,6 +32,13 @@ namespace trajectory_optimization {
 /// achieve a 3rd order integration accuracy.
 /// DIRCON addresses kinematic constraints by incorporating constraint forces
 /// and corresponding acceleration, velocity, and position constraints.
+///
+/// By default, the constraints at a knot point share the context of the knot
+/// point, and the constraints of a mode share a DynamicsCache, so the
+/// constraints must be evaluated one at a time. With `num_threads` > 1, every
+/// constraint gets its own contexts and cache instead, and
+/// EvalGenericConstraints() evaluates the constraints across `num_threads`
+/// threads.
 template <typename T>
 class Dircon
     : public drake::systems::trajectory_optimization::MultipleShooting {
@@ -35,10 +46,26 @@ class Dircon
   DRAKE_NO_COPY_NO_MOVE_NO_ASSIGN(Dircon)
 
   /// The default, hybrid constructor. Takes a mode sequence.
-  Dircon(const DirconModeSequence<T>& mode_sequence);
+  Dircon(const DirconModeSequence<T>& mode_sequence, int num_threads = 1);
 
   /// For simplicity, a constructor that takes only a single mode as a pointer.
-  Dircon(DirconMode<T>* mode);
+  Dircon(DirconMode<T>* mode, int num_threads = 1);
+
+  /// Evaluates all the generic constraints of the program (in the order of
+  /// generic_constraints()) at `decision_variables`. values->at(i) is the
+  /// value of the i-th binding, and gradients->at(i) (if `gradients` is not
+  /// nullptr) is its Jacobian with respect to the variables of the binding.
+  /// The constraints created by Dircon are evaluated in parallel when
+  /// num_threads > 1, and the other ones on the calling thread. The results
+  /// don't depend on the number of threads.
+  void EvalGenericConstraints(
+      const Eigen::Ref<const Eigen::VectorXd>& decision_variables,
+      std::vector<Eigen::VectorXd>* values,
+      std::vector<Eigen::MatrixXd>* gradients = nullptr) const;
+
+  /// Combined counters of all of the DynamicsCaches (e.g. to check the hit
+  /// rate after a solve)
+  DynamicsCacheStats GetDynamicsCacheStats() const;
 
   /// Returns a vector of matrices containing the state and derivative values at
   /// each breakpoint at the solution for each mode of the trajectory.
@@ -107,6 +134,14 @@ class Dircon
   void CreateVisualizationCallback(std::string model_file, double alpha,
       std::string weld_frame_to_world = "");
 
+  /// Moves the drawing of the visualization callback to a background thread,
+  /// which draws the latest iterate at most `max_rate` times per second
+  /// (skipping the others). The solver then only pays for a copy of the
+  /// decision variables. 0 (the default) draws every iterate on the solver
+  /// thread. Can be called before or after CreateVisualizationCallback(), but
+  /// not during a solve.
+  void SetAsyncVisualization(double max_rate);
+
   /// Set the initial guess for the force variables for a specific mode
   /// @param mode the mode index
   /// @param traj_init_l contact forces lambda (interpreted at knot points)
@@ -214,20 +249,44 @@ class Dircon
   void ScaleKinConstraintSlackVariables(int mode, std::vector<int> idx_list,
                                         double scale);
 
+  enum class ScalingMethod { kGeometricMean, kRuiz };
+
+  /// Automatic scaling, in place of (or on top of) the setters above.
+  /// Evaluates the Jacobians of the generic constraints at the initial guess
+  /// (unset entries are taken as 0) and equilibrates them, scaling the rows
+  /// of the NonlinearConstraints (and their bounds) and the decision
+  /// variables. The variables that the setters above scale together (e.g.
+  /// one state across all knot points) share a single factor. Factors are
+  /// limited to [1e-4, 1e4] and multiply any scaling set beforehand, so this
+  /// must be called after the initial guess is set.
+  /// kGeometricMean divides each row and column by the geometric mean of its
+  /// largest and smallest entries, kRuiz by the square root of its largest
+  /// entry (driving all of them towards 1).
+  void AutoScale(ScalingMethod method = ScalingMethod::kGeometricMean,
+                 int num_passes = 10);
+
  private:
   // Private constructor to which public constructors funnel
   Dircon(std::unique_ptr<DirconModeSequence<T>> my_sequence,
       const DirconModeSequence<T>* ext_sequence,
       const drake::multibody::MultibodyPlant<T>& plant,
-      int num_knotpoints);
+      int num_knotpoints, int num_threads);
 
   std::unique_ptr<DirconModeSequence<T>> my_sequence_;
   const drake::multibody::MultibodyPlant<T>& plant_;
+  // Only for T = double, shared by the constraints with analytic Jacobians
+  std::unique_ptr<drake::multibody::MultibodyPlant<drake::AutoDiffXd>>
+      plant_ad_;
   const DirconModeSequence<T>& mode_sequence_;
   std::vector<std::vector<std::unique_ptr<drake::systems::Context<T>>>>
       contexts_;
+  // Shared dynamics terms of every knot point (see KnotDynamics)
+  std::vector<std::vector<std::unique_ptr<KnotDynamics<T>>>> knot_dynamics_;
   std::vector<int> mode_start_;
   void DoAddRunningCost(const drake::symbolic::Expression& e) override;
+  // Draws the positions in `vars` (the variables of the visualization
+  // callback) with callback_visualizer_
+  void DrawVisualizationPoses(const Eigen::Ref<const Eigen::VectorXd>& vars);
   std::vector<drake::solvers::VectorXDecisionVariable> force_vars_;
   std::vector<drake::solvers::VectorXDecisionVariable> collocation_force_vars_;
   std::vector<drake::solvers::VectorXDecisionVariable> collocation_slack_vars_;
@@ -236,7 +295,13 @@ class Dircon
   std::vector<drake::solvers::VectorXDecisionVariable> offset_vars_;
   std::vector<drake::solvers::VectorXDecisionVariable> quaternion_slack_vars_;
   std::unique_ptr<multibody::MultiposeVisualizer> callback_visualizer_;
+  // Draws for the visualization callback if set (see SetAsyncVisualization)
+  std::unique_ptr<ThrottledWorker<Eigen::VectorXd>> visualization_worker_;
   std::vector<std::unique_ptr<DynamicsCache<T>>> cache_;
+  // Parallel evaluation (see EvalGenericConstraints())
+  const int num_threads_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  std::unordered_set<const drake::solvers::EvaluatorBase*> dircon_constraints_;
 };
 
 }  // namespace trajectory_optimization
@@ -0,0 +1,231 @@
+#include "systems/trajectory_optimization/dircon/dircon_mesh_refinement.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "multibody/multibody_utils.h"
+
+#include "drake/common/drake_assert.h"
+#include "drake/common/trajectories/piecewise_polynomial.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+
+using drake::multibody::MultibodyPlant;
+using drake::solvers::MathematicalProgramResult;
+using drake::trajectories::PiecewisePolynomial;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+namespace {
+
+// Linear interpolation of the columns of `samples` (at `times`) at time t
+VectorXd Interpolate(const VectorXd& times, const MatrixXd& samples,
+                     double t) {
+  int k = 0;
+  while (k < times.size() - 2 && times(k + 1) <= t) {
+    k++;
+  }
+  const double s = std::clamp(
+      (t - times(k)) / (times(k + 1) - times(k)), 0.0, 1.0);
+  return (1 - s) * samples.col(k) + s * samples.col(k + 1);
+}
+
+}  // namespace
+
+DirconMeshRefinement::DirconMeshRefinement(
+    const MultibodyPlant<double>& plant,
+    const std::vector<int>& initial_num_knotpoints, ModeFactory make_mode,
+    ProblemSetup setup, const DirconMeshRefinementOptions& options)
+    : plant_(plant),
+      make_mode_(make_mode),
+      setup_(setup),
+      options_(options),
+      num_knotpoints_(initial_num_knotpoints) {
+  DRAKE_DEMAND(!num_knotpoints_.empty());
+  for (int n : num_knotpoints_) {
+    DRAKE_DEMAND(2 <= n && n <= options.max_knotpoints);
+  }
+  DRAKE_DEMAND(options.tolerance > 0);
+  DRAKE_DEMAND(options.max_iterations >= 1);
+  Build();
+}
+
+void DirconMeshRefinement::Build() {
+  modes_.clear();
+  mode_sequence_ = std::make_unique<DirconModeSequence<double>>(plant_);
+  for (size_t i = 0; i < num_knotpoints_.size(); i++) {
+    modes_.push_back(make_mode_(i, num_knotpoints_[i]));
+    DRAKE_DEMAND(modes_.back()->num_knotpoints() == num_knotpoints_[i]);
+    mode_sequence_->AddMode(modes_.back().get());
+  }
+  trajopt_ = std::make_unique<Dircon<double>>(*mode_sequence_);
+  setup_(trajopt_.get());
+}
+
+MathematicalProgramResult DirconMeshRefinement::Solve(
+    const drake::solvers::SolverInterface& solver) {
+  MathematicalProgramResult result;
+  solver.Solve(*trajopt_, trajopt_->initial_guess(),
+               trajopt_->solver_options(), &result);
+  num_iterations_ = 1;
+  if (!result.is_success()) return result;
+  interval_errors_ = EstimateIntervalErrors(*trajopt_, result);
+
+  while (num_iterations_ < options_.max_iterations) {
+    const std::vector<int> num_knotpoints =
+        Refine(num_knotpoints_, interval_errors_, options_);
+    if (num_knotpoints.empty()) break;
+
+    // The previous problem (and its modes) must outlive the warm start, and
+    // is restored if the refined problem fails
+    auto previous_modes = std::move(modes_);
+    auto previous_sequence = std::move(mode_sequence_);
+    auto previous = std::move(trajopt_);
+    const std::vector<int> previous_num_knotpoints = num_knotpoints_;
+    num_knotpoints_ = num_knotpoints;
+    Build();
+    WarmStart(*previous, result);
+
+    MathematicalProgramResult refined_result;
+    solver.Solve(*trajopt_, trajopt_->initial_guess(),
+                 trajopt_->solver_options(), &refined_result);
+    num_iterations_++;
+    if (!refined_result.is_success()) {
+      modes_ = std::move(previous_modes);
+      mode_sequence_ = std::move(previous_sequence);
+      trajopt_ = std::move(previous);
+      num_knotpoints_ = previous_num_knotpoints;
+      break;
+    }
+    result = std::move(refined_result);
+    interval_errors_ = EstimateIntervalErrors(*trajopt_, result);
+  }
+  return result;
+}
+
+std::vector<VectorXd> DirconMeshRefinement::EstimateIntervalErrors(
+    const Dircon<double>& trajopt, const MathematicalProgramResult& result) {
+  std::vector<MatrixXd> states;
+  std::vector<MatrixXd> derivatives;
+  std::vector<VectorXd> times;
+  trajopt.GetStateAndDerivativeSamples(result, &states, &derivatives, &times);
+
+  std::vector<VectorXd> errors;
+  for (int mode = 0; mode < trajopt.num_modes(); mode++) {
+    const int n = trajopt.mode_length(mode);
+    errors.push_back(VectorXd::Zero(std::max(n - 1, 0)));
+    if (n < 2) continue;
+
+    const auto& evaluators = trajopt.get_evaluator_set(mode);
+    const auto& plant = evaluators.plant();
+    const auto x_traj = PiecewisePolynomial<double>::CubicHermite(
+        times[mode], states[mode], derivatives[mode]);
+    const auto xdot_traj = x_traj.derivative();
+    const MatrixXd inputs = trajopt.GetInputSamplesByMode(result, mode);
+    const MatrixXd forces = trajopt.GetForceSamplesByMode(result, mode);
+    auto context = plant.CreateDefaultContext();
+
+    for (int k = 0; k < n - 1; k++) {
+      const double h = times[mode](k + 1) - times[mode](k);
+      VectorXd integral = VectorXd::Zero(states[mode].rows());
+      for (int i = 0; i <= 4; i++) {
+        const double t = times[mode](k) + i * h / 4;
+        const VectorXd x = x_traj.value(t);
+        const VectorXd u = Interpolate(times[mode], inputs, t);
+        multibody::setContext<double>(plant, x, u, context.get());
+        const VectorXd defect =
+            xdot_traj.value(t) -
+            evaluators.CalcTimeDerivativesWithForce(
+                context.get(), Interpolate(times[mode], forces, t));
+        integral += ((i == 0 || i == 4) ? 0.5 : 1.0) * h / 4 *
+                    defect.cwiseAbs();
+      }
+      errors[mode](k) = integral.maxCoeff();
+    }
+  }
+  return errors;
+}
+
+void DirconMeshRefinement::WarmStart(const Dircon<double>& previous,
+                                     const MathematicalProgramResult& result) {
+  std::vector<MatrixXd> states;
+  std::vector<MatrixXd> derivatives;
+  std::vector<VectorXd> times;
+  previous.GetStateAndDerivativeSamples(result, &states, &derivatives, &times);
+
+  int interval_start = 0;
+  for (int mode = 0; mode < trajopt_->num_modes(); mode++) {
+    const int n = trajopt_->mode_length(mode);
+    const double t0 = times[mode](0);
+    const double h = (times[mode].tail(1)(0) - t0) / (n - 1);
+    const auto x_traj = PiecewisePolynomial<double>::CubicHermite(
+        times[mode], states[mode], derivatives[mode]);
+    const MatrixXd inputs = previous.GetInputSamplesByMode(result, mode);
+    const MatrixXd forces = previous.GetForceSamplesByMode(result, mode);
+
+    for (int j = 0; j < n; j++) {
+      const double t = (j < n - 1) ? t0 + j * h : times[mode].tail(1)(0);
+      trajopt_->SetInitialGuess(trajopt_->state_vars(mode, j),
+                                x_traj.value(t));
+      trajopt_->SetInitialGuess(trajopt_->input_vars(mode, j),
+                                Interpolate(times[mode], inputs, t));
+      trajopt_->SetInitialGuess(trajopt_->force_vars(mode, j),
+                                Interpolate(times[mode], forces, t));
+      if (j == n - 1) continue;
+
+      trajopt_->SetInitialGuess(trajopt_->h_vars()(interval_start + j), h);
+      trajopt_->SetInitialGuess(
+          trajopt_->collocation_force_vars(mode, j),
+          Interpolate(times[mode], forces, t + h / 2));
+      // The slack variables vanish at a solution
+      const auto& gamma = trajopt_->collocation_slack_vars(mode, j);
+      trajopt_->SetInitialGuess(gamma, VectorXd::Zero(gamma.size()));
+      const auto& quaternion_slack = trajopt_->quaternion_slack_vars(mode, j);
+      trajopt_->SetInitialGuess(quaternion_slack,
+                                VectorXd::Zero(quaternion_slack.size()));
+    }
+    trajopt_->SetInitialGuess(trajopt_->offset_vars(mode),
+                              result.GetSolution(previous.offset_vars(mode)));
+    if (mode < trajopt_->num_modes() - 1) {
+      trajopt_->SetInitialGuess(
+          trajopt_->impulse_vars(mode),
+          result.GetSolution(previous.impulse_vars(mode)));
+    }
+    interval_start += n - 1;
+  }
+  // The post-impact velocities are copied rather than interpolated
+  for (int i = 0; i < trajopt_->num_modes() - 1; i++) {
+    trajopt_->SetInitialGuess(
+        trajopt_->post_impact_velocity_vars(i),
+        result.GetSolution(previous.post_impact_velocity_vars(i)));
+  }
+}
+
+std::vector<int> DirconMeshRefinement::Refine(
+    const std::vector<int>& num_knotpoints,
+    const std::vector<VectorXd>& interval_errors,
+    const DirconMeshRefinementOptions& options) {
+  DRAKE_DEMAND(interval_errors.size() == num_knotpoints.size());
+  std::vector<int> refined_num_knotpoints = num_knotpoints;
+  bool refined = false;
+  for (size_t i = 0; i < num_knotpoints.size(); i++) {
+    if (interval_errors[i].size() == 0) continue;
+    const double error = interval_errors[i].maxCoeff();
+    if (error <= options.tolerance) continue;
+
+    const int num_intervals = num_knotpoints[i] - 1;
+    const int target = std::clamp(
+        static_cast<int>(std::ceil(
+            num_intervals * std::pow(error / options.tolerance, 0.25))),
+        num_intervals + 1, 2 * num_intervals);
+    refined_num_knotpoints[i] = std::min(target + 1, options.max_knotpoints);
+    refined |= refined_num_knotpoints[i] > num_knotpoints[i];
+  }
+  return refined ? refined_num_knotpoints : std::vector<int>();
+}
+
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "systems/trajectory_optimization/dircon/dircon.h"
+#include "systems/trajectory_optimization/dircon/dircon_mode.h"
+
+#include "drake/solvers/mathematical_program_result.h"
+#include "drake/solvers/solver_interface.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+
+struct DirconMeshRefinementOptions {
+  /// Largest accepted collocation error of an interval, as the integral of
+  /// the dynamics defect (in the units of the state)
+  double tolerance = 1e-3;
+  /// Maximum number of solves, including the first (coarse) one
+  int max_iterations = 5;
+  /// Upper bound on the number of knot points of each mode
+  int max_knotpoints = 100;
+};
+
+/// Coarse-to-fine solve of a Dircon problem. The problem is first solved
+/// with few knot points per mode, then the collocation error of every
+/// interval is estimated (see EstimateIntervalErrors()). Modes with errors
+/// above the tolerance get more knot points, and the problem is rebuilt and
+/// solved again, warm started from the interpolated previous solution. This
+/// repeats until every interval meets the tolerance.
+///
+/// Since Dircon uses equal time steps within a mode, knot points are added
+/// to whole modes: the number of intervals of a mode grows with the
+/// fourth root of its largest error over the tolerance (the local error of
+/// the Hermite-Simpson collocation being O(h^4) or better), at least by one
+/// and at most doubling.
+///
+/// Each problem is built from two callbacks: `make_mode(i, n)` returns mode i
+/// with n knot points (so knot-specific settings, e.g. constraint types at
+/// the first and last knot, can follow the new count), and
+/// `setup(trajopt)` adds the costs, constraints and solver options. The
+/// first problem takes its initial guess from `setup`, which the later ones
+/// override with the previous solution.
+class DirconMeshRefinement {
+ public:
+  using ModeFactory = std::function<std::unique_ptr<DirconMode<double>>(
+      int mode_index, int num_knotpoints)>;
+  using ProblemSetup = std::function<void(Dircon<double>* trajopt)>;
+
+  /// @param initial_num_knotpoints The number of knot points of each mode in
+  ///   the first solve (at least 2)
+  DirconMeshRefinement(const drake::multibody::MultibodyPlant<double>& plant,
+                       const std::vector<int>& initial_num_knotpoints,
+                       ModeFactory make_mode, ProblemSetup setup,
+                       const DirconMeshRefinementOptions& options =
+                           DirconMeshRefinementOptions());
+
+  /// Solves the sequence of problems with `solver`, and returns the result
+  /// of the last successful one. Stops early if a solve fails, in which case
+  /// trajopt(), num_knotpoints() and interval_errors() are restored to the
+  /// last successful solve (unless the first solve fails).
+  drake::solvers::MathematicalProgramResult Solve(
+      const drake::solvers::SolverInterface& solver);
+
+  /// Estimates the collocation error of every interval of every mode (the
+  /// i-th vector has mode_length(i) - 1 entries). The state trajectory is the
+  /// one of ReconstructStateTrajectory() and the input and constraint forces
+  /// are linearly interpolated. The error of an interval is the largest
+  /// (over the states) integral of the difference between the derivative of
+  /// the state trajectory and the constrained dynamics, computed with the
+  /// trapezoidal rule at the quarter points.
+  static std::vector<Eigen::VectorXd> EstimateIntervalErrors(
+      const Dircon<double>& trajopt,
+      const drake::solvers::MathematicalProgramResult& result);
+
+  /// Number of knot points of each mode for the next solve, given the
+  /// current ones and their EstimateIntervalErrors(), or empty if every
+  /// interval meets the tolerance or the modes above it can't grow
+  static std::vector<int> Refine(
+      const std::vector<int>& num_knotpoints,
+      const std::vector<Eigen::VectorXd>& interval_errors,
+      const DirconMeshRefinementOptions& options);
+
+  /// The problem of the result of Solve()
+  const Dircon<double>& trajopt() const { return *trajopt_; }
+
+  /// The number of knot points of each mode of the last problem
+  const std::vector<int>& num_knotpoints() const { return num_knotpoints_; }
+
+  /// EstimateIntervalErrors() of the last solution
+  const std::vector<Eigen::VectorXd>& interval_errors() const {
+    return interval_errors_;
+  }
+
+  /// Number of solves in the latest Solve(), including a failed one
+  int num_iterations() const { return num_iterations_; }
+
+ private:
+  // Replaces trajopt_ by a problem with num_knotpoints_
+  void Build();
+  // Sets the initial guess of trajopt_ from `result` of `previous`
+  void WarmStart(const Dircon<double>& previous,
+                 const drake::solvers::MathematicalProgramResult& result);
+
+  const drake::multibody::MultibodyPlant<double>& plant_;
+  const ModeFactory make_mode_;
+  const ProblemSetup setup_;
+  const DirconMeshRefinementOptions options_;
+
+  std::vector<int> num_knotpoints_;
+  std::vector<std::unique_ptr<DirconMode<double>>> modes_;
+  std::unique_ptr<DirconModeSequence<double>> mode_sequence_;
+  std::unique_ptr<Dircon<double>> trajopt_;
+  std::vector<Eigen::VectorXd> interval_errors_;
+  int num_iterations_ = 0;
+};
+
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
@@ -1,5 +1,9 @@
 #include "systems/trajectory_optimization/dircon/dircon_opt_constraints.h"
 
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "multibody/multibody_utils.h"
 
 namespace dairlib {
@@ -9,6 +13,7 @@ namespace trajectory_optimization {
 using multibody::KinematicEvaluatorSet;
 using solvers::NonlinearConstraint;
 
+using drake::AutoDiffXd;
 using drake::VectorX;
 using drake::multibody::MultibodyPlant;
 using drake::systems::Context;
@@ -34,7 +39,9 @@ template <typename T>
 DirconCollocationConstraint<T>::DirconCollocationConstraint(
     const MultibodyPlant<T>& plant, const KinematicEvaluatorSet<T>& evaluators,
     Context<T>* context_0, Context<T>* context_1, int mode_index,
-    int knot_index, DynamicsCache<T>* cache)
+    int knot_index, DynamicsCache<T>* cache,
+    const MultibodyPlant<AutoDiffXd>* plant_ad, KnotDynamics<T>* dynamics_0,
+    KnotDynamics<T>* dynamics_1)
     : NonlinearConstraint<T>(
           plant.num_positions() + plant.num_velocities(),
           1 +
@@ -55,7 +62,65 @@ DirconCollocationConstraint<T>::DirconCollocationConstraint(
       n_x_(plant.num_positions() + plant.num_velocities()),
       n_u_(plant.num_actuators()),
       n_l_(evaluators.count_full()),
-      cache_(cache) {}
+      cache_(cache),
+      dynamics_0_(dynamics_0),
+      dynamics_1_(dynamics_1),
+      dynamics_col_(
+          std::make_unique<KnotDynamics<T>>(plant, evaluators)) {
+  // Create new contexts (and their dynamics) if they were not provided
+  if (context_0_ == nullptr) {
+    owned_context_0_ = plant_.CreateDefaultContext();
+    context_0_ = owned_context_0_.get();
+  }
+  if (context_1_ == nullptr) {
+    owned_context_1_ = plant_.CreateDefaultContext();
+    context_1_ = owned_context_1_.get();
+  }
+  if (dynamics_0_ == nullptr) {
+    owned_dynamics_0_ = std::make_unique<KnotDynamics<T>>(plant, evaluators);
+    dynamics_0_ = owned_dynamics_0_.get();
+  }
+  if (dynamics_1_ == nullptr) {
+    owned_dynamics_1_ = std::make_unique<KnotDynamics<T>>(plant, evaluators);
+    dynamics_1_ = owned_dynamics_1_.get();
+  }
+
+  // The interpolated state depends on all of h, x0, x1, u0, u1, l0 and l1.
+  // The collocation forces only enter vdot, the velocity slack only enters
+  // qdot, and every quaternion slack only enters its own quaternion.
+  const int n_q = plant.num_positions();
+  const int lc_start = 1 + 2 * (n_x_ + n_u_) + 2 * n_l_;
+  std::vector<std::pair<int, int>> nonzeros;
+  for (int col = 0; col < lc_start; col++) {
+    for (int row = 0; row < n_x_; row++) {
+      nonzeros.emplace_back(row, col);
+    }
+  }
+  for (int i = 0; i < n_l_; i++) {
+    for (int row = n_q; row < n_x_; row++) {
+      nonzeros.emplace_back(row, lc_start + i);
+    }
+    for (int row = 0; row < n_q; row++) {
+      nonzeros.emplace_back(row, lc_start + n_l_ + i);
+    }
+  }
+  for (uint i = 0; i < quat_start_indices_.size(); i++) {
+    for (int row = 0; row < 4; row++) {
+      nonzeros.emplace_back(quat_start_indices_.at(i) + row,
+                            lc_start + 2 * n_l_ + i);
+    }
+  }
+  this->SetJacobianSparsity(nonzeros);
+
+  if constexpr (std::is_same<T, double>::value) {
+    if (plant_ad != nullptr) {
+      dynamics_jacobian_ = std::make_unique<DynamicsJacobian>(
+          plant_, *plant_ad, evaluators_, this->eps());
+    }
+  } else {
+    DRAKE_DEMAND(plant_ad == nullptr);
+  }
+}
 
 /// The format of the input to the eval() function is in the order
 ///   - timestep h
@@ -87,29 +152,28 @@ void DirconCollocationConstraint<T>::EvaluateConstraint(
   // Evaluate dynamics at k and k+1
   multibody::setContext<T>(plant_, x0, u0, context_0_);
   multibody::setContext<T>(plant_, x1, u1, context_1_);
-  const auto& xdot0 = CalcTimeDerivativesWithForce(context_0_, l0);
-  const auto& xdot1 = CalcTimeDerivativesWithForce(context_1_, l1);
+  const auto& xdot0 = CalcTimeDerivativesWithForce(context_0_, dynamics_0_, l0);
+  const auto& xdot1 = CalcTimeDerivativesWithForce(context_1_, dynamics_1_, l1);
 
   // Cubic interpolation to get xcol and xdotcol.
   const auto& xcol = 0.5 * (x0 + x1) + h / 8 * (xdot0 - xdot1);
   const auto& xdotcol = -1.5 * (x0 - x1) / h - .25 * (xdot0 + xdot1);
   const auto& ucol = 0.5 * (u0 + u1);
 
-  drake::MatrixX<T> J(evaluators_.count_full(), plant_.num_velocities());
-
   // Evaluate dynamics at colocation point
   multibody::setContext<T>(plant_, xcol, ucol, context_col_.get());
-  auto g = CalcTimeDerivativesWithForce(context_col_.get(), lc);
+  auto g = CalcTimeDerivativesWithForce(context_col_.get(), dynamics_col_.get(),
+                                        lc);
 
   // Add velocity slack contribution, J^T * gamma
-  evaluators_.EvalFullJacobian(*context_col_, &J);
+  const auto& J = dynamics_col_->EvalFullJacobian(*context_col_);
   VectorX<T> gamma_in_qdot_space(plant_.num_positions());
   plant_.MapVelocityToQDot(*context_col_, J.transpose() * gamma,
                            &gamma_in_qdot_space);
   g.head(plant_.num_positions()) += gamma_in_qdot_space;
 
   // Add quaternion slack contribution, quat * slack
-  for (uint i = 0; i < quat_start_indices_.size(); i++) {
+  for (size_t i = 0; i < quat_start_indices_.size(); i++) {
     g.segment(quat_start_indices_.at(i), 4) +=
         xcol.segment(quat_start_indices_.at(i), 4) * quat_slack(i);
   }
@@ -117,21 +181,145 @@ void DirconCollocationConstraint<T>::EvaluateConstraint(
   *y = xdotcol - g;
 }
 
+/// The Jacobian follows the chain rule through the cubic interpolation
+///   xcol = 0.5*(x0 + x1) + h/8*(xdot0 - xdot1)
+///   xdotcol = -1.5*(x0 - x1)/h - 0.25*(xdot0 + xdot1)
+/// where the dynamics xdot = f(x, u, lambda) and their Jacobians at the knot
+/// and collocation points come from DynamicsJacobian. The velocity slack term
+/// N(q)*J(q)^T*gamma is differentiated with respect to q by forward
+/// differencing, and the rest of the terms are linear.
+template <typename T>
+void DirconCollocationConstraint<T>::EvaluateConstraintWithJacobian(
+    const Eigen::Ref<const VectorXd>& x, VectorXd* y, MatrixXd* dy) const {
+  if constexpr (std::is_same<T, double>::value) {
+    if (dynamics_jacobian_) {
+      const int n_q = plant_.num_positions();
+      const int n_quat = quat_start_indices_.size();
+      // Extract decision variables
+      const double h = x(0);
+      const VectorXd x0 = x.segment(1, n_x_);
+      const VectorXd x1 = x.segment(1 + n_x_, n_x_);
+      const VectorXd u0 = x.segment(1 + 2 * n_x_, n_u_);
+      const VectorXd u1 = x.segment(1 + 2 * n_x_ + n_u_, n_u_);
+      const VectorXd l0 = x.segment(1 + 2 * (n_x_ + n_u_), n_l_);
+      const VectorXd l1 = x.segment(1 + 2 * (n_x_ + n_u_) + n_l_, n_l_);
+      const VectorXd lc = x.segment(1 + 2 * (n_x_ + n_u_) + 2 * n_l_, n_l_);
+      const VectorXd gamma =
+          x.segment(1 + 2 * (n_x_ + n_u_) + 3 * n_l_, n_l_);
+      const VectorXd quat_slack =
+          x.segment(1 + 2 * (n_x_ + n_u_) + 4 * n_l_, n_quat);
+
+      // Dynamics and their Jacobians at k and k+1
+      multibody::setContext<T>(plant_, x0, u0, context_0_);
+      dynamics_jacobian_->Calc(context_0_, l0, dynamics_0_);
+      const VectorXd xdot0 = dynamics_jacobian_->xdot();
+      const MatrixXd A0 = dynamics_jacobian_->dxdot_dx();
+      const MatrixXd B0 = dynamics_jacobian_->dxdot_du();
+      const MatrixXd C0 = dynamics_jacobian_->dxdot_dlambda();
+      multibody::setContext<T>(plant_, x1, u1, context_1_);
+      dynamics_jacobian_->Calc(context_1_, l1, dynamics_1_);
+      const VectorXd xdot1 = dynamics_jacobian_->xdot();
+      const MatrixXd A1 = dynamics_jacobian_->dxdot_dx();
+      const MatrixXd B1 = dynamics_jacobian_->dxdot_du();
+      const MatrixXd C1 = dynamics_jacobian_->dxdot_dlambda();
+
+      // Cubic interpolation to get xcol and xdotcol.
+      const VectorXd xcol = 0.5 * (x0 + x1) + h / 8 * (xdot0 - xdot1);
+      const VectorXd xdotcol = -1.5 * (x0 - x1) / h - .25 * (xdot0 + xdot1);
+      const VectorXd ucol = 0.5 * (u0 + u1);
+
+      // Dynamics at colocation point, g, and G_x = dg/dxcol
+      multibody::setContext<T>(plant_, xcol, ucol, context_col_.get());
+      dynamics_jacobian_->Calc(context_col_.get(), lc, dynamics_col_.get());
+      VectorXd g = dynamics_jacobian_->xdot();
+      MatrixXd G_x = dynamics_jacobian_->dxdot_dx();
+
+      // Add velocity slack contribution, N(q)*J^T*gamma, and its Jacobian
+      // with respect to gamma
+      const MatrixXd J = dynamics_col_->EvalFullJacobian(*context_col_);
+      VectorXd gamma_in_qdot_space(n_q);
+      plant_.MapVelocityToQDot(*context_col_, J.transpose() * gamma,
+                               &gamma_in_qdot_space);
+      g.head(n_q) += gamma_in_qdot_space;
+      MatrixXd G_gamma = MatrixXd::Zero(n_x_, n_l_);
+      VectorXd qdot(n_q);
+      for (int j = 0; j < n_l_; j++) {
+        plant_.MapVelocityToQDot(*context_col_, J.row(j).transpose(), &qdot);
+        G_gamma.col(j).head(n_q) = qdot;
+      }
+
+      // Add quaternion slack contribution, quat * slack
+      MatrixXd G_slack = MatrixXd::Zero(n_x_, n_quat);
+      for (int i = 0; i < n_quat; i++) {
+        const int start = quat_start_indices_.at(i);
+        g.segment(start, 4) += xcol.segment(start, 4) * quat_slack(i);
+        G_slack.col(i).segment(start, 4) = xcol.segment(start, 4);
+        G_x.block(start, start, 4, 4).diagonal().array() += quat_slack(i);
+      }
+
+      *y = xdotcol - g;
+
+      // Derivative of the velocity slack term with respect to q. (The
+      // collocation context is only used as a scratch context from here.)
+      VectorXd q = xcol.head(n_q);
+      MatrixXd J_fd(n_l_, plant_.num_velocities());
+      multibody::KinematicWorkspace<double> workspace;
+      for (int i = 0; i < n_q; i++) {
+        q(i) += this->eps();
+        plant_.SetPositions(context_col_.get(), q);
+        evaluators_.EvalFullJacobian(*context_col_, &J_fd, &workspace);
+        plant_.MapVelocityToQDot(*context_col_, J_fd.transpose() * gamma,
+                                 &qdot);
+        q(i) -= this->eps();
+        G_x.col(i).head(n_q) += (qdot - gamma_in_qdot_space) / this->eps();
+      }
+
+      // dy = dxdotcol - G_x*dxcol - dg/d(ucol, lc, gamma, quat_slack)
+      const MatrixXd I = MatrixXd::Identity(n_x_, n_x_);
+      dy->resize(n_x_, this->num_vars());
+      dy->col(0) = 1.5 * (x0 - x1) / (h * h) - G_x * (xdot0 - xdot1) / 8;
+      int col = 1;
+      dy->middleCols(col, n_x_) =
+          -1.5 / h * I - 0.25 * A0 - G_x * (0.5 * I + h / 8 * A0);
+      col += n_x_;
+      dy->middleCols(col, n_x_) =
+          1.5 / h * I - 0.25 * A1 - G_x * (0.5 * I - h / 8 * A1);
+      col += n_x_;
+      const MatrixXd& G_u = dynamics_jacobian_->dxdot_du();
+      dy->middleCols(col, n_u_) = -0.25 * B0 - h / 8 * G_x * B0 - 0.5 * G_u;
+      col += n_u_;
+      dy->middleCols(col, n_u_) = -0.25 * B1 + h / 8 * G_x * B1 - 0.5 * G_u;
+      col += n_u_;
+      dy->middleCols(col, n_l_) = -0.25 * C0 - h / 8 * G_x * C0;
+      col += n_l_;
+      dy->middleCols(col, n_l_) = -0.25 * C1 + h / 8 * G_x * C1;
+      col += n_l_;
+      dy->middleCols(col, n_l_) = -dynamics_jacobian_->dxdot_dlambda();
+      col += n_l_;
+      dy->middleCols(col, n_l_) = -G_gamma;
+      col += n_l_;
+      dy->middleCols(col, n_quat) = -G_slack;
+      return;
+    }
+  }
+  NonlinearConstraint<T>::EvaluateConstraintWithJacobian(x, y, dy);
+}
+
 template <typename T>
 drake::VectorX<T> DirconCollocationConstraint<T>::CalcTimeDerivativesWithForce(
-    drake::systems::Context<T>* context,
+    drake::systems::Context<T>* context, KnotDynamics<T>* dynamics,
     const drake::VectorX<T>& forces) const {
   if (cache_) {
-    return cache_->CalcTimeDerivativesWithForce(context, forces);
+    return cache_->CalcTimeDerivativesWithForce(context, forces, dynamics);
   } else {
-    return evaluators_.CalcTimeDerivativesWithForce(context, forces);
+    return dynamics->CalcTimeDerivativesWithForce(context, forces);
   }
 }
 
 template <typename T>
 ImpactConstraint<T>::ImpactConstraint(
     const MultibodyPlant<T>& plant, const KinematicEvaluatorSet<T>& evaluators,
-    Context<T>* context, std::string description)
+    Context<T>* context, std::string description, KnotDynamics<T>* dynamics)
     : NonlinearConstraint<T>(
           plant.num_velocities(),
           plant.num_positions() + 2 * plant.num_velocities() +
@@ -141,8 +329,15 @@ ImpactConstraint<T>::ImpactConstraint(
       plant_(plant),
       evaluators_(evaluators),
       context_(context),
+      dynamics_(dynamics),
       n_x_(plant.num_positions() + plant.num_velocities()),
-      n_l_(evaluators.count_full()) {}
+      n_l_(evaluators.count_full()) {
+  // Create a new context if one was not provided
+  if (context_ == nullptr) {
+    owned_context_ = plant_.CreateDefaultContext();
+    context_ = owned_context_.get();
+  }
+}
 
 /// The format of the input to the eval() function is in the order
 ///   - x0, pre-impact state (q,v)
@@ -158,7 +353,11 @@ void ImpactConstraint<T>::EvaluateConstraint(
 
   plant_.SetPositions(context_, x0.head(plant_.num_positions()));
   drake::MatrixX<T> M(plant_.num_velocities(), plant_.num_velocities());
-  plant_.CalcMassMatrix(*context_, &M);
+  if (dynamics_) {
+    M = dynamics_->EvalMassMatrix(*context_);
+  } else {
+    plant_.CalcMassMatrix(*context_, &M);
+  }
 
   *y = M * (v1 - x0.tail(plant_.num_velocities())) -
        evaluators_.EvalFullJacobian(*context_).transpose() * impulse;
@@ -168,7 +367,8 @@ template <typename T>
 CachedAccelerationConstraint<T>::CachedAccelerationConstraint(
     const MultibodyPlant<T>& plant, const KinematicEvaluatorSet<T>& evaluators,
     Context<T>* context, const std::string& description,
-    DynamicsCache<T>* cache)
+    DynamicsCache<T>* cache, const MultibodyPlant<AutoDiffXd>* plant_ad,
+    KnotDynamics<T>* dynamics)
     : NonlinearConstraint<T>(
           evaluators.count_active(),
           plant.num_positions() + plant.num_velocities() +
@@ -177,7 +377,8 @@ CachedAccelerationConstraint<T>::CachedAccelerationConstraint(
           VectorXd::Zero(evaluators.count_active()), description),
       plant_(plant),
       evaluators_(evaluators),
-      cache_(cache) {
+      cache_(cache),
+      dynamics_(dynamics) {
   // Create a new context if one was not provided
   if (context == nullptr) {
     owned_context_ = plant_.CreateDefaultContext();
@@ -185,6 +386,19 @@ CachedAccelerationConstraint<T>::CachedAccelerationConstraint(
   } else {
     context_ = context;
   }
+  if (dynamics_ == nullptr) {
+    owned_dynamics_ = std::make_unique<KnotDynamics<T>>(plant, evaluators);
+    dynamics_ = owned_dynamics_.get();
+  }
+  if constexpr (std::is_same<T, double>::value) {
+    if (plant_ad != nullptr) {
+      dynamics_jacobian_ = std::make_unique<DynamicsJacobian>(
+          plant_, *plant_ad, evaluators_, this->eps());
+      context_fd_ = plant_.CreateDefaultContext();
+    }
+  } else {
+    DRAKE_DEMAND(plant_ad == nullptr);
+  }
 }
 
 template <typename T>
@@ -196,14 +410,61 @@ void CachedAccelerationConstraint<T>::EvaluateConstraint(
   const auto& lambda = vars.tail(evaluators_.count_full());
   multibody::setContext<T>(plant_, x, u, context_);
 
-  if (cache_) {
-    const auto& xdot = cache_->CalcTimeDerivativesWithForce(context_, lambda);
-    const auto& J = evaluators_.EvalActiveJacobian(*context_);
-    const auto& Jdotv = evaluators_.EvalActiveJacobianDotTimesV(*context_);
-    *y = J * xdot.tail(plant_.num_velocities()) + Jdotv;
-  } else {
-    *y = evaluators_.EvalActiveSecondTimeDerivative(context_, lambda);
+  const auto& xdot =
+      cache_ ? cache_->CalcTimeDerivativesWithForce(context_, lambda, dynamics_)
+             : dynamics_->CalcTimeDerivativesWithForce(context_, lambda);
+  *y = dynamics_->EvalActiveJacobian(*context_) *
+           xdot.tail(plant_.num_velocities()) +
+       dynamics_->EvalActiveJacobianDotTimesV(*context_);
+}
+
+/// With vdot = f_v(x, u, lambda),
+///   dy/dx = J*dvdot/dx + d(J(q)*vdot + Jdotv(q, v))/dx (vdot fixed)
+///   dy/du = J*dvdot/du, dy/dlambda = J*dvdot/dlambda
+/// where the kinematic term is differentiated by forward differencing.
+template <typename T>
+void CachedAccelerationConstraint<T>::EvaluateConstraintWithJacobian(
+    const Eigen::Ref<const VectorXd>& vars, VectorXd* y, MatrixXd* dy) const {
+  if constexpr (std::is_same<T, double>::value) {
+    if (dynamics_jacobian_) {
+      const int n_x = plant_.num_positions() + plant_.num_velocities();
+      const int n_u = plant_.num_actuators();
+      const int n_l = evaluators_.count_full();
+      const VectorXd x = vars.head(n_x);
+      const VectorXd u = vars.segment(n_x, n_u);
+      const VectorXd lambda = vars.tail(n_l);
+      multibody::setContext<T>(plant_, x, u, context_);
+
+      dynamics_jacobian_->Calc(context_, lambda, dynamics_);
+      const auto vdot = dynamics_jacobian_->xdot().tail(plant_.num_velocities());
+      const MatrixXd J = dynamics_->EvalActiveJacobian(*context_);
+      const VectorXd Jdotv = dynamics_->EvalActiveJacobianDotTimesV(*context_);
+      *y = J * vdot + Jdotv;
+
+      dy->resize(y->size(), n_x + n_u + n_l);
+      dy->leftCols(n_x) =
+          J * dynamics_jacobian_->dxdot_dx().bottomRows(vdot.size());
+      dy->middleCols(n_x, n_u) =
+          J * dynamics_jacobian_->dxdot_du().bottomRows(vdot.size());
+      dy->rightCols(n_l) =
+          J * dynamics_jacobian_->dxdot_dlambda().bottomRows(vdot.size());
+
+      VectorXd x_fd = x;
+      MatrixXd J_fd(J.rows(), J.cols());
+      VectorXd Jdotv_fd(Jdotv.size());
+      multibody::KinematicWorkspace<double> workspace;
+      for (int i = 0; i < n_x; i++) {
+        x_fd(i) += this->eps();
+        plant_.SetPositionsAndVelocities(context_fd_.get(), x_fd);
+        x_fd(i) -= this->eps();
+        evaluators_.EvalActiveJacobianAndJdotV(*context_fd_, &J_fd, &Jdotv_fd,
+                                               nullptr, &workspace);
+        dy->col(i) += (J_fd * vdot + Jdotv_fd - *y) / this->eps();
+      }
+      return;
+    }
   }
+  NonlinearConstraint<T>::EvaluateConstraintWithJacobian(vars, y, dy);
 }
 
 DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
@@ -6,6 +6,8 @@
 #include "solvers/nonlinear_constraint.h"
 #include "systems/trajectory_optimization/dircon/dircon_mode.h"
 #include "systems/trajectory_optimization/dircon/dynamics_cache.h"
+#include "systems/trajectory_optimization/dircon/dynamics_jacobian.h"
+#include "systems/trajectory_optimization/dircon/knot_dynamics.h"
 #include "drake/common/drake_copyable.h"
 #include "drake/common/symbolic.h"
 #include "drake/solvers/constraint.h"
@@ -35,35 +37,61 @@ class DirconCollocationConstraint : public solvers::NonlinearConstraint<T> {
  public:
 
  public:
-  /// Requires two context pointers to be pasesd as arguments, one for each
-  /// knot point. The constraint will create its own pointer for the collocation
-  /// point context.
+  /// Takes two context pointers as arguments, one for each knot point. The
+  /// constraint will create its own pointer for the collocation point context,
+  /// and for the knot points whose context is nullptr.
+  ///
+  /// With `plant_ad` (an AutoDiffXd copy of `plant`, only for T = double),
+  /// the Jacobian of the constraint is computed semi-analytically (see
+  /// DynamicsJacobian) instead of by forward differencing every decision
+  /// variable.
+  ///
+  /// `dynamics_0` and `dynamics_1` are the KnotDynamics of the two knot
+  /// points (shared with the other constraints using the same contexts). The
+  /// constraint creates its own if they are nullptr.
   DirconCollocationConstraint(const drake::multibody::MultibodyPlant<T>& plant,
       const multibody::KinematicEvaluatorSet<T>& evaluators,
       drake::systems::Context<T>* context_0,
       drake::systems::Context<T>* context_1,
       int mode_index, int knot_index,
-      DynamicsCache<T>* cache = nullptr);
+      DynamicsCache<T>* cache = nullptr,
+      const drake::multibody::MultibodyPlant<drake::AutoDiffXd>* plant_ad =
+          nullptr,
+      KnotDynamics<T>* dynamics_0 = nullptr,
+      KnotDynamics<T>* dynamics_1 = nullptr);
 
  public:
   void EvaluateConstraint(const Eigen::Ref<const drake::VectorX<T>>& x,
                           drake::VectorX<T>* y) const override;
 
+ protected:
+  void EvaluateConstraintWithJacobian(
+      const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::VectorXd* y,
+      Eigen::MatrixXd* dy) const override;
+
  private:
   drake::VectorX<T> CalcTimeDerivativesWithForce(
-    drake::systems::Context<T>* context,
+    drake::systems::Context<T>* context, KnotDynamics<T>* dynamics,
     const drake::VectorX<T>& forces) const;
 
   const drake::multibody::MultibodyPlant<T>& plant_;
   const multibody::KinematicEvaluatorSet<T>& evaluators_;
   drake::systems::Context<T>* context_0_;
   drake::systems::Context<T>* context_1_;
+  std::unique_ptr<drake::systems::Context<T>> owned_context_0_;
+  std::unique_ptr<drake::systems::Context<T>> owned_context_1_;
   std::unique_ptr<drake::systems::Context<T>> context_col_;
   const std::vector<int> quat_start_indices_;
   int n_x_;
   int n_u_;
   int n_l_;
   DynamicsCache<T>* cache_;
+  KnotDynamics<T>* dynamics_0_;
+  KnotDynamics<T>* dynamics_1_;
+  std::unique_ptr<KnotDynamics<T>> owned_dynamics_0_;
+  std::unique_ptr<KnotDynamics<T>> owned_dynamics_1_;
+  std::unique_ptr<KnotDynamics<T>> dynamics_col_;
+  std::unique_ptr<DynamicsJacobian> dynamics_jacobian_;
 };
 
 /// Implements the impact constraint used by Dircon on mode transitions
@@ -73,11 +101,15 @@ class DirconCollocationConstraint : public solvers::NonlinearConstraint<T> {
 template <typename T>
 class ImpactConstraint : public solvers::NonlinearConstraint<T> {
  public:
+  /// Creates its own context if `context` is nullptr. If given, the mass
+  /// matrix is read from `dynamics`, the KnotDynamics of `context` (which
+  /// may be for a different set of evaluators).
   ImpactConstraint(
       const drake::multibody::MultibodyPlant<T>& plant,
       const multibody::KinematicEvaluatorSet<T>& evaluators,
       drake::systems::Context<T>* context,
-      std::string description);
+      std::string description,
+      KnotDynamics<T>* dynamics = nullptr);
 
   void EvaluateConstraint(const Eigen::Ref<const drake::VectorX<T>>& x,
                           drake::VectorX<T>* y) const override;
@@ -86,6 +118,8 @@ class ImpactConstraint : public solvers::NonlinearConstraint<T> {
   const drake::multibody::MultibodyPlant<T>& plant_;
   const multibody::KinematicEvaluatorSet<T>& evaluators_;
   drake::systems::Context<T>* context_;
+  std::unique_ptr<drake::systems::Context<T>> owned_context_;
+  KnotDynamics<T>* dynamics_;
   const int n_x_;
   const int n_l_;
 };
@@ -108,22 +142,38 @@ class CachedAccelerationConstraint : public solvers::NonlinearConstraint<T> {
   /// cached kinematic/dynamic computation within the context.
   /// This is the simplest form of the construtor, where the lower and upper
   /// bounds are both zero.
+  /// With `plant_ad`, the Jacobian is computed semi-analytically (see
+  /// DirconCollocationConstraint). The dynamics terms are read from
+  /// `dynamics`, the KnotDynamics of `context`, or from its own if nullptr.
   CachedAccelerationConstraint(
       const drake::multibody::MultibodyPlant<T>& plant,
       const multibody::KinematicEvaluatorSet<T>& evaluators,
       drake::systems::Context<T>* context,
       const std::string& description,
-      DynamicsCache<T>* cache = nullptr);
+      DynamicsCache<T>* cache = nullptr,
+      const drake::multibody::MultibodyPlant<drake::AutoDiffXd>* plant_ad =
+          nullptr,
+      KnotDynamics<T>* dynamics = nullptr);
 
   void EvaluateConstraint(const Eigen::Ref<const drake::VectorX<T>>& x,
                                   drake::VectorX<T>* y) const;
 
+ protected:
+  void EvaluateConstraintWithJacobian(
+      const Eigen::Ref<const Eigen::VectorXd>& x, Eigen::VectorXd* y,
+      Eigen::MatrixXd* dy) const override;
+
  private:
   const drake::multibody::MultibodyPlant<T>& plant_;
   const multibody::KinematicEvaluatorSet<T>& evaluators_;
   drake::systems::Context<T>* context_;
   std::unique_ptr<drake::systems::Context<T>> owned_context_;
   DynamicsCache<T>* cache_;
+  KnotDynamics<T>* dynamics_;
+  std::unique_ptr<KnotDynamics<T>> owned_dynamics_;
+  std::unique_ptr<DynamicsJacobian> dynamics_jacobian_;
+  // For differencing the kinematic terms
+  std::unique_ptr<drake::systems::Context<T>> context_fd_;
 };
 
 
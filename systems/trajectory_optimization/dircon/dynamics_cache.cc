@@ -1,5 +1,9 @@
 #include "systems/trajectory_optimization/dircon/dynamics_cache.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "drake/common/drake_assert.h"
 #include "drake/math/autodiff_gradient.h"
 
 namespace dairlib {
@@ -7,90 +11,216 @@ namespace systems {
 namespace trajectory_optimization {
 
 using drake::AutoDiffXd;
-using drake::AutoDiffVecXd;
+using drake::VectorX;
+
+namespace {
 
-inline void hash_combine(std::size_t& seed, const double& v) {
-    seed ^= std::hash<double>{}(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+inline void hash_combine(std::size_t& seed, double v) {
+  // -0.0 and 0.0 compare equal, so they need the same hash
+  v += 0.0;
+  uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  seed ^= bits + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2);
 }
 
-inline void hash_combine(std::size_t& seed,
-    const Eigen::Ref<const Eigen::VectorXd>& v) {
+inline void append(const VectorX<double>& v, std::vector<double>* key) {
+  key->insert(key->end(), v.data(), v.data() + v.size());
+}
+
+inline void append(const VectorX<AutoDiffXd>& v, std::vector<double>* key) {
   for (int i = 0; i < v.size(); i++) {
-    hash_combine(seed, v(i)); 
+    key->push_back(v(i).value());
   }
 }
 
-inline void hash_combine(std::size_t& seed,
-    const Eigen::Ref<const AutoDiffVecXd>& v) {
+// The derivatives follow all of the values (prefixed by their size, since it
+// can differ between elements)
+inline void append_derivatives(const VectorX<double>& v,
+                               std::vector<double>* key) {}
+
+inline void append_derivatives(const VectorX<AutoDiffXd>& v,
+                               std::vector<double>* key) {
   for (int i = 0; i < v.size(); i++) {
-    hash_combine(seed, v(i).value());
-    hash_combine(seed, v(i).derivatives());
+    const auto& derivatives = v(i).derivatives();
+    key->push_back(derivatives.size());
+    key->insert(key->end(), derivatives.data(),
+                derivatives.data() + derivatives.size());
   }
 }
 
+}  // namespace
+
+DynamicsCacheStats& DynamicsCacheStats::operator+=(
+    const DynamicsCacheStats& other) {
+  hits += other.hits;
+  misses += other.misses;
+  evictions += other.evictions;
+  bytes += other.bytes;
+  return *this;
+}
+
 template <typename T>
 DynamicsCache<T>::DynamicsCache(
     const multibody::KinematicEvaluatorSet<T>& evaluators, int max_size)
   : evaluators_(evaluators),
-    max_size_(max_size) {}
+    max_size_(max_size) {
+  DRAKE_DEMAND(max_size >= 1);
+}
 
 template <typename T>
 drake::VectorX<T> DynamicsCache<T>::CalcTimeDerivativesWithForce(
     drake::systems::Context<T>* context,
-    const drake::VectorX<T>& forces) {
-  CacheKey<T> key{evaluators_.plant().GetPositionsAndVelocities(*context), 
-                  evaluators_.plant().get_actuation_input_port().Eval(*context),
-                  forces};
-  auto it = map_.find(key);
-  if (it == map_.end()) {
-    auto xdot = evaluators_.CalcTimeDerivativesWithForce(context, forces);
-    map_[key] = xdot;
-
-    // Add to the queue_
-    if (map_.size() >= max_size_) {
-      map_.erase(queue_.front());
-      queue_.pop_front();
-    }
-    queue_.push_back(key);
-    return xdot;
+    const drake::VectorX<T>& forces, KnotDynamics<T>* dynamics) {
+  const std::size_t hash = MakeKey(
+      evaluators_.plant().GetPositionsAndVelocities(*context),
+      evaluators_.plant().get_actuation_input_port().Eval(*context), forces);
+  Reserve(key_.size());
+
+  int position = FindPosition(hash);
+  if (table_[position] >= 0) {
+    const int slot = table_[position];
+    stats_.hits++;
+    Unlink(slot);
+    PushFront(slot);
+    return values_[slot];
+  }
+
+  stats_.misses++;
+  int slot;
+  if (num_slots_ < max_size_) {
+    slot = num_slots_++;
   } else {
-    return it->second;
+    // Evict the least recently used entry
+    slot = lru_tail_;
+    stats_.evictions++;
+    EraseFromTable(slot);
+    Unlink(slot);
+    position = FindPosition(hash);
+  }
+  std::copy(key_.begin(), key_.end(), keys_.begin() + slot * key_stride_);
+  key_sizes_[slot] = key_.size();
+  hashes_[slot] = hash;
+  values_[slot] =
+      dynamics ? dynamics->CalcTimeDerivativesWithForce(context, forces)
+               : evaluators_.CalcTimeDerivativesWithForce(context, forces);
+  table_[position] = slot;
+  PushFront(slot);
+  return values_[slot];
+}
+
+template <typename T>
+std::size_t DynamicsCache<T>::MakeKey(const VectorX<T>& state,
+                                      const VectorX<T>& input,
+                                      const VectorX<T>& forces) {
+  key_.clear();
+  append(state, &key_);
+  append(input, &key_);
+  append(forces, &key_);
+  std::size_t seed = 0;
+  for (double value : key_) {
+    hash_combine(seed, value);
+  }
+  append_derivatives(state, &key_);
+  append_derivatives(input, &key_);
+  append_derivatives(forces, &key_);
+  return seed;
+}
+
+template <typename T>
+int DynamicsCache<T>::FindPosition(std::size_t hash) const {
+  std::size_t position = hash & table_mask_;
+  while (table_[position] >= 0) {
+    const int slot = table_[position];
+    if (hashes_[slot] == hash &&
+        key_sizes_[slot] == static_cast<int>(key_.size()) &&
+        std::equal(key_.begin(), key_.end(),
+                   keys_.begin() + slot * key_stride_)) {
+      break;
+    }
+    position = (position + 1) & table_mask_;
   }
+  return position;
 }
 
-bool AreVectorsEqual(const Eigen::Ref<const AutoDiffVecXd>& a,
-                     const Eigen::Ref<const AutoDiffVecXd>& b) {
-  if (a.value() != b.value()) {
-    return false;
+template <typename T>
+void DynamicsCache<T>::EraseFromTable(int slot) {
+  std::size_t i = hashes_[slot] & table_mask_;
+  while (table_[i] != slot) {
+    i = (i + 1) & table_mask_;
+  }
+  // Backward-shift deletion: move later entries of the probe sequence into
+  // the hole, unless that would move them before their ideal position
+  table_[i] = -1;
+  std::size_t j = i;
+  while (true) {
+    j = (j + 1) & table_mask_;
+    if (table_[j] < 0) break;
+    const std::size_t ideal = hashes_[table_[j]] & table_mask_;
+    if (((j - ideal) & table_mask_) >= ((j - i) & table_mask_)) {
+      table_[i] = table_[j];
+      table_[j] = -1;
+      i = j;
+    }
   }
-  const Eigen::MatrixXd& a_gradient = drake::math::autoDiffToGradientMatrix(a);
-  const Eigen::MatrixXd& b_gradient = drake::math::autoDiffToGradientMatrix(b);
+}
 
-  return a_gradient == b_gradient;
+template <typename T>
+void DynamicsCache<T>::Unlink(int slot) {
+  const int prev = lru_prev_[slot];
+  const int next = lru_next_[slot];
+  (prev >= 0 ? lru_next_[prev] : lru_head_) = next;
+  (next >= 0 ? lru_prev_[next] : lru_tail_) = prev;
 }
 
 template <typename T>
-std::size_t CacheHasher<T>::operator()(const CacheKey<T>& key) const {
-  std::size_t seed = 0;
-  hash_combine(seed, key.state);
-  hash_combine(seed, key.input);
-  hash_combine(seed, key.forces);
-  return seed;
+void DynamicsCache<T>::PushFront(int slot) {
+  lru_prev_[slot] = -1;
+  lru_next_[slot] = lru_head_;
+  (lru_head_ >= 0 ? lru_prev_[lru_head_] : lru_tail_) = slot;
+  lru_head_ = slot;
 }
 
-template <>
-bool CacheComparer<double>::operator()(const CacheKey<double>& a,
-    const CacheKey<double>& b) const {
-  return (a.state == b.state) && (a.forces == b.forces) &&
-      (a.input == b.input);
+template <typename T>
+void DynamicsCache<T>::Reserve(int key_size) {
+  if (key_size <= key_stride_) return;
+  if (key_stride_ == 0) {
+    key_sizes_.resize(max_size_);
+    hashes_.resize(max_size_);
+    values_.resize(max_size_);
+    lru_prev_.resize(max_size_);
+    lru_next_.resize(max_size_);
+    std::size_t table_size = 1;
+    while (table_size < 2 * static_cast<std::size_t>(max_size_)) {
+      table_size *= 2;
+    }
+    table_.assign(table_size, -1);
+    table_mask_ = table_size - 1;
+  }
+  // Larger keys (e.g. AutoDiffXd with more derivatives) change the stride
+  std::vector<double> keys(static_cast<std::size_t>(max_size_) * key_size);
+  for (int slot = 0; slot < num_slots_; slot++) {
+    std::copy(keys_.begin() + slot * key_stride_,
+              keys_.begin() + slot * key_stride_ + key_sizes_[slot],
+              keys.begin() + slot * key_size);
+  }
+  keys_ = std::move(keys);
+  key_stride_ = key_size;
 }
 
-template <>
-bool CacheComparer<AutoDiffXd>::operator()(const CacheKey<AutoDiffXd>& a,
-    const CacheKey<AutoDiffXd>& b) const {
-  return AreVectorsEqual(a.state, b.state) &&
-         AreVectorsEqual(a.input, b.input) &&
-        AreVectorsEqual(a.forces, b.forces);
+template <typename T>
+DynamicsCacheStats DynamicsCache<T>::stats() const {
+  DynamicsCacheStats stats = stats_;
+  stats.bytes = keys_.capacity() * sizeof(double) +
+                key_.capacity() * sizeof(double) +
+                key_sizes_.capacity() * sizeof(int) +
+                hashes_.capacity() * sizeof(std::size_t) +
+                (lru_prev_.capacity() + lru_next_.capacity() +
+                 table_.capacity()) * sizeof(int) +
+                values_.capacity() * sizeof(VectorX<T>);
+  for (int slot = 0; slot < num_slots_; slot++) {
+    stats.bytes += values_[slot].size() * sizeof(T);
+  }
+  return stats;
 }
 
 }  // namespace trajectory_optimization
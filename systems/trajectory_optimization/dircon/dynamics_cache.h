@@ -1,51 +1,93 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 
 #include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "systems/trajectory_optimization/dircon/knot_dynamics.h"
 
 namespace dairlib {
 namespace systems {
 namespace trajectory_optimization {
 
-template <typename T>
-struct CacheKey {
-  const drake::VectorX<T> state;
-  const drake::VectorX<T> input;
-  const drake::VectorX<T> forces;
-};
+/// Counters of a DynamicsCache (see DynamicsCache::stats())
+struct DynamicsCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t evictions = 0;
+  /// Memory held by the cache (not counting the derivatives of AutoDiffXd)
+  int64_t bytes = 0;
 
-// == operation for two CacheKeys
-template <typename T>
-class CacheComparer {
- public:
-  bool operator()(const CacheKey<T>& a, const CacheKey<T>& b) const;
-};
+  double hit_rate() const {
+    return (hits + misses > 0) ? static_cast<double>(hits) / (hits + misses)
+                               : 0;
+  }
 
-// Hashes a CacheKey by bit shifting and combining hashes of the double
-// elements
-template <typename T>
-class CacheHasher {
- public:
-  std::size_t operator()(const CacheKey<T>& key) const;
+  DynamicsCacheStats& operator+=(const DynamicsCacheStats& other);
 };
 
+/// DynamicsCache stores the results of
+/// KinematicEvaluatorSet::CalcTimeDerivativesWithForce for the most recently
+/// used (state, input, force) tuples, evicting the least recently used one
+/// when full.
+///
+/// All storage is allocated on first use: the keys are stored back to back
+/// in a single array (one fixed-size stride per entry), and are found
+/// through an open-addressing hash table (linear probing, backward-shift
+/// deletion) of at least twice the capacity. For AutoDiffXd, the key also
+/// contains the derivatives, but only the values are hashed.
 template <typename T>
 class DynamicsCache {
  public:
-  DynamicsCache(const multibody::KinematicEvaluatorSet<T>& constraints,
+  DynamicsCache(const multibody::KinematicEvaluatorSet<T>& evaluators,
       int max_size);
 
+  /// Misses are computed with `dynamics` (the KnotDynamics of `context`) if
+  /// given, or with the evaluators otherwise
   drake::VectorX<T> CalcTimeDerivativesWithForce(
       drake::systems::Context<T>* context,
-      const drake::VectorX<T>& forces);
+      const drake::VectorX<T>& forces,
+      KnotDynamics<T>* dynamics = nullptr);
+
+  DynamicsCacheStats stats() const;
+
+  void ResetStats() { stats_ = DynamicsCacheStats(); }
 
  private:
+  // Flattens (x, u, forces) into key_ and returns its hash
+  std::size_t MakeKey(const drake::VectorX<T>& state,
+                      const drake::VectorX<T>& input,
+                      const drake::VectorX<T>& forces);
+  // Table position of the entry matching key_, or of the empty position
+  // ending the probe sequence if there is none
+  int FindPosition(std::size_t hash) const;
+  void EraseFromTable(int slot);
+  void Unlink(int slot);
+  void PushFront(int slot);
+  // Makes room for keys of `key_size` doubles
+  void Reserve(int key_size);
+
   const multibody::KinematicEvaluatorSet<T>& evaluators_;
-  size_t max_size_;
-  std::unordered_map<CacheKey<T>, drake::VectorX<T>, CacheHasher<T>,
-      CacheComparer<T>> map_;
-  std::list<CacheKey<T>> queue_;
+  const int max_size_;
+
+  // Entries ("slots") in [0, num_slots_)
+  int num_slots_ = 0;
+  int key_stride_ = 0;
+  std::vector<double> keys_;
+  std::vector<int> key_sizes_;
+  std::vector<std::size_t> hashes_;
+  std::vector<drake::VectorX<T>> values_;
+  // LRU order, as a doubly linked list of slots (head is the most recent)
+  std::vector<int> lru_prev_;
+  std::vector<int> lru_next_;
+  int lru_head_ = -1;
+  int lru_tail_ = -1;
+  // Open-addressing table of slot indices (-1 is empty)
+  std::vector<int> table_;
+  std::size_t table_mask_ = 0;
+
+  std::vector<double> key_;
+  DynamicsCacheStats stats_;
 };
 
 }  // namespace trajectory_optimization
@@ -0,0 +1,91 @@
+#include "systems/trajectory_optimization/dircon/dynamics_jacobian.h"
+
+#include "drake/math/autodiff.h"
+#include "drake/multibody/tree/multibody_forces.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+
+using drake::AutoDiffVecXd;
+using drake::AutoDiffXd;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+namespace {
+
+// Gradient of y (entries without derivatives don't depend on the variables)
+MatrixXd GradientOf(const AutoDiffVecXd& y, int num_variables) {
+  MatrixXd dy = MatrixXd::Zero(y.size(), num_variables);
+  for (int i = 0; i < y.size(); i++) {
+    if (y(i).derivatives().size() > 0) {
+      dy.row(i) = y(i).derivatives().transpose();
+    }
+  }
+  return dy;
+}
+
+}  // namespace
+
+DynamicsJacobian::DynamicsJacobian(
+    const MultibodyPlant<double>& plant,
+    const MultibodyPlant<AutoDiffXd>& plant_ad,
+    const multibody::KinematicEvaluatorSet<double>& evaluators, double eps)
+    : plant_(plant),
+      plant_ad_(plant_ad),
+      evaluators_(evaluators),
+      eps_(eps),
+      n_q_(plant.num_positions()),
+      n_v_(plant.num_velocities()),
+      context_ad_(plant_ad.CreateDefaultContext()),
+      context_fd_(plant.CreateDefaultContext()),
+      dxdot_dx_(MatrixXd::Zero(n_q_ + n_v_, n_q_ + n_v_)),
+      dxdot_du_(MatrixXd::Zero(n_q_ + n_v_, plant.num_actuators())),
+      dxdot_dlambda_(MatrixXd::Zero(n_q_ + n_v_, evaluators.count_full())),
+      J_fd_(evaluators.count_full(), n_v_) {}
+
+void DynamicsJacobian::Calc(Context<double>* context, const VectorXd& lambda,
+                            KnotDynamics<double>* dynamics) {
+  const int n_x = n_q_ + n_v_;
+  xdot_ = dynamics->CalcTimeDerivativesWithForce(context, lambda);
+  const VectorXd x = plant_.GetPositionsAndVelocities(*context);
+
+  // Linear in u and lambda
+  dxdot_du_.bottomRows(n_v_) = dynamics->EvalMassMatrixInverseTimesB(*context);
+  dxdot_dlambda_.bottomRows(n_v_) =
+      dynamics->EvalMassMatrixInverseTimesJacobianTranspose(*context);
+
+  // dqdot/dx and dID/dx (with vdot fixed) with AutoDiff on x only
+  const AutoDiffVecXd x_ad = drake::math::initializeAutoDiff(x);
+  plant_ad_.SetPositionsAndVelocities(context_ad_.get(), x_ad);
+  AutoDiffVecXd qdot_ad(n_q_);
+  plant_ad_.MapVelocityToQDot(*context_ad_, x_ad.tail(n_v_), &qdot_ad);
+  dxdot_dx_.topRows(n_q_) = GradientOf(qdot_ad, n_x);
+
+  drake::multibody::MultibodyForces<AutoDiffXd> forces(plant_ad_);
+  plant_ad_.CalcForceElementsContribution(*context_ad_, &forces);
+  const AutoDiffVecXd vdot_ad = xdot_.tail(n_v_).cast<AutoDiffXd>();
+  const AutoDiffVecXd id_ad =
+      plant_ad_.CalcInverseDynamics(*context_ad_, vdot_ad, forces);
+  MatrixXd dID_dx = GradientOf(id_ad, n_x);
+
+  // Subtract d(J^T*lambda)/dq (by forward differencing)
+  const VectorXd JT_lambda =
+      dynamics->EvalFullJacobian(*context).transpose() * lambda;
+  VectorXd q = x.head(n_q_);
+  for (int i = 0; i < n_q_; i++) {
+    q(i) += eps_;
+    plant_.SetPositions(context_fd_.get(), q);
+    evaluators_.EvalFullJacobian(*context_fd_, &J_fd_, &workspace_);
+    q(i) -= eps_;
+    dID_dx.col(i) -= (J_fd_.transpose() * lambda - JT_lambda) / eps_;
+  }
+  dxdot_dx_.bottomRows(n_v_) =
+      -dynamics->EvalMassMatrixCholesky(*context).solve(dID_dx);
+}
+
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
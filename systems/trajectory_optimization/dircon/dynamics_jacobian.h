@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "systems/trajectory_optimization/dircon/knot_dynamics.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+
+/// DynamicsJacobian computes the constrained dynamics used by Dircon
+///   xdot = [qdot; vdot] = [N(q)*v; M(q)^-1*(tau(q, v) + B*u + J(q)^T*lambda)]
+/// (tau contains the gravity, Coriolis and force element terms) together with
+/// its Jacobians with respect to x = [q; v], u and lambda.
+///
+/// The dynamics are linear in u and lambda, so
+///   dvdot/du = M^-1*B and dvdot/dlambda = M^-1*J^T.
+/// These products, the dynamics themselves, M, its factorization and J are
+/// read from the KnotDynamics of the context, so that they are computed once
+/// per knot point and shared with the other constraints of the knot.
+/// The derivatives with respect to x follow from the inverse dynamics
+/// ID(q, v, vdot) = M(q)*vdot - tau(q, v) = B*u + J(q)^T*lambda:
+///   dvdot/dx = M^-1*(d(J^T*lambda)/dx - dID/dx),
+/// where dID/dx (with vdot fixed) and dqdot/dx are computed with AutoDiff on
+/// the AutoDiffXd plant, seeded with x only. The kinematic evaluators only
+/// exist for double, so d(J^T*lambda)/dq is computed by forward differencing
+/// the Jacobian of the evaluators (one Jacobian evaluation per position
+/// instead of one forward dynamics evaluation per decision variable).
+///
+/// The AutoDiffXd plant can be shared, but every DynamicsJacobian owns its
+/// contexts.
+class DynamicsJacobian {
+ public:
+  DynamicsJacobian(
+      const drake::multibody::MultibodyPlant<double>& plant,
+      const drake::multibody::MultibodyPlant<drake::AutoDiffXd>& plant_ad,
+      const multibody::KinematicEvaluatorSet<double>& evaluators,
+      double eps = 1e-7);
+
+  /// Evaluates at the state and the input of `context`, with the full set of
+  /// constraint forces `lambda`. (`xdot` is the same as
+  /// evaluators.CalcTimeDerivativesWithForce(context, lambda).) `dynamics` is
+  /// the KnotDynamics of `context`, for the same evaluators.
+  void Calc(drake::systems::Context<double>* context,
+            const Eigen::VectorXd& lambda, KnotDynamics<double>* dynamics);
+
+  const Eigen::VectorXd& xdot() const { return xdot_; }
+  const Eigen::MatrixXd& dxdot_dx() const { return dxdot_dx_; }
+  const Eigen::MatrixXd& dxdot_du() const { return dxdot_du_; }
+  const Eigen::MatrixXd& dxdot_dlambda() const { return dxdot_dlambda_; }
+
+ private:
+  const drake::multibody::MultibodyPlant<double>& plant_;
+  const drake::multibody::MultibodyPlant<drake::AutoDiffXd>& plant_ad_;
+  const multibody::KinematicEvaluatorSet<double>& evaluators_;
+  const double eps_;
+  const int n_q_;
+  const int n_v_;
+  std::unique_ptr<drake::systems::Context<drake::AutoDiffXd>> context_ad_;
+  // For differencing the constraint Jacobian
+  std::unique_ptr<drake::systems::Context<double>> context_fd_;
+
+  Eigen::VectorXd xdot_;
+  Eigen::MatrixXd dxdot_dx_;
+  Eigen::MatrixXd dxdot_du_;
+  Eigen::MatrixXd dxdot_dlambda_;
+  Eigen::MatrixXd J_fd_;
+  multibody::KinematicWorkspace<double> workspace_;
+};
+
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
@@ -0,0 +1,213 @@
+#include "systems/trajectory_optimization/dircon/knot_dynamics.h"
+
+#include "drake/common/default_scalars.h"
+#include "drake/multibody/tree/multibody_forces.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+
+using drake::AutoDiffXd;
+using drake::MatrixX;
+using drake::VectorX;
+using drake::multibody::MultibodyPlant;
+using drake::systems::Context;
+
+namespace {
+
+bool AreEqual(const VectorX<double>& a, const VectorX<double>& b) {
+  return a.size() == b.size() && a == b;
+}
+
+bool AreEqual(const VectorX<AutoDiffXd>& a, const VectorX<AutoDiffXd>& b) {
+  if (a.size() != b.size()) return false;
+  for (int i = 0; i < a.size(); i++) {
+    if (a(i).value() != b(i).value() ||
+        a(i).derivatives().size() != b(i).derivatives().size() ||
+        a(i).derivatives() != b(i).derivatives()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+template <typename T>
+KnotDynamics<T>::KnotDynamics(
+    const MultibodyPlant<T>& plant,
+    const multibody::KinematicEvaluatorSet<T>& evaluators)
+    : plant_(plant),
+      evaluators_(evaluators),
+      B_(plant.MakeActuationMatrix()),
+      use_evaluators_(plant.is_discrete() ||
+                      plant.num_collision_geometries() > 0),
+      M_(plant.num_velocities(), plant.num_velocities()),
+      bias_(plant.num_velocities()),
+      J_(evaluators.count_full(), plant.num_velocities()),
+      Jdotv_(evaluators.count_full()) {
+  for (int i = 0; i < evaluators.count_full(); i++) {
+    if (evaluators.is_active(i)) {
+      active_rows_.push_back(i);
+    }
+  }
+}
+
+template <typename T>
+void KnotDynamics<T>::Update(const Context<T>& context) {
+  const auto& q = plant_.GetPositions(context);
+  const auto& v = plant_.GetVelocities(context);
+  if (!AreEqual(q, q_)) {
+    q_ = q;
+    v_ = v;
+    mass_matrix_valid_ = false;
+    cholesky_valid_ = false;
+    jacobian_valid_ = false;
+    bias_valid_ = false;
+    jdotv_valid_ = false;
+    minv_b_valid_ = false;
+    minv_jt_valid_ = false;
+  } else if (!AreEqual(v, v_)) {
+    v_ = v;
+    bias_valid_ = false;
+    jdotv_valid_ = false;
+  }
+}
+
+template <typename T>
+VectorX<T> KnotDynamics<T>::CalcTimeDerivativesWithForce(
+    Context<T>* context, const VectorX<T>& lambda) {
+  if (use_evaluators_ ||
+      plant_.get_applied_spatial_force_input_port().HasValue(*context)) {
+    VectorX<T> x_dot(plant_.num_positions() + plant_.num_velocities());
+    evaluators_.CalcTimeDerivativesWithForce(context, lambda, &x_dot,
+                                             &workspace_);
+    return x_dot;
+  }
+  const VectorX<T> tau =
+      EvalBias(*context) +
+      B_ * plant_.get_actuation_input_port().Eval(*context) +
+      EvalFullJacobian(*context).transpose() * lambda;
+
+  VectorX<T> x_dot(plant_.num_positions() + plant_.num_velocities());
+  VectorX<T> q_dot(plant_.num_positions());
+  plant_.MapVelocityToQDot(*context, v_, &q_dot);
+  x_dot << q_dot, EvalMassMatrixCholesky(*context).solve(tau);
+  return x_dot;
+}
+
+template <typename T>
+const MatrixX<T>& KnotDynamics<T>::EvalMassMatrix(const Context<T>& context) {
+  Update(context);
+  if (!mass_matrix_valid_) {
+    plant_.CalcMassMatrix(context, &M_);
+    num_mass_matrix_evaluations_++;
+    mass_matrix_valid_ = true;
+  }
+  return M_;
+}
+
+template <typename T>
+const Eigen::LLT<MatrixX<T>>& KnotDynamics<T>::EvalMassMatrixCholesky(
+    const Context<T>& context) {
+  EvalMassMatrix(context);
+  if (!cholesky_valid_) {
+    M_llt_.compute(M_);
+    num_factorizations_++;
+    cholesky_valid_ = true;
+  }
+  return M_llt_;
+}
+
+template <typename T>
+const VectorX<T>& KnotDynamics<T>::EvalBias(const Context<T>& context) {
+  Update(context);
+  if (!bias_valid_) {
+    // Inverse dynamics with zero acceleration gives C - tau_app. (Gravity is
+    // one of the force elements, applied as body forces.)
+    drake::multibody::MultibodyForces<T> forces(plant_);
+    plant_.CalcForceElementsContribution(context, &forces);
+    bias_ = -plant_.CalcInverseDynamics(
+        context, VectorX<T>::Zero(plant_.num_velocities()), forces);
+    bias_valid_ = true;
+  }
+  return bias_;
+}
+
+template <typename T>
+const MatrixX<T>& KnotDynamics<T>::EvalFullJacobian(
+    const Context<T>& context) {
+  Update(context);
+  if (!jacobian_valid_) {
+    evaluators_.EvalFullJacobian(context, &J_, &workspace_);
+    jacobian_valid_ = true;
+  }
+  return J_;
+}
+
+template <typename T>
+const MatrixX<T>& KnotDynamics<T>::EvalMassMatrixInverseTimesB(
+    const Context<T>& context) {
+  const auto& M_llt = EvalMassMatrixCholesky(context);
+  if (!minv_b_valid_) {
+    Minv_B_ = M_llt.solve(B_);
+    minv_b_valid_ = true;
+  }
+  return Minv_B_;
+}
+
+template <typename T>
+const MatrixX<T>& KnotDynamics<T>::EvalMassMatrixInverseTimesJacobianTranspose(
+    const Context<T>& context) {
+  const auto& M_llt = EvalMassMatrixCholesky(context);
+  if (!minv_jt_valid_) {
+    Minv_JT_ = M_llt.solve(EvalFullJacobian(context).transpose());
+    minv_jt_valid_ = true;
+  }
+  return Minv_JT_;
+}
+
+template <typename T>
+const VectorX<T>& KnotDynamics<T>::EvalFullJacobianDotTimesV(
+    const Context<T>& context) {
+  Update(context);
+  if (!jdotv_valid_) {
+    if (jacobian_valid_) {
+      evaluators_.EvalFullJacobianDotTimesV(context, &Jdotv_, &workspace_);
+    } else {
+      evaluators_.EvalFullJacobianAndJdotV(context, &J_, &Jdotv_, nullptr,
+                                           &workspace_);
+      jacobian_valid_ = true;
+    }
+    jdotv_valid_ = true;
+  }
+  return Jdotv_;
+}
+
+template <typename T>
+MatrixX<T> KnotDynamics<T>::EvalActiveJacobian(const Context<T>& context) {
+  const auto& J = EvalFullJacobian(context);
+  MatrixX<T> J_active(active_rows_.size(), J.cols());
+  for (size_t i = 0; i < active_rows_.size(); i++) {
+    J_active.row(i) = J.row(active_rows_[i]);
+  }
+  return J_active;
+}
+
+template <typename T>
+VectorX<T> KnotDynamics<T>::EvalActiveJacobianDotTimesV(
+    const Context<T>& context) {
+  const auto& Jdotv = EvalFullJacobianDotTimesV(context);
+  VectorX<T> Jdotv_active(active_rows_.size());
+  for (size_t i = 0; i < active_rows_.size(); i++) {
+    Jdotv_active(i) = Jdotv(active_rows_[i]);
+  }
+  return Jdotv_active;
+}
+
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
+
+DRAKE_DEFINE_CLASS_TEMPLATE_INSTANTIATIONS_ON_DEFAULT_NONSYMBOLIC_SCALARS(
+    class ::dairlib::systems::trajectory_optimization::KnotDynamics)
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+
+#include "drake/multibody/plant/multibody_plant.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+
+/// KnotDynamics holds the rigid-body dynamics terms of one knot point, so
+/// that every Dircon constraint touching the knot (the collocation
+/// constraints on either side, the acceleration constraint and the impact
+/// constraint) reads them instead of recomputing them.
+///
+/// The terms are computed lazily from the context passed to each query, and
+/// are kept until the state of the context changes: M(q), its Cholesky
+/// factorization and the constraint Jacobian J(q) depend on q only, the
+/// bias (applied and gravity forces minus Coriolis terms) and Jdot*v on
+/// (q, v). The products M^-1*B and M^-1*J^T, which are the derivatives of
+/// the dynamics with respect to u and lambda, depend on q only as well. Forward dynamics with different inputs and constraint forces at
+/// the same state then only cost a back substitution, e.g. when finite
+/// differencing with respect to u or lambda.
+///
+/// The bias only contains the force elements (including gravity) of the
+/// plant: the applied generalized force input port is replaced by the
+/// constraint forces, as in the evaluators. Plants that could also have
+/// contact forces (from collision geometries registered with a SceneGraph)
+/// and contexts with applied spatial forces fall back to the evaluators.
+///
+/// Not thread safe: a KnotDynamics must only be used by the constraints
+/// sharing the same context.
+template <typename T>
+class KnotDynamics {
+ public:
+  KnotDynamics(const drake::multibody::MultibodyPlant<T>& plant,
+               const multibody::KinematicEvaluatorSet<T>& evaluators);
+
+  /// Same as evaluators.CalcTimeDerivativesWithForce(context, lambda). For a
+  /// discrete plant, a plant with collision geometries or a context with
+  /// applied spatial forces, this falls back to the evaluators.
+  drake::VectorX<T> CalcTimeDerivativesWithForce(
+      drake::systems::Context<T>* context, const drake::VectorX<T>& lambda);
+
+  const drake::MatrixX<T>& EvalMassMatrix(
+      const drake::systems::Context<T>& context);
+
+  const Eigen::LLT<drake::MatrixX<T>>& EvalMassMatrixCholesky(
+      const drake::systems::Context<T>& context);
+
+  /// tau_app(q, v) - C(q, v), where tau_app contains gravity and the force
+  /// elements, so that M*vdot = bias + B*u + J^T*lambda
+  const drake::VectorX<T>& EvalBias(
+      const drake::systems::Context<T>& context);
+
+  const drake::MatrixX<T>& EvalFullJacobian(
+      const drake::systems::Context<T>& context);
+
+  /// M^-1*B, the derivative of vdot with respect to u
+  const drake::MatrixX<T>& EvalMassMatrixInverseTimesB(
+      const drake::systems::Context<T>& context);
+
+  /// M^-1*J^T (with the full Jacobian), the derivative of vdot with respect
+  /// to lambda
+  const drake::MatrixX<T>& EvalMassMatrixInverseTimesJacobianTranspose(
+      const drake::systems::Context<T>& context);
+
+  const drake::VectorX<T>& EvalFullJacobianDotTimesV(
+      const drake::systems::Context<T>& context);
+
+  /// Active rows of EvalFullJacobian()
+  drake::MatrixX<T> EvalActiveJacobian(
+      const drake::systems::Context<T>& context);
+
+  /// Active rows of EvalFullJacobianDotTimesV()
+  drake::VectorX<T> EvalActiveJacobianDotTimesV(
+      const drake::systems::Context<T>& context);
+
+  /// Number of times that the mass matrix has been computed
+  int num_mass_matrix_evaluations() const {
+    return num_mass_matrix_evaluations_;
+  }
+
+  /// Number of times that the mass matrix has been factored
+  int num_factorizations() const { return num_factorizations_; }
+
+ private:
+  // Invalidates the stored terms if the state of `context` has changed
+  void Update(const drake::systems::Context<T>& context);
+
+  const drake::multibody::MultibodyPlant<T>& plant_;
+  const multibody::KinematicEvaluatorSet<T>& evaluators_;
+  const drake::MatrixX<T> B_;
+  // Whether the plant has forces that the bias doesn't contain
+  const bool use_evaluators_;
+  std::vector<int> active_rows_;
+
+  drake::VectorX<T> q_;
+  drake::VectorX<T> v_;
+  bool mass_matrix_valid_ = false;
+  bool cholesky_valid_ = false;
+  bool bias_valid_ = false;
+  bool jacobian_valid_ = false;
+  bool jdotv_valid_ = false;
+  bool minv_b_valid_ = false;
+  bool minv_jt_valid_ = false;
+  drake::MatrixX<T> M_;
+  Eigen::LLT<drake::MatrixX<T>> M_llt_;
+  drake::VectorX<T> bias_;
+  drake::MatrixX<T> J_;
+  drake::VectorX<T> Jdotv_;
+  drake::MatrixX<T> Minv_B_;
+  drake::MatrixX<T> Minv_JT_;
+  // Scratch of the evaluators
+  multibody::KinematicWorkspace<T> workspace_;
+  int num_mass_matrix_evaluations_ = 0;
+  int num_factorizations_ = 0;
+};
+
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
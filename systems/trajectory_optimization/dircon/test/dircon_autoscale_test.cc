@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "drake/multibody/parsing/parser.h"
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/solvers/solve.h"
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "solvers/nonlinear_constraint.h"
+#include "systems/trajectory_optimization/dircon/dircon.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using drake::solvers::MathematicalProgramResult;
+using drake::trajectories::PiecewisePolynomial;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+// 100 * (x_0 + x_1), between 10 and 20: a badly scaled row with nonzero
+// bounds
+class SumConstraint : public solvers::NonlinearConstraint<double> {
+ public:
+  SumConstraint()
+      : solvers::NonlinearConstraint<double>(
+            1, 2, VectorXd::Constant(1, 10), VectorXd::Constant(1, 20),
+            "sum") {}
+
+  void EvaluateConstraint(const Eigen::Ref<const VectorXd>& x,
+                          VectorXd* y) const override {
+    *y = VectorXd::Constant(1, 100 * x.sum());
+  }
+};
+
+// Moves the planar walker (welded to the world) from rest back to rest in
+// one second with the least effort, through a configuration at the middle
+// knot point given by SumConstraint
+class DirconAutoScaleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser(plant_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->WeldFrames(plant_->world_frame(), plant_->GetFrameByName("base"),
+                       drake::math::RigidTransform<double>());
+    plant_->Finalize();
+    evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(*plant_);
+    mode_ =
+        std::make_unique<DirconMode<double>>(*evaluators_, kNumKnots, 1, 1);
+  }
+
+  std::unique_ptr<Dircon<double>> MakeTrajopt(
+      std::shared_ptr<SumConstraint> sum) {
+    auto trajopt = std::make_unique<Dircon<double>>(mode_.get());
+    const int n_x = plant_->num_positions() + plant_->num_velocities();
+    const int n_u = plant_->num_actuators();
+    trajopt->AddBoundingBoxConstraint(VectorXd::Zero(n_x),
+                                      VectorXd::Zero(n_x),
+                                      trajopt->initial_state());
+    trajopt->AddBoundingBoxConstraint(VectorXd::Zero(n_x),
+                                      VectorXd::Zero(n_x),
+                                      trajopt->final_state());
+    trajopt->AddConstraint(sum, trajopt->state(kNumKnots / 2).head(2));
+    auto u = trajopt->input();
+    trajopt->AddRunningCost(u.transpose() * u);
+
+    VectorXd times(kNumKnots);
+    MatrixXd states(n_x, kNumKnots);
+    for (int i = 0; i < kNumKnots; i++) {
+      times(i) = i / (kNumKnots - 1.0);
+      states.col(i) = 0.1 * VectorXd::Ones(n_x) * std::sin(M_PI * times(i));
+    }
+    trajopt->SetInitialTrajectory(
+        PiecewisePolynomial<double>::FirstOrderHold(
+            times, MatrixXd::Zero(n_u, kNumKnots)),
+        PiecewisePolynomial<double>::FirstOrderHold(times, states));
+    return trajopt;
+  }
+
+  static constexpr int kNumKnots = 7;
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+  std::unique_ptr<DirconMode<double>> mode_;
+};
+
+// Every generic constraint is satisfied at the solution, within its (scaled)
+// bounds
+void ExpectFeasible(const Dircon<double>& trajopt,
+                    const MathematicalProgramResult& result) {
+  for (const auto& binding : trajopt.generic_constraints()) {
+    const VectorXd y = result.EvalBinding(binding);
+    const auto& c = binding.evaluator();
+    EXPECT_TRUE((y.array() >= c->lower_bound().array() - 1e-6).all() &&
+                (y.array() <= c->upper_bound().array() + 1e-6).all())
+        << c->get_description();
+  }
+}
+
+TEST_F(DirconAutoScaleTest, SameSolution) {
+  auto sum = std::make_shared<SumConstraint>();
+  auto trajopt = MakeTrajopt(sum);
+  const auto result = drake::solvers::Solve(*trajopt);
+  ASSERT_TRUE(result.is_success());
+  ExpectFeasible(*trajopt, result);
+
+  for (auto method : {Dircon<double>::ScalingMethod::kGeometricMean,
+                      Dircon<double>::ScalingMethod::kRuiz}) {
+    auto scaled_sum = std::make_shared<SumConstraint>();
+    auto scaled = MakeTrajopt(scaled_sum);
+    scaled->AutoScale(method);
+    // The badly scaled row is scaled, along with its bounds
+    ASSERT_EQ(scaled_sum->GetConstraintScaling().count(0), 1);
+    const double factor = scaled_sum->GetConstraintScaling().at(0);
+    EXPECT_NE(factor, 1);
+    EXPECT_DOUBLE_EQ(scaled_sum->lower_bound()(0), 10 * factor);
+    EXPECT_DOUBLE_EQ(scaled_sum->upper_bound()(0), 20 * factor);
+    EXPECT_FALSE(scaled->GetVariableScaling().empty());
+
+    const auto scaled_result = drake::solvers::Solve(*scaled);
+    ASSERT_TRUE(scaled_result.is_success());
+    ExpectFeasible(*scaled, scaled_result);
+
+    // The solutions (which are unscaled) match, with the sum at its lower
+    // bound in both
+    const VectorXd z = result.GetSolution(trajopt->decision_variables());
+    const VectorXd z_scaled =
+        scaled_result.GetSolution(scaled->decision_variables());
+    EXPECT_LE((z - z_scaled).lpNorm<Eigen::Infinity>(), 1e-4);
+    EXPECT_NEAR(result.get_optimal_cost(), scaled_result.get_optimal_cost(),
+                1e-6 * std::max(1.0, std::abs(result.get_optimal_cost())));
+    VectorXd y;
+    sum->EvaluateConstraint(
+        result.GetSolution(trajopt->state(kNumKnots / 2).head(2)), &y);
+    EXPECT_NEAR(y(0), 10, 1e-5);
+    scaled_sum->EvaluateConstraint(
+        scaled_result.GetSolution(scaled->state(kNumKnots / 2).head(2)), &y);
+    EXPECT_NEAR(y(0), 10, 1e-5);
+  }
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
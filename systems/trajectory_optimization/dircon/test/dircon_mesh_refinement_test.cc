@@ -0,0 +1,232 @@
+#include "systems/trajectory_optimization/dircon/dircon_mesh_refinement.h"
+
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "drake/common/test_utilities/eigen_matrix_compare.h"
+#include "drake/multibody/parsing/parser.h"
+#include "drake/multibody/plant/multibody_plant.h"
+#include "drake/solvers/choose_best_solver.h"
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::CompareMatrices;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using drake::solvers::MathematicalProgramResult;
+using drake::trajectories::PiecewisePolynomial;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+// The planar walker welded to the world without gravity, so that at rest
+// (and without inputs) the dynamics are zero in any configuration
+class DirconMeshRefinementTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser(plant_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->WeldFrames(plant_->world_frame(), plant_->GetFrameByName("base"),
+                       drake::math::RigidTransform<double>());
+    plant_->mutable_gravity_field().set_gravity_vector(Vector3d::Zero());
+    plant_->Finalize();
+    evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(*plant_);
+  }
+
+  // Two modes of one second each, which move the first position from 0 to
+  // 0.5 (from rest to rest) with the least effort. With
+  // `infeasible_refinement`, the refined problems (with more than
+  // `num_knotpoints` per mode) are infeasible.
+  std::unique_ptr<DirconMeshRefinement> MakeRefinement(
+      int num_knotpoints, const DirconMeshRefinementOptions& options,
+      bool infeasible_refinement = false) {
+    auto make_mode = [this](int mode_index, int n) {
+      return std::make_unique<DirconMode<double>>(*evaluators_, n, 1, 1);
+    };
+    auto setup = [this, num_knotpoints,
+                  infeasible_refinement](Dircon<double>* trajopt) {
+      const int n_x = plant_->num_positions() + plant_->num_velocities();
+      const int n_u = plant_->num_actuators();
+      VectorXd x_f = VectorXd::Zero(n_x);
+      x_f(0) = 0.5;
+      trajopt->AddBoundingBoxConstraint(VectorXd::Zero(n_x),
+                                        VectorXd::Zero(n_x),
+                                        trajopt->initial_state());
+      trajopt->AddBoundingBoxConstraint(x_f, x_f, trajopt->final_state());
+      auto u = trajopt->input();
+      trajopt->AddRunningCost(u.transpose() * u);
+      if (infeasible_refinement && trajopt->mode_length(0) > num_knotpoints) {
+        trajopt->AddBoundingBoxConstraint(1, 1, trajopt->initial_state()(0));
+      }
+      const Eigen::Vector2d times(0, 2);
+      MatrixXd states(n_x, 2);
+      states << VectorXd::Zero(n_x), x_f;
+      trajopt->SetInitialTrajectory(
+          PiecewisePolynomial<double>::FirstOrderHold(times,
+                                                      MatrixXd::Zero(n_u, 2)),
+          PiecewisePolynomial<double>::FirstOrderHold(times, states));
+    };
+    return std::make_unique<DirconMeshRefinement>(
+        *plant_, std::vector<int>{num_knotpoints, num_knotpoints}, make_mode,
+        setup, options);
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+};
+
+// The solution is at rest except for a jump of the first position to c at
+// knot point 2. Its interpolation between rest at knots 1 and 2 (and 2 and
+// 3) is c * (3 s^2 - 2 s^3), whose derivative is the defect of the
+// positions: its integral over the interval is c, and the trapezoidal rule
+// at the quarter points gives 15/16 c.
+TEST_F(DirconMeshRefinementTest, EstimateIntervalErrors) {
+  const int num_knots = 5;
+  const double h = 0.25;
+  const double c = 0.1;
+  DirconMode<double> mode(*evaluators_, num_knots);
+  Dircon<double> trajopt(&mode);
+
+  VectorXd z = VectorXd::Zero(trajopt.num_vars());
+  for (int i = 0; i < trajopt.h_vars().size(); i++) {
+    z(trajopt.FindDecisionVariableIndex(trajopt.h_vars()(i))) = h;
+  }
+  z(trajopt.FindDecisionVariableIndex(trajopt.state_vars(0, 2)(0))) = c;
+  MathematicalProgramResult result;
+  result.set_decision_variable_index(trajopt.decision_variable_index());
+  result.set_x_val(z);
+
+  const auto errors =
+      DirconMeshRefinement::EstimateIntervalErrors(trajopt, result);
+  ASSERT_EQ(errors.size(), 1);
+  ASSERT_EQ(errors[0].size(), num_knots - 1);
+  EXPECT_NEAR(errors[0](0), 0, 1e-12);
+  EXPECT_NEAR(errors[0](1), 15.0 / 16 * c, 1e-12);
+  EXPECT_NEAR(errors[0](2), 15.0 / 16 * c, 1e-12);
+  EXPECT_NEAR(errors[0](3), 0, 1e-12);
+
+  // The errors scale with the jump
+  z(trajopt.FindDecisionVariableIndex(trajopt.state_vars(0, 2)(0))) = 2 * c;
+  result.set_x_val(z);
+  const auto double_errors =
+      DirconMeshRefinement::EstimateIntervalErrors(trajopt, result);
+  EXPECT_NEAR(double_errors[0](1), 2 * errors[0](1), 1e-12);
+}
+
+// The intervals of a mode grow with the fourth root of its largest error
+// over the tolerance, by at least one and at most doubling, up to
+// max_knotpoints. Modes within the tolerance are left alone.
+TEST_F(DirconMeshRefinementTest, Refine) {
+  DirconMeshRefinementOptions options;
+  options.tolerance = 1e-3;
+  options.max_knotpoints = 20;
+  const std::vector<int> num_knotpoints{5, 5, 5, 9};
+  std::vector<VectorXd> errors(4, VectorXd::Zero(4));
+  // Within the tolerance
+  errors[0] << 1e-4, 1e-3, 0, 1e-4;
+  // (16)^(1/4) = 2 times the 4 intervals
+  errors[1] << 0, 16e-3, 1e-4, 0;
+  // (1.5)^(1/4) * 4 = 4.43 rounds up to 5 intervals
+  errors[2] << 1.5e-3, 0, 0, 0;
+  // 8 intervals, at most doubled to 16, and limited to 20 knot points
+  errors[3] = VectorXd::Zero(8);
+  errors[3](7) = 1;
+
+  EXPECT_EQ(DirconMeshRefinement::Refine(num_knotpoints, errors, options),
+            (std::vector<int>{5, 9, 6, 17}));
+  options.max_knotpoints = 12;
+  EXPECT_EQ(DirconMeshRefinement::Refine(num_knotpoints, errors, options),
+            (std::vector<int>{5, 9, 6, 12}));
+  // A small error still adds an interval
+  errors[3](7) = 1.0001e-3;
+  EXPECT_EQ(DirconMeshRefinement::Refine(num_knotpoints, errors, options),
+            (std::vector<int>{5, 9, 6, 10}));
+}
+
+TEST_F(DirconMeshRefinementTest, RefineStops) {
+  DirconMeshRefinementOptions options;
+  options.tolerance = 1e-3;
+  options.max_knotpoints = 9;
+  std::vector<VectorXd> errors(2, VectorXd::Zero(4));
+  // Every interval meets the tolerance
+  errors[0] << 1e-3, 0, 5e-4, 0;
+  errors[1] << 0, 0, 0, 1e-3;
+  EXPECT_TRUE(DirconMeshRefinement::Refine({5, 5}, errors, options).empty());
+
+  // The only mode above the tolerance is at max_knotpoints
+  errors[1] = VectorXd::Zero(8);
+  errors[1](0) = 1;
+  EXPECT_TRUE(DirconMeshRefinement::Refine({5, 9}, errors, options).empty());
+  // ... unless another one can grow
+  errors[0](1) = 2e-3;
+  EXPECT_EQ(DirconMeshRefinement::Refine({5, 9}, errors, options),
+            (std::vector<int>{6, 9}));
+
+  // Modes with a single knot point have no intervals
+  errors = {VectorXd(0), VectorXd::Zero(4)};
+  EXPECT_TRUE(DirconMeshRefinement::Refine({1, 5}, errors, options).empty());
+}
+
+// The refined problem starts from the previous solution, with the same
+// post-impact velocities
+TEST_F(DirconMeshRefinementTest, WarmStart) {
+  DirconMeshRefinementOptions options;
+  options.tolerance = 1e-12;
+  options.max_iterations = 1;
+  auto coarse = MakeRefinement(3, options);
+  auto solver = drake::solvers::MakeSolver(
+      drake::solvers::ChooseBestSolver(coarse->trajopt()));
+  const MathematicalProgramResult coarse_result = coarse->Solve(*solver);
+  ASSERT_TRUE(coarse_result.is_success());
+
+  options.max_iterations = 2;
+  auto refinement = MakeRefinement(3, options);
+  const MathematicalProgramResult result = refinement->Solve(*solver);
+  ASSERT_TRUE(result.is_success());
+  EXPECT_EQ(refinement->num_iterations(), 2);
+  EXPECT_GT(refinement->num_knotpoints()[0], 3);
+  const auto& trajopt = refinement->trajopt();
+  EXPECT_TRUE(CompareMatrices(
+      trajopt.GetInitialGuess(trajopt.post_impact_velocity_vars(0)),
+      coarse_result.GetSolution(
+          coarse->trajopt().post_impact_velocity_vars(0)),
+      1e-12));
+}
+
+// A failed refinement keeps the last successful solve
+TEST_F(DirconMeshRefinementTest, FailedRefinement) {
+  DirconMeshRefinementOptions options;
+  options.tolerance = 1e-12;
+  options.max_iterations = 3;
+  auto refinement = MakeRefinement(3, options, true);
+  auto solver = drake::solvers::MakeSolver(
+      drake::solvers::ChooseBestSolver(refinement->trajopt()));
+  const MathematicalProgramResult result = refinement->Solve(*solver);
+  ASSERT_TRUE(result.is_success());
+  EXPECT_EQ(refinement->num_iterations(), 2);
+  EXPECT_EQ(refinement->num_knotpoints(), (std::vector<int>{3, 3}));
+  const auto& trajopt = refinement->trajopt();
+  EXPECT_EQ(trajopt.mode_length(0), 3);
+  EXPECT_NEAR(result.GetSolution(trajopt.final_state())(0), 0.5, 1e-6);
+  EXPECT_EQ(refinement->interval_errors()[0].size(), 2);
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
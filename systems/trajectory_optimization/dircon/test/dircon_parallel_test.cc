@@ -0,0 +1,141 @@
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "drake/multibody/parsing/parser.h"
+#include "drake/multibody/plant/multibody_plant.h"
+
+#include "common/find_resource.h"
+#include "examples/Cassie/cassie_utils.h"
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "systems/trajectory_optimization/dircon/dircon.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+// Dircon on Cassie, with a flight mode (only the loop closures, which are
+// DistanceEvaluators) followed by an impact and a double support mode (the
+// loop closures and the toe contacts), so that every kind of Dircon
+// constraint is evaluated.
+class DirconParallelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser parser(plant_.get());
+    parser.AddModelFromFile(
+        FindResourceOrThrow("examples/Cassie/urdf/cassie_fixed_springs.urdf"));
+    plant_->Finalize();
+
+    left_loop_ = std::make_unique<multibody::DistanceEvaluator<double>>(
+        LeftLoopClosureEvaluator(*plant_));
+    right_loop_ = std::make_unique<multibody::DistanceEvaluator<double>>(
+        RightLoopClosureEvaluator(*plant_));
+    const auto left_toe = LeftToeFront(*plant_);
+    const auto left_heel = LeftToeRear(*plant_);
+    const auto right_toe = RightToeFront(*plant_);
+    const auto right_heel = RightToeRear(*plant_);
+    auto add_contact = [&](const auto& point, std::vector<int> active_inds) {
+      contacts_.push_back(
+          std::make_unique<multibody::WorldPointEvaluator<double>>(
+              *plant_, point.first, point.second, Eigen::Matrix3d::Identity(),
+              Eigen::Vector3d::Zero(), active_inds));
+      contacts_.back()->set_frictional();
+      contacts_.back()->set_mu(1);
+    };
+    add_contact(left_toe, {0, 1, 2});
+    add_contact(left_heel, {1, 2});
+    add_contact(right_toe, {0, 1, 2});
+    add_contact(right_heel, {1, 2});
+
+    flight_evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(*plant_);
+    flight_evaluators_->add_evaluator(left_loop_.get());
+    flight_evaluators_->add_evaluator(right_loop_.get());
+    stance_evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(*plant_);
+    for (const auto& contact : contacts_) {
+      stance_evaluators_->add_evaluator(contact.get());
+    }
+    stance_evaluators_->add_evaluator(left_loop_.get());
+    stance_evaluators_->add_evaluator(right_loop_.get());
+
+    flight_ = std::make_unique<DirconMode<double>>(*flight_evaluators_, 4);
+    stance_ = std::make_unique<DirconMode<double>>(*stance_evaluators_, 5);
+    for (int i = 0; i < 4; i++) {
+      stance_->MakeConstraintRelative(i, 1);
+    }
+    sequence_ = std::make_unique<DirconModeSequence<double>>(*plant_);
+    sequence_->AddMode(flight_.get());
+    sequence_->AddMode(stance_.get());
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<multibody::DistanceEvaluator<double>> left_loop_;
+  std::unique_ptr<multibody::DistanceEvaluator<double>> right_loop_;
+  std::vector<std::unique_ptr<multibody::WorldPointEvaluator<double>>>
+      contacts_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> flight_evaluators_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> stance_evaluators_;
+  std::unique_ptr<DirconMode<double>> flight_;
+  std::unique_ptr<DirconMode<double>> stance_;
+  std::unique_ptr<DirconModeSequence<double>> sequence_;
+};
+
+// The values and gradients of all of the constraints don't depend on the
+// number of threads, bit for bit, across repeated evaluations at changing
+// decision variables (which also exercises the caches).
+TEST_F(DirconParallelTest, SerialAndParallelAreIdentical) {
+  Dircon<double> serial(*sequence_, 1);
+  Dircon<double> parallel(*sequence_, 4);
+  ASSERT_EQ(serial.num_vars(), parallel.num_vars());
+  ASSERT_EQ(serial.generic_constraints().size(),
+            parallel.generic_constraints().size());
+
+  std::srand(42);
+  for (int trial = 0; trial < 5; trial++) {
+    const VectorXd z = VectorXd::Random(serial.num_vars());
+    std::vector<VectorXd> serial_values;
+    std::vector<MatrixXd> serial_gradients;
+    serial.EvalGenericConstraints(z, &serial_values, &serial_gradients);
+    std::vector<VectorXd> serial_double_values;
+    serial.EvalGenericConstraints(z, &serial_double_values);
+
+    for (int repeat = 0; repeat < 3; repeat++) {
+      std::vector<VectorXd> values;
+      std::vector<MatrixXd> gradients;
+      parallel.EvalGenericConstraints(z, &values, &gradients);
+      ASSERT_EQ(values.size(), serial_values.size());
+      for (int i = 0; i < static_cast<int>(values.size()); i++) {
+        const std::string name =
+            serial.generic_constraints()[i].evaluator()->get_description();
+        EXPECT_TRUE(values[i] == serial_values[i]) << name;
+        EXPECT_TRUE(gradients[i] == serial_gradients[i]) << name;
+      }
+
+      // Values alone take the double path
+      parallel.EvalGenericConstraints(z, &values);
+      for (int i = 0; i < static_cast<int>(values.size()); i++) {
+        EXPECT_TRUE(values[i] == serial_double_values[i]);
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,201 @@
+#include "systems/trajectory_optimization/dircon/dynamics_cache.h"
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "drake/multibody/parsing/parser.h"
+#include "drake/multibody/plant/multibody_plant.h"
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/multibody_utils.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using Eigen::VectorXd;
+
+class DynamicsCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser(plant_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->Finalize();
+    evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(*plant_);
+    context_ = plant_->CreateDefaultContext();
+
+    std::srand(0);
+    for (int i = 0; i < 12; i++) {
+      states_.push_back(
+          VectorXd::Random(plant_->num_positions() + plant_->num_velocities()));
+    }
+    input_ = VectorXd::Zero(plant_->num_actuators());
+  }
+
+  // Looks the dynamics at states_[key] up in `cache`, and checks the result
+  // against the evaluators. Returns whether it was a hit.
+  bool Query(DynamicsCache<double>* cache, int key) {
+    multibody::setContext<double>(*plant_, states_[key], input_,
+                                  context_.get());
+    const int64_t hits = cache->stats().hits;
+    const VectorXd xdot =
+        cache->CalcTimeDerivativesWithForce(context_.get(), VectorXd(0));
+    EXPECT_TRUE(xdot ==
+        evaluators_->CalcTimeDerivativesWithForce(context_.get(), VectorXd(0)))
+        << "key " << key;
+    return cache->stats().hits > hits;
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+  std::unique_ptr<drake::systems::Context<double>> context_;
+  std::vector<VectorXd> states_;
+  VectorXd input_;
+};
+
+TEST_F(DynamicsCacheTest, HitsAndMisses) {
+  DynamicsCache<double> cache(*evaluators_, 4);
+  EXPECT_FALSE(Query(&cache, 0));
+  EXPECT_TRUE(Query(&cache, 0));
+  EXPECT_FALSE(Query(&cache, 1));
+  EXPECT_TRUE(Query(&cache, 0));
+  EXPECT_TRUE(Query(&cache, 1));
+
+  // The input is part of the key
+  input_.setOnes();
+  EXPECT_FALSE(Query(&cache, 0));
+  EXPECT_TRUE(Query(&cache, 0));
+  input_.setZero();
+  EXPECT_TRUE(Query(&cache, 0));
+
+  // -0.0 and 0.0 are the same key
+  states_[2].setZero();
+  EXPECT_FALSE(Query(&cache, 2));
+  states_[2] = -states_[2];
+  EXPECT_TRUE(Query(&cache, 2));
+}
+
+TEST_F(DynamicsCacheTest, EvictsLeastRecentlyUsed) {
+  DynamicsCache<double> cache(*evaluators_, 3);
+  EXPECT_FALSE(Query(&cache, 0));
+  EXPECT_FALSE(Query(&cache, 1));
+  EXPECT_FALSE(Query(&cache, 2));
+  // Most to least recent: 0, 2, 1
+  EXPECT_TRUE(Query(&cache, 0));
+  // Evicts 1: 3, 0, 2
+  EXPECT_FALSE(Query(&cache, 3));
+  EXPECT_EQ(cache.stats().evictions, 1);
+  EXPECT_TRUE(Query(&cache, 0));
+  EXPECT_TRUE(Query(&cache, 2));
+  EXPECT_TRUE(Query(&cache, 3));
+  // 3, 2, 0: evicts 0
+  EXPECT_FALSE(Query(&cache, 1));
+  EXPECT_EQ(cache.stats().evictions, 2);
+  EXPECT_TRUE(Query(&cache, 2));
+  EXPECT_TRUE(Query(&cache, 3));
+  EXPECT_TRUE(Query(&cache, 1));
+  EXPECT_FALSE(Query(&cache, 0));
+  EXPECT_EQ(cache.stats().evictions, 3);
+}
+
+// Random queries against a model of the LRU cache. The hash table is at most
+// half full, with only a few positions for small capacities, so that keys
+// collide and each eviction backward-shifts probe sequences: every key the
+// model holds must still be found (and not be inserted twice).
+TEST_F(DynamicsCacheTest, MatchesModelAcrossEvictions) {
+  std::mt19937 generator(0);
+  for (int capacity = 1; capacity <= 9; capacity++) {
+    DynamicsCache<double> cache(*evaluators_, capacity);
+    std::list<int> model;
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    std::uniform_int_distribution<int> key_distribution(
+        0, std::min<int>(states_.size(), capacity + 3) - 1);
+    for (int query = 0; query < 500; query++) {
+      const int key = key_distribution(generator);
+      const auto it = std::find(model.begin(), model.end(), key);
+      const bool expected_hit = it != model.end();
+      if (expected_hit) {
+        model.erase(it);
+        hits++;
+      } else {
+        if (static_cast<int>(model.size()) == capacity) {
+          model.pop_back();
+          evictions++;
+        }
+        misses++;
+      }
+      model.push_front(key);
+      ASSERT_EQ(Query(&cache, key), expected_hit)
+          << "capacity " << capacity << ", query " << query;
+    }
+    // Every key the model holds is still cached
+    for (int key : std::vector<int>(model.begin(), model.end())) {
+      EXPECT_TRUE(Query(&cache, key)) << "capacity " << capacity;
+      hits++;
+    }
+
+    const DynamicsCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, hits);
+    EXPECT_EQ(stats.misses, misses);
+    EXPECT_EQ(stats.evictions, evictions);
+  }
+}
+
+TEST_F(DynamicsCacheTest, Stats) {
+  DynamicsCache<double> cache(*evaluators_, 2);
+  EXPECT_EQ(cache.stats().hit_rate(), 0);
+  EXPECT_FALSE(Query(&cache, 0));
+  const int64_t bytes = cache.stats().bytes;
+  EXPECT_GT(bytes, 0);
+  EXPECT_TRUE(Query(&cache, 0));
+  EXPECT_TRUE(Query(&cache, 0));
+  EXPECT_FALSE(Query(&cache, 1));
+  EXPECT_FALSE(Query(&cache, 2));
+
+  DynamicsCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 3);
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.4);
+  // The storage is allocated on first use, and only the (fixed size) values
+  // of the new entries are added
+  EXPECT_EQ(stats.bytes,
+            bytes + static_cast<int64_t>(sizeof(double)) * states_[0].size());
+
+  stats += stats;
+  EXPECT_EQ(stats.hits, 4);
+  EXPECT_EQ(stats.misses, 6);
+  EXPECT_EQ(stats.evictions, 2);
+
+  cache.ResetStats();
+  EXPECT_EQ(cache.stats().hits, 0);
+  EXPECT_EQ(cache.stats().misses, 0);
+  EXPECT_EQ(cache.stats().evictions, 0);
+  // Resetting the counters keeps the entries
+  EXPECT_TRUE(Query(&cache, 2));
+  EXPECT_TRUE(Query(&cache, 1));
+  EXPECT_EQ(cache.stats().hits, 2);
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "drake/multibody/parsing/parser.h"
+#include "drake/multibody/plant/multibody_plant.h"
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "multibody/multibody_utils.h"
+#include "systems/trajectory_optimization/dircon/dircon_opt_constraints.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::AutoDiffXd;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using Eigen::MatrixXd;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+using solvers::NonlinearConstraint;
+
+// Exposes the analytic and the finite difference Jacobians of a constraint
+template <typename C>
+class JacobianTester : public C {
+ public:
+  using C::C;
+  using C::CalcFiniteDifferenceJacobian;
+  using C::EvaluateConstraintWithJacobian;
+};
+
+// Checks the (semi-)analytic Jacobian of `constraint` at x against its
+// central finite difference Jacobian, entry by entry
+template <typename C>
+void ExpectJacobianMatchesFiniteDifference(JacobianTester<C>* constraint,
+                                           const VectorXd& x) {
+  VectorXd y;
+  MatrixXd dy;
+  constraint->EvaluateConstraintWithJacobian(x, &y, &dy);
+
+  VectorXd y_fd;
+  MatrixXd dy_fd;
+  constraint->SetFiniteDifference(
+      NonlinearConstraint<double>::FiniteDifference::kCentral);
+  constraint->CalcFiniteDifferenceJacobian(x, &y_fd, &dy_fd);
+
+  ASSERT_EQ(y.size(), y_fd.size());
+  EXPECT_LE((y - y_fd).lpNorm<Eigen::Infinity>(),
+            1e-8 * std::max(1.0, y_fd.lpNorm<Eigen::Infinity>()));
+  ASSERT_EQ(dy.rows(), dy_fd.rows());
+  ASSERT_EQ(dy.cols(), dy_fd.cols());
+  // The analytic Jacobians forward difference the kinematic terms
+  const double tolerance = 1e-4;
+  for (int i = 0; i < dy.rows(); i++) {
+    for (int j = 0; j < dy.cols(); j++) {
+      EXPECT_NEAR(dy(i, j), dy_fd(i, j),
+                  tolerance * std::max(1.0, std::abs(dy_fd(i, j))))
+          << constraint->get_description() << " (" << i << ", " << j << ")";
+    }
+  }
+}
+
+// Random decision variables of a collocation constraint, with a positive
+// time step and unit quaternions at the knot points
+VectorXd RandomCollocationVariables(const MultibodyPlant<double>& plant,
+                                    int num_vars) {
+  const int n_x = plant.num_positions() + plant.num_velocities();
+  VectorXd x = VectorXd::Random(num_vars);
+  x(0) = 0.1;
+  for (int start : multibody::QuaternionStartIndices(plant)) {
+    x.segment(1 + start, 4).normalize();
+    x.segment(1 + n_x + start, 4).normalize();
+  }
+  return x;
+}
+
+class DynamicsJacobianTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::srand(0);
+    // Planar walker, welded to the world (no quaternions)
+    planar_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser(planar_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    planar_->WeldFrames(planar_->world_frame(),
+                        planar_->GetFrameByName("base"),
+                        drake::math::RigidTransform<double>());
+    planar_->Finalize();
+    planar_ad_ = drake::systems::System<double>::ToAutoDiffXd(*planar_);
+
+    // Acrobot with a floating base, pinned to the world and with a distance
+    // constraint between its links (a passive 3D pendulum)
+    pendulum_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser(pendulum_.get())
+        .AddModelFromFile(FindResourceOrThrow(
+            "systems/trajectory_optimization/dircon/test/"
+            "acrobot_floating.urdf"));
+    pendulum_->Finalize();
+    pendulum_ad_ = drake::systems::System<double>::ToAutoDiffXd(*pendulum_);
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> planar_;
+  std::unique_ptr<MultibodyPlant<AutoDiffXd>> planar_ad_;
+  std::unique_ptr<MultibodyPlant<double>> pendulum_;
+  std::unique_ptr<MultibodyPlant<AutoDiffXd>> pendulum_ad_;
+};
+
+TEST_F(DynamicsJacobianTest, UnconstrainedCollocation) {
+  multibody::KinematicEvaluatorSet<double> evaluators(*planar_);
+  JacobianTester<DirconCollocationConstraint<double>> constraint(
+      *planar_, evaluators, nullptr, nullptr, 0, 0, nullptr, planar_ad_.get());
+  for (int trial = 0; trial < 3; trial++) {
+    ExpectJacobianMatchesFiniteDifference(
+        &constraint,
+        RandomCollocationVariables(*planar_, constraint.num_vars()));
+  }
+}
+
+TEST_F(DynamicsJacobianTest, ConstrainedPlanarWalker) {
+  // Foot contact (x and z) and a distance between the feet
+  multibody::WorldPointEvaluator<double> foot(
+      *planar_, Vector3d(0, 0, -0.5), planar_->GetFrameByName("left_lower_leg"),
+      Eigen::Matrix3d::Identity(), Vector3d::Zero(), {0, 2});
+  multibody::DistanceEvaluator<double> feet(
+      *planar_, Vector3d(0, 0, -0.5), planar_->GetFrameByName("left_lower_leg"),
+      Vector3d(0, 0, -0.5), planar_->GetFrameByName("right_lower_leg"), 0.3);
+  multibody::KinematicEvaluatorSet<double> evaluators(*planar_);
+  evaluators.add_evaluator(&foot);
+  evaluators.add_evaluator(&feet);
+
+  JacobianTester<DirconCollocationConstraint<double>> collocation(
+      *planar_, evaluators, nullptr, nullptr, 0, 0, nullptr, planar_ad_.get());
+  JacobianTester<CachedAccelerationConstraint<double>> acceleration(
+      *planar_, evaluators, nullptr, "acceleration", nullptr,
+      planar_ad_.get());
+  for (int trial = 0; trial < 3; trial++) {
+    ExpectJacobianMatchesFiniteDifference(
+        &collocation,
+        RandomCollocationVariables(*planar_, collocation.num_vars()));
+    ExpectJacobianMatchesFiniteDifference(
+        &acceleration, VectorXd::Random(acceleration.num_vars()));
+  }
+}
+
+// The gradients read the mass matrix (and its factorization) from the
+// KnotDynamics of the knot points, so a gradient evaluation computes it once
+// per knot, and the other constraints of the knot reuse it
+TEST_F(DynamicsJacobianTest, SharesKnotDynamics) {
+  multibody::WorldPointEvaluator<double> foot(
+      *planar_, Vector3d(0, 0, -0.5), planar_->GetFrameByName("left_lower_leg"),
+      Eigen::Matrix3d::Identity(), Vector3d::Zero(), {0, 2});
+  multibody::KinematicEvaluatorSet<double> evaluators(*planar_);
+  evaluators.add_evaluator(&foot);
+  auto context_0 = planar_->CreateDefaultContext();
+  auto context_1 = planar_->CreateDefaultContext();
+  KnotDynamics<double> dynamics_0(*planar_, evaluators);
+  KnotDynamics<double> dynamics_1(*planar_, evaluators);
+
+  JacobianTester<DirconCollocationConstraint<double>> collocation(
+      *planar_, evaluators, context_0.get(), context_1.get(), 0, 0, nullptr,
+      planar_ad_.get(), &dynamics_0, &dynamics_1);
+  JacobianTester<CachedAccelerationConstraint<double>> acceleration(
+      *planar_, evaluators, context_0.get(), "acceleration", nullptr,
+      planar_ad_.get(), &dynamics_0);
+
+  const int n_x = planar_->num_positions() + planar_->num_velocities();
+  const int n_u = planar_->num_actuators();
+  const int n_l = evaluators.count_full();
+  const VectorXd x =
+      RandomCollocationVariables(*planar_, collocation.num_vars());
+  VectorXd y;
+  MatrixXd dy;
+  collocation.EvaluateConstraintWithJacobian(x, &y, &dy);
+  EXPECT_EQ(dynamics_0.num_mass_matrix_evaluations(), 1);
+  EXPECT_EQ(dynamics_1.num_mass_matrix_evaluations(), 1);
+  EXPECT_EQ(dynamics_0.num_factorizations(), 1);
+  EXPECT_EQ(dynamics_1.num_factorizations(), 1);
+
+  // The acceleration constraint at the first knot point
+  VectorXd vars(acceleration.num_vars());
+  vars << x.segment(1, n_x), x.segment(1 + 2 * n_x, n_u),
+      x.segment(1 + 2 * (n_x + n_u), n_l);
+  acceleration.EvaluateConstraintWithJacobian(vars, &y, &dy);
+  EXPECT_EQ(dynamics_0.num_mass_matrix_evaluations(), 1);
+  EXPECT_EQ(dynamics_0.num_factorizations(), 1);
+
+  // Another gradient at the same knot states, and at a new one
+  collocation.EvaluateConstraintWithJacobian(x, &y, &dy);
+  EXPECT_EQ(dynamics_0.num_mass_matrix_evaluations(), 1);
+  EXPECT_EQ(dynamics_1.num_mass_matrix_evaluations(), 1);
+  VectorXd x_new = x;
+  x_new.segment(1, n_x) = VectorXd::Random(n_x);
+  collocation.EvaluateConstraintWithJacobian(x_new, &y, &dy);
+  EXPECT_EQ(dynamics_0.num_mass_matrix_evaluations(), 2);
+  EXPECT_EQ(dynamics_1.num_mass_matrix_evaluations(), 1);
+}
+
+TEST_F(DynamicsJacobianTest, ConstrainedFloatingPendulum) {
+  const auto& base = pendulum_->GetFrameByName("base_link");
+  const auto& lower_link = pendulum_->GetFrameByName("lower_link");
+  multibody::DistanceEvaluator<double> distance(
+      *pendulum_, Vector3d::Zero(), base, Vector3d(-1, 0, 0), lower_link, 0.7);
+  multibody::WorldPointEvaluator<double> pin(*pendulum_, Vector3d::Zero(),
+                                             base);
+  multibody::KinematicEvaluatorSet<double> evaluators(*pendulum_);
+  evaluators.add_evaluator(&distance);
+  evaluators.add_evaluator(&pin);
+
+  // (The quaternion slack variables enter the collocation constraint)
+  JacobianTester<DirconCollocationConstraint<double>> collocation(
+      *pendulum_, evaluators, nullptr, nullptr, 0, 0, nullptr,
+      pendulum_ad_.get());
+  JacobianTester<CachedAccelerationConstraint<double>> acceleration(
+      *pendulum_, evaluators, nullptr, "acceleration", nullptr,
+      pendulum_ad_.get());
+  for (int trial = 0; trial < 3; trial++) {
+    ExpectJacobianMatchesFiniteDifference(
+        &collocation,
+        RandomCollocationVariables(*pendulum_, collocation.num_vars()));
+    VectorXd vars = VectorXd::Random(acceleration.num_vars());
+    for (int start : multibody::QuaternionStartIndices(*pendulum_)) {
+      vars.segment(start, 4).normalize();
+    }
+    ExpectJacobianMatchesFiniteDifference(&acceleration, vars);
+  }
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,145 @@
+#include "systems/trajectory_optimization/dircon/knot_dynamics.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "drake/multibody/parsing/parser.h"
+#include "drake/multibody/plant/externally_applied_spatial_force.h"
+#include "drake/multibody/plant/multibody_plant.h"
+
+#include "common/find_resource.h"
+#include "multibody/kinematic/distance_evaluator.h"
+#include "multibody/kinematic/kinematic_evaluator_set.h"
+#include "multibody/kinematic/world_point_evaluator.h"
+#include "multibody/multibody_utils.h"
+
+namespace dairlib {
+namespace systems {
+namespace trajectory_optimization {
+namespace {
+
+using drake::multibody::ExternallyAppliedSpatialForce;
+using drake::multibody::MultibodyPlant;
+using drake::multibody::Parser;
+using drake::multibody::SpatialForce;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+// The planar walker with a foot contact (x and z) and a distance between its
+// feet, so that the constraint forces enter the dynamics
+class KnotDynamicsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    plant_ = std::make_unique<MultibodyPlant<double>>(0.0);
+    Parser(plant_.get())
+        .AddModelFromFile(
+            FindResourceOrThrow("examples/PlanarWalker/PlanarWalker.urdf"));
+    plant_->Finalize();
+    ASSERT_EQ(plant_->num_collision_geometries(), 0);
+    context_ = plant_->CreateDefaultContext();
+
+    const auto& left = plant_->GetFrameByName("left_lower_leg");
+    const auto& right = plant_->GetFrameByName("right_lower_leg");
+    foot_ = std::make_unique<multibody::WorldPointEvaluator<double>>(
+        *plant_, Vector3d(0, 0, -0.5), left, Eigen::Matrix3d::Identity(),
+        Vector3d::Zero(), std::vector<int>{0, 2});
+    feet_ = std::make_unique<multibody::DistanceEvaluator<double>>(
+        *plant_, Vector3d(0, 0, -0.5), left, Vector3d(0, 0, -0.5), right, 0.3);
+    evaluators_ =
+        std::make_unique<multibody::KinematicEvaluatorSet<double>>(*plant_);
+    evaluators_->add_evaluator(foot_.get());
+    evaluators_->add_evaluator(feet_.get());
+    std::srand(0);
+  }
+
+  void SetRandomState() {
+    multibody::setContext<double>(
+        *plant_,
+        VectorXd::Random(plant_->num_positions() + plant_->num_velocities()),
+        VectorXd::Random(plant_->num_actuators()), context_.get());
+  }
+
+  // Compares KnotDynamics to the evaluators at the state of context_
+  void ExpectMatchesEvaluators(KnotDynamics<double>* dynamics,
+                               const VectorXd& lambda) {
+    const VectorXd expected =
+        evaluators_->CalcTimeDerivativesWithForce(context_.get(), lambda);
+    const VectorXd xdot =
+        dynamics->CalcTimeDerivativesWithForce(context_.get(), lambda);
+    ASSERT_EQ(xdot.size(), expected.size());
+    EXPECT_LE((xdot - expected).lpNorm<Eigen::Infinity>(),
+              1e-10 * std::max(1.0, expected.lpNorm<Eigen::Infinity>()));
+  }
+
+  std::unique_ptr<MultibodyPlant<double>> plant_;
+  std::unique_ptr<drake::systems::Context<double>> context_;
+  std::unique_ptr<multibody::WorldPointEvaluator<double>> foot_;
+  std::unique_ptr<multibody::DistanceEvaluator<double>> feet_;
+  std::unique_ptr<multibody::KinematicEvaluatorSet<double>> evaluators_;
+};
+
+TEST_F(KnotDynamicsTest, MatchesEvaluators) {
+  KnotDynamics<double> dynamics(*plant_, *evaluators_);
+  for (int trial = 0; trial < 5; trial++) {
+    SetRandomState();
+    // Different inputs and forces at the same state reuse the factorization
+    for (int i = 0; i < 3; i++) {
+      plant_->get_actuation_input_port().FixValue(
+          context_.get(), VectorXd::Random(plant_->num_actuators()));
+      ExpectMatchesEvaluators(&dynamics,
+                              VectorXd::Random(evaluators_->count_full()));
+    }
+    EXPECT_EQ(dynamics.num_factorizations(), trial + 1);
+  }
+}
+
+// The derivatives with respect to u and lambda use the same factorization
+TEST_F(KnotDynamicsTest, MassMatrixInverseProducts) {
+  KnotDynamics<double> dynamics(*plant_, *evaluators_);
+  SetRandomState();
+  const Eigen::MatrixXd M = dynamics.EvalMassMatrix(*context_);
+  const Eigen::MatrixXd B = plant_->MakeActuationMatrix();
+  const Eigen::MatrixXd J = dynamics.EvalFullJacobian(*context_);
+  EXPECT_LE((M * dynamics.EvalMassMatrixInverseTimesB(*context_) - B)
+                .lpNorm<Eigen::Infinity>(),
+            1e-10);
+  EXPECT_LE((M * dynamics.EvalMassMatrixInverseTimesJacobianTranspose(
+                     *context_) -
+             J.transpose())
+                .lpNorm<Eigen::Infinity>(),
+            1e-10);
+  EXPECT_EQ(dynamics.num_mass_matrix_evaluations(), 1);
+  EXPECT_EQ(dynamics.num_factorizations(), 1);
+}
+
+// Port-applied generalized forces are replaced by the constraint forces in
+// both, and applied spatial forces make KnotDynamics use the evaluators
+TEST_F(KnotDynamicsTest, MatchesEvaluatorsWithAppliedForces) {
+  KnotDynamics<double> dynamics(*plant_, *evaluators_);
+  SetRandomState();
+  plant_->get_applied_generalized_force_input_port().FixValue(
+      context_.get(), VectorXd::Random(plant_->num_velocities()));
+  ExpectMatchesEvaluators(&dynamics,
+                          VectorXd::Random(evaluators_->count_full()));
+
+  ExternallyAppliedSpatialForce<double> force;
+  force.body_index = plant_->GetBodyByName("left_lower_leg").index();
+  force.p_BoBq_B = Vector3d(0, 0, -0.25);
+  force.F_Bq_W = SpatialForce<double>(Vector3d(0.5, -1, 2), Vector3d(3, 0, -4));
+  plant_->get_applied_spatial_force_input_port().FixValue(
+      context_.get(), std::vector<ExternallyAppliedSpatialForce<double>>{force});
+  ExpectMatchesEvaluators(&dynamics,
+                          VectorXd::Random(evaluators_->count_full()));
+}
+
+}  // namespace
+}  // namespace trajectory_optimization
+}  // namespace systems
+}  // namespace dairlib
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
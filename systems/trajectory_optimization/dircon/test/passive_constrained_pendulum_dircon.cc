@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <chrono>
+#include <type_traits>
 
 #include <gflags/gflags.h>
 
@@ -18,6 +19,7 @@
 
 #include "common/find_resource.h"
 #include "systems/trajectory_optimization/dircon/dircon.h"
+#include "systems/trajectory_optimization/dircon/dircon_mesh_refinement.h"
 #include "multibody/kinematic/distance_evaluator.h"
 #include "multibody/kinematic/world_point_evaluator.h"
 #include "multibody/multibody_utils.h"
@@ -34,6 +36,10 @@
 /// Runs DIRCON from a given initial condition.
 
 DEFINE_bool(autodiff, false, "Use double or autodiff");
+DEFINE_int32(knotpoints, 30,
+             "Number of knot points (of the first solve with mesh_refinement)");
+DEFINE_bool(mesh_refinement, false,
+            "Solve coarse-to-fine with DirconMeshRefinement (double only)");
 
 namespace dairlib {
 namespace {
@@ -49,6 +55,7 @@ using Eigen::MatrixXd;
 using systems::trajectory_optimization::DirconModeSequence;
 using systems::trajectory_optimization::DirconMode;
 using systems::trajectory_optimization::Dircon;
+using systems::trajectory_optimization::DirconMeshRefinement;
 
 // Fixed path to double pendulum SDF model.
 static const char* const kDoublePendulumUrdfPath =
@@ -98,17 +105,8 @@ void runDircon() {
   evaluators.add_evaluator(&distance_eval);
   evaluators.add_evaluator(&pin_eval);
 
-  int num_knotpoints = 30;
   double min_T = 3;
   double max_T = 3;
-  auto mode = DirconMode<T>(evaluators, num_knotpoints, min_T, max_T);
-
-  auto trajopt = Dircon<T>(&mode);
-
-  const double R = 100;  // Cost on input effort
-  auto u = trajopt.input();
-  trajopt.AddRunningCost(u.transpose()*R*u);
-
 
   auto positions_map = multibody::makeNameToPositionsMap(plant);
   auto velocities_map = multibody::makeNameToVelocitiesMap(plant);
@@ -117,44 +115,77 @@ void runDircon() {
   //   std::cout << it.first << std::endl;
   // }
 
-  // trajopt.SetSolverOption(drake::solvers::SnoptSolver::id(),
-  //                          "Print file", "../snopt.out");
-  trajopt.SetSolverOption(drake::solvers::SnoptSolver::id(),
-                           "Major iterations limit", 200);
-
-  int nx = plant.num_positions() + plant.num_velocities();
-  VectorXd times(num_knotpoints);
-  MatrixXd states(nx, num_knotpoints);
-  MatrixXd inputs(1, num_knotpoints);
-  for (int i = 0; i < num_knotpoints; i++) {
-    times(i) = min_T * i / (num_knotpoints - 1);
-    states.col(i) = .1*Eigen::VectorXd::Random(nx);
-    states.col(i).head(4) /= states.col(i).head(4).norm();
-    inputs.col(i) = Eigen::VectorXd::Zero(1);
-  }
-
-  auto traj_init_u = PiecewisePolynomial<double>::FirstOrderHold(times, inputs);
-  auto traj_init_x = PiecewisePolynomial<double>::FirstOrderHold(times, states);
-
-  trajopt.SetInitialTrajectory(traj_init_u, traj_init_x);
-
-  auto x0 = trajopt.initial_state();
-  // Set initial floating base orientation without overconstraining when
-  // combined with quaternion norm constraint
-  trajopt.AddLinearConstraint(x0(positions_map.at("base_qx")) == .2);
-  trajopt.AddLinearConstraint(x0(positions_map.at("base_qy")) == .3);
-  trajopt.AddLinearConstraint(x0(positions_map.at("base_qz")) == -.2);
-  trajopt.AddLinearConstraint(x0(positions_map.at("base_qw")) >= .1);
-  trajopt.AddLinearConstraint(x0(plant.num_positions() + 
-      velocities_map.at("base_wx")) == 0);
-  trajopt.AddLinearConstraint(x0(plant.num_positions() + 
-      velocities_map.at("base_wy")) == 0);
-  trajopt.AddLinearConstraint(x0(plant.num_positions() + 
-      velocities_map.at("base_wz")) == 0);
-
-
+  // Adds the costs, constraints and initial guess for any number of knots
+  auto setup = [&](Dircon<T>* trajopt) {
+    const int num_knotpoints = trajopt->N();
+    const double R = 100;  // Cost on input effort
+    auto u = trajopt->input();
+    trajopt->AddRunningCost(u.transpose()*R*u);
+
+    // trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
+    //                          "Print file", "../snopt.out");
+    trajopt->SetSolverOption(drake::solvers::SnoptSolver::id(),
+                             "Major iterations limit", 200);
+
+    int nx = plant.num_positions() + plant.num_velocities();
+    VectorXd times(num_knotpoints);
+    MatrixXd states(nx, num_knotpoints);
+    MatrixXd inputs(1, num_knotpoints);
+    for (int i = 0; i < num_knotpoints; i++) {
+      times(i) = min_T * i / (num_knotpoints - 1);
+      states.col(i) = .1*Eigen::VectorXd::Random(nx);
+      states.col(i).head(4) /= states.col(i).head(4).norm();
+      inputs.col(i) = Eigen::VectorXd::Zero(1);
+    }
+
+    auto traj_init_u =
+        PiecewisePolynomial<double>::FirstOrderHold(times, inputs);
+    auto traj_init_x =
+        PiecewisePolynomial<double>::FirstOrderHold(times, states);
+
+    trajopt->SetInitialTrajectory(traj_init_u, traj_init_x);
+
+    auto x0 = trajopt->initial_state();
+    // Set initial floating base orientation without overconstraining when
+    // combined with quaternion norm constraint
+    trajopt->AddLinearConstraint(x0(positions_map.at("base_qx")) == .2);
+    trajopt->AddLinearConstraint(x0(positions_map.at("base_qy")) == .3);
+    trajopt->AddLinearConstraint(x0(positions_map.at("base_qz")) == -.2);
+    trajopt->AddLinearConstraint(x0(positions_map.at("base_qw")) >= .1);
+    trajopt->AddLinearConstraint(x0(plant.num_positions() +
+        velocities_map.at("base_wx")) == 0);
+    trajopt->AddLinearConstraint(x0(plant.num_positions() +
+        velocities_map.at("base_wy")) == 0);
+    trajopt->AddLinearConstraint(x0(plant.num_positions() +
+        velocities_map.at("base_wz")) == 0);
+  };
+
+  drake::solvers::MathematicalProgramResult result;
+  PiecewisePolynomial<double> pp_xtraj;
   auto start = std::chrono::high_resolution_clock::now();
-  const auto result = Solve(trajopt, trajopt.initial_guess());
+  if constexpr (std::is_same<T, double>::value) {
+    if (FLAGS_mesh_refinement) {
+      DirconMeshRefinement refinement(
+          plant, {FLAGS_knotpoints},
+          [&](int mode_index, int num_knotpoints) {
+            return std::make_unique<DirconMode<double>>(
+                evaluators, num_knotpoints, min_T, max_T);
+          },
+          setup);
+      result = refinement.Solve(drake::solvers::SnoptSolver());
+      pp_xtraj = refinement.trajopt().ReconstructStateTrajectory(result);
+      std::cout << "Solves: " << refinement.num_iterations()
+                << ", final knot points: " << refinement.num_knotpoints()[0]
+                << std::endl;
+    }
+  }
+  if (!FLAGS_mesh_refinement) {
+    auto mode = DirconMode<T>(evaluators, FLAGS_knotpoints, min_T, max_T);
+    auto trajopt = Dircon<T>(&mode);
+    setup(&trajopt);
+    result = Solve(trajopt, trajopt.initial_guess());
+    pp_xtraj = trajopt.ReconstructStateTrajectory(result);
+  }
   auto finish = std::chrono::high_resolution_clock::now();
   std::chrono::duration<double> elapsed = finish - start;
   std::cout << "Solve time:" << elapsed.count() <<std::endl;
@@ -166,16 +197,7 @@ void runDircon() {
     std::cout << "Failure." << std::endl;
   }
 
-  // // Print out solution
-  // VectorXd z = result.GetSolution(trajopt.decision_variables());
-  // for (int i = 0; i < z.size(); i++) {
-  //   std::cout << trajopt.decision_variables()(i) << " = " << z(i) << std::endl;
-  // }
-
-
   // visualizer
-  const drake::trajectories::PiecewisePolynomial<double> pp_xtraj =
-      trajopt.ReconstructStateTrajectory(result);
   multibody::connectTrajectoryVisualizer(&plant_vis, &builder, &scene_graph,
                                          pp_xtraj);
   auto diagram = builder.Build();
@@ -194,6 +216,7 @@ void runDircon() {
 
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
+  DRAKE_DEMAND(!(FLAGS_autodiff && FLAGS_mesh_refinement));
   if (FLAGS_autodiff) {
     dairlib::runDircon<drake::AutoDiffXd>();
   } else {